@@ -292,6 +292,10 @@ namespace p2c::cli
 						if (!captureAll && (opts.multiCsv || targetCount == 1)) {
 							std::erase_if(pumps, [&](const auto& s) {return s->GetPid() == *p; });
 						}
+						// pid may be reused by a different process, so forget cached filter decisions
+						for (auto& pump : pumps) {
+							pump->NotifyProcessExit(*p);
+						}
 						// keep track of how many processes have exited
 						out << "Detected that process with pid [" << *p << "] has exited." << std::endl;
 						exitedProcessCount++;
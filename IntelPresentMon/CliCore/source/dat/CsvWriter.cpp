@@ -19,7 +19,10 @@ namespace p2c::cli::dat
 #undef X_
     };
 
-    CsvWriter::~CsvWriter() = default;
+    CsvWriter::~CsvWriter()
+    {
+        Flush();
+    }
     CsvWriter::CsvWriter(CsvWriter&&) = default;
     CsvWriter& CsvWriter::operator=(CsvWriter&&) = default;
 
@@ -61,19 +64,25 @@ namespace p2c::cli::dat
 #define X_(name, unit, symbol, transform, index, group) if (pGroupFlags_->group) { if (col++) buffer_ << ','; buffer_ << transform(frame.symbol index); }
         COLUMN_LIST
 #undef X_
-        buffer_ << "\n";
+        buffer_ << '\n';
 
-        Flush();
+        // rows accumulate in the buffer and are written out in blocks
+        if (buffer_.IsFull()) {
+            Flush();
+        }
     }
 
     void CsvWriter::Flush()
     {
-        const auto string = buffer_.GetString();
+        const auto string = buffer_.GetView();
+        if (string.empty()) {
+            return;
+        }
         if (writeStdout_) {
-            std::cout << string;
+            std::cout.write(string.data(), std::streamsize(string.size()));
         }
         if (file_) {
-            file_ << string;
+            file_.write(string.data(), std::streamsize(string.size()));
         }
         buffer_.Clear();
     }
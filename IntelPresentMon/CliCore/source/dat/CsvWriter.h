@@ -4,7 +4,11 @@
 #include <fstream>
 #include <memory>
 #include <vector>
-#include <sstream>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
 #include "FrameSink.h"
 #include <PresentMonAPI/PresentMonAPI.h>
 
@@ -32,42 +36,80 @@ namespace p2c::cli::dat
 		CsvWriter& operator=(CsvWriter&&);
 		~CsvWriter();
 		void Process(const struct PM_FRAME_DATA& frame) override;
+		void Flush() override;
 	private:
 		// types
+		// formats directly into a reusable char buffer with std::to_chars
+		// output matches default std::ostream formatting (%g with precision 6 for floating point)
 		class Buffer_
 		{
 		public:
+			Buffer_()
+			{
+				data_.reserve(blockSize * 2);
+			}
 			template<PresentMonOptional T>
 			Buffer_& operator<<(const T& input)
 			{
-				if (!input.valid) {
-					stream_ << "NA";
-				}
-				else {
-					stream_ << input.data;
+				if (input.valid) {
+					return *this << input.data;
 				}
+				data_.append("NA", 2);
+				return *this;
+			}
+			Buffer_& operator<<(char c)
+			{
+				data_.push_back(c);
 				return *this;
 			}
-			template<typename T>
-			Buffer_& operator<<(T&& input)
+			Buffer_& operator<<(const char* pString)
 			{
-				stream_ << std::forward<T>(input);
+				data_.append(pString, std::strlen(pString));
 				return *this;
 			}
-			std::string GetString() const
+			Buffer_& operator<<(std::string_view string)
+			{
+				data_.append(string);
+				return *this;
+			}
+			template<typename T> requires std::is_enum_v<T>
+			Buffer_& operator<<(T input)
+			{
+				return *this << static_cast<std::underlying_type_t<T>>(input);
+			}
+			template<typename T> requires std::is_integral_v<T> && (!std::same_as<T, char>)
+			Buffer_& operator<<(T input)
+			{
+				char digits[24];
+				const auto result = std::to_chars(std::begin(digits), std::end(digits), input);
+				data_.append(digits, result.ptr);
+				return *this;
+			}
+			template<typename T> requires std::is_floating_point_v<T>
+			Buffer_& operator<<(T input)
+			{
+				char digits[32];
+				const auto result = std::to_chars(std::begin(digits), std::end(digits), input,
+					std::chars_format::general, 6);
+				data_.append(digits, result.ptr);
+				return *this;
+			}
+			std::string_view GetView() const
+			{
+				return data_;
+			}
+			bool IsFull() const
 			{
-				return stream_.str();
+				return data_.size() >= blockSize;
 			}
 			void Clear()
 			{
-				stream_.str({});
-				stream_.clear();
+				data_.clear();
 			}
+			static constexpr size_t blockSize = 64 * 1024;
 		private:
-			std::stringstream stream_;
+			std::string data_;
 		};
-		// functions
-		void Flush();
 		// data
 		std::unique_ptr<GroupFlags> pGroupFlags_;
 		Buffer_ buffer_;
@@ -26,4 +26,10 @@ namespace p2c::cli::dat
 			procs_.emplace(frame.process_id, std::move(pWriter));
 		}
 	}
+	void FrameDemultiplexer::Flush()
+	{
+		for (auto& [pid, pWriter] : procs_) {
+			pWriter->Flush();
+		}
+	}
 }
\ No newline at end of file
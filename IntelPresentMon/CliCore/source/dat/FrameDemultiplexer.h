@@ -16,6 +16,7 @@ namespace p2c::cli::dat
 	public:
 		FrameDemultiplexer(std::vector<std::string> groups, std::optional<std::string> customFileName);
 		void Process(const PM_FRAME_DATA& frame) override;
+		void Flush() override;
 	private:
 		std::unordered_map<uint32_t, std::shared_ptr<CsvWriter>> procs_;
 		std::vector<std::string> groups_;
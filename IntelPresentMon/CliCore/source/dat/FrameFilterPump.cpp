@@ -1,5 +1,6 @@
 #include "FrameFilterPump.h"
 #include <CliCore/source/pmon/FrameDataStream.h>
+#include <PresentMonAPI/PresentMonAPI.h>
 #include <filesystem>
 #include <ranges>
 
@@ -27,22 +28,36 @@ namespace p2c::cli::dat
 	{
 		includes_.insert(pid);
 	}
+	void FrameFilterPump::NotifyProcessExit(uint32_t pid)
+	{
+		excludedByPid_.erase(pid);
+		if (lastExcludeDecision_ && lastExcludeDecision_->first == pid) {
+			lastExcludeDecision_.reset();
+		}
+	}
+	bool FrameFilterPump::IsExcluded_(const PM_FRAME_DATA& f)
+	{
+		if (lastExcludeDecision_ && lastExcludeDecision_->first == f.process_id) {
+			return lastExcludeDecision_->second;
+		}
+		auto i = excludedByPid_.find(f.process_id);
+		if (i == excludedByPid_.end()) {
+			// first frame seen for this pid, resolve by application name
+			auto appName = std::filesystem::path{ f.application }.filename().string();
+			if (ignoreCase_) {
+				appName = appName
+					| vi::transform([](char c) {return(char)std::tolower(c); })
+					| rn::to<std::basic_string>();
+			}
+			i = excludedByPid_.emplace(f.process_id, excludes_.contains(appName)).first;
+		}
+		lastExcludeDecision_.emplace(f.process_id, i->second);
+		return i->second;
+	}
 	void FrameFilterPump::Process(double timestamp)
 	{
 		for (auto& f : pSource_->Pull(timestamp)) {
-			// skip rows for applications in the exclude list
-			if (!excludes_.empty()) {
-				auto appName = std::filesystem::path{ f.application }.filename().string();
-				if (ignoreCase_) {
-					appName = appName
-						| vi::transform([](char c) {return(char)std::tolower(c); })
-						| rn::to<std::basic_string>();
-				}
-				if (excludes_.contains(appName)) {
-					continue;
-				}
-			}
-			// skip rows for pid NOT in the include list
+			// skip rows for pid NOT in the include list (cheap check first)
 			if (!includes_.empty()) {
 				if (!includes_.contains(f.process_id)) {
 					continue;
@@ -54,8 +69,15 @@ namespace p2c::cli::dat
 					continue;
 				}
 			}
+			// skip rows for applications in the exclude list
+			if (!excludes_.empty()) {
+				if (IsExcluded_(f)) {
+					continue;
+				}
+			}
 			pSink_->Process(f);
 		}
+		pSink_->Flush();
 	}
 	uint32_t FrameFilterPump::GetPid() const
 	{
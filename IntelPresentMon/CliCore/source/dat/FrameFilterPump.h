@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
+#include <optional>
 
 namespace p2c::cli::pmon
 {
@@ -25,14 +27,21 @@ namespace p2c::cli::dat
 			bool excludeDropped,
 			bool ignoreCase);
 		void AddInclude(uint32_t pid);
+		// drop cached exclude decision for pid so that a reused pid gets re-resolved
+		void NotifyProcessExit(uint32_t pid);
 		void Process(double timestamp);
 		uint32_t GetPid() const;
 	private:
+		// functions
+		bool IsExcluded_(const PM_FRAME_DATA& frame);
+		// data
 		std::shared_ptr<pmon::FrameDataStream> pSource_;
 		std::shared_ptr<FrameSink> pSink_;
-		// TODO: add exclude-by-pid to speed up filtering
 		std::unordered_set<std::string> excludes_;
-		// TODO: use includes for an early-pass in non-whitelist situations
+		// exclude decisions resolved from process name, cached per pid
+		std::unordered_map<uint32_t, bool> excludedByPid_;
+		// most recent decision, frames typically arrive in runs from the same pid
+		std::optional<std::pair<uint32_t, bool>> lastExcludeDecision_;
 		std::unordered_set<uint32_t> includes_;
 		bool ignoreCase_;
 		bool excludeDropped_;
@@ -10,5 +10,7 @@ namespace p2c::cli::dat
 	{
 	public:
 		virtual void Process(const PM_FRAME_DATA&) = 0;
+		// called after each batch of frames so sinks that buffer output can write it out
+		virtual void Flush() {}
 	};
 }
\ No newline at end of file
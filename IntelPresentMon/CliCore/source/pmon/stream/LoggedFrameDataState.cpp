@@ -26,7 +26,7 @@ namespace p2c::cli::pmon::stream
 		}
     }
 
-    std::vector<FrameDataStream::Struct> LoggedFrameDataState::Pull(double timestamp, uint32_t pid)
+    std::span<const FrameDataStream::Struct> LoggedFrameDataState::Pull(double timestamp, uint32_t pid)
     {
         if (!cacheTimestamp_ || cacheTimestamp_ != timestamp)
         {
@@ -82,14 +82,46 @@ namespace p2c::cli::pmon::stream
                     });
                 }
             }
+            RebuildPidIndex_();
         }
         // if pid is 0, return all frames
         if (pid == 0) {
             return cache_;
         }
-        // filter out frames not for this pid
-        return cache_ |
-            vi::filter([pid](const auto& frame){ return frame.process_id == pid; }) |
-            rn::to<std::vector>();
+        // lookup the range of frames for this pid
+        const auto i = rn::lower_bound(pidIndex_, pid, {}, &PidRange_::pid);
+        if (i == pidIndex_.end() || i->pid != pid) {
+            return {};
+        }
+        return std::span{ pidOrderedCache_ }.subspan(i->offset, i->count);
+    }
+
+    void LoggedFrameDataState::RebuildPidIndex_()
+    {
+        // count frames per pid
+        pidIndex_.clear();
+        for (const auto& frame : cache_) {
+            const auto i = rn::lower_bound(pidIndex_, frame.process_id, {}, &PidRange_::pid);
+            if (i == pidIndex_.end() || i->pid != frame.process_id) {
+                pidIndex_.insert(i, PidRange_{ .pid = frame.process_id, .offset = 0, .count = 1 });
+            }
+            else {
+                i->count++;
+            }
+        }
+        // convert counts to offsets
+        size_t offset = 0;
+        for (auto& range : pidIndex_) {
+            range.offset = offset;
+            offset += range.count;
+            // reuse count as the write cursor for scatter
+            range.count = 0;
+        }
+        // scatter frames into their pid groups (single copy per frame)
+        pidOrderedCache_.resize(cache_.size());
+        for (const auto& frame : cache_) {
+            auto& range = *rn::lower_bound(pidIndex_, frame.process_id, {}, &PidRange_::pid);
+            pidOrderedCache_[range.offset + range.count++] = frame;
+        }
     }
-}
\ No newline at end of file
+}
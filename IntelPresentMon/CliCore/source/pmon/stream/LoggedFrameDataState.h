@@ -5,6 +5,7 @@
 #include <optional>
 #include <vector>
 #include <string>
+#include <span>
 #include <unordered_set>
 
 namespace p2c::cli::cons
@@ -18,11 +19,27 @@ namespace p2c::cli::pmon::stream
     {
     public:
         LoggedFrameDataState(std::string filePath, cons::ConsoleWaitControl* pWaitControl);
-        std::vector<FrameDataStream::Struct> Pull(double timestamp, uint32_t pid);
+        // returned span is valid until the next Pull with a different timestamp
+        std::span<const FrameDataStream::Struct> Pull(double timestamp, uint32_t pid);
     private:
+        // types
+        struct PidRange_
+        {
+            uint32_t pid;
+            size_t offset;
+            size_t count;
+        };
+        // functions
+        void RebuildPidIndex_();
+        // data
         static constexpr size_t initialCacheSize_ = 120;
         std::optional<double> cacheTimestamp_;
+        // frames in the order they were received from the api
         std::vector<FrameDataStream::Struct> cache_;
+        // same frames grouped by pid (received order preserved within each pid)
+        std::vector<FrameDataStream::Struct> pidOrderedCache_;
+        // ranges into pidOrderedCache_, sorted by pid for binary search
+        std::vector<PidRange_> pidIndex_;
         cons::ConsoleWaitControl* pWaitControl_;
         std::unordered_set<uint32_t> pids_;
     };
@@ -10,18 +10,12 @@ namespace p2c::cli::pmon::stream
     LoggedFrameDataStream::LoggedFrameDataStream(uint32_t pid, std::shared_ptr<LoggedFrameDataState> pState)
         :
         pid_(pid),
-        cache_(initialCacheSize_),
         pState_{ std::move(pState) }
     {}
 
     std::span<const FrameDataStream::Struct> LoggedFrameDataStream::Pull(double timestamp)
     {
-        if (!cacheTimestamp_ || cacheTimestamp_ != timestamp)
-        {
-            cache_ = pState_->Pull(timestamp, pid_);
-            cacheTimestamp_ = timestamp;
-        }
-        return cache_;
+        return pState_->Pull(timestamp, pid_);
     }
     uint32_t LoggedFrameDataStream::GetPid() const
     {
@@ -23,10 +23,8 @@ namespace p2c::cli::pmon::stream
         std::span<const Struct> Pull(double timestamp) override;
         uint32_t GetPid() const override;
     private:
-        static constexpr size_t initialCacheSize_ = 120;
         uint32_t pid_;
+        // frames are cached and indexed by pid in the shared state, so no per-stream cache is needed
         std::shared_ptr<LoggedFrameDataState> pState_;
-        std::optional<double> cacheTimestamp_;
-        std::vector<Struct> cache_;
     };
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "win/WinAPI.h"
 #include "log/Log.h"
 #include <thread>
+#include <algorithm>
+#include <intrin.h>
+#include <immintrin.h>
 
 
 namespace pmon::util
@@ -33,6 +36,101 @@ namespace pmon::util
 		return double(end - start) * period;
 	}
 
+	namespace
+	{
+		bool CpuSupportsAvx2_() noexcept
+		{
+			int regs[4]{};
+			__cpuid(regs, 0);
+			if (regs[0] < 7) {
+				return false;
+			}
+			// os must save ymm state (osxsave + xcr0 bits 1 and 2)
+			__cpuid(regs, 1);
+			if ((regs[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0b110) != 0b110) {
+				return false;
+			}
+			__cpuidex(regs, 7, 0);
+			return (regs[1] & (1 << 5)) != 0;
+		}
+		const bool hasAvx2_ = CpuSupportsAvx2_();
+
+		// exact uint64 -> double conversion for 4 lanes (AVX2 has no native instruction for this)
+		// high and low 32-bit halves are injected into the mantissas of 2^84 and 2^52 and recombined
+		__m256d ConvertU64ToDouble_(__m256i v) noexcept
+		{
+			const __m256i magicLo = _mm256_set1_epi64x(0x4330000000000000); // 2^52
+			const __m256i magicHi = _mm256_set1_epi64x(0x4530000000000000); // 2^84
+			const __m256d magicAll = _mm256_set1_pd(19342813118337666422669312.); // 2^84 + 2^52
+			const __m256i lo = _mm256_blend_epi32(magicLo, v, 0b01010101);
+			const __m256i hi = _mm256_or_si256(_mm256_srli_epi64(v, 32), magicHi);
+			const __m256d hiDouble = _mm256_sub_pd(_mm256_castsi256_pd(hi), magicAll);
+			return _mm256_add_pd(hiDouble, _mm256_castsi256_pd(lo));
+		}
+
+		size_t TimestampDeltasToMilliSecondsAvx2_(const uint64_t* pDeltas, double* pOut, size_t count, double periodMs) noexcept
+		{
+			const __m256d period = _mm256_set1_pd(periodMs);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m256i delta = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pDeltas + i));
+				_mm256_storeu_pd(pOut + i, _mm256_mul_pd(ConvertU64ToDouble_(delta), period));
+			}
+			return i;
+		}
+
+		size_t TimestampDeltasToUnsignedMilliSecondsAvx2_(const uint64_t* pStarts, const uint64_t* pEnds,
+			double* pOut, size_t count, double periodMs) noexcept
+		{
+			const __m256d period = _mm256_set1_pd(periodMs);
+			const __m256i zero = _mm256_setzero_si256();
+			// flipping the sign bit turns the signed 64-bit compare into an unsigned one
+			const __m256i signBit = _mm256_set1_epi64x(int64_t(0x8000000000000000ull));
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const __m256i start = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pStarts + i));
+				const __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pEnds + i));
+				// valid = start != 0 && end > start
+				const __m256i startIsZero = _mm256_cmpeq_epi64(start, zero);
+				const __m256i endAfterStart = _mm256_cmpgt_epi64(
+					_mm256_xor_si256(end, signBit), _mm256_xor_si256(start, signBit));
+				const __m256i valid = _mm256_andnot_si256(startIsZero, endAfterStart);
+				const __m256d ms = _mm256_mul_pd(ConvertU64ToDouble_(_mm256_sub_epi64(end, start)), period);
+				_mm256_storeu_pd(pOut + i, _mm256_and_pd(ms, _mm256_castsi256_pd(valid)));
+			}
+			return i;
+		}
+	}
+
+	void TimestampDeltasToMilliSeconds(std::span<const uint64_t> deltas,
+		std::span<double> out, double periodMs) noexcept
+	{
+		const auto count = std::min(deltas.size(), out.size());
+		size_t i = 0;
+		if (hasAvx2_) {
+			i = TimestampDeltasToMilliSecondsAvx2_(deltas.data(), out.data(), count, periodMs);
+		}
+		for (; i < count; i++) {
+			out[i] = TimestampDeltaToMilliSeconds(deltas[i], periodMs);
+		}
+	}
+	void TimestampDeltasToUnsignedMilliSeconds(std::span<const uint64_t> starts,
+		std::span<const uint64_t> ends, std::span<double> out, double periodMs) noexcept
+	{
+		const auto count = std::min({ starts.size(), ends.size(), out.size() });
+		size_t i = 0;
+		if (hasAvx2_) {
+			i = TimestampDeltasToUnsignedMilliSecondsAvx2_(starts.data(), ends.data(), out.data(), count, periodMs);
+		}
+		for (; i < count; i++) {
+			out[i] = TimestampDeltaToUnsignedMilliSeconds(starts[i], ends[i], periodMs);
+		}
+	}
+	bool QpcBatchConversionIsVectorized() noexcept
+	{
+		return hasAvx2_;
+	}
+
 
 	QpcTimer::QpcTimer() noexcept
 	{
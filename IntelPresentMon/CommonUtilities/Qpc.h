@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include <cstdint>
+#include <span>
 
 namespace pmon::util
 {
@@ -10,6 +11,32 @@ namespace pmon::util
 	void SpinWaitUntilTimestamp(uint64_t timestamp) noexcept;
 	double TimestampDeltaToSeconds(uint64_t start, uint64_t end, double period) noexcept;
 
+	// qpc to millisecond conversions shared by the metric calculation paths
+	// periodMs is the duration of one qpc tick in milliseconds
+	inline double TimestampDeltaToMilliSeconds(uint64_t delta, double periodMs) noexcept
+	{
+		return periodMs * double(delta);
+	}
+	// unsigned delta clamps to 0 when start is unset (0) or end does not come after start
+	inline double TimestampDeltaToUnsignedMilliSeconds(uint64_t start, uint64_t end, double periodMs) noexcept
+	{
+		return start == 0 || end <= start ? 0.0 : TimestampDeltaToMilliSeconds(end - start, periodMs);
+	}
+	// signed delta is 0 when either timestamp is unset (0), negative when end precedes start
+	inline double TimestampDeltaToMilliSeconds(uint64_t start, uint64_t end, double periodMs) noexcept
+	{
+		return start == 0 || end == 0 || start == end ? 0.0 :
+			end > start ? TimestampDeltaToMilliSeconds(end - start, periodMs) :
+			-TimestampDeltaToMilliSeconds(start - end, periodMs);
+	}
+	// batch versions of the above, using AVX2 when supported by the cpu
+	// output span must be at least as long as the input span(s)
+	void TimestampDeltasToMilliSeconds(std::span<const uint64_t> deltas,
+		std::span<double> out, double periodMs) noexcept;
+	void TimestampDeltasToUnsignedMilliSeconds(std::span<const uint64_t> starts,
+		std::span<const uint64_t> ends, std::span<double> out, double periodMs) noexcept;
+	bool QpcBatchConversionIsVectorized() noexcept;
+
 	class QpcTimer
 	{
 	public:
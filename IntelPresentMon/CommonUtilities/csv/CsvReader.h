@@ -0,0 +1,296 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "../win/WinAPI.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PM_CSV_USE_SSE2 1
+#endif
+
+// Header-only so that tools outside of the IntelPresentMon solution (e.g., pm_convert_csv) can
+// use it without linking CommonUtilities.
+//
+// PresentMon CSVs never quote fields, so quotes have no special meaning here: a field is
+// everything between two commas (or a comma and a line end), trimmed of spaces and tabs.
+namespace pmon::util::csv
+{
+	// read-only view of a whole file, memory-mapped so that rows can be tokenized in place
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { Close(); }
+		bool Open(const std::wstring& path)
+		{
+			Close();
+			file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+				FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file_, &size) || uint64_t(size.QuadPart) > SIZE_MAX) {
+				Close();
+				return false;
+			}
+			// an empty file can't be mapped, but it's a valid (empty) csv
+			if (size.QuadPart == 0) {
+				return true;
+			}
+			mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_ == nullptr) {
+				Close();
+				return false;
+			}
+			view_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			if (view_ == nullptr) {
+				Close();
+				return false;
+			}
+			data_ = { view_, size_t(size.QuadPart) };
+			if (data_.starts_with("\xef\xbb\xbf")) {
+				data_.remove_prefix(3);
+			}
+			return true;
+		}
+		void Close()
+		{
+			if (view_) {
+				UnmapViewOfFile(view_);
+				view_ = nullptr;
+			}
+			if (mapping_) {
+				CloseHandle(mapping_);
+				mapping_ = nullptr;
+			}
+			if (file_ != INVALID_HANDLE_VALUE) {
+				CloseHandle(file_);
+				file_ = INVALID_HANDLE_VALUE;
+			}
+			data_ = {};
+		}
+		// file contents, excluding any UTF-8 byte order mark
+		std::string_view GetData() const { return data_; }
+	private:
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+		const char* view_ = nullptr;
+		std::string_view data_;
+	};
+
+	// splits csv text into rows of fields; fields are views into the text, so the text must
+	// outlive them
+	class Tokenizer
+	{
+	public:
+		Tokenizer() = default;
+		explicit Tokenizer(std::string_view data) : pos_{ data.data() }, end_{ data.data() + data.size() } {}
+		// reads the next row into fields, skipping blank lines; returns false at the end of the text
+		bool ReadRow(std::vector<std::string_view>& fields)
+		{
+			fields.clear();
+			auto fieldStart = pos_;
+			// delimiters are located 16 bytes at a time, then each is handled in turn
+			for (auto block = pos_; block < end_; block += 16) {
+				for (auto mask = GetDelimiterMask(block); mask != 0; mask &= mask - 1) {
+					const auto delimiter = block + std::countr_zero(mask);
+					fields.push_back(Trim(fieldStart, delimiter));
+					fieldStart = delimiter + 1;
+					if (*delimiter == '\n') {
+						line_++;
+						if (fields.size() == 1 && fields[0].empty()) {
+							fields.clear();
+							continue;
+						}
+						rowLine_ = line_;
+						pos_ = fieldStart;
+						return true;
+					}
+				}
+			}
+			// last row without a line end
+			pos_ = end_;
+			if (fieldStart < end_ || !fields.empty()) {
+				fields.push_back(Trim(fieldStart, end_));
+				if (fields.size() > 1 || !fields[0].empty()) {
+					rowLine_ = ++line_;
+					return true;
+				}
+			}
+			fields.clear();
+			return false;
+		}
+		// 1-based line number of the last row read, counting from the start of the tokenized text
+		size_t GetLine() const { return rowLine_; }
+		// the text following the last row read
+		std::string_view GetRemainder() const { return { pos_, size_t(end_ - pos_) }; }
+	private:
+		static std::string_view Trim(const char* begin, const char* end)
+		{
+			while (begin < end && (*begin == ' ' || *begin == '\t')) {
+				begin++;
+			}
+			while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+				end--;
+			}
+			return { begin, size_t(end - begin) };
+		}
+		// bit i is set if block[i] is ',' or '\n', for the bytes of the block before end_
+		uint32_t GetDelimiterMask(const char* block) const
+		{
+			const auto size = end_ - block;
+#ifdef PM_CSV_USE_SSE2
+			if (size >= 16) {
+				const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+				const auto delimiters = _mm_or_si128(
+					_mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')),
+					_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+				return uint32_t(_mm_movemask_epi8(delimiters));
+			}
+#endif
+			uint32_t mask = 0;
+			for (ptrdiff_t i = 0; i < 16 && i < size; i++) {
+				if (block[i] == ',' || block[i] == '\n') {
+					mask |= 1u << i;
+				}
+			}
+			return mask;
+		}
+		const char* pos_ = nullptr;
+		const char* end_ = nullptr;
+		size_t line_ = 0;
+		size_t rowLine_ = 0;
+	};
+
+	// maps the column names of a header row to their indices
+	class ColumnMap
+	{
+	public:
+		static constexpr size_t npos = SIZE_MAX;
+		ColumnMap() = default;
+		explicit ColumnMap(std::span<const std::string_view> header)
+		{
+			for (size_t i = 0; i < header.size(); i++) {
+				if (!indices_.emplace(std::string{ header[i] }, i).second) {
+					duplicate_ = std::string{ header[i] };
+				}
+			}
+			count_ = header.size();
+		}
+		// index of the named column, or npos if it isn't present
+		size_t Find(std::string_view name) const
+		{
+			if (auto i = indices_.find(std::string{ name }); i != indices_.end()) {
+				return i->second;
+			}
+			return npos;
+		}
+		size_t GetCount() const { return count_; }
+		// the name of a column that appeared more than once in the header, if any
+		const std::optional<std::string>& GetDuplicate() const { return duplicate_; }
+	private:
+		std::unordered_map<std::string, size_t> indices_;
+		size_t count_ = 0;
+		std::optional<std::string> duplicate_;
+	};
+
+	// "NA" marks a metric that doesn't apply to a frame
+	inline bool IsNA(std::string_view field)
+	{
+		return field == "NA";
+	}
+
+	// parses a whole field as T, returning false if it isn't entirely a valid T; integers with a
+	// 0x prefix are parsed as hexadecimal
+	template<class T>
+	bool ParseField(std::string_view field, T& value)
+	{
+		const auto begin = field.data();
+		const auto end = begin + field.size();
+		std::from_chars_result result;
+		if constexpr (std::is_floating_point_v<T>) {
+			result = std::from_chars(begin, end, value);
+		}
+		else if constexpr (std::is_same_v<T, bool>) {
+			uint32_t v = 0;
+			result = std::from_chars(begin, end, v);
+			if (result.ec == std::errc{} && v > 1) {
+				return false;
+			}
+			value = v != 0;
+		}
+		else {
+			static_assert(std::is_integral_v<T>);
+			if (field.size() > 2 && field[0] == '0' && (field[1] == 'x' || field[1] == 'X')) {
+				result = std::from_chars(begin + 2, end, value, 16);
+			}
+			else {
+				result = std::from_chars(begin, end, value);
+			}
+		}
+		return result.ec == std::errc{} && result.ptr == end;
+	}
+
+	// as ParseField(), but an NA field resets value
+	template<class T>
+	bool ParseField(std::string_view field, std::optional<T>& value)
+	{
+		if (IsNA(field)) {
+			value.reset();
+			return true;
+		}
+		T v{};
+		if (!ParseField(field, v)) {
+			return false;
+		}
+		value = v;
+		return true;
+	}
+
+	// splits text into at most chunkCount chunks of whole rows of roughly equal size
+	inline std::vector<std::string_view> SplitIntoChunks(std::string_view text, size_t chunkCount)
+	{
+		std::vector<std::string_view> chunks;
+		const auto targetSize = text.size() / std::max<size_t>(chunkCount, 1) + 1;
+		while (!text.empty()) {
+			auto size = text.size();
+			if (size > targetSize) {
+				const auto lineEnd = text.find('\n', targetSize - 1);
+				size = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+			}
+			chunks.push_back(text.substr(0, size));
+			text.remove_prefix(size);
+		}
+		return chunks;
+	}
+
+	// calls parseChunk(index, chunk) for each chunk, each on its own thread, and waits for them
+	// all to return
+	template<class F>
+	void ParseChunksInParallel(std::span<const std::string_view> chunks, F&& parseChunk)
+	{
+		if (chunks.size() == 1) {
+			parseChunk(size_t(0), chunks[0]);
+			return;
+		}
+		std::vector<std::jthread> threads;
+		threads.reserve(chunks.size());
+		for (size_t i = 0; i < chunks.size(); i++) {
+			threads.emplace_back([&parseChunk, &chunks, i] { parseChunk(i, chunks[i]); });
+		}
+	}
+}
@@ -0,0 +1,216 @@
+#include "PollScheduler.h"
+#include <algorithm>
+#include <limits>
+
+namespace pmon::util::mt
+{
+	namespace
+	{
+		double ToMs_(PollScheduler::Clock::duration d)
+		{
+			return std::chrono::duration<double, std::milli>(d).count();
+		}
+		void Accumulate_(uint64_t n, double sample, double& mean, double& max)
+		{
+			mean += (sample - mean) / double(n);
+			max = std::max(max, sample);
+		}
+	}
+
+	PollScheduler::PollScheduler(size_t workerCount, Clock::duration tickPeriod, size_t slotCount)
+		:
+		epoch_{ Clock::now() },
+		tickPeriod_{ std::max(tickPeriod, Clock::duration{ 1 }) },
+		wheel_(std::max(slotCount, size_t(1)))
+	{
+		workerCount = std::max(workerCount, size_t(1));
+		for (size_t i = 0; i < workerCount; i++) {
+			workers_.emplace_back([this] { WorkerLoop_(); });
+		}
+		dispatcher_ = std::jthread{ [this] { DispatcherLoop_(); } };
+	}
+
+	PollScheduler::~PollScheduler()
+	{
+		{
+			std::lock_guard lk{ mtx_ };
+			stopping_ = true;
+		}
+		dispatchCv_.notify_all();
+		workCv_.notify_all();
+		// explicit joins so that threads are finished before any other member is destroyed
+		dispatcher_.join();
+		for (auto& w : workers_) {
+			w.join();
+		}
+	}
+
+	uint32_t PollScheduler::AddSource(std::function<void()> sample, Clock::duration period)
+	{
+		uint32_t id;
+		{
+			std::lock_guard lk{ mtx_ };
+			id = uint32_t(sources_.size());
+			auto& src = sources_.emplace_back();
+			src.sample = std::move(sample);
+			src.period = std::max(period, tickPeriod_);
+			src.nextDue = Clock::now();
+			Insert_(id);
+		}
+		dispatchCv_.notify_one();
+		return id;
+	}
+
+	void PollScheduler::SetPeriod(uint32_t id, Clock::duration period)
+	{
+		{
+			std::lock_guard lk{ mtx_ };
+			auto& src = sources_.at(id);
+			period = std::max(period, tickPeriod_);
+			if (period == src.period) {
+				return;
+			}
+			src.period = period;
+			src.generation++;
+			src.nextDue = Clock::now() + period;
+			Insert_(id);
+		}
+		dispatchCv_.notify_one();
+	}
+
+	PollScheduler::Clock::duration PollScheduler::GetPeriod(uint32_t id) const
+	{
+		std::lock_guard lk{ mtx_ };
+		return sources_.at(id).period;
+	}
+
+	PollStats PollScheduler::GetStats(uint32_t id) const
+	{
+		std::lock_guard lk{ mtx_ };
+		return sources_.at(id).stats;
+	}
+
+	size_t PollScheduler::GetSourceCount() const
+	{
+		std::lock_guard lk{ mtx_ };
+		return sources_.size();
+	}
+
+	uint64_t PollScheduler::TickOf_(Clock::time_point t) const
+	{
+		if (t <= epoch_) {
+			return 0;
+		}
+		// round up so that a source is never dispatched before its nominal time
+		return uint64_t((t - epoch_ + tickPeriod_ - Clock::duration{ 1 }) / tickPeriod_);
+	}
+
+	PollScheduler::Clock::time_point PollScheduler::TimeOf_(uint64_t tick) const
+	{
+		return epoch_ + tickPeriod_ * tick;
+	}
+
+	void PollScheduler::Insert_(uint32_t id)
+	{
+		const auto& src = sources_[id];
+		// never schedule into a tick the dispatcher has already passed
+		const auto dueTick = std::max(TickOf_(src.nextDue), cursorTick_);
+		wheel_[dueTick % wheel_.size()].push_back({ id, src.generation, dueTick });
+	}
+
+	void PollScheduler::ProcessTick_(uint64_t tick, Clock::time_point now)
+	{
+		auto& slot = wheel_[tick % wheel_.size()];
+		// entries for later revolutions of the wheel stay in the slot
+		std::vector<WheelEntry_> due;
+		std::erase_if(slot, [&](const WheelEntry_& e) {
+			if (e.dueTick > tick) {
+				return false;
+			}
+			if (e.generation == sources_[e.id].generation) {
+				due.push_back(e);
+			}
+			return true;
+		});
+		for (auto& e : due) {
+			auto& src = sources_[e.id];
+			if (src.inFlight) {
+				src.stats.overrunCount++;
+			}
+			else {
+				src.inFlight = true;
+				jobs_.push_back({ e.id, src.nextDue });
+			}
+			// advance on a fixed cadence, skipping whole periods that have already been missed
+			src.nextDue += src.period;
+			if (src.nextDue <= now) {
+				src.nextDue += src.period * ((now - src.nextDue) / src.period + 1);
+			}
+			Insert_(e.id);
+		}
+		if (!due.empty()) {
+			workCv_.notify_all();
+		}
+	}
+
+	void PollScheduler::DispatcherLoop_()
+	{
+		std::unique_lock lk{ mtx_ };
+		while (!stopping_) {
+			// sleep until the earliest tick with an entry, or until the schedule changes
+			uint64_t nextTick = std::numeric_limits<uint64_t>::max();
+			for (auto& slot : wheel_) {
+				for (auto& e : slot) {
+					nextTick = std::min(nextTick, e.dueTick);
+				}
+			}
+			if (nextTick == std::numeric_limits<uint64_t>::max()) {
+				dispatchCv_.wait(lk);
+				continue;
+			}
+			nextTick = std::max(nextTick, cursorTick_);
+			if (Clock::now() < TimeOf_(nextTick)) {
+				dispatchCv_.wait_until(lk, TimeOf_(nextTick));
+				continue;
+			}
+			// process every tick up to now (catching up if the dispatcher was delayed)
+			const auto now = Clock::now();
+			const auto nowTick = std::max(now - epoch_, Clock::duration{}) / tickPeriod_;
+			// when far behind jump straight to the earliest populated tick instead of walking empty ones
+			cursorTick_ = std::max(cursorTick_, nextTick);
+			for (; cursorTick_ <= uint64_t(nowTick); cursorTick_++) {
+				ProcessTick_(cursorTick_, now);
+			}
+		}
+	}
+
+	void PollScheduler::WorkerLoop_()
+	{
+		std::unique_lock lk{ mtx_ };
+		while (true) {
+			workCv_.wait(lk, [this] { return stopping_ || !jobs_.empty(); });
+			if (stopping_) {
+				return;
+			}
+			const auto job = jobs_.front();
+			jobs_.pop_front();
+			auto& sample = sources_[job.id].sample;
+			lk.unlock();
+			const auto start = Clock::now();
+			sample();
+			const auto end = Clock::now();
+			lk.lock();
+			CompleteSample_(job.id, job.nominal, start, end);
+		}
+	}
+
+	void PollScheduler::CompleteSample_(uint32_t id, Clock::time_point nominal, Clock::time_point start, Clock::time_point end)
+	{
+		auto& src = sources_[id];
+		src.inFlight = false;
+		auto& stats = src.stats;
+		stats.sampleCount++;
+		Accumulate_(stats.sampleCount, std::max(ToMs_(start - nominal), 0.), stats.meanJitterMs, stats.maxJitterMs);
+		Accumulate_(stats.sampleCount, ToMs_(end - start), stats.meanDurationMs, stats.maxDurationMs);
+	}
+}
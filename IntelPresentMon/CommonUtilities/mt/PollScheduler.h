@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+namespace pmon::util::mt
+{
+	// timing statistics for one polled source
+	// jitter is how late a sample started relative to its nominal time on the source's cadence
+	struct PollStats
+	{
+		uint64_t sampleCount = 0;
+		// samples skipped because the previous sample of the same source was still running
+		uint64_t overrunCount = 0;
+		double meanJitterMs = 0.;
+		double maxJitterMs = 0.;
+		double meanDurationMs = 0.;
+		double maxDurationMs = 0.;
+	};
+
+	// schedules periodic sampling of multiple sources, each with its own period
+	// due times are kept on a hashed timer wheel serviced by one dispatcher thread, and samples
+	// execute on a small worker pool so that a slow source does not delay the others
+	// a source never has more than one sample in flight
+	class PollScheduler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		PollScheduler(size_t workerCount, Clock::duration tickPeriod = std::chrono::milliseconds{ 1 }, size_t slotCount = 256);
+		PollScheduler(const PollScheduler&) = delete;
+		PollScheduler& operator=(const PollScheduler&) = delete;
+		PollScheduler(PollScheduler&&) = delete;
+		PollScheduler& operator=(PollScheduler&&) = delete;
+		~PollScheduler();
+		// returns id of the source, first sample is due immediately (sample must not throw)
+		uint32_t AddSource(std::function<void()> sample, Clock::duration period);
+		// new period takes effect from now (next sample due one new period from now)
+		void SetPeriod(uint32_t id, Clock::duration period);
+		Clock::duration GetPeriod(uint32_t id) const;
+		PollStats GetStats(uint32_t id) const;
+		size_t GetSourceCount() const;
+	private:
+		// types
+		struct Source_
+		{
+			std::function<void()> sample;
+			Clock::duration period;
+			Clock::time_point nextDue;
+			// incremented when the source is rescheduled out of band, stale wheel entries are dropped
+			uint32_t generation = 0;
+			bool inFlight = false;
+			PollStats stats;
+		};
+		struct WheelEntry_
+		{
+			uint32_t id;
+			uint32_t generation;
+			uint64_t dueTick;
+		};
+		struct Job_
+		{
+			uint32_t id;
+			Clock::time_point nominal;
+		};
+		// functions
+		void DispatcherLoop_();
+		void WorkerLoop_();
+		uint64_t TickOf_(Clock::time_point t) const;
+		Clock::time_point TimeOf_(uint64_t tick) const;
+		void Insert_(uint32_t id);
+		void ProcessTick_(uint64_t tick, Clock::time_point now);
+		void CompleteSample_(uint32_t id, Clock::time_point nominal, Clock::time_point start, Clock::time_point end);
+		// data
+		Clock::time_point epoch_;
+		Clock::duration tickPeriod_;
+		mutable std::mutex mtx_;
+		std::condition_variable dispatchCv_;
+		std::condition_variable workCv_;
+		bool stopping_ = false;
+		std::deque<Source_> sources_;
+		std::vector<std::vector<WheelEntry_>> wheel_;
+		// next tick the dispatcher has yet to process
+		uint64_t cursorTick_ = 0;
+		std::deque<Job_> jobs_;
+		std::vector<std::jthread> workers_;
+		std::jthread dispatcher_;
+	};
+}
@@ -1,6 +1,7 @@
 #include "Pipe.h"
 #include <sddl.h>
 #include <string_view>
+#include <array>
 
 namespace pmon::util::pipe
 {
@@ -112,6 +113,9 @@ namespace pmon::util::pipe
 		writeStream_{ &writeBuf_ },
 		writeArchive_{ writeStream_ }
 	{
+		// pre-size the reusable buffers so that typical small packets never reallocate
+		readBuf_.prepare(initialBufferCapacity_);
+		writeBuf_.prepare(initialBufferCapacity_);
 		if (asClient) {
 			// client is automatically connected upon creation, so immediatly transfer pipe to asio
 			asioPipeHandle_.assign(rawPipeHandle_.Release());
@@ -177,38 +181,42 @@ namespace pmon::util::pipe
 	}
 	as::awaitable<void> DuplexPipe::Read_(size_t byteCount, std::optional<uint32_t> timeoutMs)
 	{
-		if (timeoutMs) {
-			const auto result = co_await(as::async_read(asioPipeHandle_, readBuf_, as::transfer_exactly(byteCount),
-				as::as_tuple(as::use_awaitable)) || Timeout_(*timeoutMs));
-			// 2nd index active means timed out
-			if (result.index() == 1) {
-				throw Except<PipeError>("Timeout during read");
-			}
-			// otherwise 1st index active => extract error code and transform
-			auto&& [ec, n] = std::get<0>(result);
-			TransformError_(ec);
-		}
-		else {
-			const auto [ec, n] = co_await as::async_read(asioPipeHandle_, readBuf_, as::transfer_exactly(byteCount),
-				as::as_tuple(as::use_awaitable));
-			TransformError_(ec);
-		}
+		co_await Complete_(as::async_read(asioPipeHandle_, readBuf_, as::transfer_exactly(byteCount),
+			as::as_tuple(as::use_awaitable)), timeoutMs, "read");
+	}
+	as::awaitable<uint32_t> DuplexPipe::ReadSize_(std::optional<uint32_t> timeoutMs)
+	{
+		co_await Complete_(as::async_read(asioPipeHandle_, as::buffer(&readSize_, sizeof(readSize_)),
+			as::as_tuple(as::use_awaitable)), timeoutMs, "read");
+		co_return readSize_;
 	}
 	as::awaitable<void> DuplexPipe::Write_(std::optional<uint32_t> timeoutMs)
+	{
+		// gather write of size prefix and serialized body, avoids patching a size placeholder in the body buffer
+		const std::array<as::const_buffer, 2> buffers{
+			as::buffer(&writeSize_, sizeof(writeSize_)),
+			writeBuf_.data(),
+		};
+		co_await Complete_(as::async_write(asioPipeHandle_, buffers, as::as_tuple(as::use_awaitable)),
+			timeoutMs, "write");
+		// buffer sequence writes do not consume from the streambuf, storage is retained for the next packet
+		writeBuf_.consume(writeBuf_.size());
+	}
+	as::awaitable<void> DuplexPipe::Complete_(as::awaitable<std::tuple<boost::system::error_code, size_t>> op,
+		std::optional<uint32_t> timeoutMs, const char* opName)
 	{
 		if (timeoutMs) {
-			const auto result = co_await(as::async_write(asioPipeHandle_, writeBuf_, as::as_tuple(as::use_awaitable))
-				|| Timeout_(*timeoutMs));
+			const auto result = co_await(std::move(op) || Timeout_(*timeoutMs));
 			// 2nd index active means timed out
 			if (result.index() == 1) {
-				throw Except<PipeError>("Timeout during write");
+				throw Except<PipeError>(std::format("Timeout during {}", opName));
 			}
 			// otherwise 1st index active => extract error code and transform
 			auto&& [ec, n] = std::get<0>(result);
 			TransformError_(ec);
 		}
 		else {
-			const auto [ec, n] = co_await as::async_write(asioPipeHandle_, writeBuf_, as::as_tuple(as::use_awaitable));
+			const auto [ec, n] = co_await std::move(op);
 			TransformError_(ec);
 		}
 	}
@@ -20,6 +20,10 @@ namespace pmon::util::pipe
 	PM_DEFINE_EX(PipeError);
 	PM_DEFINE_EX_FROM(PipeError, PipeBroken);
 
+	// payloads that opt in with a static fixedLayout flag are transferred as raw bytes, bypassing cereal
+	template<class P>
+	concept FixedLayoutPayload = std::is_trivially_copyable_v<P> && requires { P::fixedLayout; } && bool(P::fixedLayout);
+
 	class DuplexPipe
 	{
 	public:
@@ -38,21 +42,16 @@ namespace pmon::util::pipe
 		{
 			assert(writeBuf_.size() == 0);
 			assert(asioPipeHandle_.is_open());
-			// first we directly write bytes for the size of the body as a placeholder until we know how many are serialized
-			const uint32_t placeholderSize = 'TEMP';
-			writeStream_.write(reinterpret_cast<const char*>(&placeholderSize), sizeof(placeholderSize));
-			// record how many bytes used for the serialization of the size
-			const auto sizeSize = writeBuf_.size();
-			// serialize the packet body
-			writeArchive_(header, payload);
-			// calculate size of body
-			const auto payloadSize = uint32_t(writeBuf_.size() - sizeSize);
-			// replace the placeholder with the actual body size
-			auto bufSeq = writeBuf_.data();
-			const auto iSize = const_cast<char*>(as::buffer_cast<const char*>(bufSeq));
-			auto replacement = std::string_view{ reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize) };
-			std::ranges::copy(replacement, iSize);
-			// transmit the packet
+			// serialize the packet body (header then payload) into the reusable write buffer
+			writeArchive_(header);
+			if constexpr (FixedLayoutPayload<P>) {
+				writeBuf_.commit(as::buffer_copy(writeBuf_.prepare(sizeof(P)), as::buffer(&payload, sizeof(P))));
+			}
+			else {
+				writeArchive_(payload);
+			}
+			// size prefix is gathered from its own buffer together with the body when transmitting
+			writeSize_ = uint32_t(writeBuf_.size());
 			co_await Write_(timeoutMs);
 		}
 		template<class H>
@@ -61,10 +60,8 @@ namespace pmon::util::pipe
 			assert(readBuf_.size() == 0);
 			assert(asioPipeHandle_.is_open());
 			// read in request
-			// first read the number of bytes in the request payload (always 4-byte read)
-			uint32_t payloadSize;
-			co_await Read_(sizeof(payloadSize), timeoutMs);
-			readStream_.read(reinterpret_cast<char*>(&payloadSize), sizeof(payloadSize));
+			// first read the number of bytes in the request payload (always 4-byte read, direct to integer)
+			const auto payloadSize = co_await ReadSize_(timeoutMs);
 			// read the payload
 			co_await Read_(payloadSize, timeoutMs);
 			// deserialize header portion of request payload
@@ -76,7 +73,13 @@ namespace pmon::util::pipe
 		P ConsumePacketPayload()
 		{
 			P payload;
-			readArchive_(payload);
+			if constexpr (FixedLayoutPayload<P>) {
+				assert(readBuf_.size() >= sizeof(P));
+				readBuf_.consume(as::buffer_copy(as::buffer(&payload, sizeof(P)), readBuf_.data()));
+			}
+			else {
+				readArchive_(payload);
+			}
 			if (const auto sz = readBuf_.size()) {
 				assert("unexpected data when reading packet payload from buffer!!" && false);
 				pmlog_warn(std::format("Buffer contained unexpected data of size", sz));
@@ -97,19 +100,27 @@ namespace pmon::util::pipe
 		static HANDLE Make_(const std::string& name, const std::string& security = {});
 		// wrapper to convert EOF system_error to PipeBroken error, with optional timeout
 		as::awaitable<void> Read_(size_t byteCount, std::optional<uint32_t> timeoutMs = {});
+		// read packet size prefix directly into an integer (bypasses read buffer)
+		as::awaitable<uint32_t> ReadSize_(std::optional<uint32_t> timeoutMs = {});
 		// wrapper to convert EOF system_error to PipeBroken error, with optional timeout
 		as::awaitable<void> Write_(std::optional<uint32_t> timeoutMs = {});
 		as::awaitable<void> Timeout_(uint32_t ms);
+		// await an io operation, racing it against a timeout when specified, and transform errors
+		as::awaitable<void> Complete_(as::awaitable<std::tuple<boost::system::error_code, size_t>> op,
+			std::optional<uint32_t> timeoutMs, const char* opName);
 		void TransformError_(const boost::system::error_code& ec);
 		// data
+		static constexpr size_t initialBufferCapacity_ = 4096;
 		static std::atomic<uint32_t> nextUid_;
 		std::string name_;
 		uint32_t uid_ = nextUid_++;
 		win::Handle rawPipeHandle_;
 		as::windows::stream_handle asioPipeHandle_;
+		uint32_t readSize_ = 0;
 		as::streambuf readBuf_;
 		std::istream readStream_;
 		cereal::BinaryInputArchive readArchive_;
+		uint32_t writeSize_ = 0;
 		as::streambuf writeBuf_;
 		std::ostream writeStream_;
 		cereal::BinaryOutputArchive writeArchive_;
@@ -153,7 +153,7 @@ bool AmdPowerTelemetryAdapter::Sample() noexcept {
 
   // Insert telemetry into history
   std::lock_guard lock{history_mutex_};
-  history_.Push(info);
+  history_.Push(info, GetPowerTelemetryCapBits());
 
   return sample_return;
 }
@@ -4,7 +4,7 @@
 #include <mutex>
 #include <source_location>
 #include "PowerTelemetryAdapter.h"
-#include "TelemetryHistory.h"
+#include "ColumnarTelemetryHistory.h"
 #include "Adl2Wrapper.h"
 
 namespace pwr::amd {
@@ -44,7 +44,8 @@ class AmdPowerTelemetryAdapter : public PowerTelemetryAdapter {
   int overdrive_version_ = 0;
   std::string name_ = "Unknown Adapter Name";
   mutable std::mutex history_mutex_;
-  TelemetryHistory<PresentMonPowerTelemetryInfo> history_{
-      PowerTelemetryAdapter::defaultHistorySize};
+  ColumnarTelemetryHistory history_{
+      PowerTelemetryAdapter::defaultHistorySize,
+      PowerTelemetryAdapter::defaultColdHistoryBlockCount};
 };
 }
\ No newline at end of file
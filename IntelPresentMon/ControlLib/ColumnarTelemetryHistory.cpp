@@ -0,0 +1,365 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "ColumnarTelemetryHistory.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+namespace pwr
+{
+    namespace
+    {
+        using Info = PresentMonPowerTelemetryInfo;
+        using Cap = GpuTelemetryCapBits;
+
+        struct Field_
+        {
+            size_t offset;
+            size_t size;
+        };
+
+#define PM_TELEMETRY_FIELD_(member) Field_{ offsetof(Info, member), sizeof(Info::member) }
+#define PM_TELEMETRY_ELEMENT_(member, i) Field_{ offsetof(Info, member) + sizeof(Info::member[0]) * (i), sizeof(Info::member[0]) }
+
+        // location of the struct field that each cap bit reports on
+        Field_ GetCapField_(Cap cap) noexcept
+        {
+            switch (cap) {
+            case Cap::time_stamp: return PM_TELEMETRY_FIELD_(time_stamp);
+            case Cap::gpu_power: return PM_TELEMETRY_FIELD_(gpu_power_w);
+            case Cap::gpu_sustained_power_limit: return PM_TELEMETRY_FIELD_(gpu_sustained_power_limit_w);
+            case Cap::gpu_voltage: return PM_TELEMETRY_FIELD_(gpu_voltage_v);
+            case Cap::gpu_frequency: return PM_TELEMETRY_FIELD_(gpu_frequency_mhz);
+            case Cap::gpu_temperature: return PM_TELEMETRY_FIELD_(gpu_temperature_c);
+            case Cap::gpu_utilization: return PM_TELEMETRY_FIELD_(gpu_utilization);
+            case Cap::gpu_render_compute_utilization: return PM_TELEMETRY_FIELD_(gpu_render_compute_utilization);
+            case Cap::gpu_media_utilization: return PM_TELEMETRY_FIELD_(gpu_media_utilization);
+            case Cap::vram_power: return PM_TELEMETRY_FIELD_(vram_power_w);
+            case Cap::vram_voltage: return PM_TELEMETRY_FIELD_(vram_voltage_v);
+            case Cap::vram_frequency: return PM_TELEMETRY_FIELD_(vram_frequency_mhz);
+            case Cap::vram_effective_frequency: return PM_TELEMETRY_FIELD_(vram_effective_frequency_gbps);
+            case Cap::vram_temperature: return PM_TELEMETRY_FIELD_(vram_temperature_c);
+            case Cap::fan_speed_0: return PM_TELEMETRY_ELEMENT_(fan_speed_rpm, 0);
+            case Cap::fan_speed_1: return PM_TELEMETRY_ELEMENT_(fan_speed_rpm, 1);
+            case Cap::fan_speed_2: return PM_TELEMETRY_ELEMENT_(fan_speed_rpm, 2);
+            case Cap::fan_speed_3: return PM_TELEMETRY_ELEMENT_(fan_speed_rpm, 3);
+            case Cap::fan_speed_4: return PM_TELEMETRY_ELEMENT_(fan_speed_rpm, 4);
+            case Cap::psu_info_0: return PM_TELEMETRY_ELEMENT_(psu, 0);
+            case Cap::psu_info_1: return PM_TELEMETRY_ELEMENT_(psu, 1);
+            case Cap::psu_info_2: return PM_TELEMETRY_ELEMENT_(psu, 2);
+            case Cap::psu_info_3: return PM_TELEMETRY_ELEMENT_(psu, 3);
+            case Cap::psu_info_4: return PM_TELEMETRY_ELEMENT_(psu, 4);
+            case Cap::gpu_mem_size: return PM_TELEMETRY_FIELD_(gpu_mem_total_size_b);
+            case Cap::gpu_mem_used: return PM_TELEMETRY_FIELD_(gpu_mem_used_b);
+            case Cap::gpu_mem_max_bandwidth: return PM_TELEMETRY_FIELD_(gpu_mem_max_bandwidth_bps);
+            case Cap::gpu_mem_write_bandwidth: return PM_TELEMETRY_FIELD_(gpu_mem_write_bandwidth_bps);
+            case Cap::gpu_mem_read_bandwidth: return PM_TELEMETRY_FIELD_(gpu_mem_read_bandwidth_bps);
+            case Cap::gpu_power_limited: return PM_TELEMETRY_FIELD_(gpu_power_limited);
+            case Cap::gpu_temperature_limited: return PM_TELEMETRY_FIELD_(gpu_temperature_limited);
+            case Cap::gpu_current_limited: return PM_TELEMETRY_FIELD_(gpu_current_limited);
+            case Cap::gpu_voltage_limited: return PM_TELEMETRY_FIELD_(gpu_voltage_limited);
+            case Cap::gpu_utilization_limited: return PM_TELEMETRY_FIELD_(gpu_utilization_limited);
+            case Cap::vram_power_limited: return PM_TELEMETRY_FIELD_(vram_power_limited);
+            case Cap::vram_temperature_limited: return PM_TELEMETRY_FIELD_(vram_temperature_limited);
+            case Cap::vram_current_limited: return PM_TELEMETRY_FIELD_(vram_current_limited);
+            case Cap::vram_voltage_limited: return PM_TELEMETRY_FIELD_(vram_voltage_limited);
+            case Cap::vram_utilization_limited: return PM_TELEMETRY_FIELD_(vram_utilization_limited);
+            default: return { 0, 0 };
+            }
+        }
+
+#undef PM_TELEMETRY_ELEMENT_
+#undef PM_TELEMETRY_FIELD_
+
+        size_t LaneCount_(size_t size) noexcept
+        {
+            return (size + 7) / 8;
+        }
+        // reads up to 8 bytes of a field as one lane (zero extended)
+        uint64_t ReadLane_(const uint8_t* pField, size_t size, size_t lane) noexcept
+        {
+            uint64_t v = 0;
+            memcpy(&v, pField + lane * 8, std::min<size_t>(8, size - lane * 8));
+            return v;
+        }
+        void WriteLane_(uint8_t* pField, size_t size, size_t lane, uint64_t v) noexcept
+        {
+            memcpy(pField + lane * 8, &v, std::min<size_t>(8, size - lane * 8));
+        }
+        uint64_t ZigZag_(uint64_t delta) noexcept
+        {
+            const auto d = int64_t(delta);
+            return uint64_t(d << 1) ^ uint64_t(d >> 63);
+        }
+        uint64_t UnZigZag_(uint64_t z) noexcept
+        {
+            return (z >> 1) ^ (0 - (z & 1));
+        }
+
+        class BitWriter_
+        {
+        public:
+            BitWriter_(std::vector<uint64_t>& words) : words_{ words } {}
+            void Write(uint64_t value, unsigned width)
+            {
+                if (width == 0) {
+                    return;
+                }
+                const auto shift = unsigned(pos_ % 64);
+                if (shift == 0) {
+                    words_.push_back(0);
+                }
+                words_.back() |= value << shift;
+                if (shift + width > 64) {
+                    words_.push_back(value >> (64 - shift));
+                }
+                pos_ += width;
+            }
+        private:
+            std::vector<uint64_t>& words_;
+            size_t pos_ = 0;
+        };
+
+        class BitReader_
+        {
+        public:
+            BitReader_(const std::vector<uint64_t>& words) : words_{ words } {}
+            uint64_t Read(unsigned width) noexcept
+            {
+                if (width == 0) {
+                    return 0;
+                }
+                const auto word = pos_ / 64;
+                const auto shift = unsigned(pos_ % 64);
+                uint64_t v = words_[word] >> shift;
+                if (shift + width > 64) {
+                    v |= words_[word + 1] << (64 - shift);
+                }
+                pos_ += width;
+                return width == 64 ? v : v & ((uint64_t(1) << width) - 1);
+            }
+        private:
+            const std::vector<uint64_t>& words_;
+            size_t pos_ = 0;
+        };
+    }
+
+    ColumnarTelemetryHistory::ColumnarTelemetryHistory(size_t hotCapacity, size_t coldBlockCount)
+        :
+        hotCapacity_{ std::max<size_t>(hotCapacity, 1) },
+        // cold tier evicts whole blocks from the hot ring, so hot ring must hold at least one block
+        coldBlockCount_{ hotCapacity >= coldBlockSize ? coldBlockCount : 0 }
+    {
+        columns_[qpcColumn_].offset = uint16_t(offsetof(Info, qpc));
+        columns_[qpcColumn_].size = uint16_t(sizeof(Info::qpc));
+        columns_[qpcColumn_].data.resize(hotCapacity_ * sizeof(Info::qpc));
+        for (size_t i = 0; i < size_t(Cap::gpu_telemetry_count); i++) {
+            const auto field = GetCapField_(Cap(i));
+            columns_[i + 1].offset = uint16_t(field.offset);
+            columns_[i + 1].size = uint16_t(field.size);
+        }
+    }
+
+    size_t ColumnarTelemetryHistory::HotSlot_(size_t logicalIndex) const noexcept
+    {
+        return (hotBegin_ + logicalIndex) % hotCapacity_;
+    }
+
+    uint64_t ColumnarTelemetryHistory::HotQpc_(size_t logicalIndex) const noexcept
+    {
+        uint64_t qpc;
+        memcpy(&qpc, columns_[qpcColumn_].data.data() + HotSlot_(logicalIndex) * sizeof(qpc), sizeof(qpc));
+        return qpc;
+    }
+
+    PresentMonPowerTelemetryInfo ColumnarTelemetryHistory::HotSample_(size_t logicalIndex) const noexcept
+    {
+        Info info{};
+        const auto slot = HotSlot_(logicalIndex);
+        const auto pInfo = reinterpret_cast<uint8_t*>(&info);
+        for (auto& col : columns_) {
+            if (!col.data.empty()) {
+                memcpy(pInfo + col.offset, col.data.data() + slot * col.size, col.size);
+            }
+        }
+        return info;
+    }
+
+    void ColumnarTelemetryHistory::Push(const PresentMonPowerTelemetryInfo& info, const GpuTelemetryBitset& caps)
+    {
+        if (hotCount_ == hotCapacity_) {
+            if (coldBlockCount_) {
+                EvictToCold_();
+            }
+            else {
+                // plain ring behavior, newest overwrites oldest
+                hotBegin_ = (hotBegin_ + 1) % hotCapacity_;
+                hotCount_--;
+            }
+        }
+        const auto slot = HotSlot_(hotCount_);
+        const auto pInfo = reinterpret_cast<const uint8_t*>(&info);
+        for (size_t i = 0; i < columns_.size(); i++) {
+            auto& col = columns_[i];
+            if (col.data.empty()) {
+                if (i == qpcColumn_ || !caps[i - 1]) {
+                    continue;
+                }
+                // first report of this field, samples before now read as zero
+                col.data.resize(hotCapacity_ * col.size);
+            }
+            memcpy(col.data.data() + slot * col.size, pInfo + col.offset, col.size);
+        }
+        hotCount_++;
+    }
+
+    void ColumnarTelemetryHistory::EvictToCold_()
+    {
+        ColdBlock_ block;
+        block.count = uint32_t(std::min(coldBlockSize, hotCount_));
+        block.firstQpc = HotQpc_(0);
+        block.lastQpc = HotQpc_(block.count - 1);
+        BitWriter_ writer{ block.bits };
+        std::vector<uint64_t> values(block.count);
+        for (size_t c = 0; c < columns_.size(); c++) {
+            auto& col = columns_[c];
+            if (col.data.empty()) {
+                continue;
+            }
+            block.columns.push_back(uint8_t(c));
+            for (size_t lane = 0; lane < LaneCount_(col.size); lane++) {
+                uint64_t maxZig = 0;
+                for (size_t j = 0; j < block.count; j++) {
+                    values[j] = ReadLane_(col.data.data() + HotSlot_(j) * col.size, col.size, lane);
+                    if (j) {
+                        maxZig = std::max(maxZig, ZigZag_(values[j] - values[j - 1]));
+                    }
+                }
+                const auto width = unsigned(std::bit_width(maxZig));
+                block.lanes.push_back({ values[0], uint8_t(width) });
+                for (size_t j = 1; j < block.count; j++) {
+                    writer.Write(ZigZag_(values[j] - values[j - 1]), width);
+                }
+            }
+        }
+        block.bits.shrink_to_fit();
+        block.lanes.shrink_to_fit();
+        block.columns.shrink_to_fit();
+        hotBegin_ = HotSlot_(block.count);
+        hotCount_ -= block.count;
+        cold_.push_back(std::move(block));
+        if (cold_.size() > coldBlockCount_) {
+            cold_.pop_front();
+        }
+    }
+
+    std::vector<PresentMonPowerTelemetryInfo> ColumnarTelemetryHistory::Decode_(const ColdBlock_& block) const
+    {
+        std::vector<Info> samples(block.count, Info{});
+        BitReader_ reader{ block.bits };
+        size_t laneIndex = 0;
+        for (const auto c : block.columns) {
+            const auto& col = columns_[c];
+            for (size_t lane = 0; lane < LaneCount_(col.size); lane++) {
+                const auto& header = block.lanes[laneIndex++];
+                uint64_t v = header.base;
+                for (size_t j = 0; j < block.count; j++) {
+                    if (j) {
+                        v += UnZigZag_(reader.Read(header.width));
+                    }
+                    WriteLane_(reinterpret_cast<uint8_t*>(&samples[j]) + col.offset, col.size, lane, v);
+                }
+            }
+        }
+        return samples;
+    }
+
+    std::optional<PresentMonPowerTelemetryInfo> ColumnarTelemetryHistory::GetNearest(uint64_t qpc) const
+    {
+        if (hotCount_ == 0 && cold_.empty()) {
+            return {};
+        }
+        if (hotCount_ == 0 || qpc < HotQpc_(0)) {
+            if (!cold_.empty()) {
+                return GetNearestCold_(qpc);
+            }
+            return HotSample_(0);
+        }
+        // if outside the qpc history range return the closest values
+        if (qpc >= HotQpc_(hotCount_ - 1)) {
+            return HotSample_(hotCount_ - 1);
+        }
+        // find lowest not less than query qpc
+        size_t lo = 0, hi = hotCount_;
+        while (lo < hi) {
+            const auto mid = (lo + hi) / 2;
+            if (HotQpc_(mid) < qpc) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        const auto upperQpc = HotQpc_(lo);
+        // lo > 0 is guaranteed here because qpc >= first hot qpc
+        if (upperQpc == qpc || upperQpc - qpc <= qpc - HotQpc_(lo - 1)) {
+            return HotSample_(lo);
+        }
+        return HotSample_(lo - 1);
+    }
+
+    std::optional<PresentMonPowerTelemetryInfo> ColumnarTelemetryHistory::GetNearestCold_(uint64_t qpc) const
+    {
+        // block containing or immediately preceding qpc (clamped to the oldest block)
+        auto i = std::upper_bound(cold_.begin(), cold_.end(), qpc,
+            [](uint64_t q, const ColdBlock_& b) { return q < b.firstQpc; });
+        if (i != cold_.begin()) {
+            --i;
+        }
+        if (qpc > i->lastQpc) {
+            // between this block and the next sample (next block or start of hot ring)
+            const auto lowerDistance = qpc - i->lastQpc;
+            const auto next = std::next(i);
+            if (next != cold_.end()) {
+                if (next->firstQpc - qpc <= lowerDistance) {
+                    return Decode_(*next).front();
+                }
+            }
+            else if (hotCount_ && HotQpc_(0) - qpc <= lowerDistance) {
+                return HotSample_(0);
+            }
+            return Decode_(*i).back();
+        }
+        const auto samples = Decode_(*i);
+        const auto upper = std::lower_bound(samples.begin(), samples.end(), qpc,
+            [](const Info& s, uint64_t q) { return s.qpc < q; });
+        if (upper == samples.begin() || upper->qpc == qpc) {
+            return *upper;
+        }
+        const auto lower = std::prev(upper);
+        return upper->qpc - qpc <= qpc - lower->qpc ? *upper : *lower;
+    }
+
+    size_t ColumnarTelemetryHistory::GetSize() const noexcept
+    {
+        size_t size = hotCount_;
+        for (auto& b : cold_) {
+            size += b.count;
+        }
+        return size;
+    }
+
+    size_t ColumnarTelemetryHistory::GetMemoryFootprint() const noexcept
+    {
+        size_t bytes = 0;
+        for (auto& col : columns_) {
+            bytes += col.data.capacity();
+        }
+        for (auto& b : cold_) {
+            bytes += sizeof(ColdBlock_) + b.columns.capacity() +
+                b.lanes.capacity() * sizeof(LaneHeader_) + b.bits.capacity() * sizeof(uint64_t);
+        }
+        return bytes;
+    }
+}
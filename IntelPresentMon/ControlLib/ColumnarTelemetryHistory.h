@@ -0,0 +1,76 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "PresentMonPowerTelemetry.h"
+#include <optional>
+#include <vector>
+#include <deque>
+#include <array>
+#include <cstdint>
+
+namespace pwr
+{
+    // power telemetry history stored one column per field instead of one struct per sample
+    // only fields whose cap bit has been reported by the adapter are allocated/stored
+    // (qpc is always stored); samples are reconstructed on lookup with unreported fields zeroed
+    // when the hot ring is full, the oldest samples can optionally be moved to a cold tier of
+    // blocks compressed losslessly with per-lane delta + bit packing, extending the time span
+    // that can be aligned to frames for a small amount of extra memory
+    class ColumnarTelemetryHistory
+    {
+    public:
+        // number of samples compressed together into one cold block
+        static constexpr size_t coldBlockSize = 64;
+
+        // hotCapacity: samples kept uncompressed; coldBlockCount: max cold blocks kept (0 disables tier)
+        ColumnarTelemetryHistory(size_t hotCapacity, size_t coldBlockCount = 0);
+        // allocates the column of a field when it is first reported, and cold blocks when the hot ring is full
+        void Push(const PresentMonPowerTelemetryInfo& info, const GpuTelemetryBitset& caps);
+        // decodes a cold block when the nearest sample is in the cold tier
+        std::optional<PresentMonPowerTelemetryInfo> GetNearest(uint64_t qpc) const;
+        // number of samples currently retained across both tiers
+        size_t GetSize() const noexcept;
+        // bytes of sample storage currently allocated across both tiers (excluding fixed overhead)
+        size_t GetMemoryFootprint() const noexcept;
+    private:
+        // types
+        struct Column_
+        {
+            uint16_t offset = 0;
+            uint16_t size = 0;
+            // hot ring storage, empty until the field is first reported
+            std::vector<uint8_t> data;
+        };
+        struct LaneHeader_
+        {
+            uint64_t base;
+            uint8_t width;
+        };
+        struct ColdBlock_
+        {
+            uint64_t firstQpc;
+            uint64_t lastQpc;
+            uint32_t count;
+            // columns present in this block (qpc column always present)
+            std::vector<uint8_t> columns;
+            std::vector<LaneHeader_> lanes;
+            std::vector<uint64_t> bits;
+        };
+        // functions
+        uint64_t HotQpc_(size_t logicalIndex) const noexcept;
+        size_t HotSlot_(size_t logicalIndex) const noexcept;
+        PresentMonPowerTelemetryInfo HotSample_(size_t logicalIndex) const noexcept;
+        void EvictToCold_();
+        std::vector<PresentMonPowerTelemetryInfo> Decode_(const ColdBlock_& block) const;
+        std::optional<PresentMonPowerTelemetryInfo> GetNearestCold_(uint64_t qpc) const;
+        // data
+        static constexpr size_t qpcColumn_ = 0;
+        // column 0 is qpc, column i + 1 is cap bit i
+        std::array<Column_, size_t(GpuTelemetryCapBits::gpu_telemetry_count) + 1> columns_;
+        size_t hotCapacity_;
+        size_t hotBegin_ = 0;
+        size_t hotCount_ = 0;
+        size_t coldBlockCount_;
+        std::deque<ColdBlock_> cold_;
+    };
+}
@@ -637,7 +637,7 @@ namespace pwr::intel
     void IntelPowerTelemetryAdapter::SavePmPowerTelemetryData(PresentMonPowerTelemetryInfo& info)
     {
         std::lock_guard<std::mutex> lock(historyMutex);
-        history.Push(info);
+        history.Push(info, GetPowerTelemetryCapBits());
     }
 
     GpuTelemetryCapBits IntelPowerTelemetryAdapter::GetFlagTelemetryCapBit(
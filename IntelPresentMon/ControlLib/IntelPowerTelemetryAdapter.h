@@ -5,7 +5,7 @@
 #include <Windows.h>
 #include "igcl_api.h"
 #include "PowerTelemetryAdapter.h"
-#include "TelemetryHistory.h"
+#include "ColumnarTelemetryHistory.h"
 #include <mutex>
 #include <optional>
 
@@ -81,7 +81,7 @@ namespace pwr::intel
 		ctl_device_adapter_properties_t properties{};
 		std::vector<ctl_mem_handle_t> memoryModules;
 		mutable std::mutex historyMutex;
-		TelemetryHistory<PresentMonPowerTelemetryInfo> history{ PowerTelemetryAdapter::defaultHistorySize };
+		ColumnarTelemetryHistory history{ PowerTelemetryAdapter::defaultHistorySize, PowerTelemetryAdapter::defaultColdHistoryBlockCount };
 		std::optional<ctl_power_telemetry_t> previousSample;
 		std::optional<ctl_mem_bandwidth_t> previousMemBwSample;
 		double time_delta_ = 0.f;
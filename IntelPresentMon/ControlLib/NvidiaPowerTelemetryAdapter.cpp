@@ -194,7 +194,7 @@ namespace pwr::nv
 
         // insert telemetry into history
         std::lock_guard lock{ historyMutex };
-        history.Push(info);
+        history.Push(info, GetPowerTelemetryCapBits());
 
         return true;
     }
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include "PowerTelemetryAdapter.h"
-#include "TelemetryHistory.h"
+#include "ColumnarTelemetryHistory.h"
 #include <mutex>
 #include <optional>
 #include "NvapiWrapper.h"
@@ -34,7 +34,7 @@ namespace pwr::nv
 		std::optional<nvmlDevice_t> hNvml;
 		std::string name = "Unknown Adapter Name";
 		mutable std::mutex historyMutex;
-		TelemetryHistory<PresentMonPowerTelemetryInfo> history{ PowerTelemetryAdapter::defaultHistorySize };
+		ColumnarTelemetryHistory history{ PowerTelemetryAdapter::defaultHistorySize, PowerTelemetryAdapter::defaultColdHistoryBlockCount };
 		bool useNvmlTemperature = false;
 	};
 }
\ No newline at end of file
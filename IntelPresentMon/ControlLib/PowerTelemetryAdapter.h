@@ -35,6 +35,8 @@ namespace pwr
         }
         // constants
         static constexpr size_t defaultHistorySize = 300;
+        // compressed blocks of older samples kept behind the uncompressed history
+        static constexpr size_t defaultColdHistoryBlockCount = 8;
 
        private:
         // data
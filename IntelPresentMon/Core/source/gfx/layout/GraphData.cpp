@@ -48,7 +48,7 @@ namespace p2c::gfx::lay
 	{
 		return data.size();
 	}
-	void GraphData::Trim(double now)
+	bool GraphData::Trim(double now)
 	{
 		const auto cutoff = now - timeWindow;
 		// find iterator pair that marks all data points that are
@@ -69,7 +69,9 @@ namespace p2c::gfx::lay
 			}
 		}
 		// erase all in range from data buffer
+		const bool trimmed = i != end;
 		data.erase(i, end);
+		return trimmed;
 	}
 	void GraphData::Resize(double window)
 	{
@@ -95,7 +95,8 @@ namespace p2c::gfx::lay
 		const DataPoint& Back() const;
 		void Push(const DataPoint& data);
 		size_t Size() const;
-		void Trim(double now);
+		// returns true if any samples were removed
+		bool Trim(double now);
 		void Resize(double window);
 		std::optional<float> Min() const;
 		std::optional<float> Max() const;
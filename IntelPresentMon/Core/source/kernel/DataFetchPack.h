@@ -10,15 +10,30 @@ namespace p2c::kern
 	struct DataFetchPack
 	{
 		// functions
-		void Populate(double timestamp)
+		// returns true if the displayed content of this pack changed
+		// graphs change when the new sample differs from the newest one, or when samples drop out of
+		// a window that is not flat; readouts change only when their text differs
+		bool Populate(double timestamp)
 		{
+			bool changed = false;
 			if (graphData) {
-				graphData->Push({ gfx::lay::DataPoint{.value = pFetcher->ReadValue(), .time = timestamp} });
-				graphData->Trim(timestamp);
+				const auto value = pFetcher->ReadValue();
+				changed = graphData->Size() == 0 || graphData->Front().value != value;
+				graphData->Push({ gfx::lay::DataPoint{.value = value, .time = timestamp} });
+				// samples trimmed from a flat window all equal the ones that remain
+				const bool flat = graphData->Min() == graphData->Max();
+				if (graphData->Trim(timestamp) && !flat) {
+					changed = true;
+				}
 			}
 			if (textData) {
-				*textData = pFetcher->ReadStringValue();
+				auto text = pFetcher->ReadStringValue();
+				if (text != *textData) {
+					*textData = std::move(text);
+					changed = true;
+				}
 			}
+			return changed;
 		}
 		
 		// data
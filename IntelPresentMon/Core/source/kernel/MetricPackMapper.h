@@ -99,15 +99,19 @@ namespace p2c::kern
 			}
 			usageMap_[qmet].text = true;
 		}
-		void Populate(const pmapi::ProcessTracker& tracker, double timestamp)
+		// returns true if any pack's displayed content changed
+		bool Populate(const pmapi::ProcessTracker& tracker, double timestamp)
 		{
+			bool changed = false;
 			// if query is empty, don't do anything (empty loadout)
 			if (pQuery_) {
+				// all widgets' metrics share a single query, so this is one middleware poll
 				pQuery_->Poll(tracker);
 				for (auto&& [qmet, pPack] : metricPackMap_) {
-					pPack.Populate(timestamp);
+					changed = pPack.Populate(timestamp) || changed;
 				}
 			}
+			return changed;
 		}
 		DataFetchPack& operator[](const QualifiedMetric& qmet)
 		{
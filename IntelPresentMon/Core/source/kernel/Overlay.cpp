@@ -115,7 +115,7 @@ namespace p2c::kern
         proc{ std::move(proc_) },
         pm{ pm_ },
         pSpec{ std::move(pSpec_) },
-        scheduler_{ pSpec->metricPollRate, pSpec->overlayDrawRate, 10 },
+        scheduler_{ pSpec->metricPollRate, pSpec->overlayDrawRate, 10, pSpec->maxPollBackoff },
         fetcherFactory{ *pm },
         pPackMapper{ std::move(pPackMapper_) },
         hProcess{ OpenProcess(SYNCHRONIZE, TRUE, proc.pid) },
@@ -222,7 +222,7 @@ namespace p2c::kern
         UpdateDataSets_();
         pRoot = MakeDocument_(gfx, *pSpec, *pPackMapper, fetcherFactory, pCaptureIndicatorText);
         UpdateCaptureStatusText_();
-        scheduler_ = { pSpec->metricPollRate, pSpec->overlayDrawRate, 10 },
+        scheduler_ = { pSpec->metricPollRate, pSpec->overlayDrawRate, 10, pSpec->maxPollBackoff };
         hideDuringCapture = pSpec->hideDuringCapture;
         hideAlways = pSpec->hideAlways;
         AdjustOverlaySituation_(pSpec->overlayPosition);
@@ -248,6 +248,7 @@ namespace p2c::kern
                 pWindow->Move(CalculateOverlayPosition_());
             }
             gfx.Resize(graphicsDimensions);
+            scheduler_.MarkContentChanged();
             position = position_;
         }
         else if (position != position_)
@@ -264,7 +265,7 @@ namespace p2c::kern
         if (!IsTargetLive()) {
             throw TargetLostException{};
         }
-        pPackMapper->Populate(pm->GetTracker(), timestamp);
+        scheduler_.ReportPoll(pPackMapper->Populate(pm->GetTracker(), timestamp));
     }
 
     void Overlay::UpdateTargetRect(const RectI& newRect)
@@ -361,6 +362,7 @@ namespace p2c::kern
         else {
             pCaptureIndicatorText->SetText(L"Standing By");
         }
+        scheduler_.MarkContentChanged();
     }
 
     void Overlay::InitiateClose()
@@ -388,10 +390,12 @@ namespace p2c::kern
                     lastMoveTime = {};
                     if (!IsHidden_()) {
                         pWindow->Show();
+                        scheduler_.MarkContentChanged();
                     }
                 }
             }
-            if (!IsHidden_()) {
+            // skip the redraw when nothing displayed has changed since the last one
+            if (!IsHidden_() && scheduler_.ConsumeRender()) {
                 pmlog_mark mkRender;
                 Render_();
                 pmlog_perf(v::overlay)("Overlay draw time").mark(mkRender);
@@ -544,47 +548,4 @@ namespace p2c::kern
     {
         return targetRect;
     }
-
-    Overlay::TaskScheduler::TaskScheduler(size_t pollRate, size_t renderRate, size_t traceRate)
-    {
-        assert(pollRate != 0);
-        assert(renderRate != 0);
-        assert(traceRate != 0);
-        const size_t tickRate = std::lcm(pollRate, std::lcm(renderRate, traceRate));
-        periods_[Poll_] = tickRate / pollRate;
-        periods_[Render_] = tickRate / renderRate;
-        periods_[Trace_] = tickRate / traceRate;
-        for (int i = 0; i < Count_; i++) {
-            remainings_[i] = periods_[i];
-        }
-        using namespace std::chrono_literals;
-        tickDuration_ = 1s / double(tickRate);
-    }
-    Overlay::TaskScheduler::nano Overlay::TaskScheduler::GetNextWait()
-    {
-        // reset all zeros
-        for (auto&&[r, p] : vi::zip(remainings_, periods_)) {
-            if (r == 0) r = p;
-        }
-        // find the lowest remaining
-        const auto min = *rn::min_element(remainings_);
-        // step all by lowest
-        for (auto& r : remainings_) {
-            r -= min;
-        }
-        // return step duration
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(tickDuration_) * min;
-    }
-    bool Overlay::TaskScheduler::AtPoll() const
-    {
-        return remainings_[Poll_] == 0;
-    }
-    bool Overlay::TaskScheduler::AtRender() const
-    {
-        return remainings_[Render_] == 0;
-    }
-    bool Overlay::TaskScheduler::AtTrace() const
-    {
-        return remainings_[Trace_] == 0;
-    }
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "WindowActivateHandler.h"
 #include "OverlaySpec.h"
 #include "MetricPackMapper.h"
+#include "TaskScheduler.h"
 
 namespace p2c::gfx::lay
 {
@@ -73,27 +74,6 @@ namespace p2c::kern
             Capture,
             Always,
         };
-        class TaskScheduler
-        {
-            enum Task_ : size_t
-            {
-                Poll_,
-                Render_,
-                Trace_,
-                Count_,
-            };
-            using nano = std::chrono::nanoseconds;
-        public:
-            TaskScheduler(size_t pollRate, size_t renderRate, size_t traceRate);
-            nano GetNextWait();
-            bool AtPoll() const;
-            bool AtRender() const;
-            bool AtTrace() const;
-        private:
-            std::chrono::duration<double, std::milli> tickDuration_;
-            size_t periods_[Count_];
-            size_t remainings_[Count_];
-        };
         // data
         win::Process proc;
         std::shared_ptr<OverlaySpec> pSpec;
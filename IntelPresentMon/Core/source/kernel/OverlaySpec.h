@@ -85,6 +85,8 @@ namespace p2c::kern
         float upscaleFactor;
         uint64_t metricPollRate = 10;
         uint64_t overlayDrawRate = 10;
+        // polling slows to at most this multiple of the poll period while polled values leave the widgets unchanged
+        uint64_t maxPollBackoff = 4;
         uint32_t telemetrySamplingPeriodMs;
         bool hideDuringCapture;
         bool hideAlways;
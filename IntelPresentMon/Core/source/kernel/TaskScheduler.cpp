@@ -0,0 +1,87 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "TaskScheduler.h"
+#include <numeric>
+#include <algorithm>
+#include <ranges>
+#include <cassert>
+
+namespace p2c::kern
+{
+    namespace rn = std::ranges;
+    namespace vi = std::views;
+
+    TaskScheduler::TaskScheduler(size_t pollRate, size_t renderRate, size_t traceRate, size_t maxPollBackoff)
+        :
+        maxPollBackoff_{ std::max(maxPollBackoff, size_t(1)) }
+    {
+        assert(pollRate != 0);
+        assert(renderRate != 0);
+        assert(traceRate != 0);
+        const size_t tickRate = std::lcm(pollRate, std::lcm(renderRate, traceRate));
+        periods_[Poll_] = tickRate / pollRate;
+        periods_[Render_] = tickRate / renderRate;
+        periods_[Trace_] = tickRate / traceRate;
+        basePollPeriod_ = periods_[Poll_];
+        for (int i = 0; i < Count_; i++) {
+            remainings_[i] = periods_[i];
+        }
+        using namespace std::chrono_literals;
+        tickDuration_ = 1s / double(tickRate);
+    }
+    TaskScheduler::nano TaskScheduler::GetNextWait()
+    {
+        // reset all zeros
+        for (auto&&[r, p] : vi::zip(remainings_, periods_)) {
+            if (r == 0) r = p;
+        }
+        // find the lowest remaining
+        const auto min = *rn::min_element(remainings_);
+        // step all by lowest
+        for (auto& r : remainings_) {
+            r -= min;
+        }
+        // return step duration
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(tickDuration_) * min;
+    }
+    bool TaskScheduler::AtPoll() const
+    {
+        return remainings_[Poll_] == 0;
+    }
+    bool TaskScheduler::AtRender() const
+    {
+        return remainings_[Render_] == 0;
+    }
+    bool TaskScheduler::AtTrace() const
+    {
+        return remainings_[Trace_] == 0;
+    }
+    void TaskScheduler::MarkContentChanged()
+    {
+        contentChanged_ = true;
+    }
+    void TaskScheduler::ReportPoll(bool contentChanged)
+    {
+        if (contentChanged) {
+            MarkContentChanged();
+            pollBackoff_ = 1;
+        }
+        else {
+            pollBackoff_ = std::min(pollBackoff_ * 2, maxPollBackoff_);
+        }
+        // takes effect when the poll countdown is reloaded at the next wait
+        periods_[Poll_] = basePollPeriod_ * pollBackoff_;
+    }
+    size_t TaskScheduler::GetPollBackoff() const
+    {
+        return pollBackoff_;
+    }
+    bool TaskScheduler::ConsumeRender()
+    {
+        if (AtRender() && contentChanged_) {
+            contentChanged_ = false;
+            return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace p2c::kern
+{
+    // schedules the periodic overlay tasks (poll, render, trace) on a common tick
+    // render ticks are gated on content changes so that unchanged frames are not redrawn
+    // polling backs off (doubling its period up to maxPollBackoff times the configured period) while
+    // polls leave the displayed content unchanged, and returns to the configured rate on a change
+    class TaskScheduler
+    {
+        enum Task_ : size_t
+        {
+            Poll_,
+            Render_,
+            Trace_,
+            Count_,
+        };
+        using nano = std::chrono::nanoseconds;
+    public:
+        TaskScheduler(size_t pollRate, size_t renderRate, size_t traceRate, size_t maxPollBackoff = 1);
+        nano GetNextWait();
+        bool AtPoll() const;
+        bool AtRender() const;
+        bool AtTrace() const;
+        // signal that displayed content (data, text, visibility, layout) has changed
+        void MarkContentChanged();
+        // report the outcome of the poll at the current tick, adapting the poll period
+        void ReportPoll(bool contentChanged);
+        // multiple of the configured poll period that polling currently runs at
+        size_t GetPollBackoff() const;
+        // true when at a render tick and content changed since the last render; clears the change flag
+        bool ConsumeRender();
+    private:
+        std::chrono::duration<double, std::milli> tickDuration_;
+        size_t periods_[Count_];
+        size_t remainings_[Count_];
+        bool contentChanged_ = true;
+        size_t basePollPeriod_;
+        size_t maxPollBackoff_;
+        size_t pollBackoff_ = 1;
+    };
+}
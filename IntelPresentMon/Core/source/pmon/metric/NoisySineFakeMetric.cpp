@@ -1,14 +1,13 @@
 // Copyright (C) 2022 Intel Corporation
 // SPDX-License-Identifier: MIT
-#pragma once
 #include "NoisySineFakeMetric.h"
-#include <Core/source/gfx/layout/GraphData.h>
+#include <cmath>
 
 namespace p2c::pmon::met
 {
-	NoisySineFakeMetric::NoisySineFakeMetric(std::wstring name, float freq, float phase, float ampli, float offset, float dev, float errScale)
+	NoisySineFakeMetric::NoisySineFakeMetric(std::function<double()> clock, float freq, float phase, float ampli, float offset, float dev, float errScale)
 		:
-		Metric{ std::move(name), L"fak" },
+		clock{ std::move(clock) },
 		freq{ freq },
 		phase{ phase },
 		ampli{ ampli },
@@ -18,26 +17,8 @@ namespace p2c::pmon::met
 		dist{ 0.f, dev }
 	{}
 
-	void NoisySineFakeMetric::PopulateData(gfx::lay::GraphData& data, double timestamp)
+	std::optional<float> NoisySineFakeMetric::ReadValue()
 	{
-		data.Push(gfx::lay::DataPoint{ .value = ReadValue(timestamp), .time = timestamp});
-		data.Trim(timestamp);
-	}
-
-	const std::wstring& NoisySineFakeMetric::GetMetricClassName() const
-	{
-		static std::wstring name = L"Numeric";
-		return name;
-	}
-
-	std::optional<float> NoisySineFakeMetric::ReadValue(double timestamp)
-	{
-		return ampli * std::sin(float(timestamp) * 2.f * 3.14159f * freq + phase) + offset + errScale * dist(rng);
-	}
-
-	const std::wstring& NoisySineFakeMetric::GetCategory() const
-	{
-		static std::wstring cat = L"Fake Sine";
-		return cat;
+		return ampli * std::sin(float(clock()) * 2.f * 3.14159f * freq + phase) + offset + errScale * dist(rng);
 	}
 }
@@ -2,19 +2,20 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include <random>
-#include "Metric.h"
+#include <functional>
+#include "MetricFetcher.h"
 
 namespace p2c::pmon::met
 {
-	class NoisySineFakeMetric : public Metric
+	// fake fetcher following a sine wave with gaussian noise, for driving the overlay without a target
+	class NoisySineFakeMetric : public MetricFetcher
 	{
 	public:
-		NoisySineFakeMetric(std::wstring name, float freq, float phase, float ampli, float offset, float dev, float errScale);
-		void PopulateData(gfx::lay::GraphData& data, double timestamp) override;
-		std::optional<float> ReadValue(double timestamp) override;
-		const std::wstring& GetCategory() const override;
-		const std::wstring& GetMetricClassName() const override;
+		// clock returns the current time in seconds
+		NoisySineFakeMetric(std::function<double()> clock, float freq, float phase, float ampli, float offset, float dev, float errScale);
+		std::optional<float> ReadValue() override;
 	private:
+		std::function<double()> clock;
 		float freq;
 		float phase;
 		float ampli;
@@ -23,4 +24,4 @@ namespace p2c::pmon::met
 		std::minstd_rand rng;
 		std::normal_distribution<float> dist;
 	};
-}
\ No newline at end of file
+}
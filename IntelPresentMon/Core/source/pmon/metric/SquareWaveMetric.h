@@ -1,21 +1,22 @@
 // Copyright (C) 2022 Intel Corporation
 // SPDX-License-Identifier: MIT
 #pragma once
-#include "Metric.h"
+#include "MetricFetcher.h"
+#include <functional>
 
 namespace p2c::pmon::met
 {
-	class SquareWaveMetric : public Metric
+	// fake fetcher that alternates between min and max, for driving the overlay without a target
+	class SquareWaveMetric : public MetricFetcher
 	{
 	public:
-		SquareWaveMetric(std::wstring name, double period, float min, float max);
-		void PopulateData(gfx::lay::GraphData& data, double timestamp) override;
-		std::optional<float> ReadValue(double timestamp) override;
-		const std::wstring& GetCategory() const override;
-		const std::wstring& GetMetricClassName() const override;
+		// clock returns the current time in seconds
+		SquareWaveMetric(std::function<double()> clock, double period, float min, float max);
+		std::optional<float> ReadValue() override;
 	private:
+		std::function<double()> clock;
 		double period;
 		float min;
 		float max;
 	};
-}
\ No newline at end of file
+}
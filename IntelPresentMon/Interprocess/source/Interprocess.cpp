@@ -3,10 +3,14 @@
 #include "IntrospectionPopulators.h"
 #include "SharedMemoryTypes.h"
 #include "IntrospectionCloneAllocators.h"
+#include "IntrospectionSnapshot.h"
+#include "TelemetryRing.h"
 #include <boost/interprocess/sync/interprocess_sharable_mutex.hpp>
 #include <boost/interprocess/sync/interprocess_semaphore.hpp>
 #include <boost/interprocess/sync/sharable_lock.hpp>
 #include <chrono>
+#include <map>
+#include <unordered_map>
 #include "../../PresentMonService/GlobalIdentifiers.h"
 #include <windows.h>
 #include <sddl.h>
@@ -17,13 +21,24 @@ namespace pmon::ipc
 
 	namespace
 	{
+		using GpuTelemetryRing = TelemetryRing<PresentMonPowerTelemetryInfo>;
+		using CpuTelemetryRing = TelemetryRing<CpuTelemetryInfo>;
+
 		class CommsBase_
 		{
 		protected:
 			static constexpr const char* defaultSegmentName_ = pmon::gid::defaultIntrospectionNsmName;
 			static constexpr const char* introspectionRootName_ = "in-root";
+			static constexpr const char* introspectionSnapshotName_ = "in-snap";
 			static constexpr const char* introspectionMutexName_ = "in-mtx";
 			static constexpr const char* introspectionSemaphoreName_ = "in-sem";
+			static constexpr const char* cpuTelemetryRingName_ = "tel-cpu";
+			// enough samples to cover a couple of seconds of query window at the fastest polling rate
+			static constexpr size_t telemetryRingCapacity_ = 2048;
+			static std::string GetGpuTelemetryRingName_(uint32_t deviceId)
+			{
+				return "tel-gpu-" + std::to_string(deviceId);
+			}
 		};
 
 		class ServiceComms_ : public ServiceComms, CommsBase_
@@ -32,13 +47,15 @@ namespace pmon::ipc
 			ServiceComms_(std::optional<std::string> sharedMemoryName)
 				:
 				shm_{ bip::create_only, sharedMemoryName.value_or(defaultSegmentName_).c_str(),
-					0x10'0000, nullptr, Permissions_{} },
+					0x80'0000, nullptr, Permissions_{} },
 				pIntroMutex_{ ShmMakeNamedUnique<bip::interprocess_sharable_mutex>(
 					introspectionMutexName_, shm_.get_segment_manager()) },
 				pIntroSemaphore_{ ShmMakeNamedUnique<bip::interprocess_semaphore>(
 					introspectionSemaphoreName_, shm_.get_segment_manager(), 0) },
 				pRoot_{ ShmMakeNamedUnique<intro::IntrospectionRoot>(introspectionRootName_,
-					shm_.get_segment_manager(), shm_.get_segment_manager()) }
+					shm_.get_segment_manager(), shm_.get_segment_manager()) },
+				pCpuRing_{ ShmMakeNamedUnique<CpuTelemetryRing>(cpuTelemetryRingName_,
+					shm_.get_segment_manager(), telemetryRingCapacity_, shm_.get_segment_manager()) }
 			{
 				PreInitializeIntrospection_();
 			}
@@ -46,10 +63,15 @@ namespace pmon::ipc
 			{
 				return *pRoot_;
 			}
-			void RegisterGpuDevice(PM_DEVICE_VENDOR vendor, std::string deviceName, const GpuTelemetryBitset& gpuCaps) override
+			uint32_t RegisterGpuDevice(PM_DEVICE_VENDOR vendor, std::string deviceName, const GpuTelemetryBitset& gpuCaps) override
 			{
 				auto lck = LockIntrospectionMutexExclusive_();
-				intro::PopulateGpuDevice(shm_.get_segment_manager(), *pRoot_, nextDeviceIndex_++, vendor, deviceName, gpuCaps);
+				const auto deviceId = nextDeviceIndex_++;
+				intro::PopulateGpuDevice(shm_.get_segment_manager(), *pRoot_, deviceId, vendor, deviceName, gpuCaps);
+				InvalidateIntrospectionSnapshot_();
+				gpuRings_.emplace(deviceId, ShmMakeNamedUnique<GpuTelemetryRing>(GetGpuTelemetryRingName_(deviceId),
+					shm_.get_segment_manager(), telemetryRingCapacity_, shm_.get_segment_manager()));
+				return deviceId;
 			}
 			void FinalizeGpuDevices() override
 			{
@@ -64,12 +86,31 @@ namespace pmon::ipc
 			{
 				auto lck = LockIntrospectionMutexExclusive_();
 				intro::PopulateCpu(shm_.get_segment_manager(), *pRoot_, vendor, deviceName, cpuCaps);
+				InvalidateIntrospectionSnapshot_();
 				introCpuComplete_ = true;
 				if (introGpuComplete_ && introCpuComplete_) {
 					lck.unlock();
 					FinalizeIntrospection_();
 				}
 			}
+			void PushGpuTelemetry(uint32_t deviceId, const PresentMonPowerTelemetryInfo& sample) override
+			{
+				// rings are only added during device registration, before polling starts
+				if (auto i = gpuRings_.find(deviceId); i != gpuRings_.end()) {
+					i->second->Push(sample);
+				}
+			}
+			void PushCpuTelemetry(const CpuTelemetryInfo& sample) override
+			{
+				pCpuRing_->Push(sample);
+			}
+			void SetTelemetryPeriod(uint64_t periodQpc) override
+			{
+				for (auto& [deviceId, pRing] : gpuRings_) {
+					pRing->SetPeriod(periodQpc);
+				}
+				pCpuRing_->SetPeriod(periodQpc);
+			}
 		private:
 			// types
 			class Permissions_
@@ -106,9 +147,24 @@ namespace pmon::ipc
 			{
 				// sort all ordered introspection entities in their pricipal containers
 				pRoot_->Sort();
+				// publish relocatable single-block snapshot so clients can skip the per-node clone
+				PublishIntrospectionSnapshot_();
 				// release semaphore holdoff once construction is complete
 				for (int i = 0; i < 8; i++) { pIntroSemaphore_->post(); }
 			}
+			void InvalidateIntrospectionSnapshot_()
+			{
+				// clients fall back to cloning the live tree when no snapshot is present
+				shm_.destroy<char>(introspectionSnapshotName_);
+			}
+			void PublishIntrospectionSnapshot_()
+			{
+				auto lck = LockIntrospectionMutexExclusive_();
+				InvalidateIntrospectionSnapshot_();
+				const auto size = intro::GetIntrospectionSnapshotSize(*pRoot_);
+				const auto pSnapshot = shm_.construct<char>(introspectionSnapshotName_)[size]();
+				intro::WriteIntrospectionSnapshot(*pRoot_, pSnapshot, size);
+			}
 			bip::scoped_lock<bip::interprocess_sharable_mutex> LockIntrospectionMutexExclusive_()
 			{
 				const auto result = shm_.find<bip::interprocess_sharable_mutex>(introspectionMutexName_);
@@ -122,6 +178,8 @@ namespace pmon::ipc
 			ShmUniquePtr<bip::interprocess_sharable_mutex> pIntroMutex_;
 			ShmUniquePtr<bip::interprocess_semaphore> pIntroSemaphore_;
 			ShmUniquePtr<intro::IntrospectionRoot> pRoot_;
+			ShmUniquePtr<CpuTelemetryRing> pCpuRing_;
+			std::map<uint32_t, ShmUniquePtr<GpuTelemetryRing>> gpuRings_;
 			uint32_t nextDeviceIndex_ = 1;
 			bool introGpuComplete_ = false;
 			bool introCpuComplete_ = false;
@@ -140,6 +198,13 @@ namespace pmon::ipc
 				WaitOnIntrospectionHoldoff_(timeoutMs);
 				// acquire shared lock on introspection data
 				auto sharedLock = LockIntrospectionMutexForShare_();
+				// fast path: copy the prebuilt relocatable snapshot with a single memcpy
+				{
+					const auto snap = shm_.find<char>(introspectionSnapshotName_);
+					if (auto pRoot = intro::LoadIntrospectionSnapshot(snap.first, snap.second)) {
+						return pRoot;
+					}
+				}
 				// find the introspection structure in shared memory
 				const auto result = shm_.find<intro::IntrospectionRoot>(introspectionRootName_);
 				if (!result.first) {
@@ -155,8 +220,61 @@ namespace pmon::ipc
 				// create the CAPI introspection struct on the heap, it is now the caller's responsibility to track this resource
 				return root.ApiClone(blockAllocator);
 			}
+			bool HasGpuTelemetry(uint32_t deviceId) override
+			{
+				return FindGpuRing_(deviceId) != nullptr;
+			}
+			std::optional<PresentMonPowerTelemetryInfo> GetGpuTelemetryNearest(uint32_t deviceId, uint64_t qpc) override
+			{
+				if (auto pRing = FindGpuRing_(deviceId)) {
+					return pRing->GetNearest(qpc);
+				}
+				return {};
+			}
+			void ReadGpuTelemetry(uint32_t deviceId, uint64_t qpcBegin, uint64_t qpcEnd, std::vector<PresentMonPowerTelemetryInfo>& samples) override
+			{
+				if (auto pRing = FindGpuRing_(deviceId)) {
+					pRing->ReadRange(qpcBegin, qpcEnd, samples);
+				}
+			}
+			bool HasCpuTelemetry() override
+			{
+				return FindCpuRing_() != nullptr;
+			}
+			std::optional<CpuTelemetryInfo> GetCpuTelemetryNearest(uint64_t qpc) override
+			{
+				if (auto pRing = FindCpuRing_()) {
+					return pRing->GetNearest(qpc);
+				}
+				return {};
+			}
+			void ReadCpuTelemetry(uint64_t qpcBegin, uint64_t qpcEnd, std::vector<CpuTelemetryInfo>& samples) override
+			{
+				if (auto pRing = FindCpuRing_()) {
+					pRing->ReadRange(qpcBegin, qpcEnd, samples);
+				}
+			}
 		private:
 			// functions
+			const GpuTelemetryRing* FindGpuRing_(uint32_t deviceId)
+			{
+				if (auto i = gpuRings_.find(deviceId); i != gpuRings_.end()) {
+					return i->second;
+				}
+				// rings are never destroyed while the segment exists, so a found ring can be cached
+				const auto pRing = shm_.find<GpuTelemetryRing>(GetGpuTelemetryRingName_(deviceId).c_str()).first;
+				if (pRing) {
+					gpuRings_.emplace(deviceId, pRing);
+				}
+				return pRing;
+			}
+			const CpuTelemetryRing* FindCpuRing_()
+			{
+				if (!pCpuRing_) {
+					pCpuRing_ = shm_.find<CpuTelemetryRing>(cpuTelemetryRingName_).first;
+				}
+				return pCpuRing_;
+			}
 			void WaitOnIntrospectionHoldoff_(uint32_t timeoutMs)
 			{
 				using namespace std::chrono_literals;
@@ -183,6 +301,8 @@ namespace pmon::ipc
 			}
 			// data
 			ShmSegment shm_;
+			std::unordered_map<uint32_t, const GpuTelemetryRing*> gpuRings_;
+			const CpuTelemetryRing* pCpuRing_ = nullptr;
 		};
 	}
 
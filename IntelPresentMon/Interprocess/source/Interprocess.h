@@ -2,6 +2,7 @@
 #include <optional>
 #include <string>
 #include <memory>
+#include <vector>
 #include "../../ControlLib/PresentMonPowerTelemetry.h"
 #include "../../ControlLib/CpuTelemetryInfo.h"
 #include "../../PresentMonAPI2/PresentMonAPI.h"
@@ -20,9 +21,15 @@ namespace pmon::ipc
 	public:
 		virtual ~ServiceComms() = default;
 		virtual intro::IntrospectionRoot& GetIntrospectionRoot() = 0;
-		virtual void RegisterGpuDevice(PM_DEVICE_VENDOR vendor, std::string deviceName, const GpuTelemetryBitset& gpuCaps) = 0;
+		// returns the device id assigned to the gpu in introspection
+		virtual uint32_t RegisterGpuDevice(PM_DEVICE_VENDOR vendor, std::string deviceName, const GpuTelemetryBitset& gpuCaps) = 0;
 		virtual void FinalizeGpuDevices() = 0;
 		virtual void RegisterCpuDevice(PM_DEVICE_VENDOR vendor, std::string deviceName, const CpuTelemetryBitset& cpuCaps) = 0;
+		// publish a telemetry sample to the per-device ring at the polling rate (single writer per device)
+		virtual void PushGpuTelemetry(uint32_t deviceId, const PresentMonPowerTelemetryInfo& sample) = 0;
+		virtual void PushCpuTelemetry(const CpuTelemetryInfo& sample) = 0;
+		// qpc period the rings are polled at; nearest-sample lookups reject samples further than this
+		virtual void SetTelemetryPeriod(uint64_t periodQpc) = 0;
 	};
 
 	class MiddlewareComms
@@ -30,6 +37,15 @@ namespace pmon::ipc
 	public:
 		virtual ~MiddlewareComms() = default;
 		virtual const PM_INTROSPECTION_ROOT* GetIntrospectionRoot(uint32_t timeoutMs = 2000) = 0;
+		// telemetry published by the service independent of frame events, joined to frames by qpc
+		// return false when the service has not published a ring for the device
+		// nearest-sample lookups are empty when no sample is within one polling period of qpc
+		virtual bool HasGpuTelemetry(uint32_t deviceId) = 0;
+		virtual std::optional<PresentMonPowerTelemetryInfo> GetGpuTelemetryNearest(uint32_t deviceId, uint64_t qpc) = 0;
+		virtual void ReadGpuTelemetry(uint32_t deviceId, uint64_t qpcBegin, uint64_t qpcEnd, std::vector<PresentMonPowerTelemetryInfo>& samples) = 0;
+		virtual bool HasCpuTelemetry() = 0;
+		virtual std::optional<CpuTelemetryInfo> GetCpuTelemetryNearest(uint64_t qpc) = 0;
+		virtual void ReadCpuTelemetry(uint64_t qpcBegin, uint64_t qpcEnd, std::vector<CpuTelemetryInfo>& samples) = 0;
 	};
 
 	std::unique_ptr<ServiceComms> MakeServiceComms(std::optional<std::string> sharedMemoryName = {});
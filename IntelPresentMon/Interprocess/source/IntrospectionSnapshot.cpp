@@ -0,0 +1,151 @@
+#include "IntrospectionSnapshot.h"
+#include "IntrospectionTransfer.h"
+#include "IntrospectionCloneAllocators.h"
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace pmon::ipc::intro
+{
+	namespace
+	{
+		uint64_t Fnv1a_(const char* pData, size_t size)
+		{
+			uint64_t hash = 0xcbf2'9ce4'8422'2325ull;
+			for (size_t i = 0; i < size; i++) {
+				hash ^= uint8_t(pData[i]);
+				hash *= 0x100'0000'01b3ull;
+			}
+			return hash;
+		}
+
+		// walks the api introspection tree contained in a single block, converting every
+		// pointer between absolute and base-relative form
+		class Relocator_
+		{
+		public:
+			Relocator_(char* pBase, bool toOffsets) : pBase_{ pBase }, toOffsets_{ toOffsets } {}
+			void Root(PM_INTROSPECTION_ROOT* pRoot)
+			{
+				Array_<PM_INTROSPECTION_METRIC>(Field_(pRoot->pMetrics), [this](auto p) { Metric_(p); });
+				Array_<PM_INTROSPECTION_ENUM>(Field_(pRoot->pEnums), [this](auto p) { Enum_(p); });
+				Array_<PM_INTROSPECTION_DEVICE>(Field_(pRoot->pDevices), [this](auto p) { String_(Field_(p->pName)); });
+				Array_<PM_INTROSPECTION_UNIT>(Field_(pRoot->pUnits), [](auto) {});
+			}
+		private:
+			// rewrites the field and returns its absolute value so the walk can continue through it
+			template<typename T>
+			T* Field_(T*& p)
+			{
+				if (!p) {
+					return nullptr;
+				}
+				if (toOffsets_) {
+					const auto pAbsolute = p;
+					p = reinterpret_cast<T*>(uintptr_t(reinterpret_cast<const char*>(pAbsolute) - pBase_));
+					return pAbsolute;
+				}
+				p = reinterpret_cast<T*>(pBase_ + reinterpret_cast<uintptr_t>(p));
+				return p;
+			}
+			void String_(PM_INTROSPECTION_STRING* p)
+			{
+				if (p) {
+					Field_(p->pData);
+				}
+			}
+			template<typename E, typename F>
+			void Array_(PM_INTROSPECTION_OBJARRAY* p, F&& visitElement)
+			{
+				if (!p) {
+					return;
+				}
+				if (auto pData = Field_(p->pData)) {
+					for (size_t i = 0; i < p->size; i++) {
+						if (auto pElement = Field_(pData[i])) {
+							visitElement(const_cast<E*>(static_cast<const E*>(pElement)));
+						}
+					}
+				}
+			}
+			void Enum_(PM_INTROSPECTION_ENUM* p)
+			{
+				String_(Field_(p->pSymbol));
+				String_(Field_(p->pDescription));
+				Array_<PM_INTROSPECTION_ENUM_KEY>(Field_(p->pKeys), [this](auto pKey) {
+					String_(Field_(pKey->pSymbol));
+					String_(Field_(pKey->pName));
+					String_(Field_(pKey->pShortName));
+					String_(Field_(pKey->pDescription));
+				});
+			}
+			void Metric_(PM_INTROSPECTION_METRIC* p)
+			{
+				Field_(p->pTypeInfo);
+				Array_<PM_INTROSPECTION_STAT_INFO>(Field_(p->pStatInfo), [](auto) {});
+				Array_<PM_INTROSPECTION_DEVICE_METRIC_INFO>(Field_(p->pDeviceMetricInfo), [](auto) {});
+			}
+			char* pBase_;
+			bool toOffsets_;
+		};
+	}
+
+	size_t GetIntrospectionSnapshotSize(const IntrospectionRoot& root)
+	{
+		ProbeAllocator<void> probeAllocator;
+		root.ApiClone(probeAllocator);
+		return sizeof(IntrospectionSnapshotHeader) + probeAllocator.GetTotalSize();
+	}
+
+	void WriteIntrospectionSnapshot(const IntrospectionRoot& root, char* pDest, size_t destSize)
+	{
+		ProbeAllocator<void> probeAllocator;
+		root.ApiClone(probeAllocator);
+		const auto payloadSize = probeAllocator.GetTotalSize();
+		if (destSize < sizeof(IntrospectionSnapshotHeader) + payloadSize) {
+			throw std::runtime_error{ "Introspection snapshot destination too small" };
+		}
+		// clone to heap block (root is always first allocation => offset 0), then make relocatable
+		BlockAllocator<void> blockAllocator{ payloadSize };
+		const auto pRoot = const_cast<PM_INTROSPECTION_ROOT*>(root.ApiClone(blockAllocator));
+		const auto pBlock = reinterpret_cast<char*>(pRoot);
+		Relocator_{ pBlock, true }.Root(pRoot);
+		const IntrospectionSnapshotHeader header{
+			.magic = IntrospectionSnapshotHeader::magicValue,
+			.version = IntrospectionSnapshotHeader::currentVersion,
+			.payloadSize = payloadSize,
+			.checksum = Fnv1a_(pBlock, payloadSize),
+		};
+		memcpy(pDest, &header, sizeof(header));
+		memcpy(pDest + sizeof(header), pBlock, payloadSize);
+		free(pBlock);
+	}
+
+	const PM_INTROSPECTION_ROOT* LoadIntrospectionSnapshot(const char* pSnapshot, size_t snapshotSize)
+	{
+		IntrospectionSnapshotHeader header;
+		if (!pSnapshot || snapshotSize < sizeof(header)) {
+			return nullptr;
+		}
+		memcpy(&header, pSnapshot, sizeof(header));
+		if (header.magic != IntrospectionSnapshotHeader::magicValue ||
+			header.version != IntrospectionSnapshotHeader::currentVersion ||
+			header.payloadSize < sizeof(PM_INTROSPECTION_ROOT) ||
+			header.payloadSize > snapshotSize - sizeof(header)) {
+			return nullptr;
+		}
+		const auto pPayload = pSnapshot + sizeof(header);
+		if (Fnv1a_(pPayload, header.payloadSize) != header.checksum) {
+			return nullptr;
+		}
+		// single copy to the heap, then fix up offsets to point into the copy
+		const auto pBlock = reinterpret_cast<char*>(malloc(header.payloadSize));
+		if (!pBlock) {
+			return nullptr;
+		}
+		memcpy(pBlock, pPayload, header.payloadSize);
+		const auto pRoot = reinterpret_cast<PM_INTROSPECTION_ROOT*>(pBlock);
+		Relocator_{ pBlock, false }.Root(pRoot);
+		return pRoot;
+	}
+}
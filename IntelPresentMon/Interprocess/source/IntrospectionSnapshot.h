@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "../../PresentMonAPI2/PresentMonAPI.h"
+
+namespace pmon::ipc::intro
+{
+	struct IntrospectionRoot;
+
+	// header prepended to the relocatable introspection block that the service publishes
+	// payload is an ApiClone of the root laid out in one block (root at offset 0) with all
+	// internal pointers stored as offsets from the start of the payload (null stays null)
+	struct IntrospectionSnapshotHeader
+	{
+		static constexpr uint32_t magicValue = 0x50'4D'49'53; // 'PMIS'
+		static constexpr uint32_t currentVersion = 1;
+		uint32_t magic;
+		uint32_t version;
+		uint64_t payloadSize;
+		uint64_t checksum;
+	};
+
+	// total bytes (header + payload) required to snapshot the root
+	size_t GetIntrospectionSnapshotSize(const IntrospectionRoot& root);
+	// serialize root into pDest, which must have room for GetIntrospectionSnapshotSize bytes
+	void WriteIntrospectionSnapshot(const IntrospectionRoot& root, char* pDest, size_t destSize);
+	// validate snapshot and copy it to a single heap block with absolute pointers (free with free())
+	// returns nullptr when the snapshot is truncated, of a different version, or fails the checksum
+	const PM_INTROSPECTION_ROOT* LoadIntrospectionSnapshot(const char* pSnapshot, size_t snapshotSize);
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include "SharedMemoryTypes.h"
+#include <atomic>
+#include <optional>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace pmon::ipc
+{
+	// fixed-capacity ring of qpc-stamped telemetry samples that lives in shared memory
+	// written by a single service-side polling thread, read lock-free by any number of clients
+	// every slot carries a sequence number derived from the serial of the sample it holds, so a
+	// reader can detect a sample that was overwritten (or is being written) while it was copied
+	template<class T>
+	class TelemetryRing
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+	public:
+		TelemetryRing(size_t capacity, ShmSegmentManager* pSegmentManager)
+			:
+			slots_{ capacity, pSegmentManager->get_allocator<Slot_>() }
+		{}
+		TelemetryRing(const TelemetryRing&) = delete;
+		TelemetryRing& operator=(const TelemetryRing&) = delete;
+		// samples must be pushed in non-decreasing qpc order
+		void Push(const T& sample)
+		{
+			const auto serial = pushCount_.load(std::memory_order_relaxed);
+			auto& slot = slots_[serial % slots_.size()];
+			slot.sequence.store(serial * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.sample = sample;
+			slot.sequence.store(serial * 2 + 2, std::memory_order_release);
+			pushCount_.store(serial + 1, std::memory_order_release);
+		}
+		uint64_t GetPushCount() const
+		{
+			return pushCount_.load(std::memory_order_acquire);
+		}
+		// qpc period that samples are pushed at, 0 when unknown
+		void SetPeriod(uint64_t periodQpc)
+		{
+			periodQpc_.store(periodQpc, std::memory_order_relaxed);
+		}
+		// sample closest in time to qpc, ties resolve to the later sample
+		// empty when that sample is more than one polling period away from qpc (e.g. polling was
+		// stopped or stalled around that time), since it would not represent the state at qpc
+		std::optional<T> GetNearest(uint64_t qpc) const
+		{
+			const auto sample = GetNearest_(qpc);
+			const auto period = periodQpc_.load(std::memory_order_relaxed);
+			if (sample && period != 0 && (sample->qpc > qpc ? sample->qpc - qpc : qpc - sample->qpc) > period) {
+				return {};
+			}
+			return sample;
+		}
+		// appends samples with qpc in [qpcBegin, qpcEnd] to out, oldest first
+		void ReadRange(uint64_t qpcBegin, uint64_t qpcEnd, std::vector<T>& out) const
+		{
+			for (int attempt = 0; attempt < maxAttempts_; attempt++) {
+				const auto [first, count] = GetReadableRange_();
+				const auto iBegin = LowerBound_(first, count, qpcBegin);
+				if (!iBegin) {
+					continue;
+				}
+				T sample;
+				for (auto i = *iBegin; i < count; i++) {
+					// samples overwritten during the scan are the oldest ones, so skipping is fine
+					if (!Read_(i, sample)) {
+						continue;
+					}
+					if (sample.qpc > qpcEnd) {
+						break;
+					}
+					out.push_back(sample);
+				}
+				return;
+			}
+		}
+	private:
+		// types
+		struct Slot_
+		{
+			// 2 * serial + 1 while being written, 2 * serial + 2 once complete
+			std::atomic<uint64_t> sequence = 0;
+			T sample;
+		};
+		// functions
+		std::optional<T> GetNearest_(uint64_t qpc) const
+		{
+			for (int attempt = 0; attempt < maxAttempts_; attempt++) {
+				const auto [first, count] = GetReadableRange_();
+				if (first == count) {
+					return {};
+				}
+				T upper, lower;
+				const auto iUpper = LowerBound_(first, count, qpc);
+				if (!iUpper) {
+					continue;
+				}
+				if (*iUpper == count) {
+					if (Read_(count - 1, lower)) {
+						return lower;
+					}
+					continue;
+				}
+				if (!Read_(*iUpper, upper)) {
+					continue;
+				}
+				if (*iUpper == first || upper.qpc == qpc) {
+					return upper;
+				}
+				if (!Read_(*iUpper - 1, lower)) {
+					// lower neighbour was just overwritten, upper is now the oldest sample
+					return upper;
+				}
+				return upper.qpc - qpc <= qpc - lower.qpc ? upper : lower;
+			}
+			return {};
+		}
+		std::pair<uint64_t, uint64_t> GetReadableRange_() const
+		{
+			const auto count = GetPushCount();
+			// leave one slot of slack for the writer which may already be reusing the oldest slot
+			const auto capacity = uint64_t(slots_.size()) - 1;
+			return { count > capacity ? count - capacity : 0, count };
+		}
+		bool Read_(uint64_t serial, T& out) const
+		{
+			const auto& slot = slots_[serial % slots_.size()];
+			const auto expected = serial * 2 + 2;
+			if (slot.sequence.load(std::memory_order_acquire) != expected) {
+				return false;
+			}
+			out = slot.sample;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot.sequence.load(std::memory_order_relaxed) == expected;
+		}
+		// first serial in [first, count) whose qpc is not less than qpc (count if none)
+		// empty optional if a probed sample was overwritten during the search
+		std::optional<uint64_t> LowerBound_(uint64_t first, uint64_t count, uint64_t qpc) const
+		{
+			T probe;
+			while (first < count) {
+				const auto mid = first + (count - first) / 2;
+				if (!Read_(mid, probe)) {
+					return {};
+				}
+				if (probe.qpc < qpc) {
+					first = mid + 1;
+				}
+				else {
+					count = mid;
+				}
+			}
+			return first;
+		}
+		// data
+		static constexpr int maxAttempts_ = 4;
+		std::atomic<uint64_t> pushCount_ = 0;
+		std::atomic<uint64_t> periodQpc_ = 0;
+		ShmVector<Slot_> slots_;
+	};
+}
@@ -6,6 +6,7 @@
 #include "../Interprocess/source/PmStatusError.h"
 #include "Internal.h"
 #include "PresentMonAPI.h"
+#include "PresentMonDiagnostics.h"
 #include "../PresentMonMiddleware/LogSetup.h"
 
 
@@ -295,6 +296,24 @@ PRESENTMON_API2_EXPORT PM_STATUS pmSetEtwFlushPeriod(PM_SESSION_HANDLE handle, u
 	}
 }
 
+PRESENTMON_API2_EXPORT PM_STATUS pmDiagnosticGetAnalysisInstrumentation(PM_SESSION_HANDLE handle,
+	PM_ANALYSIS_INSTRUMENTATION* pInstrumentation, PM_ANALYSIS_EVENT_COST* pEventCosts, uint32_t* pNumEventCosts)
+{
+	try {
+		if (!pInstrumentation || !pNumEventCosts) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		LookupMiddleware_(handle).GetAnalysisInstrumentation(*pInstrumentation, pEventCosts, *pNumEventCosts);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (...) {
+		const auto code = util::GeneratePmStatus();
+		pmlog_error(util::ReportException()).code(code);
+		return code;
+	}
+}
+
 PRESENTMON_API2_EXPORT PM_STATUS pmRegisterDynamicQuery(PM_SESSION_HANDLE sessionHandle, PM_DYNAMIC_QUERY_HANDLE* pQueryHandle,
 	PM_QUERY_ELEMENT* pElements, uint64_t numElements, double windowSizeMs, double metricOffsetMs)
 {
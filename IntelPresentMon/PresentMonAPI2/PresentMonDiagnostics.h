@@ -84,6 +84,91 @@ extern "C" {
 		bool enableLocation;
 	};
 
+	// Analysis Instrumentation (EXPERIMENTAL)
+	// when the service is built with PRESENTMON_ENABLE_INSTRUMENTATION, its ETW consumer counts
+	// the events it analyzes and the cycles spent on each, and samples the size of the tables it
+	// uses to track in-progress presents; this helps determine whether the consumer is the reason
+	// ETW is losing events
+
+	// ETW consumer function that analyzed an event
+	enum PM_ANALYSIS_HANDLER
+	{
+		PM_ANALYSIS_HANDLER_DXGI,
+		PM_ANALYSIS_HANDLER_D3D9,
+		PM_ANALYSIS_HANDLER_DXGK,
+		PM_ANALYSIS_HANDLER_WIN32K,
+		PM_ANALYSIS_HANDLER_DWM,
+		PM_ANALYSIS_HANDLER_PROCESS,
+		PM_ANALYSIS_HANDLER_METADATA,
+		PM_ANALYSIS_HANDLER_PRESENTMON,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_BLT,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_FLIP,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_PRESENT_HISTORY,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_QUEUE_PACKET,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_VSYNC_DPC,
+		PM_ANALYSIS_HANDLER_WIN7_DXGK_MMIO_FLIP,
+		PM_ANALYSIS_HANDLER_COUNT,
+	};
+
+	// ETW consumer table holding per-present, per-process or per-gpu-context state
+	enum PM_ANALYSIS_TABLE
+	{
+		PM_ANALYSIS_TABLE_TRACKED_PRESENTS,
+		PM_ANALYSIS_TABLE_PRESENT_BY_THREAD_ID,
+		PM_ANALYSIS_TABLE_PRESENT_BY_SUBMIT_SEQUENCE,
+		PM_ANALYSIS_TABLE_PRESENT_BY_WIN32K_PRESENT_HISTORY_TOKEN,
+		PM_ANALYSIS_TABLE_PRESENT_BY_DXGK_PRESENT_HISTORY_TOKEN,
+		PM_ANALYSIS_TABLE_PRESENT_BY_DXGK_PRESENT_HISTORY_TOKEN_DATA,
+		PM_ANALYSIS_TABLE_PRESENT_BY_DXGK_CONTEXT,
+		PM_ANALYSIS_TABLE_PRESENT_BY_VIDPN_LAYER_ID,
+		PM_ANALYSIS_TABLE_LAST_PRESENT_BY_WINDOW,
+		PM_ANALYSIS_TABLE_RECEIVED_MOUSE_CLICK_BY_HWND,
+		PM_ANALYSIS_TABLE_PENDING_PRESENT_FRAME_TYPE_EVENTS,
+		PM_ANALYSIS_TABLE_PENDING_FLIP_FRAME_TYPE_EVENTS,
+		PM_ANALYSIS_TABLE_RETRIEVED_INPUT,
+		PM_ANALYSIS_TABLE_PRESENTS_WAITING_FOR_DWM,
+		PM_ANALYSIS_TABLE_GPU_DEVICES,
+		PM_ANALYSIS_TABLE_GPU_CONTEXTS,
+		PM_ANALYSIS_TABLE_GPU_PROCESS_FRAME_INFO,
+		PM_ANALYSIS_TABLE_GPU_PAGING_SEQUENCE_IDS,
+		PM_ANALYSIS_TABLE_COUNT,
+	};
+
+	// bucket i of a cycle histogram counts events analyzed in [2^i, 2^(i+1)) cycles, and the last
+	// bucket also counts all slower events
+#define PM_ANALYSIS_CYCLE_BUCKET_COUNT 24
+
+	struct PM_ANALYSIS_EVENT_COST
+	{
+		PM_ANALYSIS_HANDLER handler;
+		// event ids are only unique within a handler
+		uint32_t eventId;
+		uint64_t count;
+		uint64_t cycles;
+		uint64_t cycleHistogram[PM_ANALYSIS_CYCLE_BUCKET_COUNT];
+	};
+
+	struct PM_ANALYSIS_INSTRUMENTATION
+	{
+		// false when the service was built without instrumentation, in which case all counters are zero
+		bool enabled;
+		// events received from ETW, and cycles spent on them including their handler
+		uint64_t eventCount;
+		uint64_t callbackCycles;
+		uint64_t callbackCycleHistogram[PM_ANALYSIS_CYCLE_BUCKET_COUNT];
+		// events that were analyzed but that the per-thread cost table had no room for
+		uint64_t untrackedEventCount;
+		// sizes of the tables last sampled by the consumer, indexed by PM_ANALYSIS_TABLE
+		uint64_t tableSizes[PM_ANALYSIS_TABLE_COUNT];
+		// stale table entries evicted because their expected stop event never arrived
+		uint64_t evictedEntryCount;
+		// presents analyzed but not yet dequeued by the service, now and at most
+		uint32_t completedPresentCount;
+		uint32_t peakCompletedPresentCount;
+		// total number of PM_ANALYSIS_EVENT_COST entries available
+		uint32_t eventCostCount;
+	};
+
 	// NOTE: pmDiagnosticDequeueMessage and pmDiagnosticWaitForMessage must both be accessed
 	// from the same single thread, never concurrently from multiple threads
 
@@ -111,6 +196,11 @@ extern "C" {
 	// useful during shutdown if you have a worker thread blocked waiting for a message, you can
 	// wake it up so that it can exit gracefully
 	PRESENTMON_API2_EXPORT PM_STATUS pmDiagnosticUnblockWaitingThread();
+	// get the counters of the service's analysis instrumentation, along with the cost of each
+	// distinct event; on input *pNumEventCosts is the capacity of pEventCosts and on output it is
+	// the number of entries written (pEventCosts can be nullptr to only get the counters)
+	PRESENTMON_API2_EXPORT PM_STATUS pmDiagnosticGetAnalysisInstrumentation(PM_SESSION_HANDLE handle,
+		PM_ANALYSIS_INSTRUMENTATION* pInstrumentation, PM_ANALYSIS_EVENT_COST* pEventCosts, uint32_t* pNumEventCosts);
 
 #ifdef __cplusplus
 } // extern "C"
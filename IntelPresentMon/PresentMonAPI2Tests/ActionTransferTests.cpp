@@ -0,0 +1,183 @@
+#include "CppUnitTest.h"
+#include <optional>
+#include <thread>
+#include <chrono>
+#include <format>
+#include <unordered_map>
+#include "../Interprocess/source/act/AsyncActionManager.h"
+#include "../Interprocess/source/act/Transfer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PresentMonAPI2Mock
+{
+	using namespace pmon;
+	using namespace std::literals;
+	namespace as = boost::asio;
+
+	namespace
+	{
+		struct EchoSession
+		{
+			std::shared_ptr<util::pipe::DuplexPipe> pPipe;
+			uint32_t clientPid = 1;
+			std::optional<uint32_t> lastTokenSeen;
+			std::chrono::high_resolution_clock::time_point lastReceived;
+			uint32_t receiveCount = 0;
+			uint32_t errorCount = 0;
+		};
+
+		struct EchoContext
+		{
+			using SessionContextType = EchoSession;
+			uint32_t responseWriteTimeoutMs = 0;
+			std::unordered_map<uint32_t, SessionContextType> sessions;
+		};
+
+		// echoes value back, fails with a status error for the sentinel value
+		class Echo : public ipc::act::AsyncActionBase_<Echo, EchoContext>
+		{
+		public:
+			static constexpr const char* Identifier = "Echo";
+			static constexpr uint32_t failValue = 0xDEAD;
+			struct Params
+			{
+				uint32_t value;
+				template<class A> void serialize(A& ar) {
+					ar(value);
+				}
+			};
+			struct Response
+			{
+				uint32_t value;
+				template<class A> void serialize(A& ar) {
+					ar(value);
+				}
+			};
+		private:
+			friend class ipc::act::AsyncActionBase_<Echo, EchoContext>;
+			static Response Execute_(const EchoContext&, SessionContext&, Params&& in)
+			{
+				if (in.value == failValue) {
+					throw util::Except<ipc::act::ActionExecutionError>(PM_STATUS_FAILURE);
+				}
+				return { in.value };
+			}
+		};
+
+		// same as Echo, but params bypass cereal through the fixed-layout pipe path
+		class EchoFixed : public ipc::act::AsyncActionBase_<EchoFixed, EchoContext>
+		{
+		public:
+			static constexpr const char* Identifier = "EchoFixed";
+			struct Params
+			{
+				uint32_t value;
+				static constexpr bool fixedLayout = true;
+				template<class A> void serialize(A& ar) {
+					ar(value);
+				}
+			};
+			using Response = Echo::Response;
+		private:
+			friend class ipc::act::AsyncActionBase_<EchoFixed, EchoContext>;
+			static Response Execute_(const EchoContext&, SessionContext&, Params&& in)
+			{
+				return { in.value };
+			}
+		};
+
+		ipc::act::AsyncActionRegistrator<Echo, EchoContext> echoRegistrator_;
+		ipc::act::AsyncActionRegistrator<EchoFixed, EchoContext> echoFixedRegistrator_;
+
+		// single-connection loopback server on its own thread, serving requests in order like the service
+		class EchoServer
+		{
+		public:
+			EchoServer(std::string pipeName)
+				:
+				thread_{ [this, pipeName] {
+					as::co_spawn(ioctx_, Serve_(pipeName), as::detached);
+					ioctx_.run();
+				} }
+			{}
+			~EchoServer()
+			{
+				thread_.join();
+			}
+		private:
+			as::awaitable<void> Serve_(std::string pipeName)
+			{
+				try {
+					auto pPipe = util::pipe::DuplexPipe::MakeAsPtr(pipeName, ioctx_);
+					co_await pPipe->Accept();
+					manager_.ctx_.sessions[pPipe->GetId()].pPipe = std::move(pPipe);
+					auto& pipe = *manager_.ctx_.sessions.begin()->second.pPipe;
+					while (true) {
+						co_await manager_.SyncHandleRequest(pipe);
+					}
+				}
+				catch (...) {}
+			}
+			as::io_context ioctx_;
+			ipc::act::AsyncActionManager<EchoContext> manager_;
+			std::thread thread_;
+		};
+
+		template<class C>
+		auto RunSync(as::io_context& ioctx, C&& coro)
+		{
+			auto fut = as::co_spawn(ioctx, std::forward<C>(coro), as::use_future);
+			ioctx.run();
+			ioctx.restart();
+			return fut.get();
+		}
+	}
+
+	TEST_CLASS(ActionTransferTests)
+	{
+	public:
+		TEST_METHOD(ResponsesAndErrors)
+		{
+			const auto pipeName = R"(\\.\pipe\pm-test-act-transfer-1)"s;
+			EchoServer server{ pipeName };
+			Assert::IsTrue(util::pipe::DuplexPipe::WaitForAvailability(pipeName, 1000));
+			as::io_context ioctx;
+			auto pipe = util::pipe::DuplexPipe::Connect(pipeName, ioctx);
+
+			Assert::ExpectException<ipc::act::ActionExecutionError>([&] {
+				RunSync(ioctx, ipc::act::SyncRequest<Echo>({ Echo::failValue }, 1, pipe, 1000));
+			});
+			// pipe stream should be left clean for subsequent requests after an error response
+			const auto res = RunSync(ioctx, ipc::act::SyncRequest<Echo>({ 42 }, 2, pipe, 1000));
+			Assert::AreEqual(42u, res.value);
+		}
+		TEST_METHOD(RoundTripCost)
+		{
+			static_assert(util::pipe::FixedLayoutPayload<EchoFixed::Params>);
+			static_assert(!util::pipe::FixedLayoutPayload<Echo::Params>);
+			const auto pipeName = R"(\\.\pipe\pm-test-act-transfer-2)"s;
+			EchoServer server{ pipeName };
+			Assert::IsTrue(util::pipe::DuplexPipe::WaitForAvailability(pipeName, 1000));
+			as::io_context ioctx;
+			auto pipe = util::pipe::DuplexPipe::Connect(pipeName, ioctx);
+
+			const uint32_t count = 2000;
+			const auto measure = [&]<class C>(const char* label) {
+				const auto start = std::chrono::high_resolution_clock::now();
+				const auto total = RunSync(ioctx, [&]() -> as::awaitable<uint64_t> {
+					uint64_t sum = 0;
+					for (uint32_t i = 0; i < count; i++) {
+						sum += (co_await ipc::act::SyncRequest<C>({ i }, i, pipe, 1000)).value;
+					}
+					co_return sum;
+				}());
+				const std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+				Assert::AreEqual(uint64_t(count) * (count - 1) / 2, total);
+				Logger::WriteMessage(std::format("{}: {:.2f} us per round trip\n", label, elapsed.count() / count).c_str());
+			};
+			measure.operator()<Echo>("cereal params");
+			measure.operator()<EchoFixed>("fixed-layout params");
+		}
+	};
+}
@@ -6,9 +6,10 @@
 #include "../PresentMonAPI2/Internal.h"
 #include "../PresentMonAPIWrapper/PresentMonAPIWrapper.h"
 #include "../CommonUtilities/str/String.h"
-#include <Windows.h>
+#include "../CommonUtilities/csv/CsvReader.h"
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <map>
 #include <optional>
@@ -155,59 +156,17 @@ std::wstring CreateErrorString(Header columnId, size_t line)
 template <typename T>
 class CharConvert {
 public:
-    void Convert(const std::string data, T& convertedData, Header columnId, size_t line);
+    void Convert(std::string_view data, T& convertedData, Header columnId, size_t line);
 };
 
 template <typename T>
-void CharConvert<T>::Convert(const std::string data, T& convertedData, Header columnId, size_t line) {
-    if constexpr (std::is_same<T, double>::value) {
-        try
-        {
-            convertedData = std::stod(data);
-        }
-        catch (...) {
-            Assert::Fail(CreateErrorString(columnId, line).c_str());
-        }
-    }
-    else if constexpr (std::is_same<T, uint32_t>::value) {
-        try
-        {
-            convertedData = std::stoul(data);
-        }
-        catch (...) {
+void CharConvert<T>::Convert(std::string_view data, T& convertedData, Header columnId, size_t line) {
+    // Numbers (and NA for optional metrics) are parsed by the shared csv reader
+    if constexpr (std::is_arithmetic<T>::value || std::is_same<T, std::optional<double>>::value) {
+        if (!pmon::util::csv::ParseField(data, convertedData)) {
             Assert::Fail(CreateErrorString(columnId, line).c_str());
         }
     }
-    else if constexpr (std::is_same<T, int32_t>::value) {
-        try
-        {
-            convertedData = std::stoi(data);
-        }
-        catch (...) {
-            Assert::Fail(CreateErrorString(columnId, line).c_str());
-        }
-    }
-    else if constexpr (std::is_same<T, uint64_t>::value) {
-        try
-        {
-            char* endptr;
-            unsigned long long result1;
-
-            if (data.size() > 2 && data[0] == '0' && (data[1] == 'x' || data[1] == 'X')) {
-                // Convert hexadecimal
-                result1 = std::strtoull(data.c_str(), &endptr, 16);
-            }
-            else {
-                // Convert decimal
-                result1 = std::strtoull(data.c_str(), &endptr, 10);
-            }
-            convertedData = static_cast<uint64_t>(result1);
-        }
-        catch (...) {
-            Assert::Fail(CreateErrorString(columnId, line).c_str());
-
-        }
-    }
     else if constexpr (std::is_same<T, PM_GRAPHICS_RUNTIME>::value) {
         if (data == "DXGI") {
             convertedData = PM_GRAPHICS_RUNTIME_DXGI;
@@ -303,20 +262,20 @@ public:
 private:
     bool FindFirstRowWithPid(const unsigned int& processId);
     bool ReadRow(bool gatherMetrics = false);
-    size_t GetColumnIndex(char const* header);
+    size_t GetColumnIndex(std::string_view header);
 
-    Header FindHeader(char const* header);
+    Header FindHeader(std::string_view header);
     void CheckAll(size_t const* columnIndex, bool* ok, std::initializer_list<Header> const& headers);
 
-    void ConvertToMetricDataType(const char* data, Header columnId);
+    void ConvertToMetricDataType(std::string_view data, Header columnId);
 
-    FILE* fp_ = nullptr;
+    pmon::util::csv::MappedFile file_;
+    pmon::util::csv::Tokenizer tokenizer_;
 
     size_t headerColumnIndex_[KnownHeaderCount];
 
-    char row_[1024];
     size_t line_ = 0;
-    std::vector<char const*> cols_;
+    std::vector<std::string_view> cols_;
     v2Metrics v2MetricRow_;
     uint32_t processId_ = 0;
     std::map<size_t, Header> activeColHeadersMap_;
@@ -517,12 +476,10 @@ bool CsvParser::FindFirstRowWithPid(const unsigned int& searchProcessId)
         }
         if (headerColumnIndex_[Header_ProcessID] != SIZE_MAX) {
             auto processColIdx = headerColumnIndex_[Header_ProcessID];
-            char const* processIdString = nullptr;
             if (processColIdx < cols_.size()) {
-                processIdString = cols_[Header_ProcessID];
                 unsigned int currentProcessId = 0;
-                int succeededCount = sscanf_s(processIdString, "%ud", &currentProcessId);
-                if (searchProcessId == currentProcessId) {
+                if (pmon::util::csv::ParseField(cols_[processColIdx], currentProcessId) &&
+                    searchProcessId == currentProcessId) {
                     return true;
                 }
             }
@@ -534,9 +491,9 @@ bool CsvParser::FindFirstRowWithPid(const unsigned int& searchProcessId)
 
 bool CsvParser::ResetCsv()
 {
-    // Rewind the file pointer and then read the header to get
-    // to the data
-    rewind(fp_);
+    // Restart tokenizing from the beginning of the file and then read
+    // the header to get to the data
+    tokenizer_ = pmon::util::csv::Tokenizer{ file_.GetData() };
     ReadRow();
 
     return true;
@@ -548,43 +505,32 @@ bool CsvParser::Open(std::wstring const& path, uint32_t processId) {
     }
     cols_.clear();
 
-    if (_wfopen_s(&fp_, path.c_str(), L"r")) {
+    // The mapped view excludes any UTF-8 marker
+    if (!file_.Open(path)) {
         return false;
     }
-
-    // Remove UTF-8 marker if there is one.
-    if (fread(row_, 3, 1, fp_) != 1 ||
-        row_[0] != -17 || // 0xef
-        row_[1] != -69 || // 0xbb
-        row_[2] != -65) { // 0xbf
-        fseek(fp_, 0, SEEK_SET);
-    }
+    tokenizer_ = pmon::util::csv::Tokenizer{ file_.GetData() };
 
     // Read the header and ensure required columns are present
     ReadRow();
 
     for (size_t i = 0, n = cols_.size(); i < n; ++i) {
         auto h = FindHeader(cols_[i]);
-        switch (h) {
-        case KnownHeaderCount:
-        case UnknownHeader:
+        if (h == UnknownHeader) {
             Assert::Fail(CreateErrorString(h, line_).c_str());
-        default:
-            if ((size_t)h < KnownHeaderCount) {
-                if (headerColumnIndex_[(size_t)h] != SIZE_MAX) {
-                    std::wstring errorMessage = L"Duplicate column: ";
-                    errorMessage += pmon::util::str::ToWide(cols_[i]);
-                    Assert::Fail(errorMessage.c_str());
-                }
-                else {
-                    headerColumnIndex_[(size_t)h] = i;
-                }
-                break;
-            }
-            else {
-                std::wstring errorMessage = L"Index outside of known headers.";
-                Assert::Fail(errorMessage.c_str());
-            }
+        }
+    }
+
+    pmon::util::csv::ColumnMap columns{ cols_ };
+    if (auto& duplicate = columns.GetDuplicate()) {
+        std::wstring errorMessage = L"Duplicate column: ";
+        errorMessage += pmon::util::str::ToWide(*duplicate);
+        Assert::Fail(errorMessage.c_str());
+    }
+    for (uint32_t i = 0; i < KnownHeaderCount; ++i) {
+        auto columnIndex = columns.Find(GetHeaderString((Header)i));
+        if (columnIndex != pmon::util::csv::ColumnMap::npos) {
+            headerColumnIndex_[i] = columnIndex;
         }
     }
 
@@ -642,17 +588,17 @@ void CsvParser::CheckAll(size_t const* columnIndex, bool* ok, std::initializer_l
 
 void CsvParser::Close()
 {
-    fclose(fp_);
-    fp_ = nullptr;
+    file_.Close();
+    tokenizer_ = {};
 }
 
-void CsvParser::ConvertToMetricDataType(const char* data, Header columnId)
+void CsvParser::ConvertToMetricDataType(std::string_view data, Header columnId)
 {
     switch (columnId)
     {
     case Header_Application:
     {
-        v2MetricRow_.appName = data;
+        v2MetricRow_.appName.assign(data);
     }
     break;
     case Header_ProcessID:
@@ -753,68 +699,32 @@ void CsvParser::ConvertToMetricDataType(const char* data, Header columnId)
     break;
     case Header_DisplayLatency:
     {
-        if (strncmp(data, "NA", 2) != 0) {
-            double convertedData = 0.;
-            CharConvert<double> converter;
-            converter.Convert(data, convertedData, columnId, line_);
-            v2MetricRow_.displayLatency = convertedData;
-        }
-        else
-        {
-            v2MetricRow_.displayLatency.reset();
-        }
+        CharConvert<std::optional<double>> converter;
+        converter.Convert(data, v2MetricRow_.displayLatency, columnId, line_);
     }
     break;
     case Header_DisplayedTime:
     {
-        if (strncmp(data, "NA", 2) != 0) {
-            double convertedData = 0.;
-            CharConvert<double> converter;
-            converter.Convert(data, convertedData, columnId, line_);
-            v2MetricRow_.displayedTime = convertedData;
-        }
-        else {
-            v2MetricRow_.displayedTime.reset();
-        }
+        CharConvert<std::optional<double>> converter;
+        converter.Convert(data, v2MetricRow_.displayedTime, columnId, line_);
     }
     break;
     case Header_AnimationError:
     {
-        if (strncmp(data, "NA", 2) != 0) {
-            double convertedData = 0.;
-            CharConvert<double> converter;
-            converter.Convert(data, convertedData, columnId, line_);
-            v2MetricRow_.animationError = convertedData;
-        }
-        else {
-            v2MetricRow_.animationError.reset();
-        }
+        CharConvert<std::optional<double>> converter;
+        converter.Convert(data, v2MetricRow_.animationError, columnId, line_);
     }
     break;
     case Header_ClickToPhotonLatency:
     {
-        if (strncmp(data, "NA", 2) != 0) {
-            double convertedData = 0.;
-            CharConvert<double> converter;
-            converter.Convert(data, convertedData, columnId, line_);
-            v2MetricRow_.clickToPhotonLatency = convertedData;
-        }
-        else {
-            v2MetricRow_.clickToPhotonLatency.reset();
-        }
+        CharConvert<std::optional<double>> converter;
+        converter.Convert(data, v2MetricRow_.clickToPhotonLatency, columnId, line_);
     }
     break;
     case Header_AllInputToPhotonLatency:
     {
-        if (strncmp(data, "NA", 2) != 0) {
-            double convertedData = 0.;
-            CharConvert<double> converter;
-            converter.Convert(data, convertedData, columnId, line_);
-            v2MetricRow_.AllInputToPhotonLatency = convertedData;
-        }
-        else {
-            v2MetricRow_.AllInputToPhotonLatency.reset();
-        }
+        CharConvert<std::optional<double>> converter;
+        converter.Convert(data, v2MetricRow_.AllInputToPhotonLatency, columnId, line_);
     }
     break;
     default:
@@ -826,53 +736,34 @@ void CsvParser::ConvertToMetricDataType(const char* data, Header columnId)
 
 bool CsvParser::ReadRow(bool gatherMetrics)
 {
-    row_[0] = '\0';
-    cols_.clear();
-
-    // Read a line
-    if (fgets(row_, _countof(row_), fp_) == nullptr) {
-        if (ferror(fp_) != 0) {
-            std::wstring errorMessage = L"File read error at line: ";
-            errorMessage += std::to_wstring(line_);
-            Assert::Fail(errorMessage.c_str());
-        }
+    // Read a row, split into columns with leading/trailing whitespace
+    // removed
+    if (!tokenizer_.ReadRow(cols_)) {
         return false;
     }
 
-    line_ += 1;
+    line_ = tokenizer_.GetLine();
 
-    // Split line into columns, skipping leading/trailing whitespace
-    auto p0 = row_;
-    for (; *p0 == ' ' || *p0 == '\t'; ++p0) *p0 = '\0';
-    uint32_t columnId = 0;
-    for (auto p = p0; ; ++p) {
-        auto ch = *p;
-        if (ch == ',' || ch == '\0') {
-            *p = '\0';
-            cols_.push_back(p0);
-            if (gatherMetrics) {
-                ConvertToMetricDataType(p0, activeColHeadersMap_[columnId++]);
-            }
-            for (p0 = p + 1; *p0 == ' ' || *p0 == '\t'; ++p0) *p0 = '\0';
-            for (auto q = p - 1; *q == ' ' || *q == '\t' || *q == '\n' || *q == '\r'; --q) *q = '\0';
-            if (ch == '\0') break;
+    if (gatherMetrics) {
+        for (size_t i = 0, n = cols_.size(); i < n; ++i) {
+            ConvertToMetricDataType(cols_[i], activeColHeadersMap_[i]);
         }
     }
 
     return true;
 }
 
-size_t CsvParser::GetColumnIndex(char const* header)
+size_t CsvParser::GetColumnIndex(std::string_view header)
 {
     auto h = FindHeader(header);
     return h < KnownHeaderCount ? headerColumnIndex_[h] : SIZE_MAX;
 }
 
-Header CsvParser::FindHeader(char const* header)
+Header CsvParser::FindHeader(std::string_view header)
 {
     for (uint32_t i = 0; i < KnownHeaderCount; ++i) {
         auto h = (Header)i;
-        if (strcmp(header, GetHeaderString(h)) == 0) {
+        if (header == GetHeaderString(h)) {
             return h;
         }
     }
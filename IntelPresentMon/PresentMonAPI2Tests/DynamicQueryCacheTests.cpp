@@ -0,0 +1,197 @@
+#include "CppUnitTest.h"
+#include <vector>
+#include <chrono>
+#include <format>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include "../PresentMonMiddleware/DynamicQueryCache.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PresentMonAPI2Mock
+{
+	using namespace pmon::mid;
+
+	namespace
+	{
+		// lays out elements the way RegisterDynamicQuery does
+		PM_DYNAMIC_QUERY MakeQuery(std::vector<PM_QUERY_ELEMENT> elements)
+		{
+			PM_DYNAMIC_QUERY query;
+			uint64_t offset = 0;
+			for (auto& qe : elements) {
+				qe.dataOffset = offset;
+				qe.dataSize = sizeof(double);
+				offset += qe.dataSize;
+			}
+			query.elements = std::move(elements);
+			return query;
+		}
+		double ReadValue(const std::vector<uint8_t>& blob, const PM_QUERY_ELEMENT& qe)
+		{
+			double value;
+			std::memcpy(&value, blob.data() + qe.dataOffset, sizeof(value));
+			return value;
+		}
+		void WriteValue(std::vector<uint8_t>& blob, const PM_QUERY_ELEMENT& qe, double value)
+		{
+			std::memcpy(blob.data() + qe.dataOffset, &value, sizeof(value));
+		}
+		// stand-in for the statistic a query element computes over a window
+		double Calculate(std::vector<double>& frameTimes, const PM_QUERY_ELEMENT& qe)
+		{
+			switch (qe.stat) {
+			case PM_STAT_AVG:
+			{
+				double sum = 0.;
+				for (auto t : frameTimes) {
+					sum += t;
+				}
+				return sum / frameTimes.size() + double(qe.metric);
+			}
+			case PM_STAT_MAX: return *std::ranges::max_element(frameTimes) + double(qe.metric);
+			default:
+			{
+				std::ranges::sort(frameTimes);
+				return frameTimes[size_t(frameTimes.size() * 0.99)] + double(qe.metric);
+			}
+			}
+		}
+	}
+
+	TEST_CLASS(DynamicQueryCacheTests)
+	{
+	public:
+		TEST_METHOD(MergeAccumulationReportsGrowth)
+		{
+			PM_DYNAMIC_QUERY window;
+			PM_DYNAMIC_QUERY fps;
+			fps.accumFpsData = true;
+			PM_DYNAMIC_QUERY power;
+			power.accumGpuBits.set(size_t(GpuTelemetryCapBits::gpu_power));
+			Assert::IsTrue(MergeAccumulation(window, fps));
+			Assert::IsFalse(MergeAccumulation(window, fps));
+			Assert::IsTrue(MergeAccumulation(window, power));
+			Assert::IsFalse(MergeAccumulation(window, fps));
+			Assert::IsTrue(window.accumFpsData);
+			Assert::IsTrue(window.accumGpuBits.test(size_t(GpuTelemetryCapBits::gpu_power)));
+		}
+		TEST_METHOD(AssembleIntoDifferentLayouts)
+		{
+			const auto a = MakeQuery({
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG },
+				{ PM_METRIC_GPU_POWER, PM_STAT_MAX, 1 },
+			});
+			// same metrics in another order, plus one that a has not computed
+			const auto b = MakeQuery({
+				{ PM_METRIC_GPU_POWER, PM_STAT_MAX, 1 },
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG },
+				{ PM_METRIC_CPU_BUSY, PM_STAT_AVG },
+			});
+			const auto c = MakeQuery({
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG },
+			});
+			DynamicQueryValueCache cache;
+			Assert::IsTrue(cache.StartBatch({ 0, 10, 20, 2 }));
+
+			std::vector<uint8_t> blobA(a.GetBlobSize());
+			WriteValue(blobA, a.elements[0], 60.);
+			WriteValue(blobA, a.elements[1], 150.);
+			cache.Store(a, blobA.data());
+			Assert::AreEqual(size_t(2), cache.GetValueCount());
+
+			std::vector<uint8_t> blobB(b.GetBlobSize(), 0xCD);
+			Assert::IsFalse(cache.Assemble(b, blobB.data()));
+			Assert::IsTrue(std::ranges::all_of(blobB, [](uint8_t v) { return v == 0xCD; }));
+
+			std::vector<uint8_t> blobC(c.GetBlobSize());
+			Assert::IsTrue(cache.Assemble(c, blobC.data()));
+			Assert::AreEqual(60., ReadValue(blobC, c.elements[0]));
+
+			// once b has been calculated, both of its values come from the cache in its own layout
+			WriteValue(blobB, b.elements[0], 150.);
+			WriteValue(blobB, b.elements[1], 60.);
+			WriteValue(blobB, b.elements[2], 4.);
+			cache.Store(b, blobB.data());
+			std::vector<uint8_t> blobB2(b.GetBlobSize());
+			Assert::IsTrue(cache.Assemble(b, blobB2.data()));
+			Assert::IsTrue(blobB == blobB2);
+		}
+		TEST_METHOD(NewBatchDropsValues)
+		{
+			const auto q = MakeQuery({ { PM_METRIC_PRESENTED_FPS, PM_STAT_AVG } });
+			std::vector<uint8_t> blob(q.GetBlobSize());
+			DynamicQueryValueCache cache;
+			Assert::IsTrue(cache.StartBatch({ 0, 10, 20, 2 }));
+			cache.Store(q, blob.data());
+			Assert::IsFalse(cache.StartBatch({ 0, 10, 20, 2 }));
+			Assert::IsTrue(cache.Assemble(q, blob.data()));
+			// a new frame at the end of the window
+			Assert::IsTrue(cache.StartBatch({ 0, 10, 30, 3 }));
+			Assert::IsFalse(cache.Assemble(q, blob.data()));
+			cache.Store(q, blob.data());
+			cache.Invalidate();
+			Assert::IsTrue(cache.StartBatch({ 0, 10, 30, 3 }));
+			Assert::AreEqual(size_t(0), cache.GetValueCount());
+		}
+		// reports the cost of 10 overlapping queries polled at 60 Hz computing independently vs sharing values
+		TEST_METHOD(OverlappingQueriesCost)
+		{
+			const PM_QUERY_ELEMENT pool[] = {
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG }, { PM_METRIC_PRESENTED_FPS, PM_STAT_PERCENTILE_99 },
+				{ PM_METRIC_DISPLAYED_FPS, PM_STAT_AVG }, { PM_METRIC_CPU_FRAME_TIME, PM_STAT_MAX },
+				{ PM_METRIC_GPU_BUSY, PM_STAT_AVG }, { PM_METRIC_GPU_BUSY, PM_STAT_PERCENTILE_99 },
+				{ PM_METRIC_DISPLAY_LATENCY, PM_STAT_AVG }, { PM_METRIC_GPU_POWER, PM_STAT_AVG, 1 },
+			};
+			// each query asks for 6 of the 8 elements in its own order
+			std::vector<PM_DYNAMIC_QUERY> queries;
+			std::minstd_rand rng{ 42 };
+			for (int i = 0; i < 10; i++) {
+				std::vector<PM_QUERY_ELEMENT> elements{ std::begin(pool), std::end(pool) };
+				std::ranges::shuffle(elements, rng);
+				elements.resize(6);
+				queries.push_back(MakeQuery(std::move(elements)));
+			}
+			// 1 s window at 240 fps, polled at 60 Hz for 10 s with 4 new frames per poll
+			std::vector<double> frameTimes(240);
+			std::uniform_real_distribution<double> dist{ 3., 5. };
+			const int polls = 600;
+			const auto run = [&](bool share) {
+				DynamicQueryValueCache cache;
+				std::vector<std::vector<uint8_t>> blobs;
+				for (auto& q : queries) {
+					blobs.emplace_back(q.GetBlobSize());
+				}
+				std::vector<double> scratch;
+				double sink = 0.;
+				const auto start = std::chrono::high_resolution_clock::now();
+				for (int p = 0; p < polls; p++) {
+					std::ranges::generate(frameTimes, [&] { return dist(rng); });
+					cache.StartBatch({ 0, uint64_t(p), uint64_t(p) + 240, frameTimes.size() });
+					for (size_t i = 0; i < queries.size(); i++) {
+						auto& q = queries[i];
+						if (share && cache.Assemble(q, blobs[i].data())) {
+							continue;
+						}
+						for (auto& qe : q.elements) {
+							scratch = frameTimes;
+							WriteValue(blobs[i], qe, Calculate(scratch, qe));
+						}
+						if (share) {
+							cache.Store(q, blobs[i].data());
+						}
+					}
+					for (size_t i = 0; i < queries.size(); i++) {
+						sink += ReadValue(blobs[i], queries[i].elements[0]);
+					}
+				}
+				const std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+				Logger::WriteMessage(std::format("{}: {:.2f} us per 60 Hz poll of 10 queries ({:.1f})\n",
+					share ? "shared values" : "independent", elapsed.count() / polls, sink).c_str());
+			};
+			run(false);
+			run(true);
+		}
+	};
+}
@@ -6,6 +6,7 @@
 #include "../Interprocess/source/Interprocess.h"
 #include "../Interprocess/source/IntrospectionTransfer.h"
 #include "../Interprocess/source/IntrospectionCloneAllocators.h"
+#include "../Interprocess/source/IntrospectionSnapshot.h"
 #include "../PresentMonAPIWrapper/PresentMonAPIWrapper.h"
 #include "../PresentMonAPI2/Internal.h"
 #include "BoostProcess.h"
@@ -151,6 +152,112 @@ namespace PresentMonAPI2Mock
 			}
 			free((void*)pRoot);
 		}
+		TEST_METHOD(ApiSnapshotRoundTrip)
+		{
+			auto pComm = ipc::MakeServiceComms("svc_comms_shm_3");
+			ipc::intro::RegisterMockIntrospectionDevices(*pComm);
+			auto& root = pComm->GetIntrospectionRoot();
+			const auto snapshotSize = ipc::intro::GetIntrospectionSnapshotSize(root);
+			Assert::AreEqual(45032ull + sizeof(ipc::intro::IntrospectionSnapshotHeader), snapshotSize);
+			std::vector<char> snapshot(snapshotSize);
+			ipc::intro::WriteIntrospectionSnapshot(root, snapshot.data(), snapshot.size());
+
+			auto pRoot = ipc::intro::LoadIntrospectionSnapshot(snapshot.data(), snapshot.size());
+			Assert::IsNotNull(pRoot);
+			Assert::AreEqual(12ull, pRoot->pEnums->size);
+			Assert::AreEqual(69ull, pRoot->pMetrics->size);
+			Assert::AreEqual(3ull, pRoot->pDevices->size);
+			// spot check pointers were relocated into the loaded block
+			{
+				auto pEnum = static_cast<const PM_INTROSPECTION_ENUM*>(pRoot->pEnums->pData[6]);
+				Assert::AreEqual("PM_UNIT", pEnum->pSymbol->pData);
+				auto pKey = static_cast<const PM_INTROSPECTION_ENUM_KEY*>(pEnum->pKeys->pData[3]);
+				Assert::AreEqual("PM_UNIT_PERCENT", pKey->pSymbol->pData);
+				Assert::AreEqual("%", pKey->pShortName->pData);
+			}
+			{
+				auto pMetric = static_cast<const PM_INTROSPECTION_METRIC*>(pRoot->pMetrics->pData[22]);
+				Assert::AreEqual((int)PM_METRIC_GPU_FAN_SPEED, (int)pMetric->id);
+				Assert::AreEqual((int)PM_DATA_TYPE_DOUBLE, (int)pMetric->pTypeInfo->polledType);
+				auto pInfo = static_cast<const PM_INTROSPECTION_DEVICE_METRIC_INFO*>(pMetric->pDeviceMetricInfo->pData[1]);
+				Assert::AreEqual(2u, pInfo->arraySize);
+			}
+			free((void*)pRoot);
+
+			// middleware side should be served from the snapshot published at finalization
+			auto pMiddlewareComm = ipc::MakeMiddlewareComms("svc_comms_shm_3");
+			auto pMiddlewareRoot = pMiddlewareComm->GetIntrospectionRoot();
+			Assert::IsNotNull(pMiddlewareRoot);
+			auto pDevice = static_cast<const PM_INTROSPECTION_DEVICE*>(pMiddlewareRoot->pDevices->pData[0]);
+			Assert::AreEqual("Device-independent", pDevice->pName->pData);
+			free((void*)pMiddlewareRoot);
+
+			// corrupted or truncated snapshots are rejected
+			snapshot.back() ^= 0xFF;
+			Assert::IsNull(ipc::intro::LoadIntrospectionSnapshot(snapshot.data(), snapshot.size()));
+			Assert::IsNull(ipc::intro::LoadIntrospectionSnapshot(snapshot.data(), snapshot.size() - 1));
+		}
+		TEST_METHOD(TelemetryRingJoin)
+		{
+			auto pComm = ipc::MakeServiceComms("svc_comms_shm_4");
+			ipc::intro::RegisterMockIntrospectionDevices(*pComm);
+			auto pMiddlewareComm = ipc::MakeMiddlewareComms("svc_comms_shm_4");
+			// rings exist as soon as devices are registered, but hold nothing yet
+			Assert::IsTrue(pMiddlewareComm->HasGpuTelemetry(1));
+			Assert::IsTrue(pMiddlewareComm->HasCpuTelemetry());
+			Assert::IsFalse(pMiddlewareComm->HasGpuTelemetry(77));
+			Assert::IsFalse(pMiddlewareComm->GetGpuTelemetryNearest(1, 100).has_value());
+			// samples every 100 qpc starting at 1000
+			for (uint64_t i = 0; i < 10; i++) {
+				pComm->PushGpuTelemetry(1, { .qpc = 1000 + i * 100, .gpu_power_w = double(i) });
+				pComm->PushCpuTelemetry({ .qpc = 1000 + i * 100, .cpu_utilization = double(i) });
+			}
+			// pushes to unregistered devices are dropped
+			pComm->PushGpuTelemetry(77, { .qpc = 5000 });
+			// nearest lookup clamps at both ends and resolves ties to the later sample
+			Assert::AreEqual(0., pMiddlewareComm->GetGpuTelemetryNearest(1, 0)->gpu_power_w);
+			Assert::AreEqual(9., pMiddlewareComm->GetGpuTelemetryNearest(1, 99'999)->gpu_power_w);
+			Assert::AreEqual(3., pMiddlewareComm->GetGpuTelemetryNearest(1, 1300)->gpu_power_w);
+			Assert::AreEqual(2., pMiddlewareComm->GetGpuTelemetryNearest(1, 1249)->gpu_power_w);
+			Assert::AreEqual(3., pMiddlewareComm->GetGpuTelemetryNearest(1, 1250)->gpu_power_w);
+			Assert::AreEqual(4., pMiddlewareComm->GetCpuTelemetryNearest(1351)->cpu_utilization);
+			// other devices have their own ring
+			Assert::IsFalse(pMiddlewareComm->GetGpuTelemetryNearest(2, 1000).has_value());
+			// once the polling period is known, samples further than one period away are rejected
+			pComm->SetTelemetryPeriod(100);
+			Assert::AreEqual(9., pMiddlewareComm->GetGpuTelemetryNearest(1, 1999)->gpu_power_w);
+			Assert::IsFalse(pMiddlewareComm->GetGpuTelemetryNearest(1, 2001).has_value());
+			Assert::IsFalse(pMiddlewareComm->GetGpuTelemetryNearest(1, 0).has_value());
+			Assert::IsFalse(pMiddlewareComm->GetCpuTelemetryNearest(99'999).has_value());
+			Assert::AreEqual(4., pMiddlewareComm->GetCpuTelemetryNearest(1351)->cpu_utilization);
+			pComm->SetTelemetryPeriod(0);
+			// range reads are inclusive on both ends and ordered oldest first
+			{
+				std::vector<PresentMonPowerTelemetryInfo> samples;
+				pMiddlewareComm->ReadGpuTelemetry(1, 1200, 1500, samples);
+				Assert::AreEqual(4ull, samples.size());
+				Assert::AreEqual(2., samples.front().gpu_power_w);
+				Assert::AreEqual(5., samples.back().gpu_power_w);
+				std::vector<CpuTelemetryInfo> cpuSamples;
+				pMiddlewareComm->ReadCpuTelemetry(1210, 1290, cpuSamples);
+				Assert::IsTrue(cpuSamples.empty());
+			}
+			// after wrapping, only the newest samples remain readable
+			for (uint64_t i = 10; i < 5000; i++) {
+				pComm->PushGpuTelemetry(1, { .qpc = 1000 + i * 100, .gpu_power_w = double(i) });
+			}
+			{
+				std::vector<PresentMonPowerTelemetryInfo> samples;
+				pMiddlewareComm->ReadGpuTelemetry(1, 0, ~0ull, samples);
+				Assert::IsTrue(samples.size() > 1000);
+				Assert::IsTrue(samples.size() < 5000);
+				Assert::AreEqual(4999., samples.back().gpu_power_w);
+				for (size_t i = 1; i < samples.size(); i++) {
+					Assert::IsTrue(samples[i - 1].qpc < samples[i].qpc);
+				}
+				Assert::AreEqual(samples.front().gpu_power_w, pMiddlewareComm->GetGpuTelemetryNearest(1, 0)->gpu_power_w);
+			}
+		}
 		TEST_METHOD(SeparateProcessesApiBlockClone)
 		{
 			namespace bp = boost::process;
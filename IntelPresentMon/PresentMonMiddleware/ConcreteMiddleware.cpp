@@ -10,6 +10,7 @@
 #include <Shlwapi.h>
 #include <numeric>
 #include <algorithm>
+#include <span>
 #include "../PresentMonUtils/QPCUtils.h"
 #include "../PresentMonAPI2/Internal.h"
 #include "../PresentMonAPIWrapperCommon/Introspection.h"
@@ -21,6 +22,7 @@
 #include "../Interprocess/source/PmStatusError.h"
 //#include "MockCommon.h"
 #include "DynamicQuery.h"
+#include "DynamicQueryWindow.h"
 #include "../ControlLib/PresentMonPowerTelemetry.h"
 #include "../ControlLib/CpuTelemetryInfo.h"
 #include "../PresentMonService/GlobalIdentifiers.h"
@@ -41,7 +43,6 @@ namespace pmon::mid
     namespace vi = std::views;
 
     static const uint32_t kMaxRespBufferSize = 4096;
-	static const uint64_t kClientFrameDeltaQPCThreshold = 50000000;
 	ConcreteMiddleware::ConcreteMiddleware(std::optional<std::string> pipeNameOverride, std::optional<std::string> introNsmOverride)
 	{
         const auto pipeName = pipeNameOverride.transform(&std::string::c_str)
@@ -114,6 +115,16 @@ namespace pmon::mid
                 presentMonStreamClients.emplace(targetPid,
                     std::make_unique<StreamClient>(std::move(res.nsmFileName), false));
             }
+            // Offline streams written to a frame store are read from the file instead
+            if (!res.frameStorePath.empty() && !frameStoreStreams.contains(targetPid)) {
+                auto pReader = std::make_unique<FrameStoreReader>(res.frameStorePath);
+                if (pReader->IsValid()) {
+                    frameStoreStreams.emplace(targetPid, FrameStoreStream{ std::move(pReader) });
+                }
+                else {
+                    pmlog_warn(std::format("Unable to open frame store [{}], using nsm", res.frameStorePath)).diag();
+                }
+            }
         }
         catch (...) {
             const auto code = util::GeneratePmStatus();
@@ -134,6 +145,8 @@ namespace pmon::mid
             if (iter != presentMonStreamClients.end()) {
                 presentMonStreamClients.erase(std::move(iter));
             }
+            frameStoreStreams.erase(targetPid);
+            std::erase_if(sharedDynamicWindows, [=](auto& w) { return w.first.processId == targetPid; });
         }
         catch (...) {
             const auto code = util::GeneratePmStatus();
@@ -226,6 +239,41 @@ namespace pmon::mid
         return PM_STATUS_SUCCESS;
     }
 
+    void ConcreteMiddleware::GetAnalysisInstrumentation(PM_ANALYSIS_INSTRUMENTATION& instrumentation, PM_ANALYSIS_EVENT_COST* pEventCosts, uint32_t& numEventCosts)
+    {
+        // the service reports PresentData's enumerations by value
+        static_assert(PM_ANALYSIS_HANDLER_COUNT == size_t(InstrumentedHandler::Count));
+        static_assert(PM_ANALYSIS_TABLE_COUNT == size_t(ConsumerTable::Count));
+        static_assert(PM_ANALYSIS_CYCLE_BUCKET_COUNT == INSTRUMENTATION_COST_BUCKET_COUNT);
+
+        const auto res = pActionClient->DispatchSync(acts::GetAnalysisInstrumentation::Params{});
+        instrumentation = {};
+        instrumentation.enabled = res.enabled;
+        instrumentation.eventCount = res.eventCount;
+        instrumentation.callbackCycles = res.callbackCycles;
+        std::copy_n(res.callbackCycleHistogram.begin(), std::min<size_t>(res.callbackCycleHistogram.size(), PM_ANALYSIS_CYCLE_BUCKET_COUNT),
+            instrumentation.callbackCycleHistogram);
+        instrumentation.untrackedEventCount = res.untrackedEventCount;
+        std::copy_n(res.tableSizes.begin(), std::min<size_t>(res.tableSizes.size(), PM_ANALYSIS_TABLE_COUNT), instrumentation.tableSizes);
+        instrumentation.evictedEntryCount = res.evictedEntryCount;
+        instrumentation.completedPresentCount = res.completedPresentCount;
+        instrumentation.peakCompletedPresentCount = res.peakCompletedPresentCount;
+        instrumentation.eventCostCount = uint32_t(res.eventCosts.size());
+
+        numEventCosts = pEventCosts ? std::min(numEventCosts, instrumentation.eventCostCount) : 0;
+        for (uint32_t i = 0; i < numEventCosts; i++) {
+            const auto& cost = res.eventCosts[i];
+            auto& out = pEventCosts[i];
+            out = {};
+            out.handler = PM_ANALYSIS_HANDLER(cost.handler);
+            out.eventId = cost.eventId;
+            out.count = cost.count;
+            out.cycles = cost.cycles;
+            std::copy_n(cost.cycleHistogram.begin(), std::min<size_t>(cost.cycleHistogram.size(), PM_ANALYSIS_CYCLE_BUCKET_COUNT),
+                out.cycleHistogram);
+        }
+    }
+
     PM_DYNAMIC_QUERY* ConcreteMiddleware::RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs)
     { 
         // get introspection data for reference
@@ -442,33 +490,36 @@ struct FakePMTraceSession {
 
     double TimestampDeltaToMilliSeconds(uint64_t qpcDelta) const
     {
-        return mMilliSecondsPerTimestamp * qpcDelta;
+        return util::TimestampDeltaToMilliSeconds(qpcDelta, mMilliSecondsPerTimestamp);
     }
 
     double TimestampDeltaToUnsignedMilliSeconds(uint64_t qpcFrom, uint64_t qpcTo) const
     {
-        return qpcFrom == 0 || qpcTo <= qpcFrom ? 0.0 : TimestampDeltaToMilliSeconds(qpcTo - qpcFrom);
+        return util::TimestampDeltaToUnsignedMilliSeconds(qpcFrom, qpcTo, mMilliSecondsPerTimestamp);
     }
 
     double TimestampDeltaToMilliSeconds(uint64_t qpcFrom, uint64_t qpcTo) const
     {
-        return qpcFrom == 0 || qpcTo == 0 || qpcFrom == qpcTo ? 0.0 :
-            qpcTo > qpcFrom ? TimestampDeltaToMilliSeconds(qpcTo - qpcFrom) :
-                             -TimestampDeltaToMilliSeconds(qpcFrom - qpcTo);
+        return util::TimestampDeltaToMilliSeconds(qpcFrom, qpcTo, mMilliSecondsPerTimestamp);
+    }
+
+    void TimestampDeltasToMilliSeconds(std::span<const uint64_t> qpcDeltas, std::span<double> out) const
+    {
+        util::TimestampDeltasToMilliSeconds(qpcDeltas, out, mMilliSecondsPerTimestamp);
+    }
+
+    void TimestampDeltasToUnsignedMilliSeconds(std::span<const uint64_t> qpcFroms, std::span<const uint64_t> qpcTos, std::span<double> out) const
+    {
+        util::TimestampDeltasToUnsignedMilliSeconds(qpcFroms, qpcTos, out, mMilliSecondsPerTimestamp);
     }
 };
 
 // Copied from: PresentMon/PresentMon.hpp
 // Metrics computed per-frame.  Duration and Latency metrics are in milliseconds.
+// The busy, wait and latency durations are kept as raw qpc in the chain and converted in batch
+// by ConvertPendingQpc.
 struct FrameMetrics {
     uint64_t mCPUStart;
-    double mCPUBusy;
-    double mCPUWait;
-    double mGPULatency;
-    double mGPUBusy;
-    double mVideoBusy;
-    double mGPUWait;
-    double mDisplayLatency;
     double mDisplayedTime;
     double mAnimationError;
     double mClickToPhotonLatency;
@@ -540,30 +591,11 @@ void ReportMetrics(
     bool includeFrameData = chain->mIncludeFrameData && (p->FrameId != nextPresent->FrameId || p->FrameType == FrameType::Application);
 
     bool displayed = p->FinalState == PresentResult::Presented;
-    double msGPUDuration = 0.0;
 
     FrameMetrics metrics;
     metrics.mCPUStart = chain->mLastPresent.PresentStartTime + chain->mLastPresent.TimeInPresent;
 
-    if (includeFrameData) {
-        msGPUDuration       = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->GPUStartTime, p->ReadyTime);
-        metrics.mCPUBusy    = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->PresentStartTime);
-        metrics.mCPUWait    = pmSession.TimestampDeltaToMilliSeconds(p->TimeInPresent);
-        metrics.mGPULatency = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->GPUStartTime);
-        metrics.mGPUBusy    = pmSession.TimestampDeltaToMilliSeconds(p->GPUDuration);
-        metrics.mVideoBusy  = pmSession.TimestampDeltaToMilliSeconds(p->GPUVideoDuration);
-        metrics.mGPUWait    = std::max(0.0, msGPUDuration - metrics.mGPUBusy);
-    } else {
-        metrics.mCPUBusy    = 0.0;
-        metrics.mCPUWait    = 0.0;
-        metrics.mGPULatency = 0.0;
-        metrics.mGPUBusy    = 0.0;
-        metrics.mVideoBusy  = 0.0;
-        metrics.mGPUWait    = 0.0;
-    }
-
     if (displayed) {
-        metrics.mDisplayLatency       = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->ScreenTime);
         metrics.mDisplayedTime        = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->ScreenTime, nextDisplayedPresent->ScreenTime);
         metrics.mAnimationError       = chain->mLastDisplayedCPUStart == 0 ? 0 : pmSession.TimestampDeltaToMilliSeconds(p->ScreenTime - chain->display_n_screen_time,
                                                                                                                         metrics.mCPUStart - chain->mLastDisplayedCPUStart);
@@ -584,7 +616,6 @@ void ReportMetrics(
         chain->mLastReceivedNotDisplayedAllInputTime = 0;
         chain->mLastReceivedNotDisplayedMouseClickTime = 0;
     } else {
-        metrics.mDisplayLatency       = 0.0;
         metrics.mDisplayedTime        = 0.0;
         metrics.mAnimationError       = 0.0;
         metrics.mClickToPhotonLatency = 0.0;
@@ -608,12 +639,14 @@ void ReportMetrics(
     // IntelPresentMon specifics:
 
     if (includeFrameData) {
-        chain->mCPUBusy       .push_back(metrics.mCPUBusy);
-        chain->mCPUWait       .push_back(metrics.mCPUWait);
-        chain->mGPULatency    .push_back(metrics.mGPULatency);
-        chain->mGPUBusy       .push_back(metrics.mGPUBusy);
-        chain->mVideoBusy     .push_back(metrics.mVideoBusy);
-        chain->mGPUWait       .push_back(metrics.mGPUWait);
+        auto& pending = chain->mPendingQpc;
+        pending.cpuStart     .push_back(metrics.mCPUStart);
+        pending.presentStart .push_back(p->PresentStartTime);
+        pending.gpuStart     .push_back(p->GPUStartTime);
+        pending.readyTime    .push_back(p->ReadyTime);
+        pending.timeInPresent.push_back(p->TimeInPresent);
+        pending.gpuDuration  .push_back(p->GPUDuration);
+        pending.videoDuration.push_back(p->GPUVideoDuration);
         chain->mAnimationError.push_back(std::abs(metrics.mAnimationError));
     }
 
@@ -632,7 +665,8 @@ void ReportMetrics(
             chain->mAllInputToPhotonLatency.push_back(metrics.mAllInputPhotonLatency);
         }
 
-        chain->mDisplayLatency.push_back(metrics.mDisplayLatency);
+        chain->mPendingQpc.displayedCpuStart.push_back(metrics.mCPUStart);
+        chain->mPendingQpc.screenTime.push_back(p->ScreenTime);
         chain->mDisplayedTime .push_back(metrics.mDisplayedTime);
         chain->mDropped       .push_back(0.0);
     } else {
@@ -640,12 +674,50 @@ void ReportMetrics(
     }
 }
 
+// Grows dst by count elements and returns the new tail for a batch conversion to write into
+std::span<double> AppendTail(std::vector<double>& dst, size_t count)
+{
+    dst.resize(dst.size() + count);
+    return std::span{ dst }.last(count);
+}
+
+// Converts the qpc columns gathered by ReportMetrics to milliseconds in one pass per metric
+// and appends them to the chain's metric vectors, in the order the frames were reported
+void ConvertPendingQpc(FakePMTraceSession const& pmSession, fpsSwapChainData* chain)
+{
+    auto& pending = chain->mPendingQpc;
+    if (const auto count = pending.cpuStart.size()) {
+        pmSession.TimestampDeltasToUnsignedMilliSeconds(pending.cpuStart, pending.presentStart, AppendTail(chain->mCPUBusy, count));
+        pmSession.TimestampDeltasToMilliSeconds(pending.timeInPresent, AppendTail(chain->mCPUWait, count));
+        pmSession.TimestampDeltasToUnsignedMilliSeconds(pending.cpuStart, pending.gpuStart, AppendTail(chain->mGPULatency, count));
+        pmSession.TimestampDeltasToMilliSeconds(pending.gpuDuration, AppendTail(chain->mGPUBusy, count));
+        pmSession.TimestampDeltasToMilliSeconds(pending.videoDuration, AppendTail(chain->mVideoBusy, count));
+        // gpu wait is the part of the gpu start to ready duration that the gpu was not busy
+        const auto gpuWait = AppendTail(chain->mGPUWait, count);
+        pmSession.TimestampDeltasToUnsignedMilliSeconds(pending.gpuStart, pending.readyTime, gpuWait);
+        const auto gpuBusy = std::span{ chain->mGPUBusy }.last(count);
+        for (size_t i = 0; i < count; i++) {
+            gpuWait[i] = std::max(0.0, gpuWait[i] - gpuBusy[i]);
+        }
+    }
+    if (const auto count = pending.screenTime.size()) {
+        pmSession.TimestampDeltasToUnsignedMilliSeconds(pending.displayedCpuStart, pending.screenTime, AppendTail(chain->mDisplayLatency, count));
+    }
+    pending.cpuStart.clear();
+    pending.presentStart.clear();
+    pending.gpuStart.clear();
+    pending.readyTime.clear();
+    pending.timeInPresent.clear();
+    pending.gpuDuration.clear();
+    pending.videoDuration.clear();
+    pending.displayedCpuStart.clear();
+    pending.screenTime.clear();
+}
+
 }
 
     void ConcreteMiddleware::PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains)
     {
-        std::unordered_map<uint64_t, fpsSwapChainData> swapChainData;
-        std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
         bool allMetricsCalculated = false;
         bool fpsMetricsCalculated = false;
 
@@ -664,71 +736,162 @@ void ReportMetrics(
             }
         }
 
-        auto iter = presentMonStreamClients.find(processId);
-        if (iter == presentMonStreamClients.end()) {
-            return;
+        // frames in the window, oldest first
+        std::vector<const PmNsmFrameData*> frames;
+        const PmNsmFrameData* pFirstFrame = nullptr;
+        const PmNsmFrameData* pLastFrame = nullptr;
+        size_t frameCount = 0;
+        uint64_t end_qpc = 0;
+        LARGE_INTEGER qpcFrequency = {};
+        // a frame store window is only gathered once it turns out to be a new batch
+        FrameStoreReader* pStoreReader = nullptr;
+        uint64_t iStoreBegin = 0;
+        uint64_t iStoreEnd = 0;
+        // the telemetry rings are stamped with live qpc, so they can only be joined to the frames
+        // of a live stream; offline streams have no telemetry
+        bool joinRingTelemetry = false;
+        if (auto storeIter = frameStoreStreams.find(processId); storeIter != frameStoreStreams.end()) {
+            auto& reader = *storeIter->second.pReader;
+            reader.Refresh();
+            qpcFrequency = reader.GetQpcFrequency();
+            // offline data has no relation to the current time, so the window is anchored to
+            // the newest frame written to the store
+            const auto newestQpc = reader.GetLatestQpc();
+            const auto offsetQpc = SecondsDeltaToQpc(pQuery->metricOffsetMs / 1000., qpcFrequency);
+            const auto windowQpc = SecondsDeltaToQpc(pQuery->windowSizeMs / 1000., qpcFrequency);
+            const auto windowEndQpc = newestQpc > offsetQpc ? newestQpc - offsetQpc : 0;
+            end_qpc = windowEndQpc > windowQpc ? windowEndQpc - windowQpc : 0;
+            const auto iBegin = reader.UpperBound(end_qpc);
+            const auto iEnd = reader.UpperBound(windowEndQpc);
+            if (iBegin >= iEnd) {
+                CopyMetricCacheToBlob(pQuery, processId, pBlob);
+                return;
+            }
+            pStoreReader = &reader;
+            iStoreBegin = iBegin;
+            iStoreEnd = iEnd;
+            pFirstFrame = reader.ReadFrameByIdx(iBegin);
+            pLastFrame = reader.ReadFrameByIdx(iEnd - 1);
+            frameCount = size_t(iEnd - iBegin);
         }
+        else {
+            auto iter = presentMonStreamClients.find(processId);
+            if (iter == presentMonStreamClients.end()) {
+                return;
+            }
 
-        // Get the named shared memory associated with the stream client
-        StreamClient* client = iter->second.get();
-        auto nsm_view = client->GetNamedSharedMemView();
-        auto nsm_hdr = nsm_view->GetHeader();
-        if (!nsm_hdr->process_active) {
-            // TODO: Do we want to inform the client if the server has destroyed the
-            // named shared memory?
-            // Server destroyed the named shared memory due to process exit. Destroy the
-            // mapped view from client side.
-            //StopStreamProcess(process_id);
-            //return PM_STATUS::PM_STATUS_PROCESS_NOT_EXIST;
-            return;
-        }
+            // Get the named shared memory associated with the stream client
+            StreamClient* client = iter->second.get();
+            auto nsm_view = client->GetNamedSharedMemView();
+            auto nsm_hdr = nsm_view->GetHeader();
+            if (!nsm_hdr->process_active) {
+                // TODO: Do we want to inform the client if the server has destroyed the
+                // named shared memory?
+                // Server destroyed the named shared memory due to process exit. Destroy the
+                // mapped view from client side.
+                //StopStreamProcess(process_id);
+                //return PM_STATUS::PM_STATUS_PROCESS_NOT_EXIST;
+                return;
+            }
 
-        uint64_t index = 0;
-        double adjusted_window_size_in_ms = pQuery->windowSizeMs;
-        auto result = queryFrameDataDeltas.emplace(std::pair(std::pair(pQuery, processId), uint64_t()));
-        auto queryToFrameDataDelta = &result.first->second;
-        
-        PmNsmFrameData* frame_data = GetFrameDataStart(client, index, SecondsDeltaToQpc(pQuery->metricOffsetMs/1000., client->GetQpcFrequency()), *queryToFrameDataDelta, adjusted_window_size_in_ms);
-        if (frame_data == nullptr) {
-            pmlog_warn("Filling cached data in dynamic metric poll due to nullptr from GetFrameDataStart").diag();
-            CopyMetricCacheToBlob(pQuery, processId, pBlob);
+            joinRingTelemetry = !nsm_hdr->from_etl_file;
+
+            auto result = queryFrameDataDeltas.emplace(std::pair(std::pair(pQuery, processId), uint64_t()));
+            DynamicQueryFrameWindow ringWindow;
+            if (!SelectDynamicQueryWindow(*client, pQuery->windowSizeMs, pQuery->metricOffsetMs,
+                result.first->second, ringWindow)) {
+                pmlog_warn("Filling cached data in dynamic metric poll due to no frames in the window").diag();
+                CopyMetricCacheToBlob(pQuery, processId, pBlob);
+                // telemetry does not depend on present events, so keep it current while the target isn't presenting
+                if (joinRingTelemetry) {
+                    CalculateTelemetryOnlyMetrics(pQuery, client->GetQpcFrequency(), pBlob);
+                }
+                return;
+            }
+            frames = std::move(ringWindow.frames);
+            pFirstFrame = frames.front();
+            pLastFrame = frames.back();
+            frameCount = frames.size();
+            end_qpc = ringWindow.beginQpc;
+            qpcFrequency = client->GetQpcFrequency();
+        }
+
+        const auto windowEndQpc = pLastFrame->present_event.PresentStartTime;
+        // live ring telemetry keeps moving with the current time even while no new frames arrive
+        DynamicQueryTelemetryWindow telemetryWindow{ end_qpc, windowEndQpc };
+        if (joinRingTelemetry) {
+            telemetryWindow = SelectLiveTelemetryWindow(pQuery->windowSizeMs, pQuery->metricOffsetMs,
+                qpcFrequency, windowEndQpc);
+        }
+
+        // queries over the same window of a process share the frame walk below and the values calculated
+        // from it; both are only redone once the window moves onto a new batch of frames or telemetry
+        auto& window = sharedDynamicWindows[DynamicQueryWindowKey{ processId, pQuery->windowSizeMs,
+            pQuery->metricOffsetMs, pQuery->cachedGpuInfoIndex.value_or(UINT32_MAX) }];
+        window.queries.insert(pQuery);
+        if (MergeAccumulation(window.accumulation, *pQuery)) {
+            window.values.Invalidate();
+        }
+        const DynamicQueryBatch batch{ end_qpc, pFirstFrame->present_event.PresentStartTime,
+            windowEndQpc, frameCount, joinRingTelemetry ? telemetryWindow.endQpc : 0 };
+        if (window.values.StartBatch(batch)) {
+            if (pStoreReader) {
+                frames.reserve(frameCount);
+                for (auto i = iStoreBegin; i < iStoreEnd; i++) {
+                    frames.push_back(pStoreReader->ReadFrameByIdx(i));
+                }
+            }
+            window.swapChainData.clear();
+            window.metricInfo.clear();
+            AccumulateWindow(&window.accumulation, frames, telemetryWindow.beginQpc, telemetryWindow.endQpc,
+                qpcFrequency, joinRingTelemetry, window.swapChainData, window.metricInfo);
+        }
+
+        // a query without fps metrics must not see the swap chains gathered for other queries
+        std::unordered_map<uint64_t, fpsSwapChainData> noSwapChainData;
+        auto& swapChainData = pQuery->accumFpsData ? window.swapChainData : noSwapChainData;
+        // with several swap chains the blob depends on how many the caller has room for, so only
+        // the single swap chain case (and telemetry-only queries) share values
+        const bool shareValues = swapChainData.size() == 1 || !pQuery->accumFpsData;
+        if (shareValues && window.values.Assemble(*pQuery, pBlob)) {
+            if (swapChainData.size() > *numSwapChains) {
+                *numSwapChains = uint32_t(swapChainData.size());
+            }
+            SaveMetricCache(pQuery, processId, pBlob);
             return;
         }
+        if (CalculateMetrics(pQuery, processId, pBlob, numSwapChains, qpcFrequency, swapChainData, window.metricInfo) &&
+            shareValues) {
+            window.values.Store(*pQuery, pBlob);
+        }
+    }
 
-        // Calculate the end qpc based on the current frame's qpc and
-        // requested window size coverted to a qpc
-        // then loop from the most recent frame data until we either run out of data or
-        // we meet the window size requirements sent in by the client
-        uint64_t end_qpc =
-            frame_data->present_event.PresentStartTime -
-            SecondsDeltaToQpc(adjusted_window_size_in_ms/1000., client->GetQpcFrequency());
-
-        std::vector<PmNsmFrameData*> frames;
-        while (frame_data->present_event.PresentStartTime > end_qpc) {
-            frames.push_back(frame_data);
-
-            // Get the index of the next frame
-            if (DecrementIndex(nsm_view, index) == false) {
-                // We have run out of data to process, time to go
-                break;
-            }
-            frame_data = client->ReadFrameByIdx(index);
-            if (frame_data == nullptr) {
-                break;
-            }
+    void ConcreteMiddleware::AccumulateWindow(const PM_DYNAMIC_QUERY* pQuery, const std::vector<const PmNsmFrameData*>& frames,
+        uint64_t telemetryBeginQpc, uint64_t telemetryEndQpc, LARGE_INTEGER qpcFrequency, bool joinRingTelemetry,
+        std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    {
+        // telemetry of a live stream is read over the telemetry window from the rings that the service
+        // publishes at its polling rate, so the samples used do not depend on the number of frames in the
+        // window (frames do not carry telemetry, so offline streams have none)
+        if (joinRingTelemetry) {
+            AccumulateGpuRingTelemetry(pQuery, telemetryBeginQpc, telemetryEndQpc, metricInfo);
+            AccumulateCpuRingTelemetry(pQuery, telemetryBeginQpc, telemetryEndQpc, metricInfo);
         }
 
         FakePMTraceSession pmSession;
-        pmSession.mMilliSecondsPerTimestamp = 1000.0 / client->GetQpcFrequency().QuadPart;
+        pmSession.mMilliSecondsPerTimestamp = 1000.0 / qpcFrequency.QuadPart;
 
-        for (const auto& frame_data : frames | std::views::reverse) {
+        for (const auto& frame_data : frames) {
             if (pQuery->accumFpsData)
             {
                 auto result = swapChainData.emplace(
                     frame_data->present_event.SwapChainAddress, fpsSwapChainData());
                 auto swap_chain = &result.first->second;
 
-                auto presentEvent = &frame_data->present_event;
+                // the frames are read-only (a frame store is mapped read-only, and the ring is shared with
+                // other queries), but ReportMetrics may patch the screen time of the next present
+                auto currentPresent = frame_data->present_event;
+                auto presentEvent = &currentPresent;
                 auto chain = swap_chain;
 
                 // The following code block copied from: PresentMon/OutputThread.cpp
@@ -756,23 +919,91 @@ void ReportMetrics(
                 }
                 // end
             }
+        }
+
+        for (auto& pair : swapChainData) {
+            ConvertPendingQpc(pmSession, &pair.second);
+        }
+    }
 
+    bool ConcreteMiddleware::AccumulateGpuRingTelemetry(const PM_DYNAMIC_QUERY* pQuery, uint64_t qpcBegin, uint64_t qpcEnd, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    {
+        if (pQuery->accumGpuBits.none() || !pQuery->cachedGpuInfoIndex) {
+            return false;
+        }
+        const auto deviceId = cachedGpuInfo[*pQuery->cachedGpuInfoIndex].deviceId;
+        if (!pComms->HasGpuTelemetry(deviceId)) {
+            return false;
+        }
+        std::vector<PresentMonPowerTelemetryInfo> samples;
+        pComms->ReadGpuTelemetry(deviceId, qpcBegin, qpcEnd, samples);
+        // window shorter than the polling period, use the sample closest to the end of the window
+        // (the ring has none within a polling period of it while polling is stopped or stalled)
+        if (samples.empty()) {
+            if (auto sample = pComms->GetGpuTelemetryNearest(deviceId, qpcEnd)) {
+                samples.push_back(*sample);
+            }
+            else {
+                return false;
+            }
+        }
+        for (auto& sample : samples) {
             for (size_t i = 0; i < pQuery->accumGpuBits.size(); ++i) {
-                if (pQuery->accumGpuBits[i])
-                {
-                    GetGpuMetricData(i, frame_data->power_telemetry, metricInfo);
+                if (pQuery->accumGpuBits[i]) {
+                    GetGpuMetricData(i, sample, metricInfo);
                 }
             }
+        }
+        return true;
+    }
 
+    bool ConcreteMiddleware::AccumulateCpuRingTelemetry(const PM_DYNAMIC_QUERY* pQuery, uint64_t qpcBegin, uint64_t qpcEnd, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    {
+        if (pQuery->accumCpuBits.none() || !pComms->HasCpuTelemetry()) {
+            return false;
+        }
+        std::vector<CpuTelemetryInfo> samples;
+        pComms->ReadCpuTelemetry(qpcBegin, qpcEnd, samples);
+        if (samples.empty()) {
+            if (auto sample = pComms->GetCpuTelemetryNearest(qpcEnd)) {
+                samples.push_back(*sample);
+            }
+            else {
+                return false;
+            }
+        }
+        for (auto& sample : samples) {
             for (size_t i = 0; i < pQuery->accumCpuBits.size(); ++i) {
-                if (pQuery->accumCpuBits[i])
-                {
-                    GetCpuMetricData(i, frame_data->cpu_telemetry, metricInfo);
+                if (pQuery->accumCpuBits[i]) {
+                    GetCpuMetricData(i, sample, metricInfo);
                 }
             }
         }
+        return true;
+    }
 
-        CalculateMetrics(pQuery, processId, pBlob, numSwapChains, client->GetQpcFrequency(), swapChainData, metricInfo);
+    void ConcreteMiddleware::CalculateTelemetryOnlyMetrics(const PM_DYNAMIC_QUERY* pQuery, LARGE_INTEGER qpcFrequency, uint8_t* pBlob)
+    {
+        if (pQuery->accumGpuBits.none() && pQuery->accumCpuBits.none()) {
+            return;
+        }
+        // same window the query would read ring telemetry over if it had frames
+        const auto window = SelectLiveTelemetryWindow(pQuery->windowSizeMs, pQuery->metricOffsetMs, qpcFrequency);
+        std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
+        AccumulateGpuRingTelemetry(pQuery, window.beginQpc, window.endQpc, metricInfo);
+        AccumulateCpuRingTelemetry(pQuery, window.beginQpc, window.endQpc, metricInfo);
+        // only overwrite elements that have fresh samples, everything else keeps the cached value
+        // (the ring metrics are all polled as doubles)
+        for (auto& qe : pQuery->elements) {
+            if (qe.metric == PM_METRIC_GPU_MEM_UTILIZATION) {
+                if (metricInfo.contains(PM_METRIC_GPU_MEM_USED)) {
+                    reinterpret_cast<double&>(pBlob[qe.dataOffset]) = CalculateGpuMemUtilization(metricInfo, qe.stat);
+                }
+            }
+            else if (metricInfo.contains(qe.metric)) {
+                CalculateGpuCpuMetric(metricInfo, qe, pBlob);
+            }
+        }
     }
 
     std::optional<size_t> ConcreteMiddleware::GetCachedGpuInfoIndex(uint32_t deviceId)
@@ -903,6 +1134,23 @@ void ReportMetrics(
         return pQuery;
     }
 
+    void ConcreteMiddleware::FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery)
+    {
+        // windows that no other query polls are dropped along with their frame walk and values
+        for (auto i = sharedDynamicWindows.begin(); i != sharedDynamicWindows.end();) {
+            i->second.queries.erase(pQuery);
+            if (i->second.queries.empty()) {
+                i = sharedDynamicWindows.erase(i);
+            }
+            else {
+                ++i;
+            }
+        }
+        std::erase_if(queryFrameDataDeltas, [=](auto& d) { return d.first.first == pQuery; });
+        std::erase_if(cachedMetricDatas, [=](auto& c) { return c.first.first == pQuery; });
+        delete const_cast<PM_DYNAMIC_QUERY*>(pQuery);
+    }
+
     void mid::ConcreteMiddleware::FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery)
     {
         delete const_cast<PM_FRAME_QUERY*>(pQuery);
@@ -920,31 +1168,49 @@ void ReportMetrics(
         uint32_t frames_copied = 0;
         numFrames = 0;
 
+        // offline streams may be backed by a frame store file that is read at our own pace,
+        // otherwise frames are consumed from the NSM ring
+        FrameStoreStream* pStore = nullptr;
         StreamClient* pShmClient = nullptr;
-        try {
-            pShmClient = presentMonStreamClients.at(processId).get();
-        }
-        catch (...) {
-            LOG(INFO)
-                << "Stream client for process " << processId
-                << " doesn't exist. Please call pmStartStream to initialize the "
-                "client.";
-            pmlog_error("Stream client for process {} doesn't exist. Please call pmStartStream to initialize the client.").diag();
-            throw Except<util::Exception>(std::format("Failed to find stream for pid {} in ConsumeFrameEvents", processId));
+        uint64_t startQpc = 0;
+        long long qpcFrequency = 0;
+        if (auto iter = frameStoreStreams.find(processId); iter != frameStoreStreams.end()) {
+            pStore = &iter->second;
+            if (pStore->pReader->Refresh() == pStore->nextIndex) {
+                // No new frames written, no error frames copied = 0
+                return;
+            }
+            startQpc = pStore->pReader->GetStartQpc();
+            qpcFrequency = pStore->pReader->GetQpcFrequency().QuadPart;
         }
+        else {
+            try {
+                pShmClient = presentMonStreamClients.at(processId).get();
+            }
+            catch (...) {
+                LOG(INFO)
+                    << "Stream client for process " << processId
+                    << " doesn't exist. Please call pmStartStream to initialize the "
+                    "client.";
+                pmlog_error("Stream client for process {} doesn't exist. Please call pmStartStream to initialize the client.").diag();
+                throw Except<util::Exception>(std::format("Failed to find stream for pid {} in ConsumeFrameEvents", processId));
+            }
 
-        const auto nsm_view = pShmClient->GetNamedSharedMemView();
-        const auto nsm_hdr = nsm_view->GetHeader();
-        if (!nsm_hdr->process_active) {
-            StopStreaming(processId);
-            pmlog_info("Process death detected while consuming frame events").diag();
-            throw Except<util::Exception>("Process died cannot consume frame events");
-        }
+            const auto nsm_view = pShmClient->GetNamedSharedMemView();
+            const auto nsm_hdr = nsm_view->GetHeader();
+            if (!nsm_hdr->process_active) {
+                StopStreaming(processId);
+                pmlog_info("Process death detected while consuming frame events").diag();
+                throw Except<util::Exception>("Process died cannot consume frame events");
+            }
 
-        const auto last_frame_idx = pShmClient->GetLatestFrameIndex();
-        if (last_frame_idx == UINT_MAX) {
-            // There are no frames available, no error frames copied = 0
-            return;
+            const auto last_frame_idx = pShmClient->GetLatestFrameIndex();
+            if (last_frame_idx == UINT_MAX) {
+                // There are no frames available, no error frames copied = 0
+                return;
+            }
+            startQpc = nsm_hdr->start_qpc;
+            qpcFrequency = pShmClient->GetQpcFrequency().QuadPart;
         }
 
         // make sure active device is the one referenced in this query
@@ -953,29 +1219,56 @@ void ReportMetrics(
         }
 
         // context transmits various data that applies to each gather command in the query
-        PM_FRAME_QUERY::Context ctx{ nsm_hdr->start_qpc, pShmClient->GetQpcFrequency().QuadPart };
+        PM_FRAME_QUERY::Context ctx{ startQpc, qpcFrequency };
+
+        // telemetry columns are joined to each frame by qpc from the rings the service publishes
+        // offline frames (from a frame store or an ETL) are not stamped with live qpc, so they have no
+        // telemetry to join
+        const bool liveStream = pShmClient && !pShmClient->GetNamedSharedMemView()->GetHeader()->from_etl_file;
+        const auto gpuDeviceId = pQuery->GetReferencedDevice();
+        const bool joinGpu = liveStream && gpuDeviceId && pComms->HasGpuTelemetry(*gpuDeviceId);
+        const bool joinCpu = liveStream && pComms->HasCpuTelemetry();
+        PresentMonPowerTelemetryInfo joinedPowerTelemetry{};
+        CpuTelemetryInfo joinedCpuTelemetry{};
 
         for (uint32_t i = 0; i < frames_to_copy; i++) {
-            const PmNsmFrameData* pCurrentFrameData = nullptr;
-            const PmNsmFrameData* pFrameDataOfLastPresented = nullptr;
-            const PmNsmFrameData* pFrameDataOfNextDisplayed = nullptr;
-            const PmNsmFrameData* pFrameDataOfLastDisplayed = nullptr;
-            const PmNsmFrameData* pPreviousFrameDataOfLastDisplayed = nullptr;
-            const auto status = pShmClient->ConsumePtrToNextNsmFrameData(&pCurrentFrameData, 
-                &pFrameDataOfNextDisplayed, &pFrameDataOfLastPresented, &pFrameDataOfLastDisplayed, &pPreviousFrameDataOfLastDisplayed);
-            if (status != PM_STATUS::PM_STATUS_SUCCESS) {
-                pmlog_error("Error while trying to get frame data from shared memory").diag();
-                throw Except<util::Exception>("Error while trying to get frame data from shared memory");
-            }
-            if (!pCurrentFrameData) {
-                break;
+            FrameStoreFrameSet frames;
+            if (pStore) {
+                if (!pStore->pReader->ReadFrameSet(pStore->nextIndex, frames)) {
+                    break;
+                }
+                pStore->nextIndex++;
+            }
+            else {
+                const auto status = pShmClient->ConsumePtrToNextNsmFrameData(&frames.frame,
+                    &frames.next_displayed, &frames.last_presented, &frames.last_displayed, &frames.previous_of_last_displayed);
+                if (status != PM_STATUS::PM_STATUS_SUCCESS) {
+                    pmlog_error("Error while trying to get frame data from shared memory").diag();
+                    throw Except<util::Exception>("Error while trying to get frame data from shared memory");
+                }
+                if (!frames.frame) {
+                    break;
+                }
             }
-            if (pFrameDataOfLastPresented && pFrameDataOfNextDisplayed) {
-                ctx.UpdateSourceData(pCurrentFrameData,
-                    pFrameDataOfNextDisplayed,
-                    pFrameDataOfLastPresented,
-                    pFrameDataOfLastDisplayed,
-                    pPreviousFrameDataOfLastDisplayed);
+            if (frames.last_presented && frames.next_displayed) {
+                ctx.UpdateSourceData(frames.frame,
+                    frames.next_displayed,
+                    frames.last_presented,
+                    frames.last_displayed,
+                    frames.previous_of_last_displayed);
+                const auto frameQpc = frames.frame->present_event.PresentStartTime;
+                if (joinGpu) {
+                    if (auto sample = pComms->GetGpuTelemetryNearest(*gpuDeviceId, frameQpc)) {
+                        joinedPowerTelemetry = *sample;
+                        ctx.pPowerTelemetry = &joinedPowerTelemetry;
+                    }
+                }
+                if (joinCpu) {
+                    if (auto sample = pComms->GetCpuTelemetryNearest(frameQpc)) {
+                        joinedCpuTelemetry = *sample;
+                        ctx.pCpuTelemetry = &joinedCpuTelemetry;
+                    }
+                }
                 pQuery->GatherToBlob(ctx, pBlob);
                 pBlob += pQuery->GetBlobSize();
                 frames_copied++;
@@ -1115,7 +1408,29 @@ void ReportMetrics(
         return;
     }
 
-    double ConcreteMiddleware::CalculateStatistic(std::vector<double>& inData, PM_STAT stat) const
+    double ConcreteMiddleware::CalculateGpuMemUtilization(const std::unordered_map<PM_METRIC, MetricInfo>& metricInfo, PM_STAT stat) const
+    {
+        double output = 0.;
+        if (cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.has_value()) {
+            auto gpuMemSize = static_cast<double>(cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.value());
+            if (gpuMemSize != 0.)
+            {
+                std::vector<double> memoryUtilization;
+                auto it = metricInfo.find(PM_METRIC_GPU_MEM_USED);
+                if (it != metricInfo.end()) {
+                    if (auto it2 = it->second.data.find(0); it2 != it->second.data.end()) {
+                        for (auto memUsed : it2->second) {
+                            memoryUtilization.push_back(100. * (memUsed / gpuMemSize));
+                        }
+                    }
+                    output = CalculateStatistic(memoryUtilization, stat);
+                }
+            }
+        }
+        return output;
+    }
+
+    double ConcreteMiddleware::CalculateStatistic(const std::vector<double>& inData, PM_STAT stat) const
     {
         if (inData.size() == 1) {
             return inData[0];
@@ -1188,8 +1503,10 @@ void ReportMetrics(
         return 0.0;
     }
 
-    // Calculate percentile using linear interpolation between the closet ranks
-    double ConcreteMiddleware::CalculatePercentile(std::vector<double>& inData, double percentile) const
+    // Calculate percentile using linear interpolation between the closet ranks.
+    // The samples are sorted in a copy: they can be shared by the queries of
+    // a window, and PM_STAT_MID_POINT depends on their order.
+    double ConcreteMiddleware::CalculatePercentile(const std::vector<double>& inData, double percentile) const
     {
         percentile = std::min(std::max(percentile, 0.), 1.);
 
@@ -1203,116 +1520,9 @@ void ReportMetrics(
             return CalculateStatistic(inData, PM_STAT_MAX);
         }
 
-        std::sort(inData.begin(), inData.end());
-        return inData[idx] + (fractpart * (inData[idx + 1] - inData[idx]));
-    }
-
-    PmNsmFrameData* ConcreteMiddleware::GetFrameDataStart(StreamClient* client, uint64_t& index, uint64_t queryMetricsDataOffset, uint64_t& queryFrameDataDelta, double& window_sample_size_in_ms)
-    {
-
-        PmNsmFrameData* frame_data = nullptr;
-        index = 0;
-        if (client == nullptr) {
-            return nullptr;
-        }
-
-        auto nsm_view = client->GetNamedSharedMemView();
-        auto nsm_hdr = nsm_view->GetHeader();
-        if (!nsm_hdr->process_active) {
-            return nullptr;
-        }
-
-        index = client->GetLatestFrameIndex();
-        frame_data = client->ReadFrameByIdx(index);
-        if (frame_data == nullptr) {
-            index = 0;
-            return nullptr;
-        }
-
-        if (queryMetricsDataOffset == 0) {
-            // Client has not specified a metric offset. Return back the most
-            // most recent frame data
-            return frame_data;
-        }
-
-        LARGE_INTEGER client_qpc = {};
-        QueryPerformanceCounter(&client_qpc);
-        uint64_t adjusted_qpc = GetAdjustedQpc(
-            client_qpc.QuadPart, frame_data->present_event.PresentStartTime,
-            queryMetricsDataOffset, client->GetQpcFrequency(), queryFrameDataDelta);
-
-        if (adjusted_qpc > frame_data->present_event.PresentStartTime) {
-            // Need to adjust the size of the window sample size
-            double ms_adjustment =
-                QpcDeltaToMs(adjusted_qpc - frame_data->present_event.PresentStartTime,
-                    client->GetQpcFrequency());
-            window_sample_size_in_ms = window_sample_size_in_ms - ms_adjustment;
-            if (window_sample_size_in_ms <= 0.0) {
-                return nullptr;
-            }
-            pmlog_dbg("Adjusting dynamic stats window due to possible excursion").pmwatch(ms_adjustment);
-        }
-        else {
-            // Find the frame with the appropriate time based on the adjusted
-            // qpc
-            for (;;) {
-
-                if (DecrementIndex(nsm_view, index) == false) {
-                    // Increment index to match up with the frame_data read below
-                    index++;
-                    break;
-                }
-                frame_data = client->ReadFrameByIdx(index);
-                if (frame_data == nullptr) {
-                    return nullptr;
-                }
-                if (adjusted_qpc >= frame_data->present_event.PresentStartTime) {
-                    break;
-                }
-            }
-        }
-
-        return frame_data;
-    }
-
-    uint64_t ConcreteMiddleware::GetAdjustedQpc(uint64_t current_qpc, uint64_t frame_data_qpc, uint64_t queryMetricsOffset, LARGE_INTEGER frequency, uint64_t& queryFrameDataDelta) {
-        // Calculate how far behind the frame data qpc is compared
-        // to the client qpc
-        uint64_t current_qpc_delta = current_qpc - frame_data_qpc;
-        if (queryFrameDataDelta == 0) {
-            queryFrameDataDelta = current_qpc_delta;
-        }
-        else {
-            if (_abs64(queryFrameDataDelta - current_qpc_delta) >
-                kClientFrameDeltaQPCThreshold) {
-                queryFrameDataDelta = current_qpc_delta;
-            }
-        }
-
-        // Add in the client set metric offset in qpc ticks
-        return current_qpc -
-            (queryFrameDataDelta + queryMetricsOffset);
-    }
-
-    bool ConcreteMiddleware::DecrementIndex(NamedSharedMem* nsm_view, uint64_t& index) {
-
-        if (nsm_view == nullptr) {
-            return false;
-        }
-
-        auto nsm_hdr = nsm_view->GetHeader();
-        if (!nsm_hdr->process_active) {
-            return false;
-        }
-
-        uint64_t current_max_entries =
-            (nsm_view->IsFull()) ? nsm_hdr->max_entries - 1 : nsm_hdr->tail_idx;
-        index = (index == 0) ? current_max_entries : index - 1;
-        if (index == nsm_hdr->head_idx) {
-            return false;
-        }
-
-        return true;
+        std::vector<double> sorted(inData);
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[idx] + (fractpart * (sorted[idx + 1] - sorted[idx]));
     }
 
     bool ConcreteMiddleware::GetGpuMetricData(size_t telemetry_item_bit, PresentMonPowerTelemetryInfo& power_telemetry_info, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
@@ -1479,31 +1689,9 @@ void ReportMetrics(
     // is encountered it will update the numSwapChains to the correct number and then copy the swap
     // chain frame information with the most presents. If the client does happen to specify two swap
     // chains this code will incorrectly copy the data. WIP.
-    void ConcreteMiddleware::CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    bool ConcreteMiddleware::CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
     {
         // Find the swapchain with the most frame metrics
-        auto CalcGpuMemUtilization = [this, metricInfo](PM_STAT stat)
-            {
-                double output = 0.;
-                if (cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.has_value()) {
-                    auto gpuMemSize = static_cast<double>(cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.value());
-                    if (gpuMemSize != 0.)
-                    {
-                        std::vector<double> memoryUtilization;
-                        auto it = metricInfo.find(PM_METRIC_GPU_MEM_USED);
-                        if (it != metricInfo.end()) {
-                            auto memUsed = it->second;
-                            auto memUsedVector = memUsed.data[0];
-                            for (auto memUsed : memUsedVector) {
-                                memoryUtilization.push_back(100. * (memUsed / gpuMemSize));
-                            }
-                            output = CalculateStatistic(memoryUtilization, stat);
-                        }
-                    }
-                }
-                return output;
-            };
-
         uint32_t maxSwapChainPresents = 0;
         uint32_t maxSwapChainPresentsIndex = 0;
         uint32_t currentSwapChainIndex = 0;
@@ -1606,7 +1794,7 @@ void ReportMetrics(
                 case PM_METRIC_GPU_MEM_UTILIZATION:
                 {
                     auto& output = reinterpret_cast<double&>(pBlob[qe.dataOffset]);
-                    output = CalcGpuMemUtilization(qe.stat);
+                    output = CalculateGpuMemUtilization(metricInfo, qe.stat);
                 }
                     break;
                 default:
@@ -1623,7 +1811,7 @@ void ReportMetrics(
 
         if (useCache == true) {
             CopyMetricCacheToBlob(pQuery, processId, pBlob);
-            return;
+            return false;
         }
 
         if (allMetricsCalculated == false)
@@ -1680,7 +1868,7 @@ void ReportMetrics(
                 case PM_METRIC_GPU_MEM_UTILIZATION:
                 {
                     auto& output = reinterpret_cast<double&>(pBlob[qe.dataOffset]);
-                    output = CalcGpuMemUtilization(qe.stat);
+                    output = CalculateGpuMemUtilization(metricInfo, qe.stat);
                 }
                 break;
                 default:
@@ -1691,6 +1879,7 @@ void ReportMetrics(
 
         // Save calculated metrics blob to cache
         SaveMetricCache(pQuery, processId, pBlob);
+        return true;
     }
 
     PM_STATUS ConcreteMiddleware::SetActiveGraphicsAdapter(uint32_t deviceId)
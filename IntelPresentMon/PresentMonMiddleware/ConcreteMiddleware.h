@@ -3,9 +3,12 @@
 #include "Middleware.h"
 #include "../Interprocess/source/Interprocess.h"
 #include "../Streamer/StreamClient.h"
+#include "../Streamer/FrameStore.h"
+#include "DynamicQueryCache.h"
 #include <optional>
 #include <string>
 #include <queue>
+#include <set>
 #include "../CommonUtilities/Hash.h"
 
 namespace pmapi::intro
@@ -54,6 +57,21 @@ namespace pmon::mid
 		std::vector<double> mAllInputToPhotonLatency;
         std::vector<double> mDropped;
 
+        // Raw qpc columns of the frames reported since the last conversion. They are converted to
+        // milliseconds in one batch per accumulation and appended to the vectors above.
+        struct {
+            std::vector<uint64_t> cpuStart;
+            std::vector<uint64_t> presentStart;
+            std::vector<uint64_t> gpuStart;
+            std::vector<uint64_t> readyTime;
+            std::vector<uint64_t> timeInPresent;
+            std::vector<uint64_t> gpuDuration;
+            std::vector<uint64_t> videoDuration;
+            // displayed frames only
+            std::vector<uint64_t> displayedCpuStart;
+            std::vector<uint64_t> screenTime;
+        } mPendingQpc;
+
 		// QPC of last received input data that did not make it to the screen due 
 		// to the Present() being dropped
 		uint64_t mLastReceivedNotDisplayedAllInputTime;
@@ -97,30 +115,39 @@ namespace pmon::mid
 		PM_STATUS SetTelemetryPollingPeriod(uint32_t deviceId, uint32_t timeMs) override;
 		PM_STATUS SetEtwFlushPeriod(std::optional<uint32_t> periodMs) override;
 		PM_DYNAMIC_QUERY* RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs) override;
-		void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) override {}
+		void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) override;
 		void PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains) override;
 		void PollStaticQuery(const PM_QUERY_ELEMENT& element, uint32_t processId, uint8_t* pBlob) override;
 		PM_FRAME_QUERY* RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize) override;
 		void FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery) override;
 		void ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames) override;
+		void GetAnalysisInstrumentation(PM_ANALYSIS_INSTRUMENTATION& instrumentation, PM_ANALYSIS_EVENT_COST* pEventCosts, uint32_t& numEventCosts) override;
 	private:
-		PmNsmFrameData* GetFrameDataStart(StreamClient* client, uint64_t& index, uint64_t dataOffset, uint64_t& queryFrameDataDelta, double& windowSampleSizeMs);
-		uint64_t GetAdjustedQpc(uint64_t current_qpc, uint64_t frame_data_qpc, uint64_t queryMetricsOffset, LARGE_INTEGER frequency, uint64_t& queryFrameDataDelta);
-		bool DecrementIndex(NamedSharedMem* nsm_view, uint64_t& index);
 		PM_STATUS SetActiveGraphicsAdapter(uint32_t deviceId);
 		void GetStaticGpuMetrics();
 
 		void CalculateFpsMetric(fpsSwapChainData& swapChain, const PM_QUERY_ELEMENT& element, uint8_t* pBlob, LARGE_INTEGER qpcFrequency);
 		void CalculateGpuCpuMetric(std::unordered_map<PM_METRIC, MetricInfo>& metricInfo, const PM_QUERY_ELEMENT& element, uint8_t* pBlob);
-		double CalculateStatistic(std::vector<double>& inData, PM_STAT stat) const;
-		double CalculatePercentile(std::vector<double>& inData, double percentile) const;
+		double CalculateStatistic(const std::vector<double>& inData, PM_STAT stat) const;
+		double CalculatePercentile(const std::vector<double>& inData, double percentile) const;
+		double CalculateGpuMemUtilization(const std::unordered_map<PM_METRIC, MetricInfo>& metricInfo, PM_STAT stat) const;
 		bool GetGpuMetricData(size_t telemetry_item_bit, PresentMonPowerTelemetryInfo& power_telemetry_info, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
 		bool GetCpuMetricData(size_t telemetryBit, CpuTelemetryInfo& cpuTelemetry, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		// accumulate samples in [qpcBegin, qpcEnd] from the service's telemetry rings
+		// returns false when no ring is available or it has no sample near the window
+		bool AccumulateGpuRingTelemetry(const PM_DYNAMIC_QUERY* pQuery, uint64_t qpcBegin, uint64_t qpcEnd, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		bool AccumulateCpuRingTelemetry(const PM_DYNAMIC_QUERY* pQuery, uint64_t qpcBegin, uint64_t qpcEnd, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		// walk the frames of a window (oldest first) gathering what pQuery accumulates
+		// ring telemetry is read over [telemetryBeginQpc, telemetryEndQpc] when joinRingTelemetry is set
+		void AccumulateWindow(const PM_DYNAMIC_QUERY* pQuery, const std::vector<const PmNsmFrameData*>& frames, uint64_t telemetryBeginQpc, uint64_t telemetryEndQpc, LARGE_INTEGER qpcFrequency, bool joinRingTelemetry,
+			std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		void CalculateTelemetryOnlyMetrics(const PM_DYNAMIC_QUERY* pQuery, LARGE_INTEGER qpcFrequency, uint8_t* pBlob);
 		void GetStaticCpuMetrics();
 		std::string GetProcessName(uint32_t processId);
 		void CopyStaticMetricData(PM_METRIC metric, uint32_t deviceId, uint8_t* pBlob, uint64_t blobOffset, size_t sizeInBytes = 0);
 
-		void CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		// returns false when no metrics could be calculated for the window and the query's cached blob was used
+		bool CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
 		void SaveMetricCache(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob);
 		void CopyMetricCacheToBlob(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob);
 
@@ -132,11 +159,31 @@ namespace pmon::mid
 		uint32_t clientProcessId = 0;
 		// Stream clients mapping to process id
 		std::map<uint32_t, std::unique_ptr<StreamClient>> presentMonStreamClients;
+		// Offline streams that the service writes to a frame store file, mapping to process id
+		struct FrameStoreStream
+		{
+			std::unique_ptr<FrameStoreReader> pReader;
+			// index of the next frame to consume in frame event queries
+			uint64_t nextIndex = 0;
+		};
+		std::map<uint32_t, FrameStoreStream> frameStoreStreams;
 		std::unique_ptr<ipc::MiddlewareComms> pComms;
 		// Dynamic query handle to frame data delta
 		std::unordered_map<std::pair<const PM_DYNAMIC_QUERY*, uint32_t>, uint64_t> queryFrameDataDeltas;
 		// Dynamic query handle to cache data
 		std::unordered_map<std::pair<const PM_DYNAMIC_QUERY*, uint32_t>, std::unique_ptr<uint8_t[]>> cachedMetricDatas;
+		// Frame data and values shared by the dynamic queries polling the same window
+		struct SharedDynamicWindow
+		{
+			// union of what the queries polling this window accumulate
+			PM_DYNAMIC_QUERY accumulation;
+			// queries that have polled this window, it is dropped when the last one is freed
+			std::set<const PM_DYNAMIC_QUERY*> queries;
+			DynamicQueryValueCache values;
+			std::unordered_map<uint64_t, fpsSwapChainData> swapChainData;
+			std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
+		};
+		std::map<DynamicQueryWindowKey, SharedDynamicWindow> sharedDynamicWindows;
 		std::vector<DeviceInfo> cachedGpuInfo;
 		std::vector<DeviceInfo> cachedCpuInfo;
 		uint32_t currentGpuInfoIndex = UINT32_MAX;
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <bitset>
+#include <optional>
 #include <map>
 #include "../PresentMonAPI2/PresentMonAPI.h"
 #include "../ControlLib/CpuTelemetryInfo.h"
@@ -0,0 +1,63 @@
+#include "DynamicQueryCache.h"
+#include <algorithm>
+
+namespace pmon::mid
+{
+	bool MergeAccumulation(PM_DYNAMIC_QUERY& window, const PM_DYNAMIC_QUERY& query)
+	{
+		const bool grew = (query.accumFpsData && !window.accumFpsData) ||
+			(query.accumGpuBits & ~window.accumGpuBits).any() ||
+			(query.accumCpuBits & ~window.accumCpuBits).any();
+		window.accumFpsData = window.accumFpsData || query.accumFpsData;
+		window.accumGpuBits |= query.accumGpuBits;
+		window.accumCpuBits |= query.accumCpuBits;
+		window.cachedGpuInfoIndex = query.cachedGpuInfoIndex;
+		return grew;
+	}
+
+	bool DynamicQueryValueCache::StartBatch(const DynamicQueryBatch& batch)
+	{
+		if (batch_ == batch) {
+			return false;
+		}
+		batch_ = batch;
+		values_.clear();
+		return true;
+	}
+
+	void DynamicQueryValueCache::Invalidate()
+	{
+		batch_.reset();
+		values_.clear();
+	}
+
+	bool DynamicQueryValueCache::Assemble(const PM_DYNAMIC_QUERY& query, uint8_t* pBlob) const
+	{
+		std::vector<const std::vector<uint8_t>*> found;
+		found.reserve(query.elements.size());
+		for (auto& qe : query.elements) {
+			auto i = values_.find(MakeKey_(qe));
+			if (i == values_.end() || i->second.size() != qe.dataSize) {
+				return false;
+			}
+			found.push_back(&i->second);
+		}
+		for (size_t i = 0; i < found.size(); i++) {
+			std::ranges::copy(*found[i], pBlob + query.elements[i].dataOffset);
+		}
+		return true;
+	}
+
+	void DynamicQueryValueCache::Store(const PM_DYNAMIC_QUERY& query, const uint8_t* pBlob)
+	{
+		for (auto& qe : query.elements) {
+			const auto pValue = pBlob + qe.dataOffset;
+			values_.insert_or_assign(MakeKey_(qe), std::vector<uint8_t>(pValue, pValue + qe.dataSize));
+		}
+	}
+
+	DynamicQueryValueCache::ElementKey_ DynamicQueryValueCache::MakeKey_(const PM_QUERY_ELEMENT& element)
+	{
+		return { element.metric, element.stat, element.deviceId, element.arrayIndex };
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "DynamicQuery.h"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace pmon::mid
+{
+	// dynamic queries that poll the same process with the same window and offset share the
+	// frame walk and the statistics computed from it
+	struct DynamicQueryWindowKey
+	{
+		uint32_t processId = 0;
+		double windowSizeMs = 0.;
+		double metricOffsetMs = 0.;
+		// gpu the window's telemetry is accumulated for (UINT32_MAX when there is none)
+		uint32_t gpuInfoIndex = UINT32_MAX;
+		auto operator<=>(const DynamicQueryWindowKey&) const = default;
+	};
+
+	// identifies the frames and telemetry a window was computed from; a new batch arrives when any of these change
+	struct DynamicQueryBatch
+	{
+		uint64_t beginQpc = 0;
+		uint64_t firstFrameQpc = 0;
+		uint64_t lastFrameQpc = 0;
+		size_t frameCount = 0;
+		// end of the ring telemetry window (0 when the stream has no live telemetry)
+		uint64_t telemetryEndQpc = 0;
+		bool operator==(const DynamicQueryBatch&) const = default;
+	};
+
+	// adds what query accumulates to what the shared window accumulates
+	// returns true if the window now needs data it did not gather before
+	bool MergeAccumulation(PM_DYNAMIC_QUERY& window, const PM_DYNAMIC_QUERY& query);
+
+	// values computed for query elements over one batch of a shared window
+	// elements are keyed by what they compute (metric, stat, device, array index) rather than by the query
+	// that asked for them, so the blob of any query over the window can be assembled by copying values
+	// into the query's own offsets
+	class DynamicQueryValueCache
+	{
+	public:
+		// drops all values and returns true when batch differs from the one values were computed for
+		bool StartBatch(const DynamicQueryBatch& batch);
+		// drops all values, the next StartBatch will report a new batch
+		void Invalidate();
+		// copies the values of all elements of query to their offsets in pBlob
+		// returns false and leaves pBlob untouched if any element has not been computed for this batch
+		bool Assemble(const PM_DYNAMIC_QUERY& query, uint8_t* pBlob) const;
+		// records the values of all elements of query from a blob calculated for this batch
+		void Store(const PM_DYNAMIC_QUERY& query, const uint8_t* pBlob);
+		size_t GetValueCount() const { return values_.size(); }
+	private:
+		using ElementKey_ = std::tuple<PM_METRIC, PM_STAT, uint32_t, uint32_t>;
+		static ElementKey_ MakeKey_(const PM_QUERY_ELEMENT& element);
+		std::optional<DynamicQueryBatch> batch_;
+		std::map<ElementKey_, std::vector<uint8_t>> values_;
+	};
+}
@@ -0,0 +1,120 @@
+#include "DynamicQueryWindow.h"
+#include "../PresentMonUtils/QPCUtils.h"
+#include "../CommonUtilities/log/Log.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace pmon::mid
+{
+	namespace
+	{
+		const uint64_t kClientFrameDeltaQPCThreshold = 50000000;
+
+		uint64_t GetAdjustedQpc(uint64_t current_qpc, uint64_t frame_data_qpc, uint64_t queryMetricsOffset, uint64_t& queryFrameDataDelta)
+		{
+			// Calculate how far behind the frame data qpc is compared
+			// to the client qpc
+			uint64_t current_qpc_delta = current_qpc - frame_data_qpc;
+			if (queryFrameDataDelta == 0) {
+				queryFrameDataDelta = current_qpc_delta;
+			}
+			else {
+				if (_abs64(queryFrameDataDelta - current_qpc_delta) >
+					kClientFrameDeltaQPCThreshold) {
+					queryFrameDataDelta = current_qpc_delta;
+				}
+			}
+
+			// Add in the client set metric offset in qpc ticks
+			return current_qpc -
+				(queryFrameDataDelta + queryMetricsOffset);
+		}
+
+		PmNsmFrameData* GetFrameDataStart(StreamClient& client, const NsmRingView& ringView, uint64_t& position, uint64_t queryMetricsDataOffset, uint64_t& queryFrameDataDelta, double& window_sample_size_in_ms)
+		{
+			position = 0;
+			if (ringView.IsEmpty()) {
+				return nullptr;
+			}
+
+			position = ringView.count - 1;
+			PmNsmFrameData* frame_data = &ringView.At(position);
+
+			if (queryMetricsDataOffset == 0) {
+				// Client has not specified a metric offset. Return back the most
+				// most recent frame data
+				return frame_data;
+			}
+
+			LARGE_INTEGER client_qpc = {};
+			QueryPerformanceCounter(&client_qpc);
+			uint64_t adjusted_qpc = GetAdjustedQpc(
+				client_qpc.QuadPart, frame_data->present_event.PresentStartTime,
+				queryMetricsDataOffset, queryFrameDataDelta);
+
+			if (adjusted_qpc > frame_data->present_event.PresentStartTime) {
+				// Need to adjust the size of the window sample size
+				double ms_adjustment =
+					QpcDeltaToMs(adjusted_qpc - frame_data->present_event.PresentStartTime,
+						client.GetQpcFrequency());
+				window_sample_size_in_ms = window_sample_size_in_ms - ms_adjustment;
+				if (window_sample_size_in_ms <= 0.0) {
+					return nullptr;
+				}
+				pmlog_dbg("Adjusting dynamic stats window due to possible excursion").pmwatch(ms_adjustment);
+			}
+			else {
+				// Find the most recent frame at or before the adjusted qpc, falling back
+				// to the oldest frame when the offset reaches past the start of the ring
+				const auto after = ringView.UpperBound(adjusted_qpc);
+				position = after > 0 ? after - 1 : 0;
+				frame_data = &ringView.At(position);
+			}
+
+			return frame_data;
+		}
+	}
+
+	bool SelectDynamicQueryWindow(StreamClient& client, double windowSizeMs, double metricOffsetMs,
+		uint64_t& queryFrameDataDelta, DynamicQueryFrameWindow& window)
+	{
+		window.frames.clear();
+		const auto ringView = client.GetRingView();
+		uint64_t position = 0;
+		double adjusted_window_size_in_ms = windowSizeMs;
+		PmNsmFrameData* frame_data = GetFrameDataStart(client, ringView, position,
+			SecondsDeltaToQpc(metricOffsetMs / 1000., client.GetQpcFrequency()), queryFrameDataDelta, adjusted_window_size_in_ms);
+		if (frame_data == nullptr) {
+			return false;
+		}
+
+		// Calculate the end qpc based on the current frame's qpc and
+		// requested window size coverted to a qpc, then binary search the ring
+		// for the oldest frame that falls in the window. The window end frame is
+		// always included, and the window is cut short if we run out of data.
+		window.beginQpc =
+			frame_data->present_event.PresentStartTime -
+			SecondsDeltaToQpc(adjusted_window_size_in_ms / 1000., client.GetQpcFrequency());
+		const auto firstPosition = std::min(ringView.UpperBound(window.beginQpc), position);
+		window.frames.reserve(size_t(position + 1 - firstPosition));
+		for (auto span : ringView.GetSpans(firstPosition, position + 1)) {
+			for (auto& frame : span) {
+				window.frames.push_back(&frame);
+			}
+		}
+		return true;
+	}
+
+	DynamicQueryTelemetryWindow SelectLiveTelemetryWindow(double windowSizeMs, double metricOffsetMs,
+		LARGE_INTEGER qpcFrequency, uint64_t newestFrameQpc)
+	{
+		LARGE_INTEGER nowQpc = {};
+		QueryPerformanceCounter(&nowQpc);
+		const auto offsetQpc = SecondsDeltaToQpc(metricOffsetMs / 1000., qpcFrequency);
+		const auto msQpc = std::max(uint64_t(qpcFrequency.QuadPart / 1000), uint64_t(1));
+		auto endQpc = uint64_t(nowQpc.QuadPart) > offsetQpc ? uint64_t(nowQpc.QuadPart) - offsetQpc : 0;
+		endQpc = std::max(endQpc - endQpc % msQpc, newestFrameQpc);
+		const auto windowQpc = SecondsDeltaToQpc(windowSizeMs / 1000., qpcFrequency);
+		return { endQpc > windowQpc ? endQpc - windowQpc : 0, endQpc };
+	}
+}
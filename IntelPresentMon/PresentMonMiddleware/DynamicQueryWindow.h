@@ -0,0 +1,38 @@
+#pragma once
+#include "../CommonUtilities/win/WinAPI.h"
+#include "../Streamer/StreamClient.h"
+#include <cstdint>
+#include <vector>
+
+namespace pmon::mid
+{
+	// frames of a dynamic query window read from a stream's NSM ring, oldest first
+	struct DynamicQueryFrameWindow
+	{
+		std::vector<const PmNsmFrameData*> frames;
+		// qpc the window reaches back to, the frames were presented after it
+		uint64_t beginQpc = 0;
+	};
+
+	// qpc range that ring telemetry is read over for a dynamic query window of a live stream
+	struct DynamicQueryTelemetryWindow
+	{
+		uint64_t beginQpc = 0;
+		uint64_t endQpc = 0;
+	};
+
+	// selects the frames of the windowSizeMs window that ends metricOffsetMs before the newest frame
+	// of the stream; the window end frame is always included, and the window is cut short if the ring
+	// runs out of frames. queryFrameDataDelta carries the delta between the client's qpc and the
+	// stream's from one poll of a query to the next.
+	// returns false when there are no frames for the window
+	bool SelectDynamicQueryWindow(StreamClient& client, double windowSizeMs, double metricOffsetMs,
+		uint64_t& queryFrameDataDelta, DynamicQueryFrameWindow& window);
+
+	// selects the telemetry window of a live stream; the rings keep being written while the target isn't
+	// presenting, so the window ends metricOffsetMs before now (or at newestFrameQpc when that is later)
+	// rather than at the newest frame. the end is snapped down to a whole millisecond so that queries
+	// polled back to back select the same window
+	DynamicQueryTelemetryWindow SelectLiveTelemetryWindow(double windowSizeMs, double metricOffsetMs,
+		LARGE_INTEGER qpcFrequency, uint64_t newestFrameQpc = 0);
+}
@@ -8,6 +8,7 @@
 #include "../CommonUtilities/Meta.h"
 #include "../CommonUtilities/log/Log.h"
 #include "../CommonUtilities/Exception.h"
+#include "../CommonUtilities/Qpc.h"
 #include <algorithm>
 #include <cstddef>
 #include <limits>
@@ -33,36 +34,18 @@ namespace pmon::mid
 
 namespace
 {
-	double TimestampDeltaToMilliSeconds(uint64_t timestampDelta, double performanceCounterPeriodMs)
-	{
-		return performanceCounterPeriodMs * double(timestampDelta);
-	}
-
-	double TimestampDeltaToUnsignedMilliSeconds(uint64_t timestampFrom, uint64_t timestampTo, double performanceCounterPeriodMs)
-	{
-		return timestampFrom == 0 || timestampTo <= timestampFrom ? 0.0 : 
-			TimestampDeltaToMilliSeconds(timestampTo - timestampFrom, performanceCounterPeriodMs);
-	}
-
-	double TimestampDeltaToMilliSeconds(uint64_t timestampFrom, uint64_t timestampTo, double performanceCounterPeriodMs)
-	{
-		return timestampFrom == 0 || timestampTo == 0 || timestampFrom == timestampTo ? 0.0 :
-			timestampTo > timestampFrom ? TimestampDeltaToMilliSeconds(timestampTo - timestampFrom, performanceCounterPeriodMs)
-			: -TimestampDeltaToMilliSeconds(timestampFrom - timestampTo, performanceCounterPeriodMs);
-	}
-
 	template<auto pMember>
-	constexpr auto GetSubstructurePointer()
+	const auto& GetSubstructure(const Context& ctx)
 	{
 		using SubstructureType = util::MemberPointerInfo<decltype(pMember)>::StructType;
 		if constexpr (std::same_as<SubstructureType, PmNsmPresentEvent>) {
-			return &PmNsmFrameData::present_event;
+			return ctx.pSourceFrameData->present_event;
 		}
 		else if constexpr (std::same_as<SubstructureType, PresentMonPowerTelemetryInfo>) {
-			return &PmNsmFrameData::power_telemetry;
+			return *ctx.pPowerTelemetry;
 		}
 		else if constexpr (std::same_as<SubstructureType, CpuTelemetryInfo>) {
-			return &PmNsmFrameData::cpu_telemetry;
+			return *ctx.pCpuTelemetry;
 		}
 	}
 
@@ -80,20 +63,20 @@ namespace
 		}
 		void Gather(Context& ctx, uint8_t* pDestBlob) const override
 		{
-			constexpr auto pSubstruct = GetSubstructurePointer<pMember>();
+			const auto& substruct = GetSubstructure<pMember>(ctx);
 			if constexpr (std::is_array_v<Type>) {
 				if constexpr (std::is_same_v<std::remove_extent_t<Type>, char>) {
-					const auto val = (ctx.pSourceFrameData->*pSubstruct.*pMember)[inputIndex_];
+					const auto val = (substruct.*pMember)[inputIndex_];
 					// TODO: only getting first character of application name. Hmmm.
 					strcpy_s(reinterpret_cast<char*>(&pDestBlob[outputOffset_]), 260, &val);
 				}
 				else {
-					const auto val = (ctx.pSourceFrameData->*pSubstruct.*pMember)[inputIndex_];
+					const auto val = (substruct.*pMember)[inputIndex_];
 					reinterpret_cast<std::remove_const_t<decltype(val)>&>(pDestBlob[outputOffset_]) = val;
 				}
 			}
 			else {
-				const auto val = ctx.pSourceFrameData->*pSubstruct.*pMember;
+				const auto val = substruct.*pMember;
 				reinterpret_cast<std::remove_const_t<decltype(val)>&>(pDestBlob[outputOffset_]) = val;
 			}
 		}
@@ -126,13 +109,8 @@ namespace
 		void Gather(Context& ctx, uint8_t* pDestBlob) const override
 		{
 			const auto qpcDuration = ctx.pSourceFrameData->present_event.*pMember;
-			if (qpcDuration != 0) {
-				const auto val = ctx.performanceCounterPeriodMs * double(qpcDuration);
-				reinterpret_cast<double&>(pDestBlob[outputOffset_]) = val;
-			}
-			else {
-				reinterpret_cast<double&>(pDestBlob[outputOffset_]) = 0.;
-			}
+			reinterpret_cast<double&>(pDestBlob[outputOffset_]) =
+				TimestampDeltaToMilliSeconds(qpcDuration, ctx.performanceCounterPeriodMs);
 		}
 		uint32_t GetBeginOffset() const override
 		{
@@ -728,7 +706,12 @@ void PM_FRAME_QUERY::Context::UpdateSourceData(const PmNsmFrameData* pSourceFram
 										       const PmNsmFrameData* pFrameDataOfLastDisplayed,
 										       const PmNsmFrameData* pPreviousFrameDataOfLastDisplayed)
 {
+	// telemetry is not part of the frame record, columns read zeros until a sample is joined to the frame
+	static const PresentMonPowerTelemetryInfo noPowerTelemetry{};
+	static const CpuTelemetryInfo noCpuTelemetry{};
 	pSourceFrameData = pSourceFrameData_in;
+	pPowerTelemetry = &noPowerTelemetry;
+	pCpuTelemetry = &noCpuTelemetry;
 	dropped = pSourceFrameData->present_event.FinalState != PresentResult::Presented;
 	if (dropped) {
 		if (pSourceFrameData->present_event.MouseClickTime != 0) {
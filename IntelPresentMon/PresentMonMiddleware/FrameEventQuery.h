@@ -31,6 +31,10 @@ public:
 			const PmNsmFrameData* pPreviousFrameDataOfLastDisplayed);
 		// data
 		const PmNsmFrameData* pSourceFrameData = nullptr;
+		// telemetry for the source frame, joined from the telemetry rings by qpc by the middleware
+		// (zeroed samples when there is nothing to join)
+		const PresentMonPowerTelemetryInfo* pPowerTelemetry = nullptr;
+		const CpuTelemetryInfo* pCpuTelemetry = nullptr;
 		const double performanceCounterPeriodMs{};
 		const uint64_t qpcStart{};
 		bool dropped{};
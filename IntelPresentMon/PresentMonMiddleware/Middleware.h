@@ -1,5 +1,6 @@
 #pragma once
 #include "../PresentMonAPI2/PresentMonAPI.h"
+#include "../PresentMonAPI2/PresentMonDiagnostics.h"
 #include <span>
 #include <optional>
 
@@ -24,5 +25,10 @@ namespace pmon::mid
 		virtual PM_FRAME_QUERY* RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize) { return nullptr; }
 		virtual void FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery) {}
 		virtual void ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames) {}
+		virtual void GetAnalysisInstrumentation(PM_ANALYSIS_INSTRUMENTATION& instrumentation, PM_ANALYSIS_EVENT_COST* pEventCosts, uint32_t& numEventCosts)
+		{
+			instrumentation = {};
+			numEventCosts = 0;
+		}
 	};
 }
\ No newline at end of file
@@ -26,6 +26,17 @@ namespace pmon::mid
 	using namespace std::string_literals;
 	using namespace pmapi;
 
+	namespace
+	{
+		// frames do not carry telemetry, so mock frame events keep the telemetry joined to them alongside
+		struct MockFrameEvent_
+		{
+			PmNsmFrameData frame;
+			PresentMonPowerTelemetryInfo powerTelemetry;
+			CpuTelemetryInfo cpuTelemetry;
+		};
+	}
+
 	MockMiddleware::MockMiddleware(bool useLocalShmServer)
 	{
 		if (useLocalShmServer) {
@@ -134,34 +145,38 @@ namespace pmon::mid
 	PM_FRAME_QUERY* MockMiddleware::RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize)
 	{
 		if (!pendingFrameEvents.has_value()) {
-			pendingFrameEvents = std::make_any<std::deque<PmNsmFrameData>>(std::deque<PmNsmFrameData>{
-				PmNsmFrameData{
-					.present_event = {
-						.PresentStartTime = 69420ull,
-						.Runtime = Runtime::DXGI,
-						.PresentMode = PresentMode::Composed_Flip,
+			pendingFrameEvents = std::make_any<std::deque<MockFrameEvent_>>(std::deque<MockFrameEvent_>{
+				MockFrameEvent_{
+					.frame = {
+						.present_event = {
+							.PresentStartTime = 69420ull,
+							.Runtime = Runtime::DXGI,
+							.PresentMode = PresentMode::Composed_Flip,
+						},
 					},
-					.power_telemetry = {
+					.powerTelemetry = {
 						.gpu_power_w = 420.,
 						.fan_speed_rpm = { 1.1, 2.2, 3.3, 4.4, 5.5 },
 						.gpu_temperature_limited = true,
 					},
-					.cpu_telemetry = {
+					.cpuTelemetry = {
 						.cpu_utilization = 30.,
 					},
 				},
-				PmNsmFrameData{
-					.present_event = {
-						.PresentStartTime = 69920ull,
-						.Runtime = Runtime::DXGI,
-						.PresentMode = PresentMode::Composed_Flip,
+				MockFrameEvent_{
+					.frame = {
+						.present_event = {
+							.PresentStartTime = 69920ull,
+							.Runtime = Runtime::DXGI,
+							.PresentMode = PresentMode::Composed_Flip,
+						},
 					},
-					.power_telemetry = {
+					.powerTelemetry = {
 						.gpu_power_w = 400.,
 						.fan_speed_rpm = { 1.0, 2.0, 3.0, 4.0, 5.0 },
 						.gpu_temperature_limited = false,
 					},
-					.cpu_telemetry = {
+					.cpuTelemetry = {
 						.cpu_utilization = 27.,
 					},
 				},
@@ -179,20 +194,22 @@ namespace pmon::mid
 
 	void MockMiddleware::ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames)
 	{
-		auto& frames = std::any_cast<std::deque<PmNsmFrameData>&>(pendingFrameEvents);
+		auto& frames = std::any_cast<std::deque<MockFrameEvent_>&>(pendingFrameEvents);
 		if (t > 0) {
-			frames.push_back(PmNsmFrameData{
-				.present_event = {
-					.PresentStartTime = 77000ull,
-					.Runtime = Runtime::DXGI,
-					.PresentMode = PresentMode::Hardware_Independent_Flip,
+			frames.push_back(MockFrameEvent_{
+				.frame = {
+					.present_event = {
+						.PresentStartTime = 77000ull,
+						.Runtime = Runtime::DXGI,
+						.PresentMode = PresentMode::Hardware_Independent_Flip,
+					},
 				},
-				.power_telemetry = {
+				.powerTelemetry = {
 					.gpu_power_w = 490.,
 					.fan_speed_rpm = { 1.8, 2.8, 3.8, 4.8, 5.8 },
 					.gpu_temperature_limited = false,
 				},
-				.cpu_telemetry = {
+				.cpuTelemetry = {
 					.cpu_utilization = 50.,
 				},
 			});
@@ -202,7 +219,9 @@ namespace pmon::mid
 		PM_FRAME_QUERY::Context ctx{ 0ull, 0ll };
 		for (uint32_t i = 0; i < numFramesToProcess; i++) {
 			// TODO: feed actual prev/next frames into this function
-			ctx.UpdateSourceData(&frames.front(), nullptr, nullptr, nullptr, nullptr);
+			ctx.UpdateSourceData(&frames.front().frame, nullptr, nullptr, nullptr, nullptr);
+			ctx.pPowerTelemetry = &frames.front().powerTelemetry;
+			ctx.pCpuTelemetry = &frames.front().cpuTelemetry;
 			pQuery->GatherToBlob(ctx, pBlob);
 			frames.pop_front();
 			pBlob += blobSize;
@@ -1,5 +1,6 @@
 #pragma once 
 #include "acts/EnumerateAdapters.h" 
+#include "acts/GetAnalysisInstrumentation.h" 
 #include "acts/GetStaticCpuMetrics.h" 
 #include "acts/OpenSession.h" 
 #include "acts/SelectAdapter.h" 
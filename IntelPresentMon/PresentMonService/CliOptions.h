@@ -22,6 +22,7 @@ namespace clio
 		Flag debug{ this, "--debug,-d", "Stall service by running in a loop after startup waiting for debugger to connect" };
 		Option<long long> timedStop{ this, "--timed-stop", -1, "Signal stop event after specified number of milliseconds" };
 		Option<std::string> etlTestFile{ this, "--etl-test-file", "", "Etl test file including necessary path" };
+		Option<std::string> etlFrameStoreDir{ this, "--etl-frame-store-dir", "", "Write frames of the etl test file to memory-mapped frame store files in this directory instead of streaming them through shared memory" };
 
 	private: Group gl_{ this, "Logging", "Control logging behavior" }; public:
 		Option<std::string> logDir{ this, "--log-dir", "", "Enable logging to a file in the specified directory" };
@@ -215,7 +215,8 @@ void MockPresentMonSession::AddPresents(
             continue;
         }
 
-        PresentMonPowerTelemetryInfo power_telemetry = {};
+        // telemetry itself is published to the introspection rings at the polling rate, frames
+        // only carry which telemetry is available
         std::bitset<static_cast<size_t>(GpuTelemetryCapBits::gpu_telemetry_count)>
             gpu_telemetry_cap_bits = {};
         if (telemetry_container_) {
@@ -224,22 +225,14 @@ void MockPresentMonSession::AddPresents(
                 current_telemetry_adapter_id_ < current_adapters.size()) {
                 auto current_telemetry_adapter =
                     current_adapters.at(current_telemetry_adapter_id_).get();
-                if (auto data = current_telemetry_adapter->GetClosest(
-                    presentEvent->PresentStartTime)) {
-                    power_telemetry = *data;
-                }
                 gpu_telemetry_cap_bits = current_telemetry_adapter
                     ->GetPowerTelemetryCapBits();
             }
         }
 
-        CpuTelemetryInfo cpu_telemetry = {};
         std::bitset<static_cast<size_t>(CpuTelemetryCapBits::cpu_telemetry_count)>
             cpu_telemetry_cap_bits = {};
         if (cpu_) {
-            if (auto data = cpu_->GetClosest(presentEvent->PresentStartTime)) {
-                cpu_telemetry = *data;
-            }
             cpu_telemetry_cap_bits = cpu_->GetCpuTelemetryCapBits();
         }
 
@@ -256,8 +249,7 @@ void MockPresentMonSession::AddPresents(
         // Remove for public build
         // Send data to streamer if we have more than single present event
         streamer_.ProcessPresentEvent(
-            presentEvent.get(), &power_telemetry, &cpu_telemetry,
-            chain->mLastPresentQPC, chain->mLastDisplayedPresentQPC,
+            presentEvent.get(), chain->mLastPresentQPC, chain->mLastDisplayedPresentQPC,
             processInfo->mModuleName, gpu_telemetry_cap_bits,
             cpu_telemetry_cap_bits);
 
@@ -12,9 +12,13 @@
 #include "CliOptions.h"
 #include "GlobalIdentifiers.h"
 #include <ranges>
+#include <optional>
+#include <limits>
 #include "../CommonUtilities/IntervalWaiter.h"
+#include "../CommonUtilities/Qpc.h"
 #include "../CommonUtilities/PrecisionWaiter.h"
 #include "../CommonUtilities/win/Event.h"
+#include "../CommonUtilities/mt/PollScheduler.h"
 
 #include "../CommonUtilities/log/GlogShim.h"
 
@@ -71,6 +75,13 @@ void EventFlushThreadEntry_(Service* const srv, PresentMon* const pm)
     }
 }
 
+// telemetry polling period in qpc ticks, published to the rings so that clients can tell
+// whether the nearest sample to a frame is recent enough to represent it
+uint64_t TelemetryPeriodToQpc_(uint32_t periodMs)
+{
+    return uint64_t(double(periodMs) / 1000. / GetTimestampPeriodSeconds());
+}
+
 void PowerTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
 	PowerTelemetryContainer* const ptc, ipc::ServiceComms* const pComms)
 {
@@ -79,6 +90,35 @@ void PowerTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
 		return;
 	}
 
+    // introspection devices registered at first population; adapters are matched to these by
+    // vendor and name whenever the container is repopulated, since a reset can reorder, add or
+    // remove adapters
+    struct RegisteredGpu_
+    {
+        PM_DEVICE_VENDOR vendor;
+        std::string name;
+        uint32_t deviceId;
+    };
+    std::vector<RegisteredGpu_> registeredGpus;
+    // introspection device id of each current adapter, in adapter order
+    std::vector<std::optional<uint32_t>> gpuDeviceIds;
+    const auto mapDeviceIds = [ptc, &registeredGpus, &gpuDeviceIds] {
+        gpuDeviceIds.clear();
+        std::vector<bool> used(registeredGpus.size());
+        for (auto& adapter : ptc->GetPowerTelemetryAdapters()) {
+            std::optional<uint32_t> deviceId;
+            for (size_t i = 0; i < registeredGpus.size(); i++) {
+                if (!used[i] && registeredGpus[i].vendor == adapter->GetVendor() &&
+                    registeredGpus[i].name == adapter->GetName()) {
+                    used[i] = true;
+                    deviceId = registeredGpus[i].deviceId;
+                    break;
+                }
+            }
+            gpuDeviceIds.push_back(deviceId);
+        }
+    };
+
     // we first wait for a client control connection before populating telemetry container
     // after populating, we sample each adapter to gather availability information
     // this is deferred until client connection in order to increase the probability that
@@ -100,20 +140,52 @@ void PowerTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
             // sample 2x here as workaround/kludge because Intel provider misreports 1st sample
             adapter->Sample();
             adapter->Sample();
-            pComms->RegisterGpuDevice(adapter->GetVendor(), adapter->GetName(), adapter->GetPowerTelemetryCapBits());
+            registeredGpus.push_back({ adapter->GetVendor(), adapter->GetName(),
+                pComms->RegisterGpuDevice(adapter->GetVendor(), adapter->GetName(), adapter->GetPowerTelemetryCapBits()) });
         }
         pComms->FinalizeGpuDevices();
+        mapDeviceIds();
         pmlog_info(std::format("Finished populating GPU telemetry introspection, {} seconds elapsed", timer.Mark()));
     }
 
 	// only start periodic polling when streaming starts
     // exit polling loop and this thread when service is stopping
     {
-        IntervalWaiter waiter{ 0.016 };
         const HANDLE events[]{
           pm->GetStreamingStartHandle(),
           srv->GetServiceStopHandle(),
         };
+        // each adapter is sampled on its own cadence by the scheduler's worker pool so that
+        // a slow vendor call on one adapter does not delay or skew the others
+        // each new sample is also published to the device's telemetry ring in shared memory so
+        // that clients can query telemetry independently of the target's present events
+        const auto makeScheduler = [ptc, pComms, &gpuDeviceIds](std::chrono::milliseconds period) {
+            auto& adapters = ptc->GetPowerTelemetryAdapters();
+            auto pScheduler = std::make_unique<mt::PollScheduler>(adapters.size());
+            for (size_t i = 0; i < adapters.size(); i++) {
+                auto pAdapter = adapters[i];
+                // adapters that match no registered device (e.g. appeared after a reset) are sampled
+                // but have no introspection device to publish under
+                const auto deviceId = gpuDeviceIds[i];
+                pScheduler->AddSource([pAdapter, pComms, deviceId] {
+                    if (pAdapter->Sample() && deviceId) {
+                        if (auto sample = pAdapter->GetClosest(std::numeric_limits<uint64_t>::max())) {
+                            pComms->PushGpuTelemetry(*deviceId, *sample);
+                        }
+                    }
+                }, period);
+            }
+            return pScheduler;
+        };
+        const auto logStats = [ptc](const mt::PollScheduler& scheduler) {
+            auto& adapters = ptc->GetPowerTelemetryAdapters();
+            for (uint32_t i = 0; i < scheduler.GetSourceCount() && i < adapters.size(); i++) {
+                const auto stats = scheduler.GetStats(i);
+                pmlog_dbg(std::format("Telemetry polling [{}]: samples={} overruns={} jitter mean={:.3f}ms max={:.3f}ms sample mean={:.3f}ms max={:.3f}ms",
+                    adapters[i]->GetName(), stats.sampleCount, stats.overrunCount, stats.meanJitterMs,
+                    stats.maxJitterMs, stats.meanDurationMs, stats.maxDurationMs));
+            }
+        };
         while (1) {
             auto waitResult = WaitForMultipleObjects((DWORD)std::size(events), events, FALSE, INFINITE);
             // TODO: check for wait result error
@@ -121,32 +193,41 @@ void PowerTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
             if ((waitResult - WAIT_OBJECT_0) == 1) {
                 return;
             }
-            // otherwise we assume streaming has started and we begin the polling loop
-            while (WaitForSingleObject(srv->GetServiceStopHandle(), 0) != WAIT_OBJECT_0) {
+            // otherwise we assume streaming has started and we begin polling
+            auto period = std::chrono::milliseconds{ pm->GetGpuTelemetryPeriod() };
+            pComms->SetTelemetryPeriod(TelemetryPeriodToQpc_(uint32_t(period.count())));
+            auto pScheduler = makeScheduler(period);
+            // supervise the scheduler: apply period changes, repopulate on reset, and go dormant when idle
+            while (!win::WaitAnyEventFor(50ms, srv->GetServiceStopHandle())) {
                 // if device was reset (driver installed etc.) we need to repopulate telemetry
                 if (WaitForSingleObject(srv->GetResetPowerTelemetryHandle(), 0) == WAIT_OBJECT_0) {
+                    // stop sampling old adapters before they are replaced
+                    pScheduler.reset();
                     // TODO: log error here or inside of repopulate
                     ptc->Repopulate();
+                    mapDeviceIds();
+                    pScheduler = makeScheduler(period);
                 }
-                for (auto& adapter : ptc->GetPowerTelemetryAdapters()) {
-                    adapter->Sample();
+                if (const auto newPeriod = std::chrono::milliseconds{ pm->GetGpuTelemetryPeriod() }; newPeriod != period) {
+                    period = newPeriod;
+                    pComms->SetTelemetryPeriod(TelemetryPeriodToQpc_(uint32_t(period.count())));
+                    for (uint32_t i = 0; i < pScheduler->GetSourceCount(); i++) {
+                        pScheduler->SetPeriod(i, period);
+                    }
                 }
-                // Convert from the ms to seconds as GetTelemetryPeriod returns back
-                // ms and SetInterval expects seconds.
-                waiter.SetInterval(pm->GetGpuTelemetryPeriod()/1000.);
-                waiter.Wait();
                 // go dormant if there are no active streams left
                 // TODO: consider race condition here if client stops and starts streams rapidly
                 if (pm->GetActiveStreams() == 0) {
                     break;
                 }
             }
+            logStats(*pScheduler);
         }
     }
 }
 
 void CpuTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
-	pwr::cpu::CpuTelemetry* const cpu)
+	pwr::cpu::CpuTelemetry* const cpu, ipc::ServiceComms* const pComms)
 {
     IntervalWaiter waiter{ 0.016 };
 	if (srv == nullptr || pm == nullptr) {
@@ -166,7 +247,12 @@ void CpuTelemetryThreadEntry_(Service* const srv, PresentMon* const pm,
 			return;
 		}
 		while (WaitForSingleObject(srv->GetServiceStopHandle(), 0) != WAIT_OBJECT_0) {
-			cpu->Sample();
+			if (cpu->Sample()) {
+                // newest sample is published for clients that join telemetry to frames at query time
+                if (auto sample = cpu->GetClosest(std::numeric_limits<uint64_t>::max())) {
+                    pComms->PushCpuTelemetry(*sample);
+                }
+            }
             // Convert from the ms to seconds as GetTelemetryPeriod returns back
             // ms and SetInterval expects seconds.
             waiter.SetInterval(pm->GetGpuTelemetryPeriod() / 1000.);
@@ -270,7 +356,7 @@ void PresentMonMainThread(Service* const pSvc)
         }
 
         if (cpu) {
-            cpuTelemetryThread = std::jthread{ CpuTelemetryThreadEntry_, pSvc, &pm, cpu.get() };
+            cpuTelemetryThread = std::jthread{ CpuTelemetryThreadEntry_, pSvc, &pm, cpu.get(), pComms.get() };
             pm.SetCpu(cpu);
             // sample once to populate the cap bits
             cpu->Sample();
@@ -23,6 +23,12 @@ class PresentMon {
                            uint32_t target_process_id,
                            std::string& nsm_file_name);
   void StopStreaming(uint32_t client_process_id, uint32_t target_process_id);
+  // Path of the frame store backing an etl stream, empty when frames are
+  // streamed through the NSM
+  std::string GetFrameStorePath(uint32_t target_process_id) {
+    // Only the etl session writes frame stores
+    return mock_session_.streamer_.GetFrameStorePath(target_process_id);
+  }
 
   std::vector<std::shared_ptr<pwr::PowerTelemetryAdapter>> EnumerateAdapters();
   std::string GetCpuName() { return real_time_session_.GetCpuName(); }
@@ -170,6 +170,11 @@ PM_STATUS RealtimePresentMonSession::StartTraceSession() {
         }
     }
 
+    // Evict tracking state that hasn't been used for 60 seconds, e.g. because its stop event was
+    // lost, so that state doesn't accumulate over the service's lifetime.
+    pm_consumer_->mTrackingStateTimeLimit = trace_session_.mTimestampFrequency.QuadPart * 60;
+    pm_consumer_->mTrackingStateTableLimit = 4096;
+
     // Start the consumer and output threads
     StartConsumerThread(trace_session_.mTraceHandle);
     StartOutputThread();
@@ -258,7 +263,8 @@ void RealtimePresentMonSession::AddPresents(
             continue;
         }
 
-        PresentMonPowerTelemetryInfo power_telemetry = {};
+        // telemetry itself is published to the introspection rings at the polling rate, frames
+        // only carry which telemetry is available
         std::bitset<static_cast<size_t>(GpuTelemetryCapBits::gpu_telemetry_count)>
             gpu_telemetry_cap_bits = {};
         if (telemetry_container_) {
@@ -267,22 +273,14 @@ void RealtimePresentMonSession::AddPresents(
                 current_telemetry_adapter_id_ < current_adapters.size()) {
                 auto current_telemetry_adapter =
                     current_adapters.at(current_telemetry_adapter_id_).get();
-                if (auto data = current_telemetry_adapter->GetClosest(
-                    presentEvent->PresentStartTime)) {
-                    power_telemetry = *data;
-                }
                 gpu_telemetry_cap_bits = current_telemetry_adapter
                     ->GetPowerTelemetryCapBits();
             }
         }
 
-        CpuTelemetryInfo cpu_telemetry = {};
         std::bitset<static_cast<size_t>(CpuTelemetryCapBits::cpu_telemetry_count)>
             cpu_telemetry_cap_bits = {};
         if (cpu_) {
-            if (auto data = cpu_->GetClosest(presentEvent->PresentStartTime)) {
-                cpu_telemetry = *data;
-            }
             cpu_telemetry_cap_bits = cpu_->GetCpuTelemetryCapBits();
         }
 
@@ -300,8 +298,7 @@ void RealtimePresentMonSession::AddPresents(
             // Remove for public build
             // Send data to streamer if we have more than single present event
             streamer_.ProcessPresentEvent(
-                presentEvent.get(), &power_telemetry, &cpu_telemetry,
-                chain->mLastPresentQPC, chain->mLastDisplayedPresentQPC,
+                presentEvent.get(), chain->mLastPresentQPC, chain->mLastDisplayedPresentQPC,
                 processInfo->mModuleName, gpu_telemetry_cap_bits,
                 cpu_telemetry_cap_bits);
         }
@@ -0,0 +1,84 @@
+#pragma once
+#include "../ActionHelper.h"
+#include "../../../PresentData/Instrumentation.hpp"
+#include <format>
+
+#define ACTNAME GetAnalysisInstrumentation
+
+namespace pmon::svc::acts
+{
+	using namespace ipc::act;
+
+	class ACTNAME : public AsyncActionBase_<ACTNAME, ServiceExecutionContext>
+	{
+	public:
+		static constexpr const char* Identifier = STRINGIFY(ACTNAME);
+		struct Params {};
+		struct Response
+		{
+			struct EventCost
+			{
+				uint32_t handler;
+				uint32_t eventId;
+				uint64_t count;
+				uint64_t cycles;
+				std::vector<uint64_t> cycleHistogram;
+
+				template<class A> void serialize(A& ar) {
+					ar(handler, eventId, count, cycles, cycleHistogram);
+				}
+			};
+			bool enabled;
+			uint64_t eventCount;
+			uint64_t callbackCycles;
+			std::vector<uint64_t> callbackCycleHistogram;
+			uint64_t untrackedEventCount;
+			std::vector<uint64_t> tableSizes;
+			uint64_t evictedEntryCount;
+			uint32_t completedPresentCount;
+			uint32_t peakCompletedPresentCount;
+			std::vector<EventCost> eventCosts;
+
+			template<class A> void serialize(A& ar) {
+				ar(enabled, eventCount, callbackCycles, callbackCycleHistogram, untrackedEventCount,
+					tableSizes, evictedEntryCount, completedPresentCount, peakCompletedPresentCount, eventCosts);
+			}
+		};
+	private:
+		friend class AsyncActionBase_<ACTNAME, ServiceExecutionContext>;
+		static Response Execute_(const ServiceExecutionContext& ctx, SessionContext& stx, Params&& in)
+		{
+			// the counters are process-wide, covering every trace session the service is running
+			InstrumentationSnapshot snapshot;
+			Response out{};
+			out.enabled = GetInstrumentationSnapshot(&snapshot);
+			out.eventCount = snapshot.mEventCount;
+			out.callbackCycles = snapshot.mCallbackCycles;
+			out.callbackCycleHistogram.assign(std::begin(snapshot.mCallbackCycleHistogram), std::end(snapshot.mCallbackCycleHistogram));
+			out.untrackedEventCount = snapshot.mUntrackedEventCount;
+			out.tableSizes.assign(std::begin(snapshot.mTableSizes), std::end(snapshot.mTableSizes));
+			out.evictedEntryCount = snapshot.mEvictedEntryCount;
+			out.completedPresentCount = snapshot.mCompletedPresentCount;
+			out.peakCompletedPresentCount = snapshot.mPeakCompletedPresentCount;
+			for (auto& cost : snapshot.mEventCosts) {
+				out.eventCosts.push_back(Response::EventCost{
+					.handler = uint32_t(cost.mHandler),
+					.eventId = cost.mEventId,
+					.count = cost.mCount,
+					.cycles = cost.mCycles,
+					.cycleHistogram = { std::begin(cost.mCycleHistogram), std::end(cost.mCycleHistogram) },
+				});
+			}
+			pmlog_dbg(std::format("analysis instrumentation gotten for {} events", out.eventCount));
+			return out;
+		}
+	};
+
+#ifdef PM_SERVICE_ASYNC_ACTION_REGISTRATION_
+	ACTION_REG(ACTNAME);
+#endif
+}
+
+ACTION_TRAITS_DEF(ACTNAME);
+
+#undef ACTNAME
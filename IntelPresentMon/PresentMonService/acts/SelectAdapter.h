@@ -18,6 +18,7 @@ namespace pmon::svc::acts
 		struct Params
 		{
 			uint32_t adapterId;
+			static constexpr bool fixedLayout = true;
 
 			template<class A> void serialize(A& ar) {
 				ar(adapterId);
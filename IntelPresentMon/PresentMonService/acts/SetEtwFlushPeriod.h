@@ -18,6 +18,7 @@ namespace pmon::svc::acts
 		struct Params
 		{
 			std::optional<uint32_t> etwFlushPeriodMs;
+			static constexpr bool fixedLayout = true;
 
 			template<class A> void serialize(A& ar) {
 				ar(etwFlushPeriodMs);
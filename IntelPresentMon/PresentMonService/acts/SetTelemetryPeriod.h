@@ -18,6 +18,7 @@ namespace pmon::svc::acts
 		struct Params
 		{
 			uint32_t telemetrySamplePeriodMs;
+			static constexpr bool fixedLayout = true;
 
 			template<class A> void serialize(A& ar) {
 				ar(telemetrySamplePeriodMs);
@@ -15,6 +15,7 @@ namespace pmon::svc::acts
 		struct Params
 		{
 			uint32_t targetPid;
+			static constexpr bool fixedLayout = true;
 
 			template<class A> void serialize(A& ar) {
 				ar(targetPid);
@@ -23,9 +24,11 @@ namespace pmon::svc::acts
 		struct Response
 		{
 			std::string nsmFileName;
+			// set when the service writes the frames of this stream to a frame store file
+			std::string frameStorePath;
 
 			template<class A> void serialize(A& ar) {
-				ar(nsmFileName);
+				ar(nsmFileName, frameStorePath);
 			}
 		};
 	private:
@@ -38,7 +41,10 @@ namespace pmon::svc::acts
 				throw util::Except<ActionExecutionError>(sta);
 			}
 			stx.trackedPids.insert(in.targetPid);
-			const Response out{ .nsmFileName = std::move(nsmFileName) };
+			const Response out{
+				.nsmFileName = std::move(nsmFileName),
+				.frameStorePath = ctx.pPmon->GetFrameStorePath(in.targetPid),
+			};
 			pmlog_info(std::format("StartTracking action from [{}] targeting [{}] assigned nsm [{}]",
 				stx.clientPid, in.targetPid, out.nsmFileName));
 			return out;
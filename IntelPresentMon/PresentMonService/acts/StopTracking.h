@@ -15,6 +15,7 @@ namespace pmon::svc::acts
 		struct Params
 		{
 			uint32_t targetPid;
+			static constexpr bool fixedLayout = true;
 
 			template<class A> void serialize(A& ar) {
 				ar(targetPid);
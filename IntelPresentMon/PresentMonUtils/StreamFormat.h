@@ -132,9 +132,9 @@ struct PmNsmPresentEvent
 	char application[MAX_PATH];
 };
 
+// gpu and cpu telemetry is not stamped into each frame, the service publishes it to
+// the telemetry rings of the introspection segment at its polling rate instead
 struct PmNsmFrameData
 {
 	PmNsmPresentEvent present_event;
-	PresentMonPowerTelemetryInfo power_telemetry;
-	CpuTelemetryInfo cpu_telemetry;
 };
@@ -0,0 +1,272 @@
+// Copyright (C) 2022-2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "FrameStore.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "../CommonUtilities/log/GlogShim.h"
+
+namespace bip = boost::interprocess;
+
+namespace {
+// Bounds on how far ReadFrameSet searches for the next and the last displayed
+// frame, the NSM ring is implicitly bounded by its capacity in the same way
+static const uint64_t kMaxDisplayedLookahead = 4096;
+static const uint64_t kMaxDisplayedLookback = 4096;
+
+std::unique_ptr<bip::mapped_region> CreateMappedFile(const std::string& path,
+                                                     uint64_t size) {
+  try {
+    {
+      std::ofstream file{path, std::ios::binary | std::ios::trunc};
+      if (!file) {
+        LOG(ERROR) << "Unable to create frame store file: " << path;
+        return {};
+      }
+    }
+    std::filesystem::resize_file(path, size);
+    bip::file_mapping mapping{path.c_str(), bip::read_write};
+    return std::make_unique<bip::mapped_region>(mapping, bip::read_write);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Unable to map frame store file " << path << ": "
+               << e.what();
+    return {};
+  }
+}
+
+std::unique_ptr<bip::mapped_region> OpenMappedFile(const std::string& path) {
+  try {
+    bip::file_mapping mapping{path.c_str(), bip::read_only};
+    return std::make_unique<bip::mapped_region>(mapping, bip::read_only);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Unable to map frame store file " << path << ": "
+               << e.what();
+    return {};
+  }
+}
+}  // namespace
+
+std::string GetFrameStoreSegmentPath(const std::string& file_path,
+                                     uint64_t segment) {
+  return file_path + "." + std::to_string(segment);
+}
+
+FrameStoreWriter::FrameStoreWriter(std::string file_path,
+                                   LARGE_INTEGER qpc_frequency,
+                                   uint64_t records_per_segment)
+    : file_path_(std::move(file_path)),
+      records_per_segment_(std::max(records_per_segment, uint64_t(1))) {
+  header_region_ = CreateMappedFile(file_path_, sizeof(FrameStoreHeader));
+  if (!header_region_) {
+    return;
+  }
+  header_ = new (header_region_->get_address()) FrameStoreHeader{};
+  header_->record_size = sizeof(FrameStoreRecord);
+  header_->records_per_segment = records_per_segment_;
+  header_->qpc_frequency = qpc_frequency;
+  LOG(INFO) << "Created frame store: " << file_path_;
+}
+
+FrameStoreWriter::~FrameStoreWriter() { MarkComplete(); }
+
+void FrameStoreWriter::RecordFirstFrameTime(uint64_t start_qpc) {
+  if (header_) {
+    header_->start_qpc = start_qpc;
+  }
+}
+
+bool FrameStoreWriter::AddSegment() {
+  auto region = CreateMappedFile(
+      GetFrameStoreSegmentPath(file_path_, segments_.size()),
+      records_per_segment_ * sizeof(FrameStoreRecord));
+  if (!region) {
+    return false;
+  }
+  segments_.push_back(std::move(region));
+  return true;
+}
+
+void FrameStoreWriter::WriteFrameData(
+    const PmNsmFrameData& data, GpuTelemetryBitset gpu_telemetry_cap_bits,
+    CpuTelemetryBitset cpu_telemetry_cap_bits) {
+  if (header_ == nullptr) {
+    return;
+  }
+  if (num_frames_ == segments_.size() * records_per_segment_ &&
+      !AddSegment()) {
+    LOG(ERROR) << "Frame store full, dropping frame.";
+    return;
+  }
+
+  max_start_qpc_ = std::max(max_start_qpc_, data.present_event.PresentStartTime);
+  auto records =
+      static_cast<FrameStoreRecord*>(segments_.back()->get_address());
+  auto& record = records[num_frames_ % records_per_segment_];
+  record.search_qpc = max_start_qpc_;
+  record.frame = data;
+  header_->gpu_telemetry_cap_bits = gpu_telemetry_cap_bits;
+  header_->cpu_telemetry_cap_bits = cpu_telemetry_cap_bits;
+
+  num_frames_++;
+  header_->num_frames.store(num_frames_, std::memory_order_release);
+}
+
+void FrameStoreWriter::MarkComplete() {
+  if (header_) {
+    header_->complete.store(1, std::memory_order_release);
+  }
+}
+
+void FrameStoreWriter::RemoveFiles() {
+  MarkComplete();
+  header_ = nullptr;
+  const auto num_segments = segments_.size();
+  segments_.clear();
+  header_region_.reset();
+  for (uint64_t segment = 0; segment < num_segments; segment++) {
+    const auto segment_path = GetFrameStoreSegmentPath(file_path_, segment);
+    if (!bip::file_mapping::remove(segment_path.c_str())) {
+      LOG(ERROR) << "Unable to remove frame store file: " << segment_path;
+    }
+  }
+  if (!bip::file_mapping::remove(file_path_.c_str())) {
+    LOG(ERROR) << "Unable to remove frame store file: " << file_path_;
+  }
+}
+
+FrameStoreReader::FrameStoreReader(std::string file_path)
+    : file_path_(std::move(file_path)) {
+  header_region_ = OpenMappedFile(file_path_);
+  if (!header_region_) {
+    return;
+  }
+  auto header = static_cast<const FrameStoreHeader*>(header_region_->get_address());
+  if (header_region_->get_size() < sizeof(FrameStoreHeader) ||
+      header->magic != kFrameStoreMagic ||
+      header->version != kFrameStoreVersion ||
+      header->record_size != sizeof(FrameStoreRecord) ||
+      header->records_per_segment == 0) {
+    LOG(ERROR) << "Incompatible frame store: " << file_path_;
+    header_region_.reset();
+    return;
+  }
+  header_ = header;
+  Refresh();
+}
+
+FrameStoreReader::~FrameStoreReader() = default;
+
+uint64_t FrameStoreReader::Refresh() {
+  if (header_ == nullptr) {
+    return 0;
+  }
+  const auto per_segment = header_->records_per_segment;
+  const auto written = header_->num_frames.load(std::memory_order_acquire);
+  const auto needed_segments = (written + per_segment - 1) / per_segment;
+  while (segments_.size() < needed_segments) {
+    auto region = OpenMappedFile(GetFrameStoreSegmentPath(file_path_, segments_.size()));
+    if (!region || region->get_size() < per_segment * sizeof(FrameStoreRecord)) {
+      break;
+    }
+    segments_.push_back(std::move(region));
+  }
+  num_frames_ = std::min(written, segments_.size() * per_segment);
+  return num_frames_;
+}
+
+bool FrameStoreReader::IsComplete() const {
+  return header_ != nullptr &&
+         header_->complete.load(std::memory_order_acquire) != 0 &&
+         header_->num_frames.load(std::memory_order_acquire) == num_frames_;
+}
+
+const FrameStoreRecord* FrameStoreReader::ReadRecord(uint64_t index) const {
+  if (index >= num_frames_) {
+    return nullptr;
+  }
+  const auto per_segment = header_->records_per_segment;
+  auto records = static_cast<const FrameStoreRecord*>(
+      segments_[index / per_segment]->get_address());
+  return &records[index % per_segment];
+}
+
+const PmNsmFrameData* FrameStoreReader::ReadFrameByIdx(uint64_t index) const {
+  if (auto record = ReadRecord(index)) {
+    return &record->frame;
+  }
+  return nullptr;
+}
+
+uint64_t FrameStoreReader::GetLatestQpc() const {
+  if (num_frames_ == 0) {
+    return 0;
+  }
+  return ReadRecord(num_frames_ - 1)->search_qpc;
+}
+
+uint64_t FrameStoreReader::LowerBound(uint64_t qpc) const {
+  uint64_t first = 0;
+  uint64_t count = num_frames_;
+  while (count > 0) {
+    const auto step = count / 2;
+    if (ReadRecord(first + step)->search_qpc < qpc) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+uint64_t FrameStoreReader::UpperBound(uint64_t qpc) const {
+  return qpc == UINT64_MAX ? num_frames_ : LowerBound(qpc + 1);
+}
+
+bool FrameStoreReader::ReadFrameSet(uint64_t index,
+                                    FrameStoreFrameSet& set) const {
+  set = {};
+  set.frame = ReadFrameByIdx(index);
+  if (set.frame == nullptr) {
+    return false;
+  }
+  const auto scan_end =
+      std::min(num_frames_, index + 1 + kMaxDisplayedLookahead);
+  for (auto i = index + 1; i < scan_end; i++) {
+    auto frame = ReadFrameByIdx(i);
+    if (frame->present_event.ScreenTime != 0) {
+      set.next_displayed = frame;
+      break;
+    }
+  }
+  if (set.next_displayed == nullptr) {
+    if (scan_end < num_frames_) {
+      // No displayed frame within the lookahead, the frame cannot be
+      // reported but the caller can move past it
+      return true;
+    }
+    // Next displayed frame hasn't been written yet
+    set.frame = nullptr;
+    return false;
+  }
+  if (index == 0) {
+    return true;
+  }
+  set.last_presented = ReadFrameByIdx(index - 1);
+  for (uint64_t back = 1; back <= index && back <= kMaxDisplayedLookback;
+       back++) {
+    const auto i = index - back;
+    auto frame = ReadFrameByIdx(i);
+    if (frame->present_event.FinalState == PresentResult::Presented) {
+      set.last_displayed = frame;
+      if (i > 0) {
+        set.previous_of_last_displayed = ReadFrameByIdx(i - 1);
+      }
+      break;
+    }
+  }
+  return true;
+}
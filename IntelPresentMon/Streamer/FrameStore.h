@@ -0,0 +1,139 @@
+// Copyright (C) 2022-2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "../PresentMonUtils/StreamFormat.h"
+
+namespace boost::interprocess
+{
+  class mapped_region;
+}
+
+// File-backed alternative to the NSM ring for offline (ETL) analysis. The
+// service appends every analyzed frame and never waits for clients; clients
+// map the same files read-only and access frames by index or by time at
+// their own pace.
+//
+// Layout: <path> holds the FrameStoreHeader, frames are stored in fixed-size
+// segment files <path>.0, <path>.1, ... so that the store can grow without
+// resizing (and remapping) a file that other processes have mapped.
+
+static const uint32_t kFrameStoreMagic = 0x53464D50;  // "PMFS"
+static const uint32_t kFrameStoreVersion = 1;
+static const uint64_t kFrameStoreRecordsPerSegment = 16384;
+
+struct FrameStoreHeader {
+  uint32_t magic = kFrameStoreMagic;
+  uint32_t version = kFrameStoreVersion;
+  uint32_t record_size = 0;
+  uint32_t reserved = 0;
+  uint64_t records_per_segment = 0;
+  uint64_t start_qpc = 0;
+  LARGE_INTEGER qpc_frequency = {};
+  GpuTelemetryBitset gpu_telemetry_cap_bits{};
+  CpuTelemetryBitset cpu_telemetry_cap_bits{};
+  // Number of complete records. Published by the writer after each record.
+  std::atomic<uint64_t> num_frames = 0;
+  // Set once the writer will not append any more frames.
+  std::atomic<uint32_t> complete = 0;
+};
+
+struct FrameStoreRecord {
+  // Running maximum of PresentStartTime up to and including this record.
+  // Frames are stored in the order the service completes them, which is not
+  // strictly ordered by start time, so this is the key used for time lookup.
+  uint64_t search_qpc;
+  PmNsmFrameData frame;
+};
+
+// The frames a client needs around the frame it consumes, as provided by
+// StreamClient::ConsumePtrToNextNsmFrameData for the NSM ring.
+struct FrameStoreFrameSet {
+  const PmNsmFrameData* frame = nullptr;
+  const PmNsmFrameData* next_displayed = nullptr;
+  const PmNsmFrameData* last_presented = nullptr;
+  const PmNsmFrameData* last_displayed = nullptr;
+  const PmNsmFrameData* previous_of_last_displayed = nullptr;
+};
+
+// Service side. Not thread safe, must be used from a single thread.
+class FrameStoreWriter {
+ public:
+  FrameStoreWriter(std::string file_path, LARGE_INTEGER qpc_frequency,
+                   uint64_t records_per_segment = kFrameStoreRecordsPerSegment);
+  // Marks the store complete
+  ~FrameStoreWriter();
+  FrameStoreWriter(const FrameStoreWriter& t) = delete;
+  FrameStoreWriter& operator=(const FrameStoreWriter& t) = delete;
+
+  bool IsValid() const { return header_ != nullptr; }
+  const std::string& GetFilePath() const { return file_path_; }
+  bool IsEmpty() const { return num_frames_ == 0; }
+  uint64_t GetNumFrames() const { return num_frames_; }
+  void RecordFirstFrameTime(uint64_t start_qpc);
+  void WriteFrameData(const PmNsmFrameData& data,
+                      GpuTelemetryBitset gpu_telemetry_cap_bits,
+                      CpuTelemetryBitset cpu_telemetry_cap_bits);
+  void MarkComplete();
+  // Marks the store complete and deletes its files. Clients that have them
+  // mapped keep their views, the files are gone once the last one is closed.
+  void RemoveFiles();
+
+ private:
+  bool AddSegment();
+  std::string file_path_;
+  std::unique_ptr<boost::interprocess::mapped_region> header_region_;
+  std::vector<std::unique_ptr<boost::interprocess::mapped_region>> segments_;
+  FrameStoreHeader* header_ = nullptr;
+  uint64_t records_per_segment_;
+  uint64_t num_frames_ = 0;
+  uint64_t max_start_qpc_ = 0;
+};
+
+// Client side. Frame pointers returned remain valid for the lifetime of the
+// reader. Frames appended by the writer become visible after Refresh().
+class FrameStoreReader {
+ public:
+  explicit FrameStoreReader(std::string file_path);
+  ~FrameStoreReader();
+  FrameStoreReader(const FrameStoreReader& t) = delete;
+  FrameStoreReader& operator=(const FrameStoreReader& t) = delete;
+
+  bool IsValid() const { return header_ != nullptr; }
+  // Picks up frames appended since the last call, returns the frame count
+  uint64_t Refresh();
+  uint64_t GetNumFrames() const { return num_frames_; }
+  // True once the writer has finished and every frame is visible
+  bool IsComplete() const;
+  uint64_t GetStartQpc() const { return header_->start_qpc; }
+  LARGE_INTEGER GetQpcFrequency() const { return header_->qpc_frequency; }
+  GpuTelemetryBitset GetGpuTelemetryCaps() const { return header_->gpu_telemetry_cap_bits; }
+  CpuTelemetryBitset GetCpuTelemetryCaps() const { return header_->cpu_telemetry_cap_bits; }
+
+  const PmNsmFrameData* ReadFrameByIdx(uint64_t index) const;
+  // Latest frame start time among the visible frames (0 when empty)
+  uint64_t GetLatestQpc() const;
+  // Index of the first frame whose start time (running max) is >= qpc, or
+  // GetNumFrames() if there is none
+  uint64_t LowerBound(uint64_t qpc) const;
+  // Index of the first frame whose start time (running max) is > qpc
+  uint64_t UpperBound(uint64_t qpc) const;
+  // Gathers the frame at index along with its neighbours. Returns false if
+  // the next displayed frame has not been written yet. The search for it is
+  // bounded, past the bound the set is returned without next_displayed.
+  bool ReadFrameSet(uint64_t index, FrameStoreFrameSet& set) const;
+
+ private:
+  const FrameStoreRecord* ReadRecord(uint64_t index) const;
+  std::string file_path_;
+  std::unique_ptr<boost::interprocess::mapped_region> header_region_;
+  std::vector<std::unique_ptr<boost::interprocess::mapped_region>> segments_;
+  const FrameStoreHeader* header_ = nullptr;
+  uint64_t num_frames_ = 0;
+};
+
+std::string GetFrameStoreSegmentPath(const std::string& file_path, uint64_t segment);
@@ -0,0 +1,63 @@
+// Copyright (C) 2022-2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <array>
+#include <span>
+#include <algorithm>
+
+#include "../PresentMonUtils/StreamFormat.h"
+
+// Snapshot of the readable part of the NSM frame ring. Positions are logical:
+// position 0 is the oldest readable frame and position count - 1 the newest.
+// The service appends a stream's frames in PresentStartTime order, so
+// positions double as a time index that can be binary searched.
+//
+// The view does not lock the ring; positions near the oldest end may be
+// overwritten by the service while the view is in use, the same as frames
+// obtained through StreamClient::ReadFrameByIdx.
+struct NsmRingView {
+  PmNsmFrameData* frames = nullptr;  // ring slot 0
+  uint64_t max_entries = 0;
+  uint64_t first_idx = 0;  // ring slot of position 0
+  uint64_t count = 0;
+
+  bool IsEmpty() const { return count == 0; }
+  uint64_t ToIndex(uint64_t position) const {
+    return (first_idx + position) % max_entries;
+  }
+  PmNsmFrameData& At(uint64_t position) const {
+    return frames[ToIndex(position)];
+  }
+
+  // First position whose PresentStartTime is greater than qpc, or count if
+  // there is none
+  uint64_t UpperBound(uint64_t qpc) const {
+    uint64_t first = 0;
+    uint64_t remaining = count;
+    while (remaining > 0) {
+      const auto step = remaining / 2;
+      if (At(first + step).present_event.PresentStartTime <= qpc) {
+        first += step + 1;
+        remaining -= step + 1;
+      } else {
+        remaining = step;
+      }
+    }
+    return first;
+  }
+
+  // Frames at positions [begin, end), oldest first, as the ring slots they
+  // occupy: one span, or two when the range wraps around the end of the ring
+  std::array<std::span<PmNsmFrameData>, 2> GetSpans(uint64_t begin,
+                                                    uint64_t end) const {
+    end = std::min(end, count);
+    if (begin >= end) {
+      return {};
+    }
+    const auto first = ToIndex(begin);
+    const auto size = end - begin;
+    const auto first_size = std::min(size, max_entries - first);
+    return {std::span<PmNsmFrameData>{frames + first, size_t(first_size)},
+            std::span<PmNsmFrameData>{frames, size_t(size - first_size)}};
+  }
+};
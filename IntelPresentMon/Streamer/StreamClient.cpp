@@ -146,8 +146,7 @@ PM_STATUS StreamClient::RecordFrame(PM_FRAME_DATA** out_frame_data) {
     uint64_t max_entries = nsm_view->GetHeader()->max_entries;
     next_dequeue_idx_ = (next_dequeue_idx_ + 1) % max_entries;
     current_dequeue_frame_num_++;
-    CopyFrameData(nsm_hdr->start_qpc, data, nsm_hdr->gpuTelemetryCapBits,
-                  nsm_hdr->cpuTelemetryCapBits, *out_frame_data);
+    CopyFrameData(nsm_hdr->start_qpc, data, *out_frame_data);
 
     return PM_STATUS::PM_STATUS_SUCCESS;
   } else {
@@ -354,8 +353,6 @@ PM_STATUS StreamClient::ConsumePtrToNextNsmFrameData(const PmNsmFrameData** pNsm
 
 void StreamClient::CopyFrameData(uint64_t start_qpc,
                                  const PmNsmFrameData* src_frame,
-                                 GpuTelemetryBitset gpu_telemetry_cap_bits,
-                                 CpuTelemetryBitset cpu_telemetry_cap_bits,
                                  PM_FRAME_DATA* dst_frame) {
   memset(dst_frame, 0, sizeof(PM_FRAME_DATA));
   dst_frame->qpc_time = src_frame->present_event.PresentStartTime;
@@ -451,215 +448,8 @@ void StreamClient::CopyFrameData(uint64_t start_qpc,
                      GetQpcFrequency());
   }
 
-  // power telemetry
-  dst_frame->gpu_power_w.data = src_frame->power_telemetry.gpu_power_w;
-  dst_frame->gpu_power_w.valid = gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::gpu_power)];
-
-  dst_frame->gpu_sustained_power_limit_w.data =
-      src_frame->power_telemetry.gpu_sustained_power_limit_w;
-  dst_frame->gpu_sustained_power_limit_w.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_sustained_power_limit)];
-
-  dst_frame->gpu_voltage_v.data =
-      src_frame->power_telemetry.gpu_voltage_v;
-  dst_frame->gpu_voltage_v.valid = gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::gpu_voltage)];
-
-  dst_frame->gpu_frequency_mhz.data =
-      src_frame->power_telemetry.gpu_frequency_mhz;
-  dst_frame->gpu_frequency_mhz.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_frequency)];
-
-  dst_frame->gpu_temperature_c.data =
-      src_frame->power_telemetry.gpu_temperature_c;
-  dst_frame->gpu_temperature_c.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_temperature)];
-
-  dst_frame->gpu_utilization.data =
-      src_frame->power_telemetry.gpu_utilization;
-  dst_frame->gpu_utilization.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_utilization)];
-
-  dst_frame->gpu_render_compute_utilization.data =
-      src_frame->power_telemetry.gpu_render_compute_utilization;
-  dst_frame->gpu_render_compute_utilization.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::gpu_render_compute_utilization)];
-
-  dst_frame->gpu_media_utilization.data =
-      src_frame->power_telemetry.gpu_media_utilization;
-  dst_frame->gpu_media_utilization.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_media_utilization)];
-
-  dst_frame->vram_power_w.data = src_frame->power_telemetry.vram_power_w;
-  dst_frame->vram_power_w.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_power)];
-
-  dst_frame->vram_voltage_v.data = src_frame->power_telemetry.vram_voltage_v;
-  dst_frame->vram_voltage_v.valid = gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::vram_voltage)];
-
-  dst_frame->vram_frequency_mhz.data = src_frame->power_telemetry.vram_frequency_mhz;
-  dst_frame->vram_frequency_mhz.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::vram_frequency)];
-
-  dst_frame->vram_effective_frequency_gbs.data =
-      src_frame->power_telemetry.vram_effective_frequency_gbps;
-  dst_frame->vram_effective_frequency_gbs.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_effective_frequency)];
-
-  dst_frame->vram_temperature_c.data = src_frame->power_telemetry.vram_temperature_c;
-  dst_frame->vram_temperature_c.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_temperature)];
-
-  for (size_t i = 0; i < MAX_PM_FAN_COUNT; i++) {
-    dst_frame->fan_speed_rpm[i].data = src_frame->power_telemetry.fan_speed_rpm[i];
-    dst_frame->fan_speed_rpm[i].valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::fan_speed_0) + i];
-  }
-
-  for (size_t i = 0; i < MAX_PM_PSU_COUNT; i++) {
-    dst_frame->psu_type[i].data =
-        TranslatePsuType(src_frame->power_telemetry.psu[i].psu_type);
-    dst_frame->psu_type[i].valid = dst_frame->psu_power[i].valid =
-        gpu_telemetry_cap_bits
-            [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-
-    dst_frame->psu_power[i].data = src_frame->power_telemetry.psu[i].psu_power;
-    dst_frame->psu_power[i].valid = gpu_telemetry_cap_bits
-        [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-
-    dst_frame->psu_voltage[i].data = src_frame->power_telemetry.psu[i].psu_voltage;
-    dst_frame->psu_voltage[i].valid = gpu_telemetry_cap_bits
-        [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-  }
-
-  // Gpu memory telemetry
-  dst_frame->gpu_mem_total_size_b.data =
-      src_frame->power_telemetry.gpu_mem_total_size_b;
-  dst_frame->gpu_mem_total_size_b.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_mem_size)];
-
-  dst_frame->gpu_mem_used_b.data =
-      src_frame->power_telemetry.gpu_mem_used_b;
-  dst_frame->gpu_mem_used_b.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_mem_used)];
-
-  dst_frame->gpu_mem_max_bandwidth_bps.data =
-      src_frame->power_telemetry.gpu_mem_max_bandwidth_bps;
-  dst_frame->gpu_mem_max_bandwidth_bps.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-      GpuTelemetryCapBits::gpu_mem_max_bandwidth)];
-
-  dst_frame->gpu_mem_read_bandwidth_bps.data =
-      src_frame->power_telemetry.gpu_mem_read_bandwidth_bps;
-  dst_frame->gpu_mem_read_bandwidth_bps.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_mem_read_bandwidth)];
-
-  dst_frame->gpu_mem_write_bandwidth_bps.data =
-      src_frame->power_telemetry.gpu_mem_write_bandwidth_bps;
-  dst_frame->gpu_mem_write_bandwidth_bps.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_mem_write_bandwidth)];
-
-  // Throttling flags
-  dst_frame->gpu_power_limited.data = src_frame->power_telemetry.gpu_power_limited;
-  dst_frame->gpu_power_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_power_limited)];
-
-  dst_frame->gpu_temperature_limited.data =
-      src_frame->power_telemetry.gpu_temperature_limited;
-  dst_frame->gpu_temperature_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_temperature_limited)];
-
-  dst_frame->gpu_current_limited.data =
-      src_frame->power_telemetry.gpu_current_limited;
-  dst_frame->gpu_current_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_current_limited)];
-
-  dst_frame->gpu_voltage_limited.data =
-      src_frame->power_telemetry.gpu_voltage_limited;
-  dst_frame->gpu_voltage_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_voltage_limited)];
-
-  dst_frame->gpu_utilization_limited.data =
-      src_frame->power_telemetry.gpu_utilization_limited;
-  dst_frame->gpu_utilization_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::gpu_utilization_limited)];
-
-  dst_frame->vram_power_limited.data =
-      src_frame->power_telemetry.vram_power_limited;
-  dst_frame->vram_power_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_utilization_limited)];
-
-  dst_frame->vram_temperature_limited.data =
-      src_frame->power_telemetry.vram_temperature_limited;
-  dst_frame->vram_temperature_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_temperature_limited)];
-
-  dst_frame->vram_current_limited.data =
-      src_frame->power_telemetry.vram_current_limited;
-  dst_frame->vram_current_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_current_limited)];
-
-  dst_frame->vram_voltage_limited.data =
-      src_frame->power_telemetry.vram_voltage_limited;
-  dst_frame->vram_voltage_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_voltage_limited)];
-
-  dst_frame->vram_utilization_limited.data =
-      src_frame->power_telemetry.vram_utilization_limited;
-  dst_frame->vram_utilization_limited.valid =
-      gpu_telemetry_cap_bits[static_cast<size_t>(
-          GpuTelemetryCapBits::vram_utilization_limited)];
-
-  // cpu telemetry - only available in INTERNAL builds
-  dst_frame->cpu_utilization.data = src_frame->cpu_telemetry.cpu_utilization;
-  dst_frame->cpu_utilization.valid =
-      cpu_telemetry_cap_bits[static_cast<size_t>(
-          CpuTelemetryCapBits::cpu_utilization)];
-
-  dst_frame->cpu_power_w.data = src_frame->cpu_telemetry.cpu_power_w;
-  dst_frame->cpu_power_w.valid = cpu_telemetry_cap_bits[static_cast<size_t>(
-      CpuTelemetryCapBits::cpu_power)];
-
-  dst_frame->cpu_power_limit_w.data = src_frame->cpu_telemetry.cpu_power_limit_w;
-  dst_frame->cpu_power_limit_w.valid =
-      cpu_telemetry_cap_bits[static_cast<size_t>(
-      CpuTelemetryCapBits::cpu_power_limit)];
-
-  dst_frame->cpu_temperature_c.data = src_frame->cpu_telemetry.cpu_temperature;
-  dst_frame->cpu_temperature_c.valid =
-      cpu_telemetry_cap_bits[static_cast<size_t>(
-          CpuTelemetryCapBits::cpu_temperature)];
-
-  dst_frame->cpu_frequency.data = src_frame->cpu_telemetry.cpu_frequency;
-  dst_frame->cpu_frequency.valid =
-      cpu_telemetry_cap_bits[static_cast<size_t>(
-          CpuTelemetryCapBits::cpu_frequency)];
+  // telemetry is not part of the frame records (see PmNsmFrameData), so the
+  // telemetry members stay zeroed and invalid
 }
 
 // Dequeue frames from head of the named shared memory. Pop the data and 
@@ -682,8 +472,7 @@ PM_STATUS StreamClient::DequeueFrame(PM_FRAME_DATA** out_frame_data) {
    PmNsmFrameData* data = reinterpret_cast<PmNsmFrameData*>(
        static_cast<char*>((nsm_view->GetBuffer())) + read_offset);
 
-  CopyFrameData(nsm_hdr->start_qpc, data, nsm_hdr->gpuTelemetryCapBits,
-                 nsm_hdr->cpuTelemetryCapBits, *out_frame_data);
+  CopyFrameData(nsm_hdr->start_qpc, data, *out_frame_data);
   nsm_view->DequeueFrameData();
   return PM_STATUS::PM_STATUS_SUCCESS;
 }
@@ -708,6 +497,28 @@ uint64_t StreamClient::GetLatestFrameIndex() {
   }
 }
 
+NsmRingView StreamClient::GetRingView() {
+  NsmRingView view;
+  if (shared_mem_view_ == nullptr) {
+    return view;
+  }
+  const auto latest_idx = GetLatestFrameIndex();
+  if (latest_idx == UINT_MAX) {
+    return view;
+  }
+  auto p_header = shared_mem_view_->GetHeader();
+  view.frames = reinterpret_cast<PmNsmFrameData*>(
+      static_cast<char*>(shared_mem_view_->GetBuffer()) +
+      shared_mem_view_->GetBaseOffset());
+  view.max_entries = p_header->max_entries;
+  // Like the dynamic query readers before it, skip the slot at head_idx: once
+  // the ring is full it is the next one to be recycled by the service
+  const auto head_idx = p_header->head_idx;
+  view.first_idx = (head_idx + 1) % view.max_entries;
+  view.count = (latest_idx + view.max_entries - head_idx) % view.max_entries;
+  return view;
+}
+
 // Calculate the number of frames written since the last dequue
 uint64_t StreamClient::CheckPendingReadFrames() {
   uint64_t num_pending_read_frames = 0;
@@ -8,6 +8,7 @@
 #include "../PresentMonUtils/StreamFormat.h"
 #include "../PresentMonUtils/LegacyAPIDefines.h"
 #include "NamedSharedMemory.h"
+#include "NsmRingView.h"
 
 class StreamClient {
  public:
@@ -32,12 +33,13 @@ class StreamClient {
   PM_STATUS DequeueFrame(PM_FRAME_DATA** out_frame_data);
   // Return the last frame id that holds valid data
   uint64_t GetLatestFrameIndex();
+  // Snapshot of the frames readable from the ring, ordered by time. Empty if
+  // there is no data or the process is no longer active.
+  NsmRingView GetRingView();
   NamedSharedMem* GetNamedSharedMemView() { return shared_mem_view_.get(); }
   void CloseSharedMemView();
   LARGE_INTEGER GetQpcFrequency() { return qpcFrequency_; };
   void CopyFrameData(uint64_t start_qpc, const PmNsmFrameData* src_frame,
-                     GpuTelemetryBitset gpu_telemetry_cap_bits,
-                     CpuTelemetryBitset cpu_telemetry_cap_bits,
                      PM_FRAME_DATA* dst_frame);
 
   std::optional<std::bitset<
@@ -15,6 +15,7 @@
 #include <chrono>
 #include <ctime>
 #include <cstdlib>
+#include <filesystem>
 #include "../PresentMonService/CliOptions.h"
 #include "../CommonUtilities/str/String.h"
 #include "../CommonUtilities/log/GlogShim.h"
@@ -31,6 +32,7 @@ Streamer::Streamer()
 {
     if (clio::Options::IsInitialized()) {
         mapfileNamePrefix_ = clio::Options::Get().nsmPrefix.AsOptional().value_or(mapfileNamePrefix_);
+        frame_store_dir_ = clio::Options::Get().etlFrameStoreDir.AsOptional().value_or(frame_store_dir_);
     }
 }
 
@@ -130,9 +132,7 @@ void Streamer::CopyFromPresentMonPresentEvent(
 }
 
 void Streamer::ProcessPresentEvent(
-    PresentEvent* present_event,
-    PresentMonPowerTelemetryInfo* power_telemetry_info,
-    CpuTelemetryInfo* cpu_telemetry_info, uint64_t last_present_qpc,
+    PresentEvent* present_event, uint64_t last_present_qpc,
     uint64_t last_displayed_qpc, std::wstring app_name,
     std::bitset<static_cast<size_t>(GpuTelemetryCapBits::gpu_telemetry_count)>
         gpu_telemetry_cap_bits,
@@ -185,6 +185,16 @@ void Streamer::ProcessPresentEvent(
       return;
     }
 
+    FrameStoreWriter* frame_store = nullptr;
+    if (auto store_iter = frame_store_map_.find(process_id);
+        store_iter != frame_store_map_.end()) {
+      frame_store = store_iter->second.get();
+      if (frame_store->IsEmpty()) {
+        frame_store->RecordFirstFrameTime(
+            start_qpc_ != 0 ? start_qpc_ : present_event->PresentStartTime);
+      }
+    }
+
     PmNsmFrameData data = {};
     // Copy the passed in PresentEvent data into the PmNsmFrameData
     // structure.
@@ -197,14 +207,13 @@ void Streamer::ProcessPresentEvent(
     auto appNameNarrow = pmon::util::str::ToNarrow(app_name);
     std::size_t length = appNameNarrow.copy(data.present_event.application, appNameNarrow.size());
     data.present_event.application[length] = '\0';
-    // Now copy the power telemetry data
-    memcpy_s(&data.power_telemetry, sizeof(PresentMonPowerTelemetryInfo),
-             power_telemetry_info, sizeof(PresentMonPowerTelemetryInfo));
-    // Finally copy the cpu telemetry data
-    memcpy_s(&data.cpu_telemetry, sizeof(CpuTelemetryInfo), cpu_telemetry_info,
-             sizeof(CpuTelemetryInfo));
-
-    if (process_nsm) {
+
+    if (frame_store) {
+      // Clients read the frame store at their own pace, so the NSM for the
+      // process is bypassed and there is nothing to wait for
+      frame_store->WriteFrameData(data, gpu_telemetry_cap_bits,
+                                  cpu_telemetry_cap_bits);
+    } else if (process_nsm) {
       // Block write frame data only when in ETL mode and nsm is full
       auto start = std::chrono::high_resolution_clock::now();
       std::chrono::milliseconds time_elapsed =
@@ -295,6 +304,13 @@ bool Streamer::UpdateNSMAttachments(uint32_t process_id, int& ref_count) {
     } else {
       iter->second->NotifyProcessKilled();
       process_shared_mem_map_.erase(std::move(iter));
+      // The stream is over, clients that still have the frame store mapped
+      // keep their views
+      if (auto store_iter = frame_store_map_.find(process_id);
+          store_iter != frame_store_map_.end()) {
+        store_iter->second->RemoveFiles();
+        frame_store_map_.erase(store_iter);
+      }
       ref_count = 0;
     }
     return true;
@@ -386,6 +402,10 @@ void Streamer::StopAllStreams() {
     it.second->NotifyProcessKilled();
   }
   process_shared_mem_map_.clear();
+  for (auto const& it : frame_store_map_) {
+    it.second->RemoveFiles();
+  }
+  frame_store_map_.clear();
   client_map_.clear();
   write_timedout_ = false;
 }
@@ -402,6 +422,9 @@ bool Streamer::CreateNamedSharedMemory(DWORD process_id,
         std::make_unique<NamedSharedMem>(std::move(mapfile_name), nsm_size_in_bytes, from_etl_file);
     if (nsm->IsNSMCreated()) {
         process_shared_mem_map_.emplace(process_id, std::move(nsm));
+        if (from_etl_file && !frame_store_dir_.empty()) {
+            CreateFrameStore(process_id);
+        }
         return true;
     } else {
         LOG(INFO) << "Unabled to create NSM for process id:" << process_id;
@@ -426,4 +449,33 @@ std::string Streamer::GetMapFileName(DWORD process_id) {
   }
 
   return mapfile_name;
-}
\ No newline at end of file
+}
+
+std::string Streamer::GetFrameStorePath(DWORD process_id) {
+  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
+  auto iter = frame_store_map_.find(process_id);
+  std::string frame_store_path;
+
+  if (iter != frame_store_map_.end()) {
+    frame_store_path = iter->second->GetFilePath();
+  }
+
+  return frame_store_path;
+}
+
+// Function assumes the NSM map mutex has been called PRIOR to calling this
+// function. Failure to create the store is not fatal, frames will be streamed
+// through the NSM instead.
+void Streamer::CreateFrameStore(DWORD process_id) {
+  LARGE_INTEGER qpc_frequency = {};
+  QueryPerformanceFrequency(&qpc_frequency);
+  const auto path = std::filesystem::path{frame_store_dir_} /
+                    ("frames_" + std::to_string(process_id) + ".pmfs");
+  auto store = std::make_unique<FrameStoreWriter>(path.string(), qpc_frequency);
+  if (store->IsValid()) {
+    frame_store_map_.emplace(process_id, std::move(store));
+  } else {
+    LOG(INFO) << "Unable to create frame store for process id:" << process_id
+              << ", streaming through NSM";
+  }
+}
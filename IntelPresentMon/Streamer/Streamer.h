@@ -10,6 +10,7 @@
 #include "../PresentMonUtils/StreamFormat.h"
 #include "gtest/gtest.h"
 #include "NamedSharedMemory.h"
+#include "FrameStore.h"
 
 static const uint32_t kEtlSleepTime = 1;
 
@@ -37,9 +38,7 @@ class Streamer {
   // Last producer and last consumer are internal fields
   // Remove for public build
   void ProcessPresentEvent(
-      PresentEvent* present_event,
-      PresentMonPowerTelemetryInfo* power_telemetry_info,
-      CpuTelemetryInfo* cpu_telemetry_info, uint64_t last_present_qpc,
+      PresentEvent* present_event, uint64_t last_present_qpc,
       uint64_t last_displayed_qpc, std::wstring app_name,
       std::bitset<static_cast<size_t>(GpuTelemetryCapBits::gpu_telemetry_count)>
           gpu_telemetry_cap_bits,
@@ -53,7 +52,15 @@ class Streamer {
       std::bitset<static_cast<size_t>(CpuTelemetryCapBits::cpu_telemetry_count)>
           cpu_telemetry_cap_bits);
   std::string GetMapFileName(DWORD process_id);
+  // Path of the frame store the process' frames are written to when offline
+  // frames are stored to file instead of the NSM, empty otherwise
+  std::string GetFrameStorePath(DWORD process_id);
   void SetStartQpc(uint64_t start_qpc) { start_qpc_ = start_qpc; };
+  // Overrides the prefix of the NSM names given to streams started after
+  // this call, e.g. a Local\ prefix for streams private to the session
+  void SetMapFileNamePrefix(std::string prefix) {
+    mapfileNamePrefix_ = std::move(prefix);
+  };
   bool IsTimedOut() { return write_timedout_; };
   int NumActiveStreams() { return (int)process_shared_mem_map_.size(); }
 
@@ -64,9 +71,15 @@ class Streamer {
   void CopyFromPresentMonPresentEvent(PresentEvent* present_event,
                                       PmNsmPresentEvent* nsm_present_event);
   bool UpdateNSMAttachments(uint32_t process_id, int& ref_count);
+  void CreateFrameStore(DWORD process_id);
   std::string mapfileNamePrefix_;
   // Shared mem buffer map of process id and share mem handle
   std::map<DWORD, std::unique_ptr<NamedSharedMem>> process_shared_mem_map_;
+  // Frame stores of ETL streams, their files are deleted with the NSM of the
+  // process
+  std::map<DWORD, std::unique_ptr<FrameStoreWriter>> frame_store_map_;
+  // Directory for ETL frame stores, empty to stream ETL frames through the NSM
+  std::string frame_store_dir_;
   std::multimap<uint32_t, uint32_t> client_map_;
   uint64_t shared_mem_size_;
   StreamMode stream_mode_;
@@ -0,0 +1,232 @@
+#include "gtest/gtest.h"
+#include "../ControlLib/ColumnarTelemetryHistory.h"
+#include "../ControlLib/TelemetryHistory.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using Cap = GpuTelemetryCapBits;
+
+    // caps typical of a discrete gpu: most scalar sensors, one fan, no psu
+    GpuTelemetryBitset MakeCaps()
+    {
+        GpuTelemetryBitset caps;
+        for (auto c : { Cap::time_stamp, Cap::gpu_power, Cap::gpu_sustained_power_limit, Cap::gpu_voltage,
+            Cap::gpu_frequency, Cap::gpu_temperature, Cap::gpu_utilization, Cap::vram_frequency,
+            Cap::fan_speed_0, Cap::gpu_mem_size, Cap::gpu_mem_used, Cap::gpu_power_limited }) {
+            caps.set(size_t(c));
+        }
+        return caps;
+    }
+
+    // sensor-like samples: slowly varying values with some noise, qpc on a jittered 10ms cadence
+    std::vector<PresentMonPowerTelemetryInfo> MakeSamples(size_t count, uint32_t seed = 0)
+    {
+        std::mt19937 gen{ seed };
+        std::uniform_int_distribution<uint64_t> jitter{ 0, 5000 };
+        std::normal_distribution<double> noise{ 0., 1. };
+        std::vector<PresentMonPowerTelemetryInfo> samples;
+        uint64_t qpc = 1'000'000;
+        for (size_t i = 0; i < count; i++) {
+            qpc += 100'000 + jitter(gen);
+            PresentMonPowerTelemetryInfo s{};
+            s.qpc = qpc;
+            s.time_stamp = double(qpc) / 10'000'000.;
+            s.gpu_power_w = 150. + 10. * std::sin(double(i) / 50.) + noise(gen);
+            s.gpu_sustained_power_limit_w = 225.;
+            s.gpu_voltage_v = 0.9 + noise(gen) * 0.01;
+            s.gpu_frequency_mhz = std::round(2100. + noise(gen) * 20.);
+            s.gpu_temperature_c = std::round(65. + std::sin(double(i) / 200.) * 5.);
+            s.gpu_utilization = std::clamp(90. + noise(gen) * 5., 0., 100.);
+            s.vram_frequency_mhz = 1000.;
+            s.fan_speed_rpm[0] = std::round(1500. + noise(gen) * 10.);
+            s.gpu_mem_total_size_b = 16ull << 30;
+            s.gpu_mem_used_b = (4ull << 30) + i * 4096;
+            s.gpu_power_limited = i % 97 == 0;
+            samples.push_back(s);
+        }
+        return samples;
+    }
+
+    // compare only the fields that the columnar history is expected to retain
+    void ExpectSameEnabledFields(const PresentMonPowerTelemetryInfo& expected, const PresentMonPowerTelemetryInfo& actual)
+    {
+        EXPECT_EQ(expected.qpc, actual.qpc);
+        EXPECT_EQ(expected.time_stamp, actual.time_stamp);
+        EXPECT_EQ(expected.gpu_power_w, actual.gpu_power_w);
+        EXPECT_EQ(expected.gpu_sustained_power_limit_w, actual.gpu_sustained_power_limit_w);
+        EXPECT_EQ(expected.gpu_voltage_v, actual.gpu_voltage_v);
+        EXPECT_EQ(expected.gpu_frequency_mhz, actual.gpu_frequency_mhz);
+        EXPECT_EQ(expected.gpu_temperature_c, actual.gpu_temperature_c);
+        EXPECT_EQ(expected.gpu_utilization, actual.gpu_utilization);
+        EXPECT_EQ(expected.vram_frequency_mhz, actual.vram_frequency_mhz);
+        EXPECT_EQ(expected.fan_speed_rpm[0], actual.fan_speed_rpm[0]);
+        EXPECT_EQ(expected.gpu_mem_total_size_b, actual.gpu_mem_total_size_b);
+        EXPECT_EQ(expected.gpu_mem_used_b, actual.gpu_mem_used_b);
+        EXPECT_EQ(expected.gpu_power_limited, actual.gpu_power_limited);
+    }
+}
+
+TEST(ColumnarTelemetryHistory, empty)
+{
+    pwr::ColumnarTelemetryHistory hist(5);
+    EXPECT_FALSE(hist.GetNearest(100).has_value());
+    EXPECT_EQ(0, hist.GetSize());
+}
+
+TEST(ColumnarTelemetryHistory, disabledFieldsAreNotStored)
+{
+    pwr::ColumnarTelemetryHistory hist(5);
+    GpuTelemetryBitset caps;
+    caps.set(size_t(Cap::gpu_power));
+    hist.Push({ .qpc = 10, .gpu_power_w = 50., .gpu_voltage_v = 1. }, caps);
+    const auto s = hist.GetNearest(10);
+    ASSERT_TRUE(s.has_value());
+    EXPECT_EQ(50., s->gpu_power_w);
+    EXPECT_EQ(0., s->gpu_voltage_v);
+    // only qpc and power columns allocated
+    EXPECT_EQ(5 * (sizeof(uint64_t) + sizeof(double)), hist.GetMemoryFootprint());
+}
+
+TEST(ColumnarTelemetryHistory, nearestMatchesTelemetryHistory)
+{
+    const auto caps = MakeCaps();
+    const auto samples = MakeSamples(500);
+    pwr::TelemetryHistory<PresentMonPowerTelemetryInfo> reference(300);
+    pwr::ColumnarTelemetryHistory hist(300);
+    for (auto& s : samples) {
+        reference.Push(s);
+        hist.Push(s, caps);
+    }
+    EXPECT_EQ(300, hist.GetSize());
+    // probe before, inside (exact and between samples), and after the retained range
+    for (uint64_t qpc = samples.front().qpc; qpc <= samples.back().qpc + 200'000; qpc += 7'919) {
+        const auto expected = reference.GetNearest(qpc);
+        const auto actual = hist.GetNearest(qpc);
+        ASSERT_TRUE(actual.has_value());
+        ExpectSameEnabledFields(*expected, *actual);
+    }
+    for (auto& s : samples) {
+        ExpectSameEnabledFields(*reference.GetNearest(s.qpc), *hist.GetNearest(s.qpc));
+    }
+}
+
+TEST(ColumnarTelemetryHistory, coldTierIsLossless)
+{
+    const auto caps = MakeCaps();
+    const auto samples = MakeSamples(1000, 7);
+    pwr::ColumnarTelemetryHistory hist(128, 100);
+    for (auto& s : samples) {
+        hist.Push(s, caps);
+    }
+    EXPECT_EQ(samples.size(), hist.GetSize());
+    for (auto& s : samples) {
+        const auto actual = hist.GetNearest(s.qpc);
+        ASSERT_TRUE(actual.has_value());
+        ExpectSameEnabledFields(s, *actual);
+    }
+}
+
+TEST(ColumnarTelemetryHistory, coldTierDropsOldestBlocks)
+{
+    const auto caps = MakeCaps();
+    const auto samples = MakeSamples(1000, 3);
+    pwr::ColumnarTelemetryHistory hist(128, 4);
+    for (auto& s : samples) {
+        hist.Push(s, caps);
+    }
+    EXPECT_GE(hist.GetSize(), 128 + 3 * pwr::ColumnarTelemetryHistory::coldBlockSize);
+    EXPECT_LE(hist.GetSize(), 128 + 4 * pwr::ColumnarTelemetryHistory::coldBlockSize);
+    // queries older than retained history clamp to the oldest retained sample
+    const auto oldest = samples[samples.size() - hist.GetSize()];
+    ExpectSameEnabledFields(oldest, *hist.GetNearest(0));
+    ExpectSameEnabledFields(oldest, *hist.GetNearest(samples.front().qpc));
+}
+
+TEST(ColumnarTelemetryHistory, nearestAcrossTierBoundary)
+{
+    const auto caps = MakeCaps();
+    const auto samples = MakeSamples(1000, 11);
+    pwr::TelemetryHistory<PresentMonPowerTelemetryInfo> reference(samples.size());
+    pwr::ColumnarTelemetryHistory hist(64, 100);
+    for (auto& s : samples) {
+        reference.Push(s);
+        hist.Push(s, caps);
+    }
+    // probe every gap, including between cold blocks and between the cold and hot tiers
+    for (size_t i = 1; i < samples.size(); i++) {
+        const auto lo = samples[i - 1].qpc;
+        const auto hi = samples[i].qpc;
+        for (auto qpc : { lo + 1, (lo + hi) / 2, (lo + hi + 1) / 2, hi - 1 }) {
+            ExpectSameEnabledFields(*reference.GetNearest(qpc), *hist.GetNearest(qpc));
+        }
+    }
+}
+
+TEST(ColumnarTelemetryHistory, extremeValuesRoundTrip)
+{
+    GpuTelemetryBitset caps;
+    caps.set(size_t(Cap::gpu_mem_used));
+    caps.set(size_t(Cap::gpu_power));
+    pwr::ColumnarTelemetryHistory hist(64, 4);
+    std::vector<PresentMonPowerTelemetryInfo> samples;
+    for (uint64_t i = 0; i < 256; i++) {
+        samples.push_back({ .qpc = i * 10, .gpu_power_w = (i % 2) ? -1e300 : std::nan(""),
+            .gpu_mem_used_b = (i % 2) ? ~0ull : 0ull });
+        hist.Push(samples.back(), caps);
+    }
+    for (auto& s : samples) {
+        const auto actual = hist.GetNearest(s.qpc);
+        EXPECT_EQ(0, memcmp(&s.gpu_power_w, &actual->gpu_power_w, sizeof(double)));
+        EXPECT_EQ(s.gpu_mem_used_b, actual->gpu_mem_used_b);
+    }
+}
+
+// reports memory and lookup cost of the columnar layout versus the whole-struct ring
+TEST(ColumnarTelemetryHistory, footprintAndLookupVersusStructRing)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    const auto caps = MakeCaps();
+    const auto samples = MakeSamples(4000, 5);
+    pwr::TelemetryHistory<PresentMonPowerTelemetryInfo> reference(300);
+    pwr::ColumnarTelemetryHistory hot(300);
+    pwr::ColumnarTelemetryHistory tiered(300, 48);
+    for (auto& s : samples) {
+        reference.Push(s);
+        hot.Push(s, caps);
+        tiered.Push(s, caps);
+    }
+    const auto referenceBytes = 300 * sizeof(PresentMonPowerTelemetryInfo);
+    std::cout << "struct ring: " << referenceBytes << " bytes for 300 samples\n"
+        << "columnar: " << hot.GetMemoryFootprint() << " bytes for " << hot.GetSize() << " samples\n"
+        << "columnar+cold: " << tiered.GetMemoryFootprint() << " bytes for " << tiered.GetSize() << " samples\n";
+    EXPECT_LT(hot.GetMemoryFootprint(), referenceBytes / 2);
+    // cold tier must cost well under a full struct per sample retained
+    EXPECT_LT(tiered.GetMemoryFootprint() / tiered.GetSize(), sizeof(PresentMonPowerTelemetryInfo) / 4);
+
+    const auto measure = [&](const char* name, auto&& lookup) {
+        constexpr int rounds = 20;
+        const auto begin = samples[samples.size() - 300].qpc;
+        const auto end = samples.back().qpc;
+        double sink = 0.;
+        size_t n = 0;
+        const auto t0 = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (auto qpc = begin + r; qpc < end; qpc += 3'331) {
+                sink += lookup(qpc)->gpu_power_w;
+                n++;
+            }
+        }
+        const auto ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        std::cout << name << ": " << ns / double(n) << " ns/lookup (" << sink << ")\n";
+    };
+    measure("struct ring", [&](uint64_t qpc) { return reference.GetNearest(qpc); });
+    measure("columnar", [&](uint64_t qpc) { return hot.GetNearest(qpc); });
+    measure("columnar+cold", [&](uint64_t qpc) { return tiered.GetNearest(qpc); });
+}
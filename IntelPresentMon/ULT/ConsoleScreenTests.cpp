@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+#include "../../PresentMon/ConsoleScreen.hpp"
+#include <cwchar>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t kWidth = 120;
+
+    // an in-memory console the screen's writes are applied to, counting the characters written
+    class MemoryConsole
+    {
+    public:
+        size_t Apply(const ConsoleScreen& screen)
+        {
+            size_t written = 0;
+            for (auto& w : screen.mWrites) {
+                for (uint32_t i = 0; i < w.mLength; i++) {
+                    const auto row = w.mRow + i / screen.mWidth;
+                    if (rows_.size() <= row) {
+                        rows_.resize(row + 1, std::wstring(screen.mWidth, L' '));
+                    }
+                    rows_[row][i % screen.mWidth] = screen.mBuffer[w.mOffset + i];
+                }
+                written += w.mLength;
+            }
+            return written;
+        }
+        // the rows' text without trailing spaces, and without trailing blank rows
+        std::vector<std::wstring> GetText() const
+        {
+            std::vector<std::wstring> text;
+            for (auto& r : rows_) {
+                text.push_back(r.substr(0, r.find_last_not_of(L' ') + 1));
+            }
+            while (!text.empty() && text.back().empty()) {
+                text.pop_back();
+            }
+            return text;
+        }
+    private:
+        std::vector<std::wstring> rows_;
+    };
+
+    void PrintRow(ConsoleScreen& screen, const std::wstring& text)
+    {
+        screen.Print(text.c_str(), text.size());
+        screen.EndRow();
+    }
+
+    // the statistics of a capture-all session, where only processes with a changed frame rate
+    // have different text
+    std::vector<std::wstring> FormatProcesses(const std::vector<double>& fps)
+    {
+        std::vector<std::wstring> rows;
+        wchar_t buffer[256];
+        for (size_t i = 0; i < fps.size(); i++) {
+            swprintf(buffer, std::size(buffer), L"app%zu.exe[%zu]:", i, 1000 + 4 * i);
+            rows.push_back(buffer);
+            swprintf(buffer, std::size(buffer), L"    %016zX (DXGI): SyncInterval=0 Flags=0 CPU=%.3fms (%.1f fps)",
+                0x1000 * i, 1000. / fps[i], fps[i]);
+            rows.push_back(buffer);
+            rows.push_back(L"");
+        }
+        return rows;
+    }
+
+    std::vector<std::wstring> WithoutTrailingBlankRows(std::vector<std::wstring> rows)
+    {
+        while (!rows.empty() && rows.back().empty()) {
+            rows.pop_back();
+        }
+        return rows;
+    }
+
+    size_t Refresh(ConsoleScreen& screen, MemoryConsole& console, const std::vector<std::wstring>& rows, bool invalidate = false)
+    {
+        screen.BeginFrame(kWidth, invalidate);
+        for (auto& r : rows) {
+            PrintRow(screen, r);
+        }
+        screen.EndFrame();
+        return console.Apply(screen);
+    }
+}
+
+TEST(ConsoleScreen, OnlyChangedRowsAreWritten)
+{
+    ConsoleScreen screen;
+    MemoryConsole console;
+    std::vector<double> fps(300, 60.);
+    auto rows = FormatProcesses(fps);
+
+    // the first refresh writes every row, in one write
+    const auto full = Refresh(screen, console, rows);
+    EXPECT_EQ(full, rows.size() * kWidth);
+    EXPECT_EQ(screen.mWrites.size(), 1u);
+    EXPECT_EQ(console.GetText(), WithoutTrailingBlankRows(rows));
+
+    // nothing changed
+    EXPECT_EQ(Refresh(screen, console, rows), 0u);
+    EXPECT_TRUE(screen.mWrites.empty());
+
+    // two processes' frame rates changed
+    fps[10] = 144.;
+    fps[200] = 30.;
+    rows = FormatProcesses(fps);
+    const auto partial = Refresh(screen, console, rows);
+    EXPECT_EQ(partial, 2 * kWidth);
+    EXPECT_EQ(screen.mWrites.size(), 2u);
+    EXPECT_EQ(console.GetText(), WithoutTrailingBlankRows(rows));
+
+    std::cout << rows.size() << " rows: " << full << " characters written on the first refresh, "
+        << partial << " when two processes changed\n";
+
+    // invalidating the screen rewrites it all
+    EXPECT_EQ(Refresh(screen, console, rows, true), full);
+    EXPECT_EQ(console.GetText(), WithoutTrailingBlankRows(rows));
+}
+
+TEST(ConsoleScreen, RemovedRowsAreCleared)
+{
+    ConsoleScreen screen;
+    MemoryConsole console;
+    Refresh(screen, console, FormatProcesses(std::vector<double>(3, 60.)));
+
+    // the last process exited: its rows are blanked, other than the one that was already blank
+    const auto rows = FormatProcesses(std::vector<double>(2, 60.));
+    EXPECT_EQ(Refresh(screen, console, rows), 2 * kWidth);
+    EXPECT_EQ(console.GetText(), WithoutTrailingBlankRows(rows));
+
+    // clearing the screen, e.g. on exit
+    EXPECT_EQ(Refresh(screen, console, {}), 4 * kWidth);
+    EXPECT_TRUE(console.GetText().empty());
+}
+
+TEST(ConsoleScreen, LongRowsWrap)
+{
+    ConsoleScreen screen;
+    MemoryConsole console;
+    screen.BeginFrame(10, false);
+    const std::wstring text = L"0123456789abcdefghijKLM";
+    screen.Print(text.c_str(), 5);
+    screen.Print(text.c_str() + 5, text.size() - 5);
+    screen.EndRow();
+    PrintRow(screen, L"next");
+    screen.EndFrame();
+    console.Apply(screen);
+
+    EXPECT_EQ(screen.mPresentedRowCount, 4u);
+    EXPECT_EQ(console.GetText(), (std::vector<std::wstring>{ L"0123456789", L"abcdefghij", L"KLM", L"next" }));
+}
@@ -0,0 +1,449 @@
+#include "EtwStreamGenerator.h"
+#include "../../PresentData/ETW/Microsoft_Windows_DXGI.h"
+#include "../../PresentData/ETW/Microsoft_Windows_DxgKrnl.h"
+#include "../../PresentData/ETW/Microsoft_Windows_Dwm_Core.h"
+#include "../../PresentData/ETW/Microsoft_Windows_Kernel_Process.h"
+#include "../../PresentData/ETW/Microsoft_Windows_Win32k.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+// layout of an event's user data; every property is an unsigned integer of the given size
+struct EtwEventSchema
+{
+    struct Property
+    {
+        const wchar_t* name;
+        uint16_t size;
+        // index of the property holding the element count, for array properties
+        // (the generator only writes arrays of one element)
+        uint16_t countIndex = UINT16_MAX;
+    };
+    GUID provider;
+    EVENT_DESCRIPTOR descriptor;
+    EtwStreamGenerator::Handler handler;
+    std::vector<Property> properties;
+};
+
+namespace
+{
+    namespace dxgi = Microsoft_Windows_DXGI;
+    namespace dxgk = Microsoft_Windows_DxgKrnl;
+    namespace dwm = Microsoft_Windows_Dwm_Core;
+    namespace win32k = Microsoft_Windows_Win32k;
+    namespace kernelProcess = Microsoft_Windows_Kernel_Process;
+    using Handler = EtwStreamGenerator::Handler;
+
+    template<typename T>
+    EtwEventSchema MakeSchema(const GUID& provider, Handler handler, std::vector<EtwEventSchema::Property> properties)
+    {
+        EVENT_DESCRIPTOR descriptor{};
+        descriptor.Id = T::Id;
+        descriptor.Version = T::Version;
+        descriptor.Channel = T::Channel;
+        descriptor.Level = T::Level;
+        descriptor.Opcode = T::Opcode;
+        descriptor.Task = T::Task;
+        descriptor.Keyword = ULONGLONG(T::Keyword);
+        return { provider, descriptor, handler, std::move(properties) };
+    }
+
+    const auto dxgiPresentStart = MakeSchema<dxgi::Present_Start>(dxgi::GUID, Handler::DXGI,
+        { { L"pIDXGISwapChain", 8 }, { L"Flags", 4 }, { L"SyncInterval", 4 } });
+    const auto dxgiPresentStop = MakeSchema<dxgi::Present_Stop>(dxgi::GUID, Handler::DXGI,
+        { { L"Result", 4 } });
+    const auto deviceStart = MakeSchema<dxgk::Device_Start>(dxgk::GUID, Handler::DXGK,
+        { { L"pDxgAdapter", 8 }, { L"hDevice", 8 } });
+    const auto contextStart = MakeSchema<dxgk::Context_Start>(dxgk::GUID, Handler::DXGK,
+        { { L"hContext", 8 }, { L"hDevice", 8 }, { L"NodeOrdinal", 4 } });
+    const auto dmaPacketStart = MakeSchema<dxgk::DmaPacket_Start>(dxgk::GUID, Handler::DXGK,
+        { { L"hContext", 8 }, { L"ulQueueSubmitSequence", 4 } });
+    const auto dmaPacketInfo = MakeSchema<dxgk::DmaPacket_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"hContext", 8 }, { L"ulQueueSubmitSequence", 4 } });
+    const auto queuePacketStart = MakeSchema<dxgk::QueuePacket_Start>(dxgk::GUID, Handler::DXGK,
+        { { L"PacketType", 4 }, { L"SubmitSequence", 4 }, { L"hContext", 8 }, { L"bPresent", 4 } });
+    const auto queuePacketStop = MakeSchema<dxgk::QueuePacket_Stop>(dxgk::GUID, Handler::DXGK,
+        { { L"hContext", 8 }, { L"SubmitSequence", 4 } });
+    const auto flipInfo = MakeSchema<dxgk::Flip_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"FlipInterval", 4 }, { L"MMIOFlip", 4 } });
+    const auto mmioFlipInfo = MakeSchema<dxgk::MMIOFlip_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"FlipSubmitSequence", 4 }, { L"Flags", 4 } });
+    const auto vsyncDpcInfo = MakeSchema<dxgk::VSyncDPC_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"FlipFenceId", 8 } });
+    const auto vsyncDpcMultiPlaneInfo = MakeSchema<dxgk::VSyncDPCMultiPlane_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"PlaneCount", 4 }, { L"PresentIdOrPhysicalAddress", 8, 0 }, { L"FlipEntryCount", 4 }, { L"FlipSubmitSequence", 8, 2 } });
+    const auto dxgkPresentInfo = MakeSchema<dxgk::Present_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"hWindow", 8 } });
+    const auto presentHistoryDetailedStart = MakeSchema<dxgk::PresentHistoryDetailed_Start>(dxgk::GUID, Handler::DXGK,
+        { { L"Token", 8 }, { L"Model", 4 }, { L"TokenData", 8 } });
+    const auto presentHistoryInfo = MakeSchema<dxgk::PresentHistory_Info>(dxgk::GUID, Handler::DXGK,
+        { { L"Token", 8 } });
+    const auto tokenCompositionSurfaceObjectInfo = MakeSchema<win32k::TokenCompositionSurfaceObject_Info>(win32k::GUID, Handler::Win32k,
+        { { L"CompositionSurfaceLuid", 8 }, { L"PresentCount", 8 }, { L"BindId", 8 }, { L"DestWidth", 4 }, { L"DestHeight", 4 } });
+    const auto tokenStateChangedInfo = MakeSchema<win32k::TokenStateChanged_Info>(win32k::GUID, Handler::Win32k,
+        { { L"CompositionSurfaceLuid", 8 }, { L"PresentCount", 4 }, { L"BindId", 8 }, { L"NewState", 4 }, { L"IndependentFlip", 4 } });
+    const auto schedulePresentStart = MakeSchema<dwm::SCHEDULE_PRESENT_Start>(dwm::GUID, Handler::DWM,
+        {});
+    const auto scheduleSurfaceUpdateInfo = MakeSchema<dwm::SCHEDULE_SURFACEUPDATE_Info>(dwm::GUID, Handler::DWM,
+        { { L"luidSurface", 8 }, { L"PresentCount", 8 }, { L"bindId", 8 } });
+    const auto inputDeviceReadStop = MakeSchema<win32k::InputDeviceRead_Stop>(win32k::GUID, Handler::Win32k,
+        { { L"DeviceType", 4 } });
+    const auto onInputXformUpdateInfo = MakeSchema<win32k::OnInputXformUpdate_Info>(win32k::GUID, Handler::Win32k,
+        { { L"Hwnd", 8 }, { L"XformQPCTime", 8 } });
+    const auto retrieveInputMessageInfo = MakeSchema<win32k::RetrieveInputMessage_Info>(win32k::GUID, Handler::Win32k,
+        { { L"hwnd", 8 } });
+    const auto processStop = MakeSchema<kernelProcess::ProcessStop_Stop>(kernelProcess::GUID, Handler::Process,
+        { { L"ProcessID", 4 } });
+
+    const EtwEventSchema* const allSchemas[] = {
+        &dxgiPresentStart, &dxgiPresentStop, &deviceStart, &contextStart, &dmaPacketStart, &dmaPacketInfo,
+        &queuePacketStart, &queuePacketStop, &flipInfo, &mmioFlipInfo, &vsyncDpcInfo, &vsyncDpcMultiPlaneInfo,
+        &dxgkPresentInfo, &presentHistoryDetailedStart, &presentHistoryInfo, &tokenCompositionSurfaceObjectInfo,
+        &tokenStateChangedInfo, &schedulePresentStart, &scheduleSurfaceUpdateInfo, &inputDeviceReadStop,
+        &onInputXformUpdateInfo, &retrieveInputMessageInfo, &processStop,
+    };
+
+    // builds the TRACE_EVENT_INFO that TDH would return for the schema
+    std::vector<uint8_t> MakeTraceEventInfo(const EtwEventSchema& schema)
+    {
+        const auto propertyCount = uint32_t(schema.properties.size());
+        const auto namesOffset = uint32_t(offsetof(TRACE_EVENT_INFO, EventPropertyInfoArray) +
+            std::max(propertyCount, 1u) * sizeof(EVENT_PROPERTY_INFO));
+        const auto size = std::accumulate(schema.properties.begin(), schema.properties.end(), size_t(namesOffset),
+            [](size_t total, const EtwEventSchema::Property& p) { return total + (wcslen(p.name) + 1) * sizeof(wchar_t); });
+
+        std::vector<uint8_t> blob(size);
+        auto tei = (TRACE_EVENT_INFO*)blob.data();
+        tei->ProviderGuid = schema.provider;
+        tei->EventDescriptor = schema.descriptor;
+        tei->DecodingSource = DecodingSourceXMLFile;
+        tei->PropertyCount = propertyCount;
+        tei->TopLevelPropertyCount = propertyCount;
+        auto nameOffset = namesOffset;
+        for (uint32_t i = 0; i < propertyCount; i++) {
+            const auto& property = schema.properties[i];
+            auto& epi = tei->EventPropertyInfoArray[i];
+            epi.NameOffset = nameOffset;
+            epi.nonStructType.InType = USHORT(property.size == 8 ? TDH_INTYPE_UINT64 : TDH_INTYPE_UINT32);
+            epi.length = property.size;
+            if (property.countIndex == UINT16_MAX) {
+                epi.count = 1;
+            }
+            else {
+                epi.Flags = PropertyParamCount;
+                epi.countPropertyIndex = property.countIndex;
+            }
+            const auto nameSize = (wcslen(property.name) + 1) * sizeof(wchar_t);
+            std::memcpy(blob.data() + nameOffset, property.name, nameSize);
+            nameOffset += uint32_t(nameSize);
+        }
+        return blob;
+    }
+
+    constexpr uint64_t adapter = 0xA000'0000;
+    constexpr uint64_t dwmDevice = 0xD000'0000;
+    constexpr uint64_t dwmContext = 0xC000'0000;
+    constexpr uint64_t bindId = 1;
+}
+
+struct EtwStreamGenerator::SwapChain_
+{
+    PresentMode mode;
+    uint32_t index;
+    uint32_t processId;
+    uint32_t threadId;
+    uint64_t address;
+    uint64_t hwnd;
+    uint64_t surfaceLuid;
+    uint64_t hContext;
+    // qpc range the swap chain's process is alive for
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct EtwStreamGenerator::ComposedPresent_
+{
+    uint64_t readyQpc;
+    uint64_t hwnd;
+    uint64_t surfaceLuid;
+    uint64_t presentCount;
+};
+
+EtwStreamGenerator::EtwStreamGenerator(const Params& params)
+    :
+    params_{ params },
+    refreshPeriod_{ uint64_t(qpcFrequency / params.refreshHz) },
+    rng_{ params.seed }
+{
+    // device and context start events come first, as from a capture state request
+    uint64_t qpc = 1;
+    Add_(qpc++, dwmProcessId_, dwmThreadId_, deviceStart, { adapter, dwmDevice });
+    Add_(qpc++, dwmProcessId_, dwmThreadId_, contextStart, { dwmContext, dwmDevice, 0 });
+
+    std::vector<SwapChain_> swapChains;
+    const auto swapChainCount = params.processCount * params.swapChainsPerProcess;
+    const auto end = uint64_t(params.durationSeconds * qpcFrequency);
+    const auto lifetime = params.processLifetimeSeconds > 0. ? uint64_t(params.processLifetimeSeconds * qpcFrequency) : end;
+    uint32_t processIndex = 0;
+    for (uint64_t begin = 0; begin < end; begin += lifetime) {
+        // each generation of processes starts with their device and context start events
+        qpc = std::max(qpc, begin);
+        for (uint32_t p = 0; p < params.processCount; p++, processIndex++) {
+            const auto processId = 1000 + 4 * processIndex;
+            const auto hDevice = dwmDevice + 0x100 * uint64_t(processIndex + 1);
+            Add_(qpc++, processId, processId + 4, deviceStart, { adapter, hDevice });
+            for (uint32_t s = 0; s < params.swapChainsPerProcess; s++) {
+                SwapChain_ swapChain{};
+                swapChain.index = uint32_t(swapChains.size());
+                swapChain.mode = PresentMode::Hardware_Legacy_Flip;
+                if (params.dwmComposition) {
+                    const auto position = (swapChain.index % swapChainCount + 0.5) / swapChainCount;
+                    if (position < params.composedFlipFraction) {
+                        swapChain.mode = PresentMode::Composed_Flip;
+                    }
+                    else if (position < params.composedFlipFraction + params.independentFlipFraction) {
+                        swapChain.mode = PresentMode::Hardware_Independent_Flip;
+                    }
+                }
+                swapChain.processId = processId;
+                swapChain.threadId = 100'000 + 4 * swapChain.index;
+                swapChain.address = 0x5'C000'0000 + 0x1000 * uint64_t(swapChain.index);
+                swapChain.hwnd = 0x1'0000 + 2 * uint64_t(swapChain.index);
+                swapChain.surfaceLuid = 0x100'0000 + uint64_t(swapChain.index);
+                swapChain.hContext = dwmContext + 0x100 * uint64_t(swapChain.index + 1);
+                swapChain.begin = begin;
+                swapChain.end = std::min(begin + lifetime, end);
+                Add_(qpc++, processId, swapChain.threadId, contextStart, { swapChain.hContext, hDevice, 0 });
+                swapChains.push_back(swapChain);
+            }
+            // the process stops once its last frame has completed
+            if (params.processStopEvents && begin + lifetime < end) {
+                Add_(begin + lifetime + qpcFrequency / 10, 0, 0, processStop, { processId });
+            }
+        }
+    }
+
+    std::vector<ComposedPresent_> composed;
+    for (auto& swapChain : swapChains) {
+        GenerateSwapChain_(swapChain, composed);
+    }
+    if (params.dwmComposition) {
+        GenerateDwmFrames_(composed);
+    }
+
+    // events were generated one sequence at a time, interleave them and point them at their data
+    std::ranges::stable_sort(events_, {}, [](const Event& e) { return e.record.EventHeader.TimeStamp.QuadPart; });
+    for (auto& event : events_) {
+        event.record.UserData = userData_.data() + uintptr_t(event.record.UserContext);
+        event.record.UserContext = nullptr;
+    }
+}
+
+void EtwStreamGenerator::RegisterMetadata(PMTraceConsumer& consumer) const
+{
+    for (auto schema : allSchemas) {
+        EventMetadataKey key;
+        key.guid_ = schema->provider;
+        key.desc_ = schema->descriptor;
+        consumer.mMetadata.metadata_[key] = MakeTraceEventInfo(*schema);
+    }
+}
+
+uint32_t EtwStreamGenerator::GetPresentCount(PresentMode mode) const
+{
+    return presentCounts_[size_t(mode)];
+}
+
+uint32_t EtwStreamGenerator::GetPresentCount() const
+{
+    return std::accumulate(std::begin(presentCounts_), std::end(presentCounts_), 0u);
+}
+
+void EtwStreamGenerator::Dispatch(PMTraceConsumer& consumer, Event& event)
+{
+    consumer.CountEventForTrackingStateSweep(event.record.EventHeader.TimeStamp.QuadPart);
+    switch (event.handler) {
+    case Handler::DXGI: consumer.HandleDXGIEvent(&event.record); break;
+    case Handler::DXGK: consumer.HandleDXGKEvent(&event.record); break;
+    case Handler::Win32k: consumer.HandleWin32kEvent(&event.record); break;
+    case Handler::DWM: consumer.HandleDWMEvent(&event.record); break;
+    case Handler::Process: consumer.HandleProcessEvent(&event.record); break;
+    case Handler::Count: break;
+    }
+}
+
+void EtwStreamGenerator::GenerateSwapChain_(SwapChain_& swapChain, std::vector<ComposedPresent_>& composed)
+{
+    const auto pid = swapChain.processId;
+    const auto tid = swapChain.threadId;
+    const auto period = double(qpcFrequency) / params_.fps;
+    const auto end = swapChain.end;
+    const uint64_t inPresent = qpcFrequency / 5000;
+    // gpu work for a frame takes most of the frame period, but finishes after the present call
+    const auto gpu = std::max(uint64_t(period * 0.6), inPresent + 100);
+    const auto packets = params_.gpuPacketsPerFrame;
+    const auto mmioFlip = uint64_t(dxgk::QueuePacketType::DXGKETW_MMIOFLIP_COMMAND_BUFFER);
+    std::uniform_real_distribution<double> jitter{ 0.95, 1.05 };
+
+    const auto inputPeriod = params_.inputHz > 0. ? uint64_t(qpcFrequency / params_.inputHz) : 0;
+    auto nextInput = swapChain.begin;
+    const auto idles = swapChain.index % 2 == 1 && params_.idleSeconds > 0.;
+    const auto idleBegin = params_.idleBeginSeconds * qpcFrequency;
+    const auto idleEnd = idleBegin + params_.idleSeconds * qpcFrequency;
+
+    auto t = swapChain.begin + qpcFrequency / 1000 + period * (1. + std::uniform_real_distribution<double>{ 0., 1. }(rng_));
+    for (uint64_t frame = 1; t < end; frame++, t += period * jitter(rng_)) {
+        if (idles && t >= idleBegin && t < idleEnd) {
+            t = idleEnd;
+            if (t >= end) {
+                break;
+            }
+        }
+        const auto t0 = uint64_t(t);
+        const auto ready = t0 + gpu;
+
+        // a mouse click is read, updates the window's transform, and is retrieved by the
+        // window just before the present it is applied to
+        if (inputPeriod != 0 && t0 >= nextInput) {
+            const uint64_t mouse = 0;
+            Add_(t0 - 60, 0, 0, inputDeviceReadStop, { mouse });
+            Add_(t0 - 50, 0, 0, onInputXformUpdateInfo, { swapChain.hwnd, t0 - 55 });
+            Add_(t0 - 40, pid, tid, retrieveInputMessageInfo, { swapChain.hwnd });
+            nextInput += inputPeriod;
+        }
+
+        // render packets are submitted while the frame is built and complete before it is ready
+        for (uint32_t k = 0; k < packets; k++) {
+            const auto sequence = nextSubmitSequence_++;
+            const auto submit = t0 - uint64_t(period / 2) + uint64_t(period / 2 * k / packets);
+            const auto complete = t0 + gpu * (k + 1) / packets - 20;
+            const auto render = uint64_t(dxgk::QueuePacketType::DXGKETW_RENDER_COMMAND_BUFFER);
+            Add_(submit, pid, tid, queuePacketStart, { render, sequence, swapChain.hContext, FALSE });
+            Add_(submit + 5, pid, tid, dmaPacketStart, { swapChain.hContext, sequence });
+            Add_(complete, 0, 0, dmaPacketInfo, { swapChain.hContext, sequence });
+            Add_(complete + 5, 0, 0, queuePacketStop, { swapChain.hContext, sequence });
+        }
+
+        const auto sequence = nextSubmitSequence_++;
+        const auto token = (uint64_t(swapChain.index + 1) << 32) | frame;
+        Add_(t0, pid, tid, dxgiPresentStart, { swapChain.address, 0, 1 });
+        if (swapChain.mode == PresentMode::Hardware_Legacy_Flip) {
+            Add_(t0 + 10, pid, tid, flipInfo, { 1, TRUE });
+            Add_(t0 + 20, pid, tid, queuePacketStart, { mmioFlip, sequence, swapChain.hContext, TRUE });
+        }
+        else {
+            Add_(t0 + 10, pid, tid, tokenCompositionSurfaceObjectInfo, { swapChain.surfaceLuid, frame, bindId, 1920, 1080 });
+            Add_(t0 + 20, pid, tid, presentHistoryDetailedStart,
+                { token, uint64_t(dxgk::PresentModel::D3DKMT_PM_REDIRECTED_FLIP), 0 });
+            if (swapChain.mode == PresentMode::Hardware_Independent_Flip) {
+                Add_(t0 + 30, pid, tid, queuePacketStart, { mmioFlip, sequence, swapChain.hContext, TRUE });
+            }
+            Add_(t0 + 40, pid, tid, dxgkPresentInfo, { swapChain.hwnd });
+            Add_(ready, pid, tid, presentHistoryInfo, { token });
+        }
+        Add_(t0 + inPresent, pid, tid, dxgiPresentStop, { S_OK });
+
+        switch (swapChain.mode) {
+        case PresentMode::Hardware_Legacy_Flip:
+        {
+            const auto vsync = NextVSync_(ready);
+            Add_(ready, 0, 0, mmioFlipInfo, { sequence, 0 });
+            Add_(vsync, 0, 0, vsyncDpcInfo, { uint64_t(sequence) << 32 });
+            Add_(vsync + 10, 0, 0, queuePacketStop, { swapChain.hContext, sequence });
+            break;
+        }
+        case PresentMode::Hardware_Independent_Flip:
+        {
+            const auto vsync = NextVSync_(ready + 10);
+            Add_(ready + 10, 0, 0, mmioFlipInfo, { sequence, 0 });
+            Add_(vsync, 0, 0, vsyncDpcInfo, { uint64_t(sequence) << 32 });
+            Add_(vsync + 1, 0, 0, vsyncDpcMultiPlaneInfo, { 1, swapChain.address, 1, uint64_t(sequence) << 32 });
+            Add_(vsync + 10, 0, 0, queuePacketStop, { swapChain.hContext, sequence });
+            break;
+        }
+        default:
+            composed.push_back({ ready, swapChain.hwnd, swapChain.surfaceLuid, frame });
+            break;
+        }
+        presentCounts_[size_t(swapChain.mode)]++;
+    }
+}
+
+void EtwStreamGenerator::GenerateDwmFrames_(std::vector<ComposedPresent_>& composed)
+{
+    const auto end = uint64_t(params_.durationSeconds * qpcFrequency);
+    // dwm starts composing a frame 1 ms before the vsync it is displayed at
+    const auto lead = qpcFrequency / 1000;
+    const auto mmioFlip = uint64_t(dxgk::QueuePacketType::DXGKETW_MMIOFLIP_COMMAND_BUFFER);
+    const auto pid = dwmProcessId_;
+    const auto tid = dwmThreadId_;
+
+    std::ranges::sort(composed, {}, &ComposedPresent_::readyQpc);
+    auto next = composed.begin();
+    std::map<uint64_t, const ComposedPresent_*> latestByWindow;
+    for (auto vsync = refreshPeriod_; vsync < end; vsync += refreshPeriod_) {
+        auto qpc = vsync - lead;
+
+        // only the latest present of each window ready by now is composed, the rest are discarded
+        latestByWindow.clear();
+        for (; next != composed.end() && next->readyQpc < qpc; ++next) {
+            auto& latest = latestByWindow[next->hwnd];
+            if (latest) {
+                Add_(qpc++, pid, tid, tokenStateChangedInfo, { latest->surfaceLuid, latest->presentCount, bindId,
+                    uint64_t(win32k::TokenState::Discarded), FALSE });
+            }
+            latest = &*next;
+        }
+        if (latestByWindow.empty()) {
+            continue;
+        }
+        for (auto& [hwnd, present] : latestByWindow) {
+            Add_(qpc++, pid, tid, tokenStateChangedInfo, { present->surfaceLuid, present->presentCount, bindId,
+                uint64_t(win32k::TokenState::InFrame), FALSE });
+            Add_(qpc++, pid, tid, scheduleSurfaceUpdateInfo, { present->surfaceLuid, present->presentCount, bindId });
+            Add_(qpc++, pid, tid, tokenStateChangedInfo, { present->surfaceLuid, present->presentCount, bindId,
+                uint64_t(win32k::TokenState::Confirmed), FALSE });
+        }
+
+        const auto sequence = nextSubmitSequence_++;
+        Add_(qpc++, pid, tid, schedulePresentStart, {});
+        Add_(qpc++, pid, tid, flipInfo, { 1, TRUE });
+        Add_(qpc++, pid, tid, queuePacketStart, { mmioFlip, sequence, dwmContext, TRUE });
+        Add_(qpc++, 0, 0, mmioFlipInfo, { sequence, 0 });
+        Add_(vsync, 0, 0, vsyncDpcInfo, { uint64_t(sequence) << 32 });
+        Add_(vsync + 10, pid, tid, queuePacketStop, { dwmContext, sequence });
+    }
+}
+
+void EtwStreamGenerator::Add_(uint64_t qpc, uint32_t pid, uint32_t tid, const EtwEventSchema& schema, std::initializer_list<uint64_t> values)
+{
+    assert(values.size() == schema.properties.size());
+    Event event{};
+    event.handler = schema.handler;
+    auto& hdr = event.record.EventHeader;
+    hdr.Size = sizeof(EVENT_HEADER);
+    hdr.Flags = EVENT_HEADER_FLAG_64_BIT_HEADER;
+    hdr.ThreadId = tid;
+    hdr.ProcessId = pid;
+    hdr.TimeStamp.QuadPart = LONGLONG(qpc);
+    hdr.ProviderId = schema.provider;
+    hdr.EventDescriptor = schema.descriptor;
+
+    // user data is appended to one buffer, the offset is kept in UserContext until generation is done
+    const auto offset = userData_.size();
+    auto value = values.begin();
+    for (auto& property : schema.properties) {
+        const auto bytes = (const uint8_t*)&*value++;
+        userData_.insert(userData_.end(), bytes, bytes + property.size);
+    }
+    event.record.UserDataLength = USHORT(userData_.size() - offset);
+    event.record.UserContext = (PVOID)uintptr_t(offset);
+    events_.push_back(event);
+}
+
+uint64_t EtwStreamGenerator::NextVSync_(uint64_t qpc) const
+{
+    return (qpc / refreshPeriod_ + 1) * refreshPeriod_;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "../../PresentData/PresentMonTraceConsumer.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct EtwEventSchema;
+
+// generates the ETW events PMTraceConsumer analyzes for a set of presenting processes, with
+// metadata for each event so it can be decoded without TDH or an ETL
+//
+// each swap chain presents through one of three paths:
+//   Hardware_Legacy_Flip: DXGI Present, DxgKrnl Flip/MMIOFLIP packet, MMIOFlip and VSyncDPC
+//   Composed_Flip: DXGI Present, Win32k token, DxgKrnl present history, then composed by a DWM
+//     present (Win32k token state changes, DWM surface update, DWM flip to the display)
+//   Hardware_Independent_Flip: as Composed_Flip, but the app's own MMIOFLIP packet is flipped
+//     directly and completed by VSyncDPCMultiPlane
+// with dwm composition off every swap chain uses Hardware_Legacy_Flip
+//
+// processes can also be given a lifetime, after which each is replaced by a new process with its
+// own ids, device, contexts and windows; the old process' stop events are never generated, as if
+// they were lost, unless processStopEvents is set
+class EtwStreamGenerator
+{
+public:
+    // the PMTraceConsumer::Handle* function an event is dispatched to
+    enum class Handler
+    {
+        DXGI,
+        DXGK,
+        Win32k,
+        DWM,
+        Process,
+        Count,
+    };
+    struct Params
+    {
+        uint32_t processCount = 4;
+        uint32_t swapChainsPerProcess = 1;
+        // fractions of swap chains presenting through each path, the rest use Hardware_Legacy_Flip
+        double composedFlipFraction = 0.5;
+        double independentFlipFraction = 0.25;
+        double fps = 144.;
+        double refreshHz = 60.;
+        // render packets (queue packet + dma packet) submitted by each frame; these are only
+        // analyzed when the consumer tracks GPU work
+        uint32_t gpuPacketsPerFrame = 0;
+        bool dwmComposition = true;
+        double durationSeconds = 2.;
+        uint32_t seed = 0;
+        // 0 for processes that present for the whole stream
+        double processLifetimeSeconds = 0.;
+        // generate a process stop event at the end of each replaced process' lifetime (the
+        // device and context stop events are still never generated)
+        bool processStopEvents = false;
+        // swap chains with an odd index stop presenting and submitting gpu work for idleSeconds
+        // from idleBeginSeconds, while the others keep presenting
+        double idleBeginSeconds = 0.;
+        double idleSeconds = 0.;
+        // mouse clicks retrieved by each swap chain's window per second; these are only analyzed
+        // when the consumer tracks input
+        double inputHz = 0.;
+    };
+    struct Event
+    {
+        Handler handler;
+        EVENT_RECORD record;
+    };
+    static constexpr uint64_t qpcFrequency = 10'000'000;
+
+    explicit EtwStreamGenerator(const Params& params);
+    EtwStreamGenerator(const EtwStreamGenerator&) = delete;
+    EtwStreamGenerator& operator=(const EtwStreamGenerator&) = delete;
+    // adds the metadata of every generated event type to consumer
+    void RegisterMetadata(PMTraceConsumer& consumer) const;
+    // events ordered by timestamp
+    std::vector<Event>& GetEvents() { return events_; }
+    // number of application presents generated for each PresentMode
+    uint32_t GetPresentCount(PresentMode mode) const;
+    uint32_t GetPresentCount() const;
+    uint32_t GetDwmProcessId() const { return dwmProcessId_; }
+    // calls the consumer's Handle* function for the event, after counting it towards the
+    // consumer's tracking state sweep as EventRecordCallback does
+    static void Dispatch(PMTraceConsumer& consumer, Event& event);
+private:
+    struct SwapChain_;
+    struct ComposedPresent_;
+    void GenerateSwapChain_(SwapChain_& swapChain, std::vector<ComposedPresent_>& composed);
+    void GenerateDwmFrames_(std::vector<ComposedPresent_>& composed);
+    void Add_(uint64_t qpc, uint32_t pid, uint32_t tid, const EtwEventSchema& schema, std::initializer_list<uint64_t> values);
+    uint64_t NextVSync_(uint64_t qpc) const;
+    Params params_;
+    uint64_t refreshPeriod_;
+    uint32_t dwmProcessId_ = 4;
+    uint32_t dwmThreadId_ = 8;
+    uint32_t nextSubmitSequence_ = 1;
+    std::minstd_rand rng_;
+    uint32_t presentCounts_[(size_t)PresentMode::Hardware_Composed_Independent_Flip + 1] = {};
+    std::vector<Event> events_;
+    std::vector<uint8_t> userData_;
+};
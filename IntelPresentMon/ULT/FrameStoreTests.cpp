@@ -0,0 +1,223 @@
+#include "gtest/gtest.h"
+#include "../Streamer/FrameStore.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    class FrameStoreTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            dir_ = std::filesystem::temp_directory_path() /
+                ("pm_frame_store_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+            std::filesystem::remove_all(dir_);
+            std::filesystem::create_directories(dir_);
+            path_ = (dir_ / "frames.pmfs").string();
+        }
+        void TearDown() override
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(dir_, ec);
+        }
+        static LARGE_INTEGER Frequency()
+        {
+            LARGE_INTEGER f{};
+            f.QuadPart = 10'000'000;
+            return f;
+        }
+        // frame i starts at 1000 + 100 * i, every 'displayedEvery' frame is displayed
+        static PmNsmFrameData MakeFrame(uint64_t i, uint64_t displayedEvery = 1)
+        {
+            PmNsmFrameData frame{};
+            frame.present_event.PresentStartTime = 1000 + 100 * i;
+            frame.present_event.FrameId = uint32_t(i);
+            if (i % displayedEvery == 0) {
+                frame.present_event.FinalState = PresentResult::Presented;
+                frame.present_event.ScreenTime = frame.present_event.PresentStartTime + 50;
+            }
+            else {
+                frame.present_event.FinalState = PresentResult::Discarded;
+            }
+            return frame;
+        }
+        std::filesystem::path dir_;
+        std::string path_;
+    };
+}
+
+TEST_F(FrameStoreTest, RoundTripAcrossSegments)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 16 };
+    ASSERT_TRUE(writer.IsValid());
+    writer.RecordFirstFrameTime(900);
+    for (uint64_t i = 0; i < 100; i++) {
+        writer.WriteFrameData(MakeFrame(i), GpuTelemetryBitset{}.set(1), CpuTelemetryBitset{}.set(2));
+    }
+
+    FrameStoreReader reader{ path_ };
+    ASSERT_TRUE(reader.IsValid());
+    EXPECT_EQ(100u, reader.GetNumFrames());
+    EXPECT_EQ(900u, reader.GetStartQpc());
+    EXPECT_EQ(10'000'000, reader.GetQpcFrequency().QuadPart);
+    EXPECT_TRUE(reader.GetGpuTelemetryCaps().test(1));
+    EXPECT_TRUE(reader.GetCpuTelemetryCaps().test(2));
+    EXPECT_FALSE(reader.IsComplete());
+    for (uint64_t i = 0; i < 100; i++) {
+        ASSERT_NE(nullptr, reader.ReadFrameByIdx(i));
+        EXPECT_EQ(uint32_t(i), reader.ReadFrameByIdx(i)->present_event.FrameId);
+    }
+    EXPECT_EQ(nullptr, reader.ReadFrameByIdx(100));
+    EXPECT_TRUE(std::filesystem::exists(GetFrameStoreSegmentPath(path_, 6)));
+    EXPECT_FALSE(std::filesystem::exists(GetFrameStoreSegmentPath(path_, 7)));
+}
+
+TEST_F(FrameStoreTest, ReaderSeesAppendsAfterRefresh)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 8 };
+    FrameStoreReader reader{ path_ };
+    ASSERT_TRUE(reader.IsValid());
+    EXPECT_EQ(0u, reader.GetNumFrames());
+    EXPECT_EQ(0u, reader.GetLatestQpc());
+
+    for (uint64_t i = 0; i < 5; i++) {
+        writer.WriteFrameData(MakeFrame(i), {}, {});
+    }
+    EXPECT_EQ(0u, reader.GetNumFrames());
+    EXPECT_EQ(5u, reader.Refresh());
+    // pointers stay valid while the store grows into new segments
+    const auto pFirst = reader.ReadFrameByIdx(0);
+    for (uint64_t i = 5; i < 30; i++) {
+        writer.WriteFrameData(MakeFrame(i), {}, {});
+    }
+    EXPECT_EQ(30u, reader.Refresh());
+    EXPECT_EQ(pFirst, reader.ReadFrameByIdx(0));
+    EXPECT_EQ(1000u + 100 * 29, reader.GetLatestQpc());
+
+    EXPECT_FALSE(reader.IsComplete());
+    writer.MarkComplete();
+    EXPECT_TRUE(reader.IsComplete());
+}
+
+TEST_F(FrameStoreTest, CompletedStoreOutlivesWriter)
+{
+    {
+        FrameStoreWriter writer{ path_, Frequency() };
+        for (uint64_t i = 0; i < 10; i++) {
+            writer.WriteFrameData(MakeFrame(i), {}, {});
+        }
+    }
+    FrameStoreReader reader{ path_ };
+    ASSERT_TRUE(reader.IsValid());
+    EXPECT_EQ(10u, reader.GetNumFrames());
+    EXPECT_TRUE(reader.IsComplete());
+}
+
+TEST_F(FrameStoreTest, RejectsMissingOrForeignFile)
+{
+    FrameStoreReader missing{ path_ };
+    EXPECT_FALSE(missing.IsValid());
+    {
+        std::ofstream file{ path_, std::ios::binary };
+        file << std::string(sizeof(FrameStoreHeader), 'x');
+    }
+    FrameStoreReader foreign{ path_ };
+    EXPECT_FALSE(foreign.IsValid());
+}
+
+TEST_F(FrameStoreTest, TimeLookupUsesRunningMaxStart)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 4 };
+    // frames complete out of start order: 1000, 1300, 1200, 1400, 1500
+    for (auto start : { 1000, 1300, 1200, 1400, 1500 }) {
+        auto frame = MakeFrame(0);
+        frame.present_event.PresentStartTime = start;
+        writer.WriteFrameData(frame, {}, {});
+    }
+    FrameStoreReader reader{ path_ };
+    EXPECT_EQ(0u, reader.LowerBound(0));
+    EXPECT_EQ(0u, reader.LowerBound(1000));
+    EXPECT_EQ(1u, reader.LowerBound(1001));
+    // the 1200 frame is keyed by the 1300 that preceded it
+    EXPECT_EQ(1u, reader.LowerBound(1200));
+    EXPECT_EQ(3u, reader.UpperBound(1300));
+    EXPECT_EQ(4u, reader.LowerBound(1500));
+    EXPECT_EQ(5u, reader.UpperBound(1500));
+    EXPECT_EQ(5u, reader.LowerBound(99'999));
+    EXPECT_EQ(5u, reader.UpperBound(UINT64_MAX));
+    EXPECT_EQ(1500u, reader.GetLatestQpc());
+}
+
+TEST_F(FrameStoreTest, FrameSetNeighbours)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 4 };
+    // frames 0, 3, 6, ... are displayed
+    for (uint64_t i = 0; i < 8; i++) {
+        writer.WriteFrameData(MakeFrame(i, 3), {}, {});
+    }
+    FrameStoreReader reader{ path_ };
+    FrameStoreFrameSet set;
+
+    // first frame has no previous frames
+    ASSERT_TRUE(reader.ReadFrameSet(0, set));
+    EXPECT_EQ(reader.ReadFrameByIdx(0), set.frame);
+    EXPECT_EQ(reader.ReadFrameByIdx(3), set.next_displayed);
+    EXPECT_EQ(nullptr, set.last_presented);
+    EXPECT_EQ(nullptr, set.last_displayed);
+
+    ASSERT_TRUE(reader.ReadFrameSet(5, set));
+    EXPECT_EQ(reader.ReadFrameByIdx(5), set.frame);
+    EXPECT_EQ(reader.ReadFrameByIdx(6), set.next_displayed);
+    EXPECT_EQ(reader.ReadFrameByIdx(4), set.last_presented);
+    EXPECT_EQ(reader.ReadFrameByIdx(3), set.last_displayed);
+    EXPECT_EQ(reader.ReadFrameByIdx(2), set.previous_of_last_displayed);
+
+    // next displayed frame (9) has not been written yet
+    EXPECT_FALSE(reader.ReadFrameSet(6, set));
+    EXPECT_EQ(nullptr, set.frame);
+    writer.WriteFrameData(MakeFrame(8, 3), {}, {});
+    writer.WriteFrameData(MakeFrame(9, 3), {}, {});
+    reader.Refresh();
+    ASSERT_TRUE(reader.ReadFrameSet(6, set));
+    EXPECT_EQ(reader.ReadFrameByIdx(9), set.next_displayed);
+    EXPECT_EQ(reader.ReadFrameByIdx(3), set.last_displayed);
+}
+
+TEST_F(FrameStoreTest, FrameSetLookaheadIsBounded)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 1024 };
+    // only frame 0 is displayed
+    for (uint64_t i = 0; i < 5000; i++) {
+        writer.WriteFrameData(MakeFrame(i, 10'000), {}, {});
+    }
+    FrameStoreReader reader{ path_ };
+    FrameStoreFrameSet set;
+
+    // no displayed frame within the lookahead, the frame is returned so the caller can move past it
+    ASSERT_TRUE(reader.ReadFrameSet(1, set));
+    EXPECT_EQ(reader.ReadFrameByIdx(1), set.frame);
+    EXPECT_EQ(nullptr, set.next_displayed);
+    // near the end the next displayed frame might still be written
+    EXPECT_FALSE(reader.ReadFrameSet(4990, set));
+}
+
+TEST_F(FrameStoreTest, RemoveFilesDeletesStore)
+{
+    FrameStoreWriter writer{ path_, Frequency(), 8 };
+    for (uint64_t i = 0; i < 20; i++) {
+        writer.WriteFrameData(MakeFrame(i), {}, {});
+    }
+    ASSERT_TRUE(std::filesystem::exists(GetFrameStoreSegmentPath(path_, 2)));
+    writer.RemoveFiles();
+    EXPECT_FALSE(writer.IsValid());
+    EXPECT_FALSE(std::filesystem::exists(path_));
+    for (uint64_t segment = 0; segment < 3; segment++) {
+        EXPECT_FALSE(std::filesystem::exists(GetFrameStoreSegmentPath(path_, segment)));
+    }
+    // later frames are dropped
+    writer.WriteFrameData(MakeFrame(20), {}, {});
+    EXPECT_FALSE(std::filesystem::exists(GetFrameStoreSegmentPath(path_, 0)));
+}
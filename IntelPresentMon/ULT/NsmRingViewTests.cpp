@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "../Streamer/NsmRingView.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr uint64_t kQpcFrequency = 10'000'000;
+
+    // ring of 'capacity' slots holding 'count' frames 'period' ticks apart, the oldest in slot 'first'
+    class Ring
+    {
+    public:
+        Ring(uint64_t capacity, uint64_t first, uint64_t count, uint64_t period = 100)
+            :
+            slots_(capacity)
+        {
+            view_ = NsmRingView{ slots_.data(), capacity, first, count };
+            for (uint64_t i = 0; i < count; i++) {
+                view_.At(i).present_event.PresentStartTime = 1000 + period * i;
+                view_.At(i).present_event.FrameId = uint32_t(i);
+            }
+        }
+        const NsmRingView& View() const { return view_; }
+    private:
+        std::vector<PmNsmFrameData> slots_;
+        NsmRingView view_;
+    };
+
+    // position of the oldest frame in the window ending at the newest frame, found by
+    // stepping back one frame at a time as dynamic queries did before the ring view
+    uint64_t FindWindowStartLinear(const NsmRingView& view, uint64_t end_qpc)
+    {
+        auto position = view.count - 1;
+        while (position > 0 && view.At(position - 1).present_event.PresentStartTime > end_qpc) {
+            position--;
+        }
+        return position;
+    }
+}
+
+TEST(NsmRingView, UpperBoundAcrossWrap)
+{
+    Ring ring{ 8, 5, 7 };
+    const auto& view = ring.View();
+    EXPECT_EQ(5u, view.ToIndex(0));
+    EXPECT_EQ(3u, view.ToIndex(6));
+    EXPECT_EQ(0u, view.UpperBound(0));
+    EXPECT_EQ(0u, view.UpperBound(999));
+    EXPECT_EQ(1u, view.UpperBound(1000));
+    EXPECT_EQ(3u, view.UpperBound(1250));
+    EXPECT_EQ(3u, view.UpperBound(1299));
+    EXPECT_EQ(4u, view.UpperBound(1300));
+    EXPECT_EQ(7u, view.UpperBound(1600));
+    EXPECT_EQ(7u, view.UpperBound(UINT64_MAX));
+}
+
+TEST(NsmRingView, EmptyView)
+{
+    NsmRingView view;
+    EXPECT_TRUE(view.IsEmpty());
+    EXPECT_EQ(0u, view.UpperBound(1000));
+    for (auto span : view.GetSpans(0, 10)) {
+        EXPECT_TRUE(span.empty());
+    }
+}
+
+TEST(NsmRingView, SpansSplitAtWrap)
+{
+    Ring ring{ 8, 5, 7 };
+    const auto& view = ring.View();
+
+    // contiguous range before the wrap
+    auto spans = view.GetSpans(0, 3);
+    ASSERT_EQ(3u, spans[0].size());
+    EXPECT_TRUE(spans[1].empty());
+    EXPECT_EQ(&view.At(0), spans[0].data());
+
+    // range crossing the wrap, oldest first
+    spans = view.GetSpans(1, 7);
+    ASSERT_EQ(2u, spans[0].size());
+    ASSERT_EQ(4u, spans[1].size());
+    uint32_t expected = 1;
+    for (auto span : spans) {
+        for (auto& frame : span) {
+            EXPECT_EQ(expected++, frame.present_event.FrameId);
+        }
+    }
+
+    // range after the wrap, end clamped to the view
+    spans = view.GetSpans(4, 100);
+    ASSERT_EQ(3u, spans[0].size());
+    EXPECT_TRUE(spans[1].empty());
+    EXPECT_EQ(4u, spans[0].front().present_event.FrameId);
+
+    spans = view.GetSpans(5, 5);
+    EXPECT_TRUE(spans[0].empty());
+    EXPECT_TRUE(spans[1].empty());
+}
+
+TEST(NsmRingView, BinarySearchMatchesLinearWalk)
+{
+    Ring ring{ 1000, 700, 999, 37 };
+    const auto& view = ring.View();
+    const auto newest = view.At(view.count - 1).present_event.PresentStartTime;
+    for (uint64_t window = 1; window < 40'000; window += 13) {
+        const auto end_qpc = newest > window ? newest - window : 0;
+        const auto expected = FindWindowStartLinear(view, end_qpc);
+        EXPECT_EQ(expected, std::min(view.UpperBound(end_qpc), view.count - 1)) << window;
+    }
+}
+
+// reports the cost of locating the dynamic query window start at 240 fps for 1 s to 60 s windows
+TEST(NsmRingView, windowStartLookupVersusLinearWalk)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr uint64_t fps = 240;
+    constexpr uint64_t period = kQpcFrequency / fps;
+    constexpr uint64_t frameCount = 61 * fps;
+    // ring holding a bit more than the largest window, already wrapped
+    Ring ring{ frameCount + 1, frameCount / 3, frameCount, period };
+    const auto& view = ring.View();
+    const auto newest = view.At(view.count - 1).present_event.PresentStartTime;
+
+    for (uint64_t seconds : { 1, 5, 10, 30, 60 }) {
+        const auto end_qpc = newest - seconds * fps * period;
+        const auto measure = [&](auto&& find) {
+            constexpr int rounds = 200;
+            uint64_t sink = 0;
+            const auto t0 = Clock::now();
+            for (int r = 0; r < rounds; r++) {
+                sink += find(end_qpc - r);
+            }
+            const auto ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            return std::pair{ ns / rounds, sink };
+        };
+        const auto [linearNs, linearSink] = measure([&](uint64_t qpc) { return FindWindowStartLinear(view, qpc); });
+        const auto [searchNs, searchSink] = measure([&](uint64_t qpc) { return view.UpperBound(qpc); });
+        EXPECT_EQ(linearSink, searchSink);
+        std::cout << seconds << " s window (" << seconds * fps << " frames): linear " << linearNs
+            << " ns, binary search " << searchNs << " ns\n";
+    }
+}
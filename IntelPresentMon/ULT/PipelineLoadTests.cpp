@@ -0,0 +1,482 @@
+#include "gtest/gtest.h"
+#include "../Streamer/Streamer.h"
+#include "../Streamer/StreamClient.h"
+#include "../PresentMonMiddleware/FrameEventQuery.h"
+#include "../PresentMonMiddleware/DynamicQueryWindow.h"
+#include "PmFrameGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // synthetic application presenting into its own NSM stream
+    struct StreamParams
+    {
+        double fps = 60.;
+        double percentDropped = 0.;
+        bool telemetry = true;
+    };
+
+    // client polling a windowed statistic of a stream, like a dynamic query
+    struct DynamicClientParams
+    {
+        size_t stream = 0;
+        double pollHz = 10.;
+        double windowMs = 1000.;
+        double offsetMs = 0.;
+    };
+
+    // client consuming every frame of a stream, like a frame query
+    struct FrameClientParams
+    {
+        size_t stream = 0;
+        double pollHz = 60.;
+        uint32_t maxFramesPerPoll = 1024;
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        std::vector<StreamParams> streams;
+        std::vector<DynamicClientParams> dynamicClients;
+        std::vector<FrameClientParams> frameClients;
+    };
+
+    const Scenario kScenarios[] = {
+        { "single_stream", { { .fps = 240. } }, { { .pollHz = 10. } }, { { .pollHz = 60. } } },
+        { "mixed_clients",
+            { { .fps = 60., .percentDropped = 5. }, { .fps = 144., .percentDropped = 10., .telemetry = false },
+                { .fps = 500. } },
+            { { .stream = 0, .pollHz = 60. }, { .stream = 0, .pollHz = 10., .windowMs = 500., .offsetMs = 1000. },
+                { .stream = 1, .pollHz = 20., .windowMs = 2000. }, { .stream = 2, .pollHz = 60. },
+                { .stream = 2, .pollHz = 1., .windowMs = 10000. } },
+            { { .stream = 0, .pollHz = 30. }, { .stream = 1 }, { .stream = 2 }, { .stream = 2, .pollHz = 144. } } },
+        // consumes 500 of the 1000 frames written each second, so the ring overruns and the
+        // client loses frames
+        { "slow_frame_consumer", { { .fps = 1000. } }, { { .pollHz = 60. } },
+            { { .pollHz = 2., .maxFramesPerPoll = 250 } } },
+    };
+
+    // lead time between setting up a scenario and its first frame, so that every thread has
+    // started before the first frame is due
+    constexpr double kStartupLeadSeconds = 0.1;
+    // time the clients keep polling after the last frame has been written
+    constexpr double kDrainSeconds = 0.25;
+
+    LARGE_INTEGER QpcFrequency()
+    {
+        static const auto frequency = [] {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return f;
+        }();
+        return frequency;
+    }
+
+    uint64_t Now()
+    {
+        LARGE_INTEGER qpc;
+        QueryPerformanceCounter(&qpc);
+        return qpc.QuadPart;
+    }
+
+    double ThreadCpuSeconds()
+    {
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+            return 0.;
+        }
+        const auto toSeconds = [](FILETIME t) { return double(uint64_t(t.dwHighDateTime) << 32 | t.dwLowDateTime) / 1e7; };
+        return toSeconds(kernel) + toSeconds(user);
+    }
+
+    // waits on a high resolution timer, so pacing neither spins nor oversleeps by a scheduler tick
+    class QpcWaiter
+    {
+    public:
+        QpcWaiter()
+            :
+            timer_{ CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS) }
+        {}
+        ~QpcWaiter()
+        {
+            if (timer_) {
+                CloseHandle(timer_);
+            }
+        }
+        QpcWaiter(const QpcWaiter&) = delete;
+        QpcWaiter& operator=(const QpcWaiter&) = delete;
+        void WaitUntil(uint64_t qpc)
+        {
+            const auto now = Now();
+            if (qpc <= now) {
+                return;
+            }
+            // negative due times are relative, in 100 ns units
+            LARGE_INTEGER due;
+            due.QuadPart = -int64_t((qpc - now) * 10'000'000 / QpcFrequency().QuadPart);
+            if (timer_ && SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer_, INFINITE);
+            }
+            else {
+                std::this_thread::sleep_for(std::chrono::microseconds(-due.QuadPart / 10));
+            }
+        }
+    private:
+        HANDLE timer_;
+    };
+
+    struct Stream
+    {
+        uint32_t processId = 0;
+        std::string mapfileName;
+        GpuTelemetryBitset gpuCaps;
+        CpuTelemetryBitset cpuCaps;
+        std::vector<PmNsmFrameData> frames;
+        // qpc at which each frame has been presented, rendered and displayed, i.e. when the
+        // service could first write it
+        std::vector<uint64_t> availableQpc;
+        // results
+        uint64_t written = 0;
+        std::vector<double> writeLagMs;
+        double cpuSeconds = 0.;
+
+        // index of the frame that presented at qpc
+        size_t IndexOf(uint64_t presentStartTime) const
+        {
+            return size_t(std::ranges::lower_bound(frames, presentStartTime, {},
+                [](const PmNsmFrameData& f) { return f.present_event.PresentStartTime; }) - frames.begin());
+        }
+    };
+
+    void ShiftQpc(uint64_t& qpc, int64_t delta)
+    {
+        if (qpc != 0) {
+            qpc += delta;
+        }
+    }
+
+    // generates the stream's frames and moves their timeline to start at startQpc
+    void GenerateStream(Stream& stream, const StreamParams& params, uint32_t processId, double seconds, uint64_t startQpc)
+    {
+        PmFrameGenerator::FrameParams frameParams{};
+        frameParams.process_id = processId;
+        frameParams.percent_dropped = params.percentDropped;
+        frameParams.between_presents_ms = 1000. / params.fps;
+        frameParams.between_presents_variation_ms = 0.05 * 1000. / params.fps;
+        PmFrameGenerator generator{ frameParams };
+        const auto frameCount = int(params.fps * seconds);
+        generator.GenerateFrames(frameCount);
+
+        stream.processId = processId;
+        if (params.telemetry) {
+            stream.gpuCaps.set();
+            stream.cpuCaps.set();
+        }
+        stream.frames.reserve(frameCount);
+        for (int i = 0; i < frameCount; i++) {
+            stream.frames.push_back(generator.GetFrameData(i));
+        }
+        const auto delta = int64_t(startQpc - stream.frames.front().present_event.PresentStartTime);
+        uint64_t available = 0;
+        for (auto& frame : stream.frames) {
+            auto& p = frame.present_event;
+            for (auto pQpc : { &p.PresentStartTime, &p.GPUStartTime, &p.ReadyTime, &p.ScreenTime, &p.InputTime,
+                &p.MouseClickTime, &p.last_present_qpc, &p.last_displayed_qpc }) {
+                ShiftQpc(*pQpc, delta);
+            }
+            // the service writes frames in present order once they complete
+            available = std::max({ available, p.PresentStartTime + p.TimeInPresent, p.ReadyTime, p.ScreenTime });
+            stream.availableQpc.push_back(available);
+        }
+    }
+
+    void Produce(Streamer& streamer, Stream& stream)
+    {
+        QpcWaiter waiter;
+        stream.writeLagMs.reserve(stream.frames.size());
+        for (size_t i = 0; i < stream.frames.size(); i++) {
+            waiter.WaitUntil(stream.availableQpc[i]);
+            streamer.WriteFrameData(stream.processId, &stream.frames[i], stream.gpuCaps, stream.cpuCaps);
+            stream.writeLagMs.push_back(QpcDeltaToMs(Now() - stream.availableQpc[i], QpcFrequency()));
+            stream.written++;
+        }
+        stream.cpuSeconds = ThreadCpuSeconds();
+    }
+
+    struct FrameClient
+    {
+        FrameClientParams params;
+        std::unique_ptr<StreamClient> client;
+        // results
+        uint64_t consumed = 0;
+        uint64_t gathered = 0;
+        uint64_t lost = 0;
+        uint64_t reordered = 0;
+        std::vector<double> latencyMs;
+        std::vector<double> pollMs;
+        double cpuSeconds = 0.;
+    };
+
+    // consumes frames the way ConcreteMiddleware::ConsumeFrameEvents does, gathering each frame
+    // that has the context for its metrics into a frame query blob
+    void ConsumeFrames(FrameClient& fc, const Stream& stream, const std::atomic<bool>& stop, uint64_t startQpc)
+    {
+        PM_QUERY_ELEMENT elements[] = {
+            { PM_METRIC_CPU_START_QPC, PM_STAT_NONE, 0, 0 },
+            { PM_METRIC_CPU_FRAME_TIME, PM_STAT_NONE, 0, 0 },
+            { PM_METRIC_DISPLAYED_TIME, PM_STAT_NONE, 0, 0 },
+            { PM_METRIC_DISPLAY_LATENCY, PM_STAT_NONE, 0, 0 },
+            { PM_METRIC_GPU_POWER, PM_STAT_NONE, 1, 0 },
+        };
+        PM_FRAME_QUERY query{ elements };
+        std::vector<uint8_t> blobs(query.GetBlobSize() * fc.params.maxFramesPerPoll);
+        auto& client = *fc.client;
+        const auto period = SecondsDeltaToQpc(1. / fc.params.pollHz, QpcFrequency());
+
+        QpcWaiter waiter;
+        std::optional<size_t> firstIndex;
+        size_t lastIndex = 0;
+        for (auto pollQpc = startQpc; !stop; pollQpc += period) {
+            waiter.WaitUntil(pollQpc);
+            const auto pollStart = Now();
+            const auto pHeader = client.GetNamedSharedMemView()->GetHeader();
+            if (!pHeader->process_active || client.GetLatestFrameIndex() == UINT_MAX) {
+                continue;
+            }
+            PM_FRAME_QUERY::Context ctx{ pHeader->start_qpc, client.GetQpcFrequency().QuadPart };
+            auto pBlob = blobs.data();
+            for (uint32_t i = 0; i < fc.params.maxFramesPerPoll; i++) {
+                const PmNsmFrameData* pFrame = nullptr;
+                const PmNsmFrameData* pNextDisplayed = nullptr;
+                const PmNsmFrameData* pLastPresented = nullptr;
+                const PmNsmFrameData* pLastDisplayed = nullptr;
+                const PmNsmFrameData* pPreviousOfLastDisplayed = nullptr;
+                if (client.ConsumePtrToNextNsmFrameData(&pFrame, &pNextDisplayed, &pLastPresented, &pLastDisplayed,
+                    &pPreviousOfLastDisplayed) != PM_STATUS_SUCCESS || !pFrame) {
+                    break;
+                }
+                // a frame is held back until the next displayed frame has been written, which
+                // is part of its latency to the client
+                const auto index = stream.IndexOf(pFrame->present_event.PresentStartTime);
+                fc.latencyMs.push_back(QpcDeltaToMs(Now() - stream.availableQpc[index], QpcFrequency()));
+                if (!firstIndex) {
+                    firstIndex = index;
+                }
+                else if (index <= lastIndex) {
+                    fc.reordered++;
+                }
+                lastIndex = std::max(lastIndex, index);
+                fc.consumed++;
+                if (pLastPresented && pNextDisplayed) {
+                    ctx.UpdateSourceData(pFrame, pNextDisplayed, pLastPresented, pLastDisplayed, pPreviousOfLastDisplayed);
+                    query.GatherToBlob(ctx, pBlob);
+                    pBlob += query.GetBlobSize();
+                    fc.gathered++;
+                }
+            }
+            fc.pollMs.push_back(QpcDeltaToMs(Now() - pollStart, QpcFrequency()));
+        }
+        // frames the client skipped over when the ring overran it
+        if (firstIndex) {
+            const uint64_t span = lastIndex - *firstIndex + 1;
+            fc.lost = span > fc.consumed ? span - fc.consumed : 0;
+        }
+        fc.cpuSeconds = ThreadCpuSeconds();
+    }
+
+    struct DynamicClient
+    {
+        DynamicClientParams params;
+        std::unique_ptr<StreamClient> client;
+        // results
+        uint64_t polls = 0;
+        uint64_t emptyPolls = 0;
+        uint64_t windowFrames = 0;
+        std::vector<double> pollMs;
+        std::vector<double> dataAgeMs;
+        double cpuSeconds = 0.;
+    };
+
+    // selects the window of frames with the middleware's own window walk, the part of
+    // ConcreteMiddleware::PollDynamicQuery that reads the NSM ring while the service writes it
+    void PollDynamic(DynamicClient& dc, const Stream& stream, const std::atomic<bool>& stop, uint64_t startQpc)
+    {
+        auto& client = *dc.client;
+        const auto frequency = QpcFrequency();
+        const auto period = SecondsDeltaToQpc(1. / dc.params.pollHz, frequency);
+
+        QpcWaiter waiter;
+        uint64_t queryFrameDataDelta = 0;
+        pmon::mid::DynamicQueryFrameWindow window;
+        for (auto pollQpc = startQpc; !stop; pollQpc += period) {
+            waiter.WaitUntil(pollQpc);
+            const auto pollStart = Now();
+            dc.polls++;
+            if (!pmon::mid::SelectDynamicQueryWindow(client, dc.params.windowMs, dc.params.offsetMs,
+                queryFrameDataDelta, window)) {
+                dc.emptyPolls++;
+                continue;
+            }
+            dc.windowFrames += window.frames.size();
+            dc.pollMs.push_back(QpcDeltaToMs(Now() - pollStart, frequency));
+            // age of the newest frame in the ring, the window trails it by the client's offset
+            const auto view = client.GetRingView();
+            const auto newestQpc = view.At(view.count - 1).present_event.PresentStartTime;
+            dc.dataAgeMs.push_back(QpcDeltaToMs(pollStart - stream.availableQpc[stream.IndexOf(newestQpc)], frequency));
+        }
+        dc.cpuSeconds = ThreadCpuSeconds();
+    }
+
+    void PrintDistribution(const char* name, std::vector<double>& ms)
+    {
+        std::cout << "    " << std::left << std::setw(24) << name << std::right;
+        if (ms.empty()) {
+            std::cout << "no samples\n";
+            return;
+        }
+        std::ranges::sort(ms);
+        const auto at = [&](double p) { return ms[std::min(ms.size() - 1, size_t(p * ms.size()))]; };
+        std::cout << "p50 " << at(0.5) << "  p90 " << at(0.9) << "  p99 " << at(0.99) << "  max " << ms.back()
+            << " ms (" << ms.size() << " samples)\n";
+    }
+
+    template<typename T>
+    std::vector<double> Merge(std::vector<T>& items, std::vector<double> T::* samples)
+    {
+        std::vector<double> merged;
+        for (auto& item : items) {
+            merged.insert(merged.end(), (item.*samples).begin(), (item.*samples).end());
+        }
+        return merged;
+    }
+}
+
+// drives synthetic streams through the Streamer into per-process NSM rings, read back by dynamic
+// and frame query clients on their own StreamClients the way the middleware reads them. Reports
+// the latency from a frame completing to each client seeing it, the frames the frame clients
+// lost, and the cpu used by each component. Runs each scenario for PM_PIPELINE_LOAD_SECONDS,
+// and is skipped when that is not set.
+TEST(PipelineLoad, StreamsAndClients)
+{
+    double seconds = 0.;
+    if (char env[32]; GetEnvironmentVariableA("PM_PIPELINE_LOAD_SECONDS", env, sizeof(env)) > 0) {
+        seconds = std::stod(env);
+    }
+    if (seconds <= 0.) {
+        GTEST_SKIP() << "set PM_PIPELINE_LOAD_SECONDS to run the pipeline load scenarios";
+    }
+    const auto frequency = QpcFrequency();
+
+    for (auto& scenario : kScenarios) {
+        // streams live in Local\ mappings named after this process, so runs need no privileges
+        // and can't collide with a running service or another run
+        Streamer streamer;
+        streamer.SetMapFileNamePrefix(std::format("Local\\PmPipelineLoad_{}_", GetCurrentProcessId()));
+
+        const auto startQpc = Now() + SecondsDeltaToQpc(kStartupLeadSeconds, frequency);
+        std::vector<Stream> streams(scenario.streams.size());
+        for (size_t i = 0; i < streams.size(); i++) {
+            GenerateStream(streams[i], scenario.streams[i], uint32_t(i + 1), seconds, startQpc);
+            ASSERT_EQ(streamer.StartStreaming(GetCurrentProcessId(), streams[i].processId, streams[i].mapfileName, false),
+                PM_STATUS_SUCCESS) << scenario.name;
+        }
+        std::vector<DynamicClient> dynamicClients;
+        for (auto& params : scenario.dynamicClients) {
+            dynamicClients.push_back({ .params = params,
+                .client = std::make_unique<StreamClient>(streams[params.stream].mapfileName, false) });
+        }
+        std::vector<FrameClient> frameClients;
+        for (auto& params : scenario.frameClients) {
+            frameClients.push_back({ .params = params,
+                .client = std::make_unique<StreamClient>(streams[params.stream].mapfileName, false) });
+        }
+
+        std::atomic<bool> stop = false;
+        std::vector<std::thread> producers;
+        std::vector<std::thread> clients;
+        for (auto& stream : streams) {
+            producers.emplace_back(Produce, std::ref(streamer), std::ref(stream));
+        }
+        for (auto& dc : dynamicClients) {
+            clients.emplace_back(PollDynamic, std::ref(dc), std::cref(streams[dc.params.stream]), std::cref(stop), startQpc);
+        }
+        for (auto& fc : frameClients) {
+            clients.emplace_back(ConsumeFrames, std::ref(fc), std::cref(streams[fc.params.stream]), std::cref(stop), startQpc);
+        }
+        for (auto& t : producers) {
+            t.join();
+        }
+        QpcWaiter{}.WaitUntil(Now() + SecondsDeltaToQpc(kDrainSeconds, frequency));
+        stop = true;
+        for (auto& t : clients) {
+            t.join();
+        }
+        const auto wallSeconds = QpcDeltaToSeconds(Now() - startQpc, frequency);
+        streamer.StopAllStreams();
+
+        uint64_t generated = 0;
+        uint64_t written = 0;
+        double producerCpu = 0.;
+        for (auto& stream : streams) {
+            generated += stream.frames.size();
+            written += stream.written;
+            producerCpu += stream.cpuSeconds;
+        }
+        uint64_t consumed = 0;
+        uint64_t gathered = 0;
+        uint64_t lost = 0;
+        double frameCpu = 0.;
+        for (auto& fc : frameClients) {
+            EXPECT_GT(fc.consumed, 0u) << scenario.name;
+            EXPECT_EQ(fc.reordered, 0u) << scenario.name;
+            consumed += fc.consumed;
+            gathered += fc.gathered;
+            lost += fc.lost;
+            frameCpu += fc.cpuSeconds;
+        }
+        uint64_t polls = 0;
+        uint64_t emptyPolls = 0;
+        uint64_t windowFrames = 0;
+        double dynamicCpu = 0.;
+        for (auto& dc : dynamicClients) {
+            EXPECT_GT(dc.polls, dc.emptyPolls) << scenario.name;
+            polls += dc.polls;
+            emptyPolls += dc.emptyPolls;
+            windowFrames += dc.windowFrames;
+            dynamicCpu += dc.cpuSeconds;
+        }
+        EXPECT_EQ(written, generated) << scenario.name;
+
+        auto writeLag = Merge(streams, &Stream::writeLagMs);
+        auto frameLatency = Merge(frameClients, &FrameClient::latencyMs);
+        auto framePoll = Merge(frameClients, &FrameClient::pollMs);
+        auto dynamicAge = Merge(dynamicClients, &DynamicClient::dataAgeMs);
+        auto dynamicPoll = Merge(dynamicClients, &DynamicClient::pollMs);
+        std::cout << scenario.name << ": " << streams.size() << " streams, " << dynamicClients.size()
+            << " dynamic clients, " << frameClients.size() << " frame clients\n"
+            << std::fixed << std::setprecision(3)
+            << "    frames written " << written << ", consumed " << consumed << " (" << gathered << " gathered), lost "
+            << lost << "\n"
+            << "    dynamic polls " << polls << ", " << emptyPolls << " without frames, "
+            << (polls > emptyPolls ? windowFrames / (polls - emptyPolls) : 0) << " frames per window\n";
+        PrintDistribution("producer write lag", writeLag);
+        PrintDistribution("frame client latency", frameLatency);
+        PrintDistribution("frame client poll", framePoll);
+        PrintDistribution("dynamic data age", dynamicAge);
+        PrintDistribution("dynamic poll", dynamicPoll);
+        std::cout << std::setprecision(1)
+            << "    cpu % of one core: producers " << 100. * producerCpu / wallSeconds
+            << ", dynamic clients " << 100. * dynamicCpu / wallSeconds
+            << ", frame clients " << 100. * frameCpu / wallSeconds << "\n"
+            << std::defaultfloat;
+    }
+}
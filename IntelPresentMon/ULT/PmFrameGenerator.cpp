@@ -139,6 +139,10 @@ PmFrameGenerator::PmFrameGenerator(const FrameParams& frame_params)
 void PmFrameGenerator::GenerateFrames(int num_frames) {
   frames_.clear();
   frames_.resize(num_frames);
+  power_telemetry_.clear();
+  power_telemetry_.resize(num_frames);
+  cpu_telemetry_.clear();
+  cpu_telemetry_.resize(num_frames);
   pmft_frames_.clear();
   pmft_frames_.resize(num_frames);
   GeneratePresentData();
@@ -202,209 +206,8 @@ PM_FRAME_DATA PmFrameGenerator::GetPmFrameData(
     temp_frame.ms_gpu_active = pmft_frames_[frame_num].ms_gpu_active;
     temp_frame.ms_gpu_video_active = pmft_frames_[frame_num].ms_gpu_video_active;
 
-    // Copy power telemetry
-    temp_frame.gpu_power_w.data = frames_[frame_num].power_telemetry.gpu_power_w;
-    temp_frame.gpu_power_w.valid = gpu_telemetry_cap_bits[static_cast<size_t>(
-        GpuTelemetryCapBits::gpu_power)];
-
-    temp_frame.gpu_sustained_power_limit_w.data =
-        frames_[frame_num].power_telemetry.gpu_sustained_power_limit_w;
-    temp_frame.gpu_sustained_power_limit_w.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-        GpuTelemetryCapBits::gpu_sustained_power_limit)];
-
-    temp_frame.gpu_voltage_v.data = frames_[frame_num].power_telemetry.gpu_voltage_v;
-    temp_frame.gpu_voltage_v.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_voltage)];
-
-    temp_frame.gpu_frequency_mhz.data =
-        frames_[frame_num].power_telemetry.gpu_frequency_mhz;
-    temp_frame.gpu_frequency_mhz.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-        GpuTelemetryCapBits::gpu_frequency)];
-
-    temp_frame.gpu_temperature_c.data =
-        frames_[frame_num].power_telemetry.gpu_temperature_c;
-    temp_frame.gpu_temperature_c.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_temperature)];
-
-    temp_frame.gpu_utilization.data =
-        frames_[frame_num].power_telemetry.gpu_utilization;
-    temp_frame.gpu_utilization.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_utilization)];
-
-    temp_frame.gpu_render_compute_utilization.data =
-        frames_[frame_num].power_telemetry.gpu_render_compute_utilization;
-    temp_frame.gpu_render_compute_utilization.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_render_compute_utilization)];
-
-    temp_frame.gpu_media_utilization.data =
-        frames_[frame_num].power_telemetry.gpu_media_utilization;
-    temp_frame.gpu_media_utilization.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_media_utilization)];
-
-    temp_frame.vram_power_w.data =
-        frames_[frame_num].power_telemetry.vram_power_w;
-    temp_frame.vram_power_w.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_power)];
-
-    temp_frame.vram_voltage_v.data =
-        frames_[frame_num].power_telemetry.vram_voltage_v;
-    temp_frame.vram_voltage_v.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-        GpuTelemetryCapBits::vram_voltage)];
-
-    temp_frame.vram_frequency_mhz.data =
-        frames_[frame_num].power_telemetry.vram_frequency_mhz;
-    temp_frame.vram_frequency_mhz.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_frequency)];
-
-    temp_frame.vram_effective_frequency_gbs.data =
-        frames_[frame_num].power_telemetry.vram_effective_frequency_gbps;
-    temp_frame.vram_effective_frequency_gbs.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_effective_frequency)];
-
-    temp_frame.vram_temperature_c.data =
-        frames_[frame_num].power_telemetry.vram_temperature_c;
-    temp_frame.vram_temperature_c.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_temperature)];
-
-    for (size_t i = 0; i < MAX_PM_FAN_COUNT; i++) {
-      temp_frame.fan_speed_rpm[i].data =
-          frames_[frame_num].power_telemetry.fan_speed_rpm[i];
-      temp_frame.fan_speed_rpm[i].valid =
-          gpu_telemetry_cap_bits[static_cast<size_t>(
-              GpuTelemetryCapBits::fan_speed_0) + i];
-    }
-
-    for (uint32_t i = 0; i < MAX_PM_PSU_COUNT; i++) {
-      temp_frame.psu_type[i].data =
-          TranslatePsuType(frames_[frame_num].power_telemetry.psu[i].psu_type);
-      temp_frame.psu_type[i].valid = gpu_telemetry_cap_bits
-          [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-
-      temp_frame.psu_power[i].data =
-          frames_[frame_num].power_telemetry.psu[i].psu_power;
-      temp_frame.psu_power[i].valid = gpu_telemetry_cap_bits
-          [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-
-      temp_frame.psu_voltage[i].data =
-          frames_[frame_num].power_telemetry.psu[i].psu_voltage;
-      temp_frame.psu_voltage[i].valid = gpu_telemetry_cap_bits
-          [static_cast<size_t>(GpuTelemetryCapBits::psu_info_0) + i];
-    }
-
-    temp_frame.gpu_mem_total_size_b.data =
-        frames_[frame_num].power_telemetry.gpu_mem_total_size_b;
-    temp_frame.gpu_mem_total_size_b.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_mem_size)];
-
-    temp_frame.gpu_mem_used_b.data =
-        frames_[frame_num].power_telemetry.gpu_mem_used_b;
-    temp_frame.gpu_mem_used_b.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_mem_used)];
-
-    temp_frame.gpu_mem_max_bandwidth_bps.data =
-        frames_[frame_num].power_telemetry.gpu_mem_max_bandwidth_bps;
-    temp_frame.gpu_mem_max_bandwidth_bps.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_mem_max_bandwidth)];
-
-    temp_frame.gpu_mem_read_bandwidth_bps.data =
-        frames_[frame_num].power_telemetry.gpu_mem_read_bandwidth_bps;
-    temp_frame.gpu_mem_read_bandwidth_bps.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_mem_read_bandwidth)];
-
-    temp_frame.gpu_mem_write_bandwidth_bps.data =
-        frames_[frame_num].power_telemetry.gpu_mem_write_bandwidth_bps;
-    temp_frame.gpu_mem_write_bandwidth_bps.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_mem_write_bandwidth)];
-
-    temp_frame.gpu_power_limited.data =
-        frames_[frame_num].power_telemetry.gpu_power_limited;
-    temp_frame.gpu_power_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_power_limited)];
-
-    temp_frame.gpu_temperature_limited.data =
-        frames_[frame_num].power_telemetry.gpu_temperature_limited;
-    temp_frame.gpu_temperature_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_temperature_limited)];
-
-    temp_frame.gpu_current_limited.data =
-        frames_[frame_num].power_telemetry.gpu_current_limited;
-    temp_frame.gpu_current_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_current_limited)];
-
-    temp_frame.gpu_voltage_limited.data =
-        frames_[frame_num].power_telemetry.gpu_voltage_limited;
-    temp_frame.gpu_voltage_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_voltage_limited)];
-
-    temp_frame.gpu_utilization_limited.data =
-        frames_[frame_num].power_telemetry.gpu_utilization_limited;
-    temp_frame.gpu_utilization_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::gpu_utilization_limited)];
-
-    temp_frame.vram_power_limited.data =
-        frames_[frame_num].power_telemetry.vram_power_limited;
-    temp_frame.vram_power_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_power_limited)];
-
-    temp_frame.vram_temperature_limited.data =
-        frames_[frame_num].power_telemetry.vram_temperature_limited;
-    temp_frame.vram_temperature_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_temperature_limited)];
-
-    temp_frame.vram_current_limited.data =
-        frames_[frame_num].power_telemetry.vram_current_limited;
-    temp_frame.vram_current_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_current_limited)];
-
-    temp_frame.vram_voltage_limited.data =
-        frames_[frame_num].power_telemetry.vram_voltage_limited;
-    temp_frame.vram_voltage_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_voltage_limited)];
-
-    temp_frame.vram_utilization_limited.data =
-        frames_[frame_num].power_telemetry.vram_utilization_limited;
-    temp_frame.vram_utilization_limited.valid =
-        gpu_telemetry_cap_bits[static_cast<size_t>(
-            GpuTelemetryCapBits::vram_utilization_limited)];
-
-    // Cpu telemetry
-    temp_frame.cpu_utilization.data =
-        frames_[frame_num].cpu_telemetry.cpu_utilization;
-    temp_frame.cpu_utilization.valid =
-        cpu_telemetry_cap_bits[static_cast<size_t>(
-            CpuTelemetryCapBits::cpu_utilization)];
-
-    temp_frame.cpu_frequency.data =
-        frames_[frame_num].cpu_telemetry.cpu_frequency;
-    temp_frame.cpu_frequency.valid =
-        cpu_telemetry_cap_bits[static_cast<size_t>(
-            CpuTelemetryCapBits::cpu_frequency)];
+    // telemetry is not part of the frame records, CopyFrameData leaves the
+    // telemetry members zeroed and invalid
   }
   return temp_frame;
 }
@@ -567,80 +370,80 @@ void PmFrameGenerator::GeneratePresentData() {
 
 void PmFrameGenerator::GenerateGPUData() {
   for (int i = 0; i < (int)frames_.size(); i++) {
-    frames_[i].power_telemetry.gpu_power_w =
+    power_telemetry_[i].gpu_power_w =
         GetAlteredTimingValue(gpu_power_w_, gpu_power_variation_w_);
-    frames_[i].power_telemetry.gpu_sustained_power_limit_w =
+    power_telemetry_[i].gpu_sustained_power_limit_w =
         GetAlteredTimingValue(gpu_sustained_power_limit_w_,
                                   gpu_sustained_power_limit_variation_w_);
-    frames_[i].power_telemetry.gpu_voltage_v =
+    power_telemetry_[i].gpu_voltage_v =
         GetAlteredTimingValue(gpu_voltage_v_, gpu_voltage_variation_v_);
-    frames_[i].power_telemetry.gpu_frequency_mhz =
+    power_telemetry_[i].gpu_frequency_mhz =
         GetAlteredTimingValue(
         gpu_frequency_mhz_, gpu_frequency_variation_mhz_);
-    frames_[i].power_telemetry.gpu_temperature_c =
+    power_telemetry_[i].gpu_temperature_c =
         GetAlteredTimingValue(gpu_temp_c_, gpu_temp_variation_c_);
-    frames_[i].power_telemetry.gpu_utilization = GetAlteredTimingValue(
+    power_telemetry_[i].gpu_utilization = GetAlteredTimingValue(
         gpu_util_percent_, gpu_util_variation_percent_);
-    frames_[i].power_telemetry.gpu_render_compute_utilization =
+    power_telemetry_[i].gpu_render_compute_utilization =
         GetAlteredTimingValue(gpu_render_compute_util_percent_,
                                   gpu_render_compute_util_variation_percent_);
-    frames_[i].power_telemetry.gpu_media_utilization =
+    power_telemetry_[i].gpu_media_utilization =
         GetAlteredTimingValue(gpu_media_util_percent_,
                                   gpu_media_util_variation_percent_);
-    frames_[i].power_telemetry.vram_power_w =
+    power_telemetry_[i].vram_power_w =
         GetAlteredTimingValue(vram_power_w_, vram_power_variation_w_);
-    frames_[i].power_telemetry.vram_voltage_v =
+    power_telemetry_[i].vram_voltage_v =
         GetAlteredTimingValue(vram_voltage_v_, vram_voltage_variation_v_);
-    frames_[i].power_telemetry.vram_frequency_mhz = GetAlteredTimingValue(
+    power_telemetry_[i].vram_frequency_mhz = GetAlteredTimingValue(
         vram_frequency_mhz_, vram_frequency_variation_mhz_);
-    frames_[i].power_telemetry.vram_effective_frequency_gbps =
+    power_telemetry_[i].vram_effective_frequency_gbps =
         GetAlteredTimingValue(vram_effective_frequency_gbps_,
                                   vram_effective_frequency_variation_gbps_);
-    frames_[i].power_telemetry.vram_temperature_c =
+    power_telemetry_[i].vram_temperature_c =
         GetAlteredTimingValue(vram_temp_c_, vram_temp_variation_c_);
-    frames_[i].power_telemetry.gpu_mem_total_size_b = GetAlteredTimingValue(
+    power_telemetry_[i].gpu_mem_total_size_b = GetAlteredTimingValue(
         gpu_mem_total_size_b_, gpu_mem_total_size_variation_b_);
-    frames_[i].power_telemetry.gpu_mem_used_b =
+    power_telemetry_[i].gpu_mem_used_b =
         GetAlteredTimingValue(gpu_mem_used_b_, gpu_mem_used_variation_b_);
-    frames_[i].power_telemetry.gpu_mem_max_bandwidth_bps =
+    power_telemetry_[i].gpu_mem_max_bandwidth_bps =
         GetAlteredTimingValue(gpu_mem_max_bw_gbps_,
                                   gpu_mem_max_bw_variation_gbps_);
-    frames_[i].power_telemetry.gpu_mem_read_bandwidth_bps =
+    power_telemetry_[i].gpu_mem_read_bandwidth_bps =
         (double)GetAlteredTimingValue(gpu_mem_read_bw_bps_,
                                           gpu_mem_read_bw_variation_bps_);
-    frames_[i].power_telemetry.gpu_mem_write_bandwidth_bps =
+    power_telemetry_[i].gpu_mem_write_bandwidth_bps =
         (double)GetAlteredTimingValue(gpu_mem_write_bw_bps_,
                                           gpu_mem_write_bw_variation_bps_);
-    frames_[i].power_telemetry.fan_speed_rpm[0] = GetAlteredTimingValue(
+    power_telemetry_[i].fan_speed_rpm[0] = GetAlteredTimingValue(
           gpu_fan_speed_rpm_, gpu_fan_speed_rpm_variation_rpm_);
-    frames_[i].power_telemetry.gpu_power_limited =
+    power_telemetry_[i].gpu_power_limited =
         IsLimited(gpu_power_limited_percent_);
-    frames_[i].power_telemetry.gpu_temperature_limited =
+    power_telemetry_[i].gpu_temperature_limited =
         IsLimited(gpu_util_limited_percent_);
-    frames_[i].power_telemetry.gpu_current_limited =
+    power_telemetry_[i].gpu_current_limited =
         IsLimited(gpu_current_limited_percent_);
-    frames_[i].power_telemetry.gpu_voltage_limited =
+    power_telemetry_[i].gpu_voltage_limited =
         IsLimited(gpu_voltage_limited_percent_);
-    frames_[i].power_telemetry.gpu_utilization_limited =
+    power_telemetry_[i].gpu_utilization_limited =
         IsLimited(gpu_util_limited_percent_);
-    frames_[i].power_telemetry.vram_power_limited =
+    power_telemetry_[i].vram_power_limited =
         IsLimited(vram_power_limited_percent_);
-    frames_[i].power_telemetry.vram_temperature_limited =
+    power_telemetry_[i].vram_temperature_limited =
         IsLimited(vram_util_limited_percent_);
-    frames_[i].power_telemetry.vram_current_limited =
+    power_telemetry_[i].vram_current_limited =
         IsLimited(vram_current_limited_percent_);
-    frames_[i].power_telemetry.vram_voltage_limited =
+    power_telemetry_[i].vram_voltage_limited =
         IsLimited(vram_voltage_limited_percent_);
-    frames_[i].power_telemetry.vram_utilization_limited =
+    power_telemetry_[i].vram_utilization_limited =
         IsLimited(vram_util_limited_percent_);
   }
 }
 
 void PmFrameGenerator::GenerateCPUData() {
   for (int i = 0; i < (int)frames_.size(); i++) {
-    frames_[i].cpu_telemetry.cpu_utilization = GetAlteredTimingValue(
+    cpu_telemetry_[i].cpu_utilization = GetAlteredTimingValue(
         cpu_util_percent_, cpu_util_variation_percent_);
-    frames_[i].cpu_telemetry.cpu_frequency = GetAlteredTimingValue(
+    cpu_telemetry_[i].cpu_frequency = GetAlteredTimingValue(
         cpu_frequency_mhz_, cpu_frequency_variation_mhz_);
   }
 }
@@ -905,95 +708,95 @@ void PmFrameGenerator::CalculateGpuMetrics(
         calculated_end_frame_qpc) {
       if (gpu_telemetry_cap_bits[static_cast<size_t>(GpuTelemetryCapBits::gpu_power)]) {
         calculated_gpu_metrics.gpu_power_w.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_power_w);
+            power_telemetry_[current_frame_number].gpu_power_w);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_sustained_power_limit)]) {
         calculated_gpu_metrics.gpu_sustained_power_limit_w.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_sustained_power_limit_w);
+            power_telemetry_[current_frame_number]
+                .gpu_sustained_power_limit_w);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_voltage)]) {
         calculated_gpu_metrics.gpu_voltage_v.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_voltage_v);
+            power_telemetry_[current_frame_number].gpu_voltage_v);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_frequency)]) {
         calculated_gpu_metrics.gpu_frequency_mhz.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_frequency_mhz);
+            power_telemetry_[current_frame_number].gpu_frequency_mhz);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_temperature)]) {
         calculated_gpu_metrics.gpu_temp_c.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_temperature_c);
+            power_telemetry_[current_frame_number].gpu_temperature_c);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_utilization)]) {
         calculated_gpu_metrics.gpu_util_percent.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_utilization);
+            power_telemetry_[current_frame_number].gpu_utilization);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_render_compute_utilization)]) {
         calculated_gpu_metrics.gpu_render_compute_util_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_render_compute_utilization);
+            power_telemetry_[current_frame_number]
+                .gpu_render_compute_utilization);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_media_utilization)]) {
         calculated_gpu_metrics.gpu_media_util_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_media_utilization);
+            power_telemetry_[current_frame_number]
+                .gpu_media_utilization);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_power)]) {
         calculated_gpu_metrics.vram_power_w.push_back(
-            frames_[current_frame_number].power_telemetry.vram_power_w);
+            power_telemetry_[current_frame_number].vram_power_w);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_voltage)]) {
         calculated_gpu_metrics.vram_voltage_v.push_back(
-            frames_[current_frame_number].power_telemetry.vram_voltage_v);
+            power_telemetry_[current_frame_number].vram_voltage_v);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_frequency)]) {
         calculated_gpu_metrics.vram_frequency_mhz.push_back(
-            frames_[current_frame_number].power_telemetry.vram_frequency_mhz);
+            power_telemetry_[current_frame_number].vram_frequency_mhz);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_effective_frequency)]) {
         calculated_gpu_metrics.vram_effective_frequency_gbps.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.vram_effective_frequency_gbps);
+            power_telemetry_[current_frame_number]
+                .vram_effective_frequency_gbps);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_temperature)]) {
         calculated_gpu_metrics.vram_temp_c.push_back(
-            frames_[current_frame_number].power_telemetry.vram_temperature_c);
+            power_telemetry_[current_frame_number].vram_temperature_c);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_mem_size)]) {
         calculated_gpu_metrics.gpu_mem_total_size_b.push_back(
-            (double)frames_[current_frame_number]
-                .power_telemetry.gpu_mem_total_size_b);
+            (double)power_telemetry_[current_frame_number]
+                .gpu_mem_total_size_b);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_mem_used)]) {
         calculated_gpu_metrics.gpu_mem_used_b.push_back(
-            (double)frames_[current_frame_number]
-                .power_telemetry.gpu_mem_used_b);
+            (double)power_telemetry_[current_frame_number]
+                .gpu_mem_used_b);
       }
       // gpu mem utilization is calculated from the total gpu memory
       // and the used gpu memory
       if (gpu_mem_util_enabled) {
-        if (frames_[current_frame_number]
-                .power_telemetry.gpu_mem_total_size_b != 0.) {
+        if (power_telemetry_[current_frame_number]
+                .gpu_mem_total_size_b != 0.) {
           calculated_gpu_metrics.gpu_mem_util_percent.push_back(
               100. *
-              double(frames_[current_frame_number]
-                         .power_telemetry.gpu_mem_used_b) /
-              frames_[current_frame_number]
-                  .power_telemetry.gpu_mem_total_size_b);
+              double(power_telemetry_[current_frame_number]
+                         .gpu_mem_used_b) /
+              power_telemetry_[current_frame_number]
+                  .gpu_mem_total_size_b);
         } else {
           calculated_gpu_metrics.gpu_mem_util_percent.push_back(0.);
         }
@@ -1001,79 +804,79 @@ void PmFrameGenerator::CalculateGpuMetrics(
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_mem_max_bandwidth)]) {
         calculated_gpu_metrics.gpu_mem_max_bw_gbps.push_back(
-            (double)frames_[current_frame_number]
-                .power_telemetry.gpu_mem_max_bandwidth_bps);
+            (double)power_telemetry_[current_frame_number]
+                .gpu_mem_max_bandwidth_bps);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_mem_read_bandwidth)]) {
         calculated_gpu_metrics.gpu_mem_read_bw_bps.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_mem_read_bandwidth_bps);
+            power_telemetry_[current_frame_number]
+                .gpu_mem_read_bandwidth_bps);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_mem_write_bandwidth)]) {
         calculated_gpu_metrics.gpu_mem_write_bw_bps.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_mem_write_bandwidth_bps);
+            power_telemetry_[current_frame_number]
+                .gpu_mem_write_bandwidth_bps);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::fan_speed_0)]) {
         calculated_gpu_metrics.gpu_fan_speed_rpm.push_back(
-            frames_[current_frame_number].power_telemetry.fan_speed_rpm[0]);
+            power_telemetry_[current_frame_number].fan_speed_rpm[0]);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_power_limited)]) {
         calculated_gpu_metrics.gpu_power_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_power_limited);
+            power_telemetry_[current_frame_number].gpu_power_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_temperature_limited)]) {
         calculated_gpu_metrics.gpu_temp_limited_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_temperature_limited);
+            power_telemetry_[current_frame_number]
+                .gpu_temperature_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_current_limited)]) {
         calculated_gpu_metrics.gpu_current_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_current_limited);
+            power_telemetry_[current_frame_number].gpu_current_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_voltage_limited)]) {
         calculated_gpu_metrics.gpu_voltage_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.gpu_voltage_limited);
+            power_telemetry_[current_frame_number].gpu_voltage_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::gpu_utilization_limited)]) {
         calculated_gpu_metrics.gpu_util_limited_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.gpu_utilization_limited);
+            power_telemetry_[current_frame_number]
+                .gpu_utilization_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_power_limited)]) {
         calculated_gpu_metrics.vram_power_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.vram_power_limited);
+            power_telemetry_[current_frame_number].vram_power_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_temperature_limited)]) {
         calculated_gpu_metrics.vram_temp_limited_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.vram_temperature_limited);
+            power_telemetry_[current_frame_number]
+                .vram_temperature_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_current_limited)]) {
         calculated_gpu_metrics.vram_current_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.vram_current_limited);
+            power_telemetry_[current_frame_number].vram_current_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_voltage_limited)]) {
         calculated_gpu_metrics.vram_voltage_limited_percent.push_back(
-            frames_[current_frame_number].power_telemetry.vram_voltage_limited);
+            power_telemetry_[current_frame_number].vram_voltage_limited);
       }
       if (gpu_telemetry_cap_bits[static_cast<size_t>(
               GpuTelemetryCapBits::vram_utilization_limited)]) {
         calculated_gpu_metrics.vram_util_limited_percent.push_back(
-            frames_[current_frame_number]
-                .power_telemetry.vram_utilization_limited);
+            power_telemetry_[current_frame_number]
+                .vram_utilization_limited);
       }
 
     } else {
@@ -1222,12 +1025,12 @@ void PmFrameGenerator::CalculateCpuMetrics(
       if (cpu_telemetry_cap_bits[static_cast<size_t>(
               CpuTelemetryCapBits::cpu_utilization)]) {
         calculated_cpu_metrics.cpu_util_percent.push_back(
-            frames_[current_frame_number].cpu_telemetry.cpu_utilization);
+            cpu_telemetry_[current_frame_number].cpu_utilization);
       }
       if (cpu_telemetry_cap_bits[static_cast<size_t>(
               CpuTelemetryCapBits::cpu_frequency)]) {
         calculated_cpu_metrics.cpu_frequency_mhz.push_back(
-            frames_[current_frame_number].cpu_telemetry.cpu_frequency);
+            cpu_telemetry_[current_frame_number].cpu_frequency);
       }
     }
   }
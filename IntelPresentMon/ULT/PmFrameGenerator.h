@@ -366,6 +366,9 @@ class PmFrameGenerator {
   LARGE_INTEGER start_qpc_;
 
   std::vector<PmNsmFrameData> frames_;
+  // telemetry generated for each frame, kept apart since frames do not carry it
+  std::vector<PresentMonPowerTelemetryInfo> power_telemetry_;
+  std::vector<CpuTelemetryInfo> cpu_telemetry_;
   std::vector<PMFrameTimingInformation> pmft_frames_;
   UniformRandomGenerator uniform_random_gen_;
 };
\ No newline at end of file
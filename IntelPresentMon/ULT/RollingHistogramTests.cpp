@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include "../../PresentMon/RollingHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // a bucket's center is within half a bucket of every value in it
+    const double kMaxRatio = std::exp2(0.5 / RollingHistogram::BUCKETS_PER_OCTAVE) * (1. + 1e-9);
+
+    struct Sample
+    {
+        uint64_t time;
+        double value;
+    };
+
+    // nearest-rank percentile of the samples in the window
+    double ExactPercentile(const std::deque<Sample>& window, double percentile)
+    {
+        std::vector<double> values;
+        for (auto& s : window) {
+            values.push_back(s.value);
+        }
+        if (values.empty()) {
+            return 0.;
+        }
+        std::ranges::sort(values);
+        auto rank = (size_t)std::ceil(percentile / 100. * (double)values.size());
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    }
+}
+
+TEST(RollingHistogram, BucketsSpanFixedRatio)
+{
+    EXPECT_EQ(RollingHistogram::GetBucket(0.), 0u);
+    EXPECT_EQ(RollingHistogram::GetBucket(-1.), 0u);
+    EXPECT_EQ(RollingHistogram::GetBucket(1. / 1024.), 0u);
+    EXPECT_EQ(RollingHistogram::GetBucket(1e9), RollingHistogram::BUCKET_COUNT - 1);
+
+    for (double v = 1. / 64.; v < 2000.; v *= 1.01) {
+        const auto bucket = RollingHistogram::GetBucket(v);
+        const auto center = RollingHistogram::GetBucketCenter(bucket);
+        EXPECT_LE(std::max(v / center, center / v), kMaxRatio) << v;
+        EXPECT_LE(bucket, RollingHistogram::GetBucket(v * 1.01));
+    }
+}
+
+TEST(RollingHistogram, EmptyWindowHasNoPercentiles)
+{
+    RollingHistogram h;
+    h.Initialize(800);
+    EXPECT_EQ(h.GetPercentile(50.), 0.);
+
+    h.Add(1000, 16.6);
+    EXPECT_EQ(h.mValueCount, 1u);
+    EXPECT_NEAR(h.GetPercentile(1.), 16.6, 16.6 * (kMaxRatio - 1.));
+    EXPECT_NEAR(h.GetPercentile(99.), 16.6, 16.6 * (kMaxRatio - 1.));
+
+    // a whole window later every slice has been evicted
+    h.Advance(1000 + 800 + 100);
+    EXPECT_EQ(h.mValueCount, 0u);
+    EXPECT_EQ(h.GetPercentile(50.), 0.);
+}
+
+// frame times are drawn from a distribution that changes over time, at a rate that changes over
+// time, and the histogram's count is checked against the same window after every value, its
+// percentiles against an exact computation over the window every 37 values
+TEST(RollingHistogram, MatchesExactPercentilesOverWindow)
+{
+    constexpr uint64_t kWindow = 2'000'000;  // 2 seconds in microseconds
+    RollingHistogram h;
+    h.Initialize(kWindow);
+
+    std::mt19937 rng{ 7 };
+    // samples in the histogram's window, oldest first (times only increase, so the window is trimmed
+    // from the front as it moves)
+    std::deque<Sample> window;
+    uint64_t time = 0;
+    for (int i = 0; i < 20000; i++) {
+        // 60fps, with hitches, moving to 144fps, then to a stall, then back
+        const double baseMs = i < 8000 ? 16.7 : i < 16000 ? 6.9 : 33.3;
+        std::lognormal_distribution<double> frameTime{ std::log(baseMs), i % 1000 < 100 ? 0.8 : 0.1 };
+        auto ms = frameTime(rng);
+        if (i == 12000) {
+            ms = 2000.;  // as long as the window
+        }
+        time += uint64_t(ms * 1000.);
+        h.Add(time, ms);
+        window.push_back({ time, ms });
+
+        const auto windowStart = h.GetWindowStart();
+        while (!window.empty() && window.front().time < windowStart) {
+            window.pop_front();
+        }
+        // the window covers between all but one slice of the requested duration and all of it
+        ASSERT_GE(windowStart + kWindow, time) << i;
+        if (windowStart > 0) {
+            ASSERT_LE(windowStart + kWindow - kWindow / RollingHistogram::SLICE_COUNT, time) << i;
+        }
+        ASSERT_EQ(h.mValueCount, window.size()) << i;
+
+        if (i % 37 == 0) {
+            for (double p : { 1., 5., 50., 99. }) {
+                const auto exact = ExactPercentile(window, p);
+                const auto estimate = h.GetPercentile(p);
+                EXPECT_LE(std::max(exact / estimate, estimate / exact), kMaxRatio) << "value " << i << " p" << p;
+            }
+        }
+    }
+}
+
+// values out of order are counted in the latest slice rather than the one they belong to
+TEST(RollingHistogram, EarlierTimesCountInCurrentSlice)
+{
+    RollingHistogram h;
+    h.Initialize(800);
+    h.Add(1000, 10.);
+    h.Add(500, 20.);
+    EXPECT_EQ(h.mValueCount, 2u);
+
+    // both values are evicted with the slice containing time 1000
+    h.Advance(1000 + 800);
+    EXPECT_EQ(h.mValueCount, 0u);
+}
@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+#include "EtwStreamGenerator.h"
+#include "../../PresentData/ShardedTraceConsumer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr uint64_t kSecond = EtwStreamGenerator::qpcFrequency;
+
+    // completed presents are dequeued every this many events, like a polling output thread would
+    constexpr size_t kDequeueInterval = 256;
+
+    // many processes presenting at once, each submitting gpu work, is the load sharding is for
+    const EtwStreamGenerator::Params kParams{
+        .processCount = 16,
+        .composedFlipFraction = 0.4,
+        .independentFlipFraction = 0.4,
+        .gpuPacketsPerFrame = 4,
+        .durationSeconds = 4.,
+    };
+
+    // the analysis results of a present that sharding must not change, and its gpu work, which
+    // sharding only preserves for processes that aren't contending with another shard's; ordered
+    // by PresentStartTime then ProcessId, the order ShardedTraceConsumer merges presents in
+    using PresentResults = std::tuple<uint64_t, uint32_t, PresentMode, PresentResult, uint64_t>;
+    using GpuResults = std::tuple<uint64_t, uint64_t>;
+
+    struct ReplayResults
+    {
+        double seconds = 0.;
+        std::vector<PresentResults> presents;
+        std::vector<GpuResults> gpu;
+    };
+
+    class Replay
+    {
+    public:
+        explicit Replay(EtwStreamGenerator& generator) : generator_{ generator } {}
+        void Configure(PMTraceConsumer& consumer) const
+        {
+            consumer.mTrackGPU = true;
+            generator_.RegisterMetadata(consumer);
+        }
+        // presents started after the first, and before the last, half second: presents in flight
+        // when a consumer completes its first present are discarded, which happens at a different
+        // time in each shard
+        void Collect(const std::vector<std::shared_ptr<PresentEvent>>& presents, ReplayResults& results) const
+        {
+            const auto begin = kSecond / 2;
+            const auto end = uint64_t(kParams.durationSeconds * kSecond) - kSecond / 2;
+            for (auto& p : presents) {
+                if (!p->IsLost && p->PresentStartTime >= begin && p->PresentStartTime < end) {
+                    results.presents.emplace_back(p->PresentStartTime, p->ProcessId, p->PresentMode, p->FinalState, p->ScreenTime);
+                    results.gpu.emplace_back(p->GPUStartTime, p->GPUDuration);
+                }
+            }
+        }
+        // a single consumer only orders presents per swapchain
+        static void Sort(ReplayResults& results)
+        {
+            // gpu results are kept in the same order as their presents
+            std::vector<size_t> order(results.presents.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                order[i] = i;
+            }
+            std::ranges::sort(order, {}, [&](size_t i) { return results.presents[i]; });
+            ReplayResults sorted;
+            for (auto i : order) {
+                sorted.presents.push_back(results.presents[i]);
+                sorted.gpu.push_back(results.gpu[i]);
+            }
+            results.presents = std::move(sorted.presents);
+            results.gpu = std::move(sorted.gpu);
+        }
+        ReplayResults Unsharded() const
+        {
+            PMTraceConsumer consumer;
+            Configure(consumer);
+            ReplayResults results;
+            std::vector<std::shared_ptr<PresentEvent>> presents;
+            auto& events = generator_.GetEvents();
+            const auto t0 = Clock::now();
+            for (size_t i = 0; i < events.size(); i++) {
+                EtwStreamGenerator::Dispatch(consumer, events[i]);
+                if (i % kDequeueInterval == 0) {
+                    consumer.DequeuePresentEvents(presents);
+                    Collect(presents, results);
+                }
+            }
+            results.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+            consumer.DequeuePresentEvents(presents);
+            Collect(presents, results);
+            Sort(results);
+            return results;
+        }
+        // times routing every event until all the shards have analyzed them; the presents are kept
+        // in the order they were dequeued
+        ReplayResults Sharded(uint32_t shardCount) const
+        {
+            PMTraceConsumer config;
+            Configure(config);
+            ShardedTraceConsumer sharded;
+            sharded.Start(config, shardCount);
+            ReplayResults results;
+            std::vector<std::shared_ptr<PresentEvent>> presents;
+            auto& events = generator_.GetEvents();
+            const auto t0 = Clock::now();
+            for (size_t i = 0; i < events.size(); i++) {
+                sharded.RouteEvent(&events[i].record);
+                if (i % kDequeueInterval == 0) {
+                    sharded.DequeuePresentEvents(presents);
+                    Collect(presents, results);
+                }
+            }
+            sharded.Stop();
+            results.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+            sharded.DequeuePresentEvents(presents);
+            Collect(presents, results);
+            return results;
+        }
+    private:
+        EtwStreamGenerator& generator_;
+    };
+}
+
+TEST(ShardedTraceConsumer, ProcessesAreSpreadAcrossShards)
+{
+    PMTraceConsumer config;
+    ShardedTraceConsumer sharded;
+    sharded.Start(config, 4);
+    uint32_t counts[4] = {};
+    for (uint32_t pid = 1000; pid < 1000 + 4 * 64; pid += 4) {
+        counts[sharded.GetShardIndex(pid)]++;
+    }
+    for (auto count : counts) {
+        EXPECT_EQ(count, 16u);
+    }
+    sharded.Stop();
+}
+
+// replays a synthetic stream of many presenting processes through 1 to 8 shards, checking that
+// every shard count dequeues the same presents as a single consumer, merged in PresentStartTime
+// order across all dequeues, and reporting the events/s of each; routing and analysis overlap, so
+// this measures the whole pipeline rather than either part
+TEST(ShardedTraceConsumer, ReplayScaling)
+{
+    EtwStreamGenerator generator{ kParams };
+    const auto eventCount = generator.GetEvents().size();
+    const Replay replay{ generator };
+
+    const auto unsharded = replay.Unsharded();
+    ASSERT_FALSE(unsharded.presents.empty());
+    std::cout << eventCount << " events, " << unsharded.presents.size() << " presents compared, "
+        << std::thread::hardware_concurrency() << " hardware threads\n"
+        << std::fixed << std::setprecision(2)
+        << "    unsharded: " << eventCount / unsharded.seconds / 1e6 << " M events/s\n";
+
+    for (uint32_t shardCount : { 1u, 2u, 4u, 8u }) {
+        const auto sharded = replay.Sharded(shardCount);
+        std::cout << "    " << shardCount << " shard(s): " << eventCount / sharded.seconds / 1e6 << " M events/s, "
+            << unsharded.seconds / sharded.seconds << "x\n";
+
+        EXPECT_EQ(sharded.presents, unsharded.presents) << shardCount << " shard(s)";
+        // with one shard every event is analyzed in order, so gpu work is unchanged too
+        if (shardCount == 1) {
+            EXPECT_EQ(sharded.gpu, unsharded.gpu);
+        }
+    }
+    std::cout << std::defaultfloat;
+}
@@ -0,0 +1,229 @@
+#include "gtest/gtest.h"
+#include "EtwStreamGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <crtdbg.h>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace
+{
+    // counts the CRT heap allocations made while it is alive, through the debug CRT's allocation
+    // hook (the release CRT has no hook, so there the count is unavailable)
+    class ScopedAllocationCounter
+    {
+    public:
+        ScopedAllocationCounter()
+        {
+            count_ = 0;
+#ifdef _DEBUG
+            pPreviousHook_ = _CrtSetAllocHook(&Hook_);
+#endif
+        }
+        ~ScopedAllocationCounter()
+        {
+#ifdef _DEBUG
+            _CrtSetAllocHook(pPreviousHook_);
+#endif
+        }
+        ScopedAllocationCounter(const ScopedAllocationCounter&) = delete;
+        ScopedAllocationCounter& operator=(const ScopedAllocationCounter&) = delete;
+        std::optional<uint64_t> GetCount() const
+        {
+#ifdef _DEBUG
+            return count_.load();
+#else
+            return std::nullopt;
+#endif
+        }
+    private:
+        static int __cdecl Hook_(int allocType, void*, size_t, int, long, const unsigned char*, int)
+        {
+            if (allocType == _HOOK_ALLOC) {
+                count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return TRUE;
+        }
+        static inline std::atomic<uint64_t> count_{ 0 };
+        _CRT_ALLOC_HOOK pPreviousHook_ = nullptr;
+    };
+
+    using Clock = std::chrono::high_resolution_clock;
+    using Handler = EtwStreamGenerator::Handler;
+
+    // completed presents are dequeued every this many events, like a polling output thread would
+    constexpr size_t kDequeueInterval = 256;
+
+    const char* const kHandlerNames[] = { "DXGI", "DXGK", "Win32k", "DWM" };
+
+    struct Scenario
+    {
+        const char* name;
+        EtwStreamGenerator::Params params;
+    };
+
+    const Scenario kScenarios[] = {
+        { "fullscreen_dwm_off", { .processCount = 1, .fps = 240., .dwmComposition = false } },
+        { "mixed_modes", { .processCount = 8, .composedFlipFraction = 0.4, .independentFlipFraction = 0.4 } },
+        { "mixed_modes_gpu", { .processCount = 8, .swapChainsPerProcess = 2, .composedFlipFraction = 0.4,
+            .independentFlipFraction = 0.4, .gpuPacketsPerFrame = 8 } },
+        { "many_composed", { .processCount = 64, .composedFlipFraction = 1., .independentFlipFraction = 0., .fps = 60.,
+            .gpuPacketsPerFrame = 2 } },
+    };
+
+    void ConfigureConsumer(PMTraceConsumer& consumer, const EtwStreamGenerator& generator, const EtwStreamGenerator::Params& params)
+    {
+        consumer.mTrackGPU = params.gpuPacketsPerFrame > 0;
+        generator.RegisterMetadata(consumer);
+    }
+
+    size_t CountTrackedPresents(const PMTraceConsumer& consumer)
+    {
+        size_t count = 0;
+        for (auto& [processId, presents] : consumer.mOrderedPresentsByProcessId) {
+            count += presents.size();
+        }
+        return count;
+    }
+
+    // presents dequeued from the consumer, by mode and result
+    struct DequeuedPresents
+    {
+        uint32_t completed = 0;
+        uint32_t lost = 0;
+        uint32_t dwmPresented = 0;
+        uint32_t presented[size_t(PresentMode::Hardware_Composed_Independent_Flip) + 1] = {};
+
+        void Add(const std::vector<std::shared_ptr<PresentEvent>>& presents, uint32_t dwmProcessId)
+        {
+            for (auto& p : presents) {
+                if (p->ProcessId == dwmProcessId) {
+                    dwmPresented += p->FinalState == PresentResult::Presented ? 1 : 0;
+                }
+                else if (p->IsLost) {
+                    lost++;
+                }
+                else {
+                    completed++;
+                    if (p->FinalState == PresentResult::Presented) {
+                        presented[size_t(p->PresentMode)]++;
+                    }
+                }
+            }
+        }
+    };
+}
+
+// checks that the synthetic stream drives each present path through to completion, so the
+// benchmarks below measure the analysis doing real work
+TEST(TraceConsumerBenchmark, SyntheticStreamIsAnalyzed)
+{
+    const EtwStreamGenerator::Params params{ .processCount = 4, .gpuPacketsPerFrame = 2 };
+    EtwStreamGenerator generator{ params };
+    PMTraceConsumer consumer;
+    ConfigureConsumer(consumer, generator, params);
+
+    DequeuedPresents dequeued;
+    std::vector<std::shared_ptr<PresentEvent>> presents;
+    for (auto& event : generator.GetEvents()) {
+        EtwStreamGenerator::Dispatch(consumer, event);
+    }
+    consumer.DequeuePresentEvents(presents);
+    dequeued.Add(presents, generator.GetDwmProcessId());
+
+    for (auto mode : { PresentMode::Hardware_Legacy_Flip, PresentMode::Composed_Flip, PresentMode::Hardware_Independent_Flip }) {
+        EXPECT_GT(generator.GetPresentCount(mode), 0u);
+        EXPECT_GT(dequeued.presented[size_t(mode)], 0u) << int(mode);
+    }
+    EXPECT_GT(dequeued.dwmPresented, 0u);
+    // presents in flight when the first present completes, and at the end of the stream, are not
+    // completed
+    EXPECT_GT(dequeued.completed, generator.GetPresentCount() * 9 / 10);
+}
+
+// reports PMTraceConsumer throughput over synthetic streams; the first pass dispatches events
+// untimed for events/s and allocations, the second times each Handle* call (including the cost of
+// reading the clock) and samples the number of tracked presents after each event. Each stream
+// lasts PM_TRACE_BENCHMARK_SECONDS, and the benchmark is skipped when that is not set.
+TEST(TraceConsumerBenchmark, HandlerThroughput)
+{
+    double seconds = 0.;
+    if (char env[32]; GetEnvironmentVariableA("PM_TRACE_BENCHMARK_SECONDS", env, sizeof(env)) > 0) {
+        seconds = std::stod(env);
+    }
+    if (seconds <= 0.) {
+        GTEST_SKIP() << "set PM_TRACE_BENCHMARK_SECONDS to run the trace consumer benchmark";
+    }
+
+    for (auto& scenario : kScenarios) {
+        auto params = scenario.params;
+        params.durationSeconds = seconds;
+        EtwStreamGenerator generator{ params };
+        auto& events = generator.GetEvents();
+        std::vector<std::shared_ptr<PresentEvent>> presents;
+
+        double eventsPerSecond = 0.;
+        std::optional<uint64_t> allocations;
+        {
+            PMTraceConsumer consumer;
+            ConfigureConsumer(consumer, generator, params);
+            ScopedAllocationCounter allocationCounter;
+            const auto t0 = Clock::now();
+            for (size_t i = 0; i < events.size(); i++) {
+                EtwStreamGenerator::Dispatch(consumer, events[i]);
+                if (i % kDequeueInterval == 0) {
+                    consumer.DequeuePresentEvents(presents);
+                }
+            }
+            const std::chrono::duration<double> elapsed = Clock::now() - t0;
+            allocations = allocationCounter.GetCount();
+            eventsPerSecond = events.size() / elapsed.count();
+        }
+
+        double handlerNs[size_t(Handler::Count)] = {};
+        uint64_t handlerEvents[size_t(Handler::Count)] = {};
+        size_t peakTrackedPresents = 0;
+        DequeuedPresents dequeued;
+        {
+            PMTraceConsumer consumer;
+            ConfigureConsumer(consumer, generator, params);
+            for (size_t i = 0; i < events.size(); i++) {
+                const auto t0 = Clock::now();
+                EtwStreamGenerator::Dispatch(consumer, events[i]);
+                const std::chrono::duration<double, std::nano> elapsed = Clock::now() - t0;
+                handlerNs[size_t(events[i].handler)] += elapsed.count();
+                handlerEvents[size_t(events[i].handler)]++;
+                peakTrackedPresents = std::max(peakTrackedPresents, CountTrackedPresents(consumer));
+                if (i % kDequeueInterval == 0) {
+                    consumer.DequeuePresentEvents(presents);
+                    dequeued.Add(presents, generator.GetDwmProcessId());
+                }
+            }
+            consumer.DequeuePresentEvents(presents);
+            dequeued.Add(presents, generator.GetDwmProcessId());
+        }
+        EXPECT_GT(dequeued.completed, 0u) << scenario.name;
+
+        std::cout << scenario.name << ": " << events.size() << " events, " << generator.GetPresentCount()
+            << " presents (" << dequeued.completed << " completed, " << dequeued.lost << " lost)\n"
+            << std::fixed << std::setprecision(1)
+            << "    " << eventsPerSecond / 1e6 << " M events/s, " << 1e9 / eventsPerSecond << " ns/event\n";
+        if (allocations) {
+            std::cout << "    " << double(*allocations) / events.size() << " allocations/event, "
+                << double(*allocations) / generator.GetPresentCount() << " allocations/present\n";
+        }
+        else {
+            std::cout << "    allocations not counted (needs the debug CRT)\n";
+        }
+        std::cout << "    peak tracked presents " << peakTrackedPresents << "\n";
+        for (size_t h = 0; h < size_t(Handler::Count); h++) {
+            if (handlerEvents[h] > 0) {
+                std::cout << "    " << std::left << std::setw(8) << kHandlerNames[h] << std::right
+                    << std::setw(8) << handlerEvents[h] << " events " << handlerNs[h] / handlerEvents[h] << " ns/event\n";
+            }
+        }
+        std::cout << std::defaultfloat;
+    }
+}
@@ -0,0 +1,279 @@
+#include "gtest/gtest.h"
+#include "EtwStreamGenerator.h"
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+namespace
+{
+    constexpr uint64_t kSecond = EtwStreamGenerator::qpcFrequency;
+
+    // processes are replaced every 2 seconds for 2 minutes without their stop events, each
+    // presenting with gpu work and retrieving mouse clicks
+    const EtwStreamGenerator::Params kChurnParams{
+        .processCount = 4,
+        .fps = 60.,
+        .gpuPacketsPerFrame = 2,
+        .durationSeconds = 120.,
+        .processLifetimeSeconds = 2.,
+        .inputHz = 10.,
+    };
+
+    // the tables that grow with each process (or its windows and gpu contexts) that is never
+    // seen to stop
+    struct ChurnTableSizes
+    {
+        size_t mouseClicks;
+        size_t retrievedInput;
+        size_t gpuDevices;
+        size_t gpuContexts;
+        size_t gpuProcesses;
+
+        size_t InputMax() const
+        {
+            return std::max(mouseClicks, retrievedInput);
+        }
+        size_t GpuMax() const
+        {
+            return std::max({ gpuDevices, gpuContexts, gpuProcesses });
+        }
+        void Accumulate(const ChurnTableSizes& s)
+        {
+            mouseClicks = std::max(mouseClicks, s.mouseClicks);
+            retrievedInput = std::max(retrievedInput, s.retrievedInput);
+            gpuDevices = std::max(gpuDevices, s.gpuDevices);
+            gpuContexts = std::max(gpuContexts, s.gpuContexts);
+            gpuProcesses = std::max(gpuProcesses, s.gpuProcesses);
+        }
+    };
+
+    std::ostream& operator<<(std::ostream& os, const ChurnTableSizes& s)
+    {
+        return os << "mouse clicks " << s.mouseClicks << ", retrieved input " << s.retrievedInput
+            << ", gpu devices " << s.gpuDevices << ", gpu contexts " << s.gpuContexts
+            << ", gpu processes " << s.gpuProcesses;
+    }
+
+    ChurnTableSizes GetChurnTableSizes(const PMTraceConsumer& consumer)
+    {
+        return {
+            consumer.mReceivedMouseClickByHwnd.size(),
+            consumer.mRetrievedInput.size(),
+            consumer.mGpuTrace.GetDeviceCount(),
+            consumer.mGpuTrace.GetContextCount(),
+            consumer.mGpuTrace.GetProcessFrameInfoCount(),
+        };
+    }
+
+    // the analysis results of a present that eviction must not change
+    using PresentResults = std::tuple<uint32_t, uint64_t, PresentResult, uint64_t, uint64_t, uint64_t>;
+
+    struct ReplayResults
+    {
+        // peak table sizes over the first and second half of the stream, after the first
+        // generations of processes have had time to age out
+        ChurnTableSizes firstHalfPeak{};
+        ChurnTableSizes secondHalfPeak{};
+        ChurnTableSizes end{};
+        uint64_t evictedCount = 0;
+        std::vector<PresentResults> presents;
+    };
+
+    ReplayResults Replay(EtwStreamGenerator& generator, uint64_t timeLimit, uint32_t tableLimit)
+    {
+        PMTraceConsumer consumer;
+        consumer.mTrackGPU = true;
+        consumer.mTrackInput = true;
+        consumer.mTrackingStateTimeLimit = timeLimit;
+        consumer.mTrackingStateTableLimit = tableLimit;
+        consumer.mTrackingStateSweepInterval = 1024;
+        generator.RegisterMetadata(consumer);
+
+        ReplayResults results;
+        std::vector<std::shared_ptr<PresentEvent>> presents;
+        auto dequeue = [&] {
+            consumer.DequeuePresentEvents(presents);
+            for (auto& p : presents) {
+                results.presents.emplace_back(p->ProcessId, p->PresentStartTime, p->FinalState,
+                    p->GPUDuration, p->InputTime, p->MouseClickTime);
+            }
+        };
+
+        auto& events = generator.GetEvents();
+        const auto warmup = 10 * kSecond;
+        const auto half = uint64_t(events.back().record.EventHeader.TimeStamp.QuadPart) / 2;
+        for (size_t i = 0; i < events.size(); i++) {
+            EtwStreamGenerator::Dispatch(consumer, events[i]);
+            if (i % 256 == 0) {
+                dequeue();
+                const auto qpc = uint64_t(events[i].record.EventHeader.TimeStamp.QuadPart);
+                if (qpc >= warmup) {
+                    (qpc < half ? results.firstHalfPeak : results.secondHalfPeak).Accumulate(GetChurnTableSizes(consumer));
+                }
+            }
+        }
+        dequeue();
+        results.end = GetChurnTableSizes(consumer);
+        results.evictedCount = consumer.mEvictedTrackingStateCount;
+        return results;
+    }
+}
+
+TEST(TrackingStateEviction, SelectsAgedThenLeastRecentlyUsed)
+{
+    const EvictionCandidates all{ { 10, 1 }, { 50, 2 }, { 20, 3 }, { 90, 4 }, { 40, 5 } };
+    auto keys = [](EvictionCandidates c) {
+        std::vector<uint64_t> k;
+        for (auto& [time, key] : c) {
+            k.push_back(key);
+        }
+        std::ranges::sort(k);
+        return k;
+    };
+
+    // no limits, nothing is evicted
+    auto c = all;
+    SelectEvictions(&c, 5, 100, 0, 0);
+    EXPECT_TRUE(c.empty());
+
+    // entries last used more than 55 before 100
+    c = all;
+    SelectEvictions(&c, 5, 100, 55, 0);
+    EXPECT_EQ(keys(c), (std::vector<uint64_t>{ 1, 3, 5 }));
+
+    // least-recently used until 2 remain
+    c = all;
+    SelectEvictions(&c, 5, 100, 0, 2);
+    EXPECT_EQ(keys(c), (std::vector<uint64_t>{ 1, 3, 5 }));
+
+    // aged entries count towards the table limit
+    c = all;
+    SelectEvictions(&c, 5, 100, 85, 3);
+    EXPECT_EQ(keys(c), (std::vector<uint64_t>{ 1, 3 }));
+
+    // entries that aren't candidates (e.g., still referenced) count towards the table size, but
+    // are never evicted
+    c = all;
+    SelectEvictions(&c, 8, 100, 0, 2);
+    EXPECT_EQ(keys(c), (std::vector<uint64_t>{ 1, 2, 3, 4, 5 }));
+
+    // entries used after the sweep's timestamp are not aged
+    c = all;
+    SelectEvictions(&c, 5, 30, 5, 0);
+    EXPECT_EQ(keys(c), (std::vector<uint64_t>{ 1, 3 }));
+}
+
+// replays two minutes of process churn where no process' stop events are seen: without eviction
+// the tables grow with every process, with eviction the input tables stay flat and the analysis
+// of each present is unchanged.  gpu devices and contexts are never evicted, since an idle context
+// can still submit work, and they keep their processes' frame info alive.
+TEST(TrackingStateEviction, TablesStayFlatUnderProcessChurn)
+{
+    EtwStreamGenerator generator{ kChurnParams };
+    const auto generations = size_t(kChurnParams.durationSeconds / kChurnParams.processLifetimeSeconds);
+    const auto processCount = kChurnParams.processCount;
+
+    const auto unbounded = Replay(generator, 0, 0);
+    const auto aged = Replay(generator, 5 * kSecond, 0);
+    // the limit is larger than the two generations of processes (and dwm) that can be recently
+    // used at once, so only dead processes are evicted
+    const auto capped = Replay(generator, 0, 12);
+
+    std::cout << "no eviction: final " << unbounded.end << "\n"
+        << "5s time limit: peak " << aged.secondHalfPeak << ", " << aged.evictedCount << " evicted\n"
+        << "12 entry table limit: peak " << capped.secondHalfPeak << ", " << capped.evictedCount << " evicted\n";
+
+    // every process generation leaves its state behind
+    EXPECT_GE(unbounded.end.gpuContexts, generations * processCount);
+    EXPECT_GE(unbounded.end.mouseClicks, generations * processCount);
+    EXPECT_GE(unbounded.end.retrievedInput, generations * processCount);
+    EXPECT_EQ(unbounded.evictedCount, 0u);
+
+    // generations last used within the time limit (rounded up), the generation that's alive, and
+    // those that aged out since the table was last swept, plus dwm
+    const auto agedBound = (5 / size_t(kChurnParams.processLifetimeSeconds) + 4) * processCount + 1;
+    EXPECT_LE(aged.firstHalfPeak.InputMax(), agedBound) << aged.firstHalfPeak;
+    EXPECT_LE(aged.secondHalfPeak.InputMax(), agedBound) << aged.secondHalfPeak;
+    EXPECT_GT(aged.evictedCount, 0u);
+
+    // the limit, plus the generation started since the table was last swept
+    const auto cappedBound = size_t(12 + 2 * processCount);
+    EXPECT_LE(capped.firstHalfPeak.InputMax(), cappedBound) << capped.firstHalfPeak;
+    EXPECT_LE(capped.secondHalfPeak.InputMax(), cappedBound) << capped.secondHalfPeak;
+    EXPECT_GT(capped.evictedCount, 0u);
+
+    // gpu state is only released by stop events
+    EXPECT_EQ(aged.end.GpuMax(), unbounded.end.GpuMax()) << aged.end;
+    EXPECT_EQ(capped.end.GpuMax(), unbounded.end.GpuMax()) << capped.end;
+
+    // only state belonging to dead processes was evicted
+    ASSERT_FALSE(unbounded.presents.empty());
+    EXPECT_EQ(aged.presents, unbounded.presents);
+    EXPECT_EQ(capped.presents, unbounded.presents);
+}
+
+// the same churn, but with each process' stop event: its gpu devices and contexts are released
+// when it stops, and its frame info then ages out
+TEST(TrackingStateEviction, GpuStateReleasedAtProcessStop)
+{
+    auto params = kChurnParams;
+    params.processStopEvents = true;
+    EtwStreamGenerator stopped{ params };
+    EtwStreamGenerator lost{ kChurnParams };
+    const auto processCount = kChurnParams.processCount;
+
+    const auto released = Replay(stopped, 5 * kSecond, 0);
+    const auto unbounded = Replay(lost, 0, 0);
+
+    std::cout << "process stop events, 5s time limit: peak " << released.secondHalfPeak << "\n";
+
+    // the generation that's alive and the one whose stop event is still pending, plus dwm
+    const auto stoppedBound = size_t(2 * processCount + 1);
+    EXPECT_LE(released.secondHalfPeak.gpuDevices, stoppedBound) << released.secondHalfPeak;
+    EXPECT_LE(released.secondHalfPeak.gpuContexts, stoppedBound) << released.secondHalfPeak;
+    const auto agedBound = (5 / size_t(kChurnParams.processLifetimeSeconds) + 4) * processCount + 1;
+    EXPECT_LE(released.secondHalfPeak.gpuProcesses, agedBound) << released.secondHalfPeak;
+
+    // processes only stop after their last present
+    ASSERT_FALSE(unbounded.presents.empty());
+    EXPECT_EQ(released.presents, unbounded.presents);
+}
+
+// a process whose gpu context goes idle for longer than the eviction time limit (and is the
+// least-recently used one) still has its gpu work tracked when it resumes presenting
+TEST(TrackingStateEviction, IdleContextKeepsTrackingGpuWork)
+{
+    const EtwStreamGenerator::Params params{
+        .processCount = 2,
+        .fps = 60.,
+        .gpuPacketsPerFrame = 2,
+        .durationSeconds = 90.,
+        .idleBeginSeconds = 10.,
+        .idleSeconds = 70.,
+    };
+    EtwStreamGenerator generator{ params };
+    // the second process' only swap chain is the one that idles
+    const uint32_t idleProcessId = 1004;
+    const auto idleEnd = uint64_t((params.idleBeginSeconds + params.idleSeconds) * kSecond);
+
+    const auto unbounded = Replay(generator, 0, 0);
+    const auto aged = Replay(generator, 5 * kSecond, 0);
+    const auto capped = Replay(generator, 0, 1);
+
+    auto resumedPresents = [&](const ReplayResults& results) {
+        size_t count = 0;
+        for (auto& present : results.presents) {
+            if (std::get<0>(present) == idleProcessId && std::get<1>(present) > idleEnd) {
+                EXPECT_GT(std::get<3>(present), 0u) << "present at " << std::get<1>(present);
+                count++;
+            }
+        }
+        return count;
+    };
+    EXPECT_GT(resumedPresents(unbounded), 0u);
+    EXPECT_GT(resumedPresents(aged), 0u);
+    EXPECT_GT(resumedPresents(capped), 0u);
+
+    EXPECT_EQ(aged.presents, unbounded.presents);
+    EXPECT_EQ(capped.presents, unbounded.presents);
+}
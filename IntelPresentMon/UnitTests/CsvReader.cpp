@@ -0,0 +1,360 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include <CommonUtilities/csv/CsvReader.h>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <CppUnitTest.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace CsvReaderTests
+{
+	using namespace pmon::util;
+	using namespace std::literals;
+
+	std::vector<std::vector<std::string>> Tokenize(std::string_view text)
+	{
+		csv::Tokenizer tokenizer{ text };
+		std::vector<std::string_view> fields;
+		std::vector<std::vector<std::string>> rows;
+		while (tokenizer.ReadRow(fields)) {
+			rows.emplace_back(fields.begin(), fields.end());
+		}
+		return rows;
+	}
+
+	// straightforward split used as the reference for the tokenizer
+	std::vector<std::vector<std::string>> TokenizeReference(std::string_view text)
+	{
+		const auto trim = [](std::string_view s) {
+			while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+			while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+			return std::string{ s };
+		};
+		std::vector<std::vector<std::string>> rows;
+		while (!text.empty()) {
+			const auto lineEnd = std::min(text.find('\n'), text.size());
+			auto line = text.substr(0, lineEnd);
+			text.remove_prefix(std::min(lineEnd + 1, text.size()));
+			std::vector<std::string> fields;
+			for (;;) {
+				const auto comma = line.find(',');
+				fields.push_back(trim(line.substr(0, comma)));
+				if (comma == std::string_view::npos) {
+					break;
+				}
+				line.remove_prefix(comma + 1);
+			}
+			if (fields.size() > 1 || !fields[0].empty()) {
+				rows.push_back(std::move(fields));
+			}
+		}
+		return rows;
+	}
+
+	// rows shaped like PresentMon's output, with a random mix of values and NA
+	std::string GenerateRows(size_t count, uint32_t seed)
+	{
+		std::mt19937 rng{ seed };
+		std::uniform_real_distribution<double> ms{ 0., 33.3 };
+		std::string text;
+		uint64_t qpc = 1'000'000'000;
+		for (size_t i = 0; i < count; i++) {
+			const auto pid = 1000 + rng() % 4;
+			qpc += 10'000 + rng() % 150'000;
+			text += std::format("app{}.exe,{},0x{:016X},DXGI,{},0,{},Hardware: Legacy Flip,{},{:.6f},{:.6f},{:.6f},",
+				pid, pid, 0x1000 * (rng() % 3), rng() % 2, rng() % 2, qpc, ms(rng), ms(rng), ms(rng));
+			text += rng() % 8 == 0 ? "NA"s : std::format("{:.6f}", ms(rng));
+			text += "\n";
+		}
+		return text;
+	}
+
+	struct ParseTotals
+	{
+		size_t rowCount = 0;
+		size_t naCount = 0;
+		uint64_t qpcSum = 0;
+		bool ok = true;
+		ParseTotals& operator+=(const ParseTotals& rhs)
+		{
+			rowCount += rhs.rowCount;
+			naCount += rhs.naCount;
+			qpcSum += rhs.qpcSum;
+			ok = ok && rhs.ok;
+			return *this;
+		}
+	};
+
+	// parses every numeric field of rows generated by GenerateRows()
+	ParseTotals ParseRows(std::string_view text)
+	{
+		ParseTotals totals;
+		csv::Tokenizer tokenizer{ text };
+		std::vector<std::string_view> fields;
+		while (tokenizer.ReadRow(fields)) {
+			uint32_t pid = 0, syncInterval = 0, flags = 0, tearing = 0;
+			uint64_t swapChain = 0, qpc = 0;
+			double values[4]{};
+			std::optional<double> latency;
+			totals.ok = totals.ok && fields.size() == 13 &&
+				csv::ParseField(fields[1], pid) &&
+				csv::ParseField(fields[2], swapChain) &&
+				csv::ParseField(fields[4], syncInterval) &&
+				csv::ParseField(fields[5], flags) &&
+				csv::ParseField(fields[6], tearing) &&
+				csv::ParseField(fields[8], qpc) &&
+				csv::ParseField(fields[9], values[0]) &&
+				csv::ParseField(fields[10], values[1]) &&
+				csv::ParseField(fields[11], values[2]) &&
+				csv::ParseField(fields[12], latency);
+			totals.rowCount++;
+			totals.naCount += latency ? 0 : 1;
+			totals.qpcSum += qpc;
+		}
+		return totals;
+	}
+
+	ParseTotals ParseRowsInParallel(std::string_view text, size_t chunkCount)
+	{
+		const auto chunks = csv::SplitIntoChunks(text, chunkCount);
+		std::vector<ParseTotals> chunkTotals(chunks.size());
+		csv::ParseChunksInParallel(chunks, [&](size_t i, std::string_view chunk) {
+			chunkTotals[i] = ParseRows(chunk);
+		});
+		ParseTotals totals;
+		for (auto& t : chunkTotals) {
+			totals += t;
+		}
+		return totals;
+	}
+
+	TEST_CLASS(TestTokenizer)
+	{
+	public:
+		TEST_METHOD(SplitsAndTrimsFields)
+		{
+			const auto rows = Tokenize("Application, ProcessID ,\tRuntime\r\nfoo.exe,12,DXGI\r\n,,\r\n");
+			Assert::AreEqual(3ull, (unsigned long long)rows.size());
+			Assert::IsTrue(rows[0] == std::vector<std::string>{ "Application", "ProcessID", "Runtime" });
+			Assert::IsTrue(rows[1] == std::vector<std::string>{ "foo.exe", "12", "DXGI" });
+			Assert::IsTrue(rows[2] == std::vector<std::string>{ "", "", "" });
+		}
+		TEST_METHOD(SkipsBlankLinesAndCountsThem)
+		{
+			csv::Tokenizer tokenizer{ "\na,b\n\r\n  \nc,d" };
+			std::vector<std::string_view> fields;
+			Assert::IsTrue(tokenizer.ReadRow(fields));
+			Assert::AreEqual(2ull, (unsigned long long)tokenizer.GetLine());
+			Assert::IsTrue(tokenizer.ReadRow(fields));
+			Assert::AreEqual(5ull, (unsigned long long)tokenizer.GetLine());
+			Assert::IsTrue(fields[1] == "d");
+			Assert::IsFalse(tokenizer.ReadRow(fields));
+			Assert::IsTrue(fields.empty());
+			Assert::IsTrue(Tokenize("").empty());
+			Assert::IsTrue(Tokenize("\r\n\n").empty());
+		}
+		// delimiters are found 16 bytes at a time, so fields and rows of every length around
+		// the block size are compared with the reference split
+		TEST_METHOD(MatchesReferenceAcrossBlockBoundaries)
+		{
+			std::mt19937 rng{ 11 };
+			const char alphabet[] = "ab1,,\n \r\t";
+			for (int i = 0; i < 20000; i++) {
+				std::string text;
+				const auto length = rng() % 70;
+				for (uint32_t j = 0; j < length; j++) {
+					text += alphabet[rng() % (sizeof(alphabet) - 1)];
+				}
+				if (Tokenize(text) != TokenizeReference(text)) {
+					Assert::Fail(std::format(L"Tokenizer mismatch for input {}", i).c_str());
+				}
+			}
+		}
+		TEST_METHOD(RemainderFollowsLastRow)
+		{
+			csv::Tokenizer tokenizer{ "h1,h2\n1,2\n" };
+			std::vector<std::string_view> fields;
+			tokenizer.ReadRow(fields);
+			Assert::IsTrue(tokenizer.GetRemainder() == "1,2\n");
+		}
+	};
+
+	TEST_CLASS(TestParseField)
+	{
+	public:
+		TEST_METHOD(ParsesWholeFieldOnly)
+		{
+			uint32_t u = 0;
+			Assert::IsTrue(csv::ParseField("4294967295", u));
+			Assert::AreEqual(4294967295u, u);
+			Assert::IsFalse(csv::ParseField("4294967296", u));
+			Assert::IsFalse(csv::ParseField("12a", u));
+			Assert::IsFalse(csv::ParseField("", u));
+			Assert::IsFalse(csv::ParseField("-1", u));
+			int32_t i = 0;
+			Assert::IsTrue(csv::ParseField("-1", i));
+			Assert::AreEqual(-1, i);
+			double d = 0.;
+			Assert::IsTrue(csv::ParseField("16.666667", d));
+			Assert::AreEqual(16.666667, d);
+			Assert::IsTrue(csv::ParseField("1e-3", d));
+			Assert::AreEqual(0.001, d);
+			Assert::IsFalse(csv::ParseField("1.5ms", d));
+			bool b = false;
+			Assert::IsTrue(csv::ParseField("1", b));
+			Assert::IsTrue(b);
+			Assert::IsFalse(csv::ParseField("2", b));
+		}
+		TEST_METHOD(ParsesHexPrefix)
+		{
+			uint64_t u = 0;
+			Assert::IsTrue(csv::ParseField("0x00000000DEADBEEF", u));
+			Assert::AreEqual(0xDEADBEEFull, u);
+			Assert::IsTrue(csv::ParseField("0X1f", u));
+			Assert::AreEqual(31ull, u);
+			Assert::IsFalse(csv::ParseField("0x", u));
+			Assert::IsFalse(csv::ParseField("0xG", u));
+		}
+		TEST_METHOD(NaResetsOptional)
+		{
+			std::optional<double> value = 1.;
+			Assert::IsTrue(csv::ParseField("NA", value));
+			Assert::IsFalse(value.has_value());
+			Assert::IsTrue(csv::ParseField("2.5", value));
+			Assert::AreEqual(2.5, *value);
+			Assert::IsFalse(csv::ParseField("N/A", value));
+			double d = 0.;
+			Assert::IsFalse(csv::ParseField("NA", d));
+		}
+	};
+
+	TEST_CLASS(TestColumnMap)
+	{
+	public:
+		TEST_METHOD(MapsHeaderNames)
+		{
+			const std::vector<std::string_view> header{ "Application", "ProcessID", "FrameTime" };
+			csv::ColumnMap columns{ header };
+			Assert::AreEqual(3ull, (unsigned long long)columns.GetCount());
+			Assert::AreEqual(2ull, (unsigned long long)columns.Find("FrameTime"));
+			Assert::IsTrue(columns.Find("GPUBusy") == csv::ColumnMap::npos);
+			Assert::IsFalse(columns.GetDuplicate().has_value());
+		}
+		TEST_METHOD(ReportsDuplicate)
+		{
+			const std::vector<std::string_view> header{ "ProcessID", "FrameTime", "ProcessID" };
+			csv::ColumnMap columns{ header };
+			Assert::IsTrue(columns.GetDuplicate() == "ProcessID");
+		}
+	};
+
+	TEST_CLASS(TestChunkedParsing)
+	{
+	public:
+		TEST_METHOD(ChunksEndOnRowBoundaries)
+		{
+			const auto text = GenerateRows(1000, 3);
+			for (size_t chunkCount : { 1, 2, 7, 64, 5000 }) {
+				const auto chunks = csv::SplitIntoChunks(text, chunkCount);
+				Assert::IsTrue(chunks.size() <= chunkCount);
+				size_t size = 0;
+				for (auto& c : chunks) {
+					Assert::IsTrue(c.back() == '\n');
+					Assert::IsTrue(c.data() == text.data() + size);
+					size += c.size();
+				}
+				Assert::AreEqual(text.size(), size);
+			}
+			Assert::IsTrue(csv::SplitIntoChunks("", 4).empty());
+			Assert::AreEqual(1ull, (unsigned long long)csv::SplitIntoChunks("a,b", 4).size());
+		}
+		TEST_METHOD(ParallelMatchesSerial)
+		{
+			const auto text = GenerateRows(20000, 5);
+			const auto serial = ParseRows(text);
+			Assert::IsTrue(serial.ok);
+			Assert::AreEqual(20000ull, (unsigned long long)serial.rowCount);
+			for (size_t chunkCount : { 2, 3, 16 }) {
+				const auto parallel = ParseRowsInParallel(text, chunkCount);
+				Assert::IsTrue(parallel.ok);
+				Assert::AreEqual(serial.rowCount, parallel.rowCount);
+				Assert::AreEqual(serial.naCount, parallel.naCount);
+				Assert::AreEqual(serial.qpcSum, parallel.qpcSum);
+			}
+		}
+	};
+
+	TEST_CLASS(TestParseThroughput)
+	{
+	public:
+		// generates a csv of PM_CSV_BENCHMARK_GB gigabytes in the temp directory and logs the rate at
+		// which it is parsed from the mapped file, serially and in parallel
+		// opt-in since it writes gigabytes to disk; passes without doing anything when the variable is unset
+		TEST_METHOD(MappedFileThroughput)
+		{
+			double gigabytes = 0.;
+			if (char env[32]; GetEnvironmentVariableA("PM_CSV_BENCHMARK_GB", env, sizeof(env)) > 0) {
+				gigabytes = std::stod(env);
+			}
+			if (gigabytes <= 0.) {
+				Logger::WriteMessage("Skipped: set PM_CSV_BENCHMARK_GB to run the csv parse benchmark\n");
+				return;
+			}
+			const auto path = std::filesystem::temp_directory_path() / "pm_csv_benchmark.csv";
+			// remove the generated file even when an assertion throws out of the test
+			struct RemoveOnExit_
+			{
+				~RemoveOnExit_()
+				{
+					std::error_code ec;
+					std::filesystem::remove(path, ec);
+				}
+				std::filesystem::path path;
+			} removeOnExit{ path };
+			{
+				const auto block = GenerateRows(100'000, 7);
+				std::ofstream file{ path, std::ios::binary };
+				file << "Application,ProcessID,SwapChainAddress,PresentRuntime,SyncInterval,PresentFlags,"
+					"AllowsTearing,PresentMode,CPUStartQPC,FrameTime,CPUBusy,CPUWait,DisplayLatency\n";
+				for (double written = 0.; written < gigabytes * 1e9; written += double(block.size())) {
+					file.write(block.data(), block.size());
+				}
+				Assert::IsTrue(bool(file));
+			}
+
+			{
+				csv::MappedFile file;
+				Assert::IsTrue(file.Open(path.wstring()));
+				csv::Tokenizer tokenizer{ file.GetData() };
+				std::vector<std::string_view> header;
+				Assert::IsTrue(tokenizer.ReadRow(header));
+				const auto rows = tokenizer.GetRemainder();
+				const auto size = double(rows.size());
+
+				const auto serialStart = std::chrono::steady_clock::now();
+				const auto serial = ParseRows(rows);
+				const std::chrono::duration<double> serialTime = std::chrono::steady_clock::now() - serialStart;
+
+				const auto threadCount = std::max(1u, std::thread::hardware_concurrency());
+				const auto parallelStart = std::chrono::steady_clock::now();
+				const auto parallel = ParseRowsInParallel(rows, threadCount);
+				const std::chrono::duration<double> parallelTime = std::chrono::steady_clock::now() - parallelStart;
+
+				Logger::WriteMessage(std::format("{:.2f}GB, {} rows: serial {:.2f}s ({:.2f}GB/s), {} threads {:.2f}s ({:.2f}GB/s)\n",
+					size / 1e9, serial.rowCount, serialTime.count(), size / 1e9 / serialTime.count(),
+					threadCount, parallelTime.count(), size / 1e9 / parallelTime.count()).c_str());
+
+				Assert::IsTrue(serial.ok && parallel.ok);
+				Assert::AreEqual(serial.rowCount, parallel.rowCount);
+				Assert::AreEqual(serial.qpcSum, parallel.qpcSum);
+			}
+		}
+	};
+}
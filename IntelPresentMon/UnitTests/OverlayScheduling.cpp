@@ -0,0 +1,141 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include <Core/source/kernel/TaskScheduler.h>
+#include <Core/source/kernel/DataFetchPack.h>
+#include <Core/source/pmon/metric/SquareWaveMetric.h>
+#include <Core/source/pmon/metric/NoisySineFakeMetric.h>
+#include <memory>
+#include <format>
+
+#include <CppUnitTest.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace OverlayTests
+{
+	using namespace p2c;
+	using namespace std::literals;
+
+	using pmon::met::SquareWaveMetric;
+	using pmon::met::NoisySineFakeMetric;
+
+	// drives the scheduler like Overlay::RunTick does, without waiting or drawing
+	struct HarnessResult
+	{
+		int polls = 0;
+		int draws = 0;
+		int renderTicks = 0;
+	};
+	HarnessResult RunHarness(std::vector<kern::DataFetchPack>& packs, double& time,
+		size_t pollRate, size_t drawRate, int pollCount, size_t maxPollBackoff = 1)
+	{
+		HarnessResult result;
+		kern::TaskScheduler scheduler{ pollRate, drawRate, 10, maxPollBackoff };
+		while (result.polls < pollCount) {
+			time += std::chrono::duration<double>(scheduler.GetNextWait()).count();
+			if (scheduler.AtPoll()) {
+				result.polls++;
+				bool changed = false;
+				for (auto& p : packs) {
+					changed = p.Populate(time) || changed;
+				}
+				scheduler.ReportPoll(changed);
+			}
+			if (scheduler.AtRender()) {
+				result.renderTicks++;
+			}
+			if (scheduler.ConsumeRender()) {
+				result.draws++;
+			}
+		}
+		return result;
+	}
+
+	TEST_CLASS(TestOverlayScheduling)
+	{
+	public:
+		TEST_METHOD(StableReadoutSkipsRedraws)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(1);
+			packs[0].pFetcher = std::make_shared<SquareWaveMetric>(clock, 2., 10.f, 20.f);
+			packs[0].textData = std::make_shared<std::wstring>();
+			const auto res = RunHarness(packs, time, 10, 60, 100);
+			Logger::WriteMessage(std::format("polls:{} renderTicks:{} draws:{}\n",
+				res.polls, res.renderTicks, res.draws).c_str());
+			// 6 render ticks per poll
+			Assert::AreEqual(600, res.renderTicks);
+			// initial draw + first value + one per square wave transition (~10 in 10s)
+			Assert::IsTrue(res.draws <= 12);
+			Assert::IsTrue(res.draws >= 10);
+		}
+		TEST_METHOD(GraphDrawsOncePerPoll)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(1);
+			packs[0].pFetcher = std::make_shared<NoisySineFakeMetric>(clock, 0.5f, 0.f, 40.f, 100.f, 5.f, 1.f);
+			packs[0].graphData = std::make_shared<gfx::lay::GraphData>(5.);
+			const auto res = RunHarness(packs, time, 20, 60, 200);
+			// noisy samples shift the graph on every poll, but render ticks between polls have nothing new
+			Assert::IsTrue(res.draws <= res.polls + 1);
+			Assert::IsTrue(res.draws > res.polls * 9 / 10);
+		}
+		TEST_METHOD(StableReadoutBacksOffPolling)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(1);
+			packs[0].pFetcher = std::make_shared<SquareWaveMetric>(clock, 8., 10.f, 20.f);
+			packs[0].textData = std::make_shared<std::wstring>();
+			const auto res = RunHarness(packs, time, 10, 60, 100, 4);
+			Logger::WriteMessage(std::format("polls:{} seconds:{:.1f} draws:{}\n",
+				res.polls, time, res.draws).c_str());
+			// 100 polls at 10Hz would take 10s, backed off they stretch to nearly 4x that
+			Assert::IsTrue(time > 30.);
+			// each transition is still picked up, at most one backed-off period late
+			Assert::IsTrue(res.draws >= int(time / 4.));
+		}
+		TEST_METHOD(ChangingGraphKeepsFullPollRate)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(1);
+			packs[0].pFetcher = std::make_shared<NoisySineFakeMetric>(clock, 0.5f, 0.f, 40.f, 100.f, 5.f, 1.f);
+			packs[0].graphData = std::make_shared<gfx::lay::GraphData>(5.);
+			RunHarness(packs, time, 10, 60, 100, 4);
+			// every noisy sample shifts the graph, so polling never backs off
+			Assert::AreEqual(10., time, 0.001);
+		}
+		TEST_METHOD(FlatGraphBacksOffPolling)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(1);
+			packs[0].pFetcher = std::make_shared<SquareWaveMetric>(clock, 8., 10.f, 20.f);
+			packs[0].graphData = std::make_shared<gfx::lay::GraphData>(1.);
+			const auto res = RunHarness(packs, time, 10, 60, 100, 4);
+			Logger::WriteMessage(std::format("polls:{} seconds:{:.1f} draws:{}\n",
+				res.polls, time, res.draws).c_str());
+			// full rate only while a transition is inside the 1s window, backed off while the line is flat
+			Assert::IsTrue(time > 15.);
+			// each transition is still picked up
+			Assert::IsTrue(res.draws >= int(time / 4.));
+		}
+		TEST_METHOD(NoisyReadoutDrawsEachPoll)
+		{
+			double time = 0.;
+			const auto clock = [&time] { return time; };
+			std::vector<kern::DataFetchPack> packs(2);
+			packs[0].pFetcher = std::make_shared<NoisySineFakeMetric>(clock, 0.5f, 0.f, 40.f, 100.f, 5.f, 1.f);
+			packs[0].textData = std::make_shared<std::wstring>();
+			packs[1].pFetcher = std::make_shared<SquareWaveMetric>(clock, 2., 10.f, 20.f);
+			packs[1].textData = std::make_shared<std::wstring>();
+			const auto res = RunHarness(packs, time, 10, 30, 100);
+			// noisy value changes text nearly every poll, but never more than once per poll
+			Assert::IsTrue(res.draws <= res.polls + 1);
+			Assert::IsTrue(res.draws > res.polls * 9 / 10);
+		}
+	};
+}
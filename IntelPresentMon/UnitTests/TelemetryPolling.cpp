@@ -0,0 +1,101 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include <CommonUtilities/mt/PollScheduler.h>
+#include <ControlLib/PowerTelemetryAdapter.h>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <thread>
+#include <memory>
+
+#include <CppUnitTest.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TelemetryTests
+{
+	using namespace pmon;
+	using namespace std::literals;
+
+	// adapter with a configurable vendor-call cost, stands in for real GPU providers
+	class FakeAdapter : public pwr::PowerTelemetryAdapter
+	{
+	public:
+		FakeAdapter(std::string name, std::chrono::milliseconds sampleCost)
+			: name_{ std::move(name) }, sampleCost_{ sampleCost } {}
+		bool Sample() noexcept override
+		{
+			if (sampleCost_.count()) {
+				std::this_thread::sleep_for(sampleCost_);
+			}
+			sampleCount_++;
+			return true;
+		}
+		std::optional<PresentMonPowerTelemetryInfo> GetClosest(uint64_t) const noexcept override { return {}; }
+		PM_DEVICE_VENDOR GetVendor() const noexcept override { return PM_DEVICE_VENDOR_UNKNOWN; }
+		std::string GetName() const noexcept override { return name_; }
+		uint64_t GetDedicatedVideoMemory() const noexcept override { return 0; }
+		uint64_t GetVideoMemoryMaxBandwidth() const noexcept override { return 0; }
+		double GetSustainedPowerLimit() const noexcept override { return 0.; }
+		int GetSampleCount() const { return sampleCount_; }
+	private:
+		std::string name_;
+		std::chrono::milliseconds sampleCost_;
+		std::atomic<int> sampleCount_ = 0;
+	};
+
+	void LogStats(const std::string& name, const util::mt::PollStats& s)
+	{
+		Logger::WriteMessage(std::format("{}: n={} overruns={} jitter mean={:.3f}ms max={:.3f}ms duration mean={:.3f}ms\n",
+			name, s.sampleCount, s.overrunCount, s.meanJitterMs, s.maxJitterMs, s.meanDurationMs).c_str());
+	}
+
+	TEST_CLASS(TestPollScheduler)
+	{
+	public:
+		TEST_METHOD(SlowAdapterDoesNotDelayOthers)
+		{
+			auto pFast = std::make_shared<FakeAdapter>("fast", 0ms);
+			auto pSlow = std::make_shared<FakeAdapter>("slow", 30ms);
+			util::mt::PollStats fastStats, slowStats;
+			{
+				util::mt::PollScheduler scheduler{ 2 };
+				const auto fastId = scheduler.AddSource([=] { pFast->Sample(); }, 5ms);
+				const auto slowId = scheduler.AddSource([=] { pSlow->Sample(); }, 20ms);
+				std::this_thread::sleep_for(500ms);
+				fastStats = scheduler.GetStats(fastId);
+				slowStats = scheduler.GetStats(slowId);
+			}
+			LogStats("fast", fastStats);
+			LogStats("slow", slowStats);
+			// slow adapter cannot keep up with its own period, but that must not spill over to fast one
+			Assert::IsTrue(slowStats.overrunCount > 0);
+			Assert::AreEqual(0ull, fastStats.overrunCount);
+			Assert::IsTrue(fastStats.sampleCount >= 60, std::format(L"fast samples: {}", fastStats.sampleCount).c_str());
+			Assert::IsTrue(fastStats.meanJitterMs < slowStats.meanDurationMs);
+			Assert::AreEqual(int(fastStats.sampleCount), pFast->GetSampleCount());
+		}
+		TEST_METHOD(PerSourcePeriods)
+		{
+			auto pA = std::make_shared<FakeAdapter>("a", 0ms);
+			auto pB = std::make_shared<FakeAdapter>("b", 0ms);
+			util::mt::PollScheduler scheduler{ 1 };
+			const auto idA = scheduler.AddSource([=] { pA->Sample(); }, 10ms);
+			const auto idB = scheduler.AddSource([=] { pB->Sample(); }, 40ms);
+			std::this_thread::sleep_for(400ms);
+			const auto nA = pA->GetSampleCount();
+			const auto nB = pB->GetSampleCount();
+			// a should be sampled roughly 4x as often as b
+			Assert::IsTrue(nA > nB * 2, std::format(L"a: {} b: {}", nA, nB).c_str());
+			// retune a to be slower than b
+			scheduler.SetPeriod(idA, 100ms);
+			Assert::IsTrue(scheduler.GetPeriod(idA) == 100ms);
+			std::this_thread::sleep_for(400ms);
+			const auto dA = pA->GetSampleCount() - nA;
+			const auto dB = pB->GetSampleCount() - nB;
+			Assert::IsTrue(dA < dB, std::format(L"a: {} b: {}", dA, dB).c_str());
+			LogStats("a", scheduler.GetStats(idA));
+			LogStats("b", scheduler.GetStats(idB));
+		}
+	};
+}
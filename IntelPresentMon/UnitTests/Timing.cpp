@@ -7,6 +7,8 @@
 #include <format>
 #include <chrono>
 #include <thread>
+#include <random>
+#include <vector>
 
 #include <CppUnitTest.h>
 
@@ -99,4 +101,82 @@ namespace UtilityTests
 		}
 		// TODO: interval waiter test with late Wait() call
 	};
+
+	TEST_CLASS(TestQpcConversion)
+	{
+	public:
+		TEST_METHOD(DeltaSemantics)
+		{
+			const double periodMs = 1000. / 10'000'000.;
+			Assert::AreEqual(1., util::TimestampDeltaToMilliSeconds(10'000ull, periodMs));
+			// unsigned delta clamps when start is unset or end does not come after start
+			Assert::AreEqual(0., util::TimestampDeltaToUnsignedMilliSeconds(0, 10'000, periodMs));
+			Assert::AreEqual(0., util::TimestampDeltaToUnsignedMilliSeconds(20'000, 10'000, periodMs));
+			Assert::AreEqual(1., util::TimestampDeltaToUnsignedMilliSeconds(10'000, 20'000, periodMs));
+			// signed delta is 0 when either end is unset, negative when end precedes start
+			Assert::AreEqual(0., util::TimestampDeltaToMilliSeconds(10'000ull, 0ull, periodMs));
+			Assert::AreEqual(-1., util::TimestampDeltaToMilliSeconds(20'000ull, 10'000ull, periodMs));
+			Assert::AreEqual(1., util::TimestampDeltaToMilliSeconds(10'000ull, 20'000ull, periodMs));
+		}
+		TEST_METHOD(BatchUnsignedMatchesScalar)
+		{
+			const double periodMs = 1000. / 10'000'000.;
+			std::mt19937_64 rng{ 42 };
+			// odd count to exercise the scalar tail after the vector loop
+			const size_t count = 1001;
+			std::vector<uint64_t> starts(count), ends(count);
+			for (size_t i = 0; i < count; i++) {
+				switch (i % 5) {
+				case 0: starts[i] = 0; ends[i] = rng(); break; // unset start
+				case 1: starts[i] = rng(); ends[i] = starts[i]; break; // zero length
+				case 2: starts[i] = rng() | 1; ends[i] = starts[i] - 1; break; // end before start
+				case 3: starts[i] = rng() >> 1; ends[i] = starts[i] + (rng() >> 1); break; // full 64-bit range
+				default: starts[i] = rng() >> 8; ends[i] = starts[i] + rng() % 500'000; break;
+				}
+			}
+			std::vector<double> out(count);
+			util::TimestampDeltasToUnsignedMilliSeconds(starts, ends, out, periodMs);
+			for (size_t i = 0; i < count; i++) {
+				Assert::AreEqual(util::TimestampDeltaToUnsignedMilliSeconds(starts[i], ends[i], periodMs), out[i],
+					std::format(L"mismatch at {}", i).c_str());
+			}
+		}
+		TEST_METHOD(BatchDeltaMatchesScalar)
+		{
+			const double periodMs = 1000. / 3'579'545.;
+			std::mt19937_64 rng{ 7 };
+			const size_t count = 1023;
+			std::vector<uint64_t> deltas(count);
+			for (auto& d : deltas) {
+				d = rng() >> (rng() % 64);
+			}
+			std::vector<double> out(count);
+			util::TimestampDeltasToMilliSeconds(deltas, out, periodMs);
+			for (size_t i = 0; i < count; i++) {
+				Assert::AreEqual(util::TimestampDeltaToMilliSeconds(deltas[i], periodMs), out[i],
+					std::format(L"mismatch at {}", i).c_str());
+			}
+		}
+		TEST_METHOD(BatchThroughput)
+		{
+			const double periodMs = 1000. / 10'000'000.;
+			const size_t count = 1'000'000;
+			std::vector<uint64_t> starts(count), ends(count);
+			for (size_t i = 0; i < count; i++) {
+				starts[i] = 1'000'000 + i * 166'666;
+				ends[i] = starts[i] + (i % 3) * 50'000;
+			}
+			std::vector<double> out(count);
+			util::QpcTimer timer;
+			for (size_t i = 0; i < count; i++) {
+				out[i] = util::TimestampDeltaToUnsignedMilliSeconds(starts[i], ends[i], periodMs);
+			}
+			const auto scalarSeconds = timer.Mark();
+			util::TimestampDeltasToUnsignedMilliSeconds(starts, ends, out, periodMs);
+			const auto batchSeconds = timer.Mark();
+			Logger::WriteMessage(std::format("qpc->ms {} pairs: scalar {:.3f}ms, batch {:.3f}ms (avx2: {})\n",
+				count, scalarSeconds * 1000., batchSeconds * 1000.,
+				util::QpcBatchConversionIsVectorized()).c_str());
+		}
+	};
 }
@@ -0,0 +1,33 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <algorithm>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+// (last use time, key) of each table entry that can be evicted.
+using EvictionCandidates = std::vector<std::pair<uint64_t, uint64_t>>;
+
+// Reduces candidates to the entries that should be evicted from a table of tableSize entries:
+// those last used more than timeLimit before timestamp and then, if the table would still have
+// more than tableLimit entries, the least-recently used of the rest.  A limit of 0 disables that
+// criteria.
+inline void SelectEvictions(EvictionCandidates* candidates, size_t tableSize, uint64_t timestamp, uint64_t timeLimit, size_t tableLimit)
+{
+    auto ii = candidates->begin();
+    if (timeLimit != 0) {
+        ii = std::partition(candidates->begin(), candidates->end(), [=](std::pair<uint64_t, uint64_t> const& c) {
+            return timestamp > c.first && timestamp - c.first > timeLimit;
+        });
+    }
+
+    auto evictCount = (size_t) (ii - candidates->begin());
+    if (tableLimit != 0 && tableSize - evictCount > tableLimit) {
+        auto overLimitCount = std::min(tableSize - evictCount - tableLimit, (size_t) (candidates->end() - ii));
+        std::nth_element(ii, ii + overLimitCount, candidates->end());
+        evictCount += overLimitCount;
+    }
+
+    candidates->resize(evictCount);
+}
@@ -3,6 +3,8 @@
 
 #include "PresentMonTraceConsumer.hpp"
 
+#include <unordered_set>
+
 namespace {
 
 void DebugPrintAccumulatedGpuTime(uint32_t processId, uint64_t accumulatedTime, uint64_t startTime, uint64_t endTime)
@@ -75,12 +77,15 @@ GpuTrace::GpuTrace(PMTraceConsumer* pmConsumer)
 {
 }
 
-void GpuTrace::RegisterDevice(uint64_t hDevice, uint64_t pDxgAdapter)
+void GpuTrace::RegisterDevice(uint64_t hDevice, uint64_t pDxgAdapter, uint32_t processId)
 {
     // Sometimes there are duplicate start events
-    DebugAssert(mDevices.find(hDevice) == mDevices.end() || mDevices.find(hDevice)->second == pDxgAdapter);
+    DebugAssert(mDevices.find(hDevice) == mDevices.end() || mDevices.find(hDevice)->second.mDxgAdapter == pDxgAdapter);
 
-    mDevices.emplace(hDevice, pDxgAdapter);
+    auto device = &mDevices.emplace(hDevice, Device{ pDxgAdapter, 0 }).first->second;
+    if (processId != 0) {
+        device->mProcessId = processId;
+    }
 }
 
 void GpuTrace::UnregisterDevice(uint64_t hDevice)
@@ -89,13 +94,13 @@ void GpuTrace::UnregisterDevice(uint64_t hDevice)
     mDevices.erase(hDevice);
 }
 
-void GpuTrace::RegisterContext(uint64_t hContext, uint64_t hDevice, uint32_t nodeOrdinal, uint32_t processId)
+void GpuTrace::RegisterContext(uint64_t hContext, uint64_t hDevice, uint32_t nodeOrdinal, uint32_t processId, uint64_t timestamp)
 {
     auto deviceIter = mDevices.find(hDevice);
     if (deviceIter == mDevices.end()) {
         return;
     }
-    auto pDxgAdapter = deviceIter->second;
+    auto pDxgAdapter = deviceIter->second.mDxgAdapter;
     auto node = &mNodes[pDxgAdapter].emplace(nodeOrdinal, Node{}).first->second;
 
     // Sometimes there are duplicate start events, make sure that they say the same thing
@@ -104,12 +109,14 @@ void GpuTrace::RegisterContext(uint64_t hContext, uint64_t hDevice, uint32_t nod
     auto context = &mContexts.emplace(hContext, Context()).first->second;
     context->mPacketTrace = nullptr;
     context->mNode = node;
+    context->mDevice = hDevice;
     context->mParentContext = 0;
+    context->mProcessId = 0;
     context->mIsParentContext = false;
     context->mIsHwQueue = false;
 
     if (processId != 0) {
-        SetContextProcessId(context, processId);
+        SetContextProcessId(context, processId, timestamp);
     }
 }
 
@@ -162,7 +169,9 @@ void GpuTrace::RegisterHwQueueContext(uint64_t hContext, uint64_t parentDxgHwQue
     auto hwQueueContext = &mContexts.emplace(parentDxgHwQueue, Context()).first->second;
     hwQueueContext->mPacketTrace = parentContext->mPacketTrace;
     hwQueueContext->mNode = node;
+    hwQueueContext->mDevice = parentContext->mDevice;
     hwQueueContext->mParentContext = hContext;
+    hwQueueContext->mProcessId = parentContext->mProcessId;
     hwQueueContext->mIsParentContext = false;
     hwQueueContext->mIsHwQueue = true;
 }
@@ -192,6 +201,28 @@ void GpuTrace::UnregisterContext(uint64_t hContext)
     }
 }
 
+void GpuTrace::UnregisterProcess(uint32_t processId)
+{
+    // HwQueue contexts are removed along with their parent context.
+    std::unordered_set<uint64_t> hContexts;
+    for (auto const& pr : mContexts) {
+        if (pr.second.mProcessId == processId) {
+            hContexts.insert(pr.second.mIsHwQueue ? pr.second.mParentContext : pr.first);
+        }
+    }
+    for (auto hContext : hContexts) {
+        UnregisterContext(hContext);
+    }
+
+    for (auto ii = mDevices.begin(), ie = mDevices.end(); ii != ie; ) {
+        if (ii->second.mProcessId == processId) {
+            ii = mDevices.erase(ii);
+        } else {
+            ++ii;
+        }
+    }
+}
+
 void GpuTrace::SetEngineType(uint64_t pDxgAdapter, uint32_t nodeOrdinal, Microsoft_Windows_DxgKrnl::DXGK_ENGINE engineType)
 {
     // Node should already be created (DxgKrnl::Context_Start comes
@@ -205,9 +236,18 @@ void GpuTrace::SetEngineType(uint64_t pDxgAdapter, uint32_t nodeOrdinal, Microso
     }
 }
 
-void GpuTrace::SetContextProcessId(Context* context, uint32_t processId)
+void GpuTrace::SetContextProcessId(Context* context, uint32_t processId, uint64_t timestamp)
 {
     auto p = mProcessFrameInfo.emplace(processId, ProcessFrameInfo{});
+    p.first->second.mLastUseTime = timestamp;
+
+    // Contexts and devices created before the capture started only learn
+    // their process from the first packet submitted to them.
+    context->mProcessId = processId;
+    auto deviceIter = mDevices.find(context->mDevice);
+    if (deviceIter != mDevices.end() && deviceIter->second.mProcessId == 0) {
+        deviceIter->second.mProcessId = processId;
+    }
 
     if (mPMConsumer->mTrackGPUVideo && context->mNode->mIsVideo) {
         context->mPacketTrace = &p.first->second.mVideoEngines;
@@ -439,7 +479,7 @@ void GpuTrace::EnqueueQueuePacket(uint64_t hContext, uint32_t sequenceId, uint32
         // cases where the context was created before the capture was started
         // so we didn't see a Context_Start event.
         if (context->mPacketTrace == nullptr) {
-            SetContextProcessId(context, processId);
+            SetContextProcessId(context, processId, timestamp);
         }
 
         // Use queue packet duration as a proxy for dma duration for cases we
@@ -523,6 +563,7 @@ void GpuTrace::CompleteFrame(PresentEvent* pEvent, uint64_t timestamp)
     if (ii != mProcessFrameInfo.end()) {
         auto frameInfo = &ii->second;
         auto packetTrace = &frameInfo->mOtherEngines;
+        frameInfo->mLastUseTime = timestamp;
         auto videoTrace = &frameInfo->mVideoEngines;
 
         // Update GPUStartTime/ReadyTime/GPUDuration if any DMA packets were
@@ -583,3 +624,41 @@ void GpuTrace::CompleteFrame(PresentEvent* pEvent, uint64_t timestamp)
         pEvent->ReadyTime = timestamp;
     }
 }
+
+size_t GpuTrace::EvictProcessFrameInfo(uint64_t timestamp, uint64_t timeLimit, size_t tableLimit, EvictionCandidates* candidates)
+{
+    // PacketTraces are referenced by contexts and by enqueued packets, and
+    // both have to be gone before the process' PacketTraces can be removed.
+    std::unordered_set<PacketTrace const*> referencedTraces;
+    auto addNode = [&](Node const& node) {
+        for (uint32_t i = 0; i < node.mQueueCount; ++i) {
+            referencedTraces.insert(node.mQueue[(node.mQueueIndex + i) % (uint32_t) node.mQueue.size()].mPacketTrace);
+        }
+    };
+    for (auto const& pr : mContexts) {
+        referencedTraces.insert(pr.second.mPacketTrace);
+        if (pr.second.mIsHwQueue) {
+            addNode(*pr.second.mNode);
+        }
+    }
+    for (auto const& adapter : mNodes) {
+        for (auto const& pr : adapter.second) {
+            addNode(pr.second);
+        }
+    }
+
+    candidates->clear();
+    for (auto const& pr : mProcessFrameInfo) {
+        if (referencedTraces.find(&pr.second.mVideoEngines) == referencedTraces.end() &&
+            referencedTraces.find(&pr.second.mOtherEngines) == referencedTraces.end()) {
+            candidates->emplace_back(pr.second.mLastUseTime, pr.first);
+        }
+    }
+
+    SelectEvictions(candidates, mProcessFrameInfo.size(), timestamp, timeLimit, tableLimit);
+
+    for (auto const& c : *candidates) {
+        mProcessFrameInfo.erase((uint32_t) c.second);
+    }
+    return candidates->size();
+}
@@ -6,6 +6,7 @@
 #include <unordered_map>
 
 #include "etw/Microsoft_Windows_DxgKrnl.h"
+#include "Eviction.hpp"
 
 struct PresentEvent;
 struct PMTraceConsumer;
@@ -36,12 +37,21 @@ class GpuTrace {
         bool mIsVideo;
     };
 
+    // Device is the adapter a device was created on, and the process that
+    // created it (0 if not yet known).
+    struct Device {
+        uint64_t mDxgAdapter;
+        uint32_t mProcessId;
+    };
+
     // Context is a process' gpu context, mapping a PacketTrace to a
     // particular Node.
     struct Context {
         PacketTrace* mPacketTrace;
         Node* mNode;
+        uint64_t mDevice;
         uint64_t mParentContext;
+        uint32_t mProcessId;                // 0 until the owning process is known
         bool mIsParentContext;
         bool mIsHwQueue;
     };
@@ -51,10 +61,11 @@ class GpuTrace {
         // Depending on mTrackGPUVideo, we may track video engines separately
         PacketTrace mVideoEngines;
         PacketTrace mOtherEngines;
+        uint64_t mLastUseTime;              // QPC of the last context registration or frame completion
     };
 
     std::unordered_map<uint64_t, std::unordered_map<uint32_t, Node> > mNodes;   // pDxgAdapter -> NodeOrdinal -> Node
-    std::unordered_map<uint64_t, uint64_t> mDevices;                            // hDevice -> pDxgAdapter
+    std::unordered_map<uint64_t, Device> mDevices;                              // hDevice -> Device
     std::unordered_map<uint64_t, Context> mContexts;                            // hContext -> Context
     std::unordered_map<uint32_t, ProcessFrameInfo> mProcessFrameInfo;           // ProcessID -> ProcessFrameInfo
     std::unordered_map<uint64_t, uint32_t> mPagingSequenceIds;                  // SequenceID -> ProcessID
@@ -62,7 +73,7 @@ class GpuTrace {
     // The parent trace consumer
     PMTraceConsumer* mPMConsumer;
 
-    void SetContextProcessId(Context* context, uint32_t processId);
+    void SetContextProcessId(Context* context, uint32_t processId, uint64_t timestamp);
 
     void StartPacket(PacketTrace* packetTrace, uint64_t timestamp) const;
     void CompletePacket(PacketTrace* packetTrace, uint64_t timestamp) const;
@@ -76,13 +87,18 @@ class GpuTrace {
 public:
     explicit GpuTrace(PMTraceConsumer* pmConsumer);
 
-    void RegisterDevice(uint64_t hDevice, uint64_t pDxgAdapter);
+    void RegisterDevice(uint64_t hDevice, uint64_t pDxgAdapter, uint32_t processId);
     void UnregisterDevice(uint64_t hDevice);
 
-    void RegisterContext(uint64_t hContext, uint64_t hDevice, uint32_t nodeOrdinal, uint32_t processId);
+    void RegisterContext(uint64_t hContext, uint64_t hDevice, uint32_t nodeOrdinal, uint32_t processId, uint64_t timestamp);
     void RegisterHwQueueContext(uint64_t hContext, uint64_t parentDxgHwQueue);
     void UnregisterContext(uint64_t hContext);
 
+    // Remove the devices and contexts owned by a process that has stopped.
+    // Devices and contexts are otherwise only removed by their stop events,
+    // since an idle context can still submit work at any time.
+    void UnregisterProcess(uint32_t processId);
+
     void SetEngineType(uint64_t pDxgAdapter, uint32_t nodeOrdinal, Microsoft_Windows_DxgKrnl::DXGK_ENGINE engineType);
 
     void EnqueueQueuePacket(uint64_t hContext, uint32_t sequenceId, uint32_t processId, uint64_t timestamp, bool isWaitPacket);
@@ -92,4 +108,15 @@ public:
     void CompleteDmaPacket(uint64_t hContext, uint32_t sequenceId, uint64_t timestamp);
 
     void CompleteFrame(PresentEvent* pEvent, uint64_t timestamp);
+
+    // Evict per-process frame info whose process stop was missed (see
+    // PMTraceConsumer::mTrackingStateTimeLimit) and return the number of entries removed.  A
+    // process is never evicted while it has a context or enqueued work.
+    size_t EvictProcessFrameInfo(uint64_t timestamp, uint64_t timeLimit, size_t tableLimit, EvictionCandidates* candidates);
+
+    // Number of entries in the device, context, process and paging sequence tables.
+    size_t GetDeviceCount() const { return mDevices.size(); }
+    size_t GetContextCount() const { return mContexts.size(); }
+    size_t GetProcessFrameInfoCount() const { return mProcessFrameInfo.size(); }
+    size_t GetPagingSequenceCount() const { return mPagingSequenceIds.size(); }
 };
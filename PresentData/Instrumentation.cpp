@@ -0,0 +1,305 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "Instrumentation.hpp"
+
+#include "PresentMonTraceConsumer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string.h>
+
+char const* GetInstrumentedHandlerName(InstrumentedHandler handler)
+{
+    switch (handler) {
+    case InstrumentedHandler::DXGI:                   return "DXGI";
+    case InstrumentedHandler::D3D9:                   return "D3D9";
+    case InstrumentedHandler::DXGK:                   return "DXGK";
+    case InstrumentedHandler::Win32k:                 return "Win32k";
+    case InstrumentedHandler::DWM:                    return "DWM";
+    case InstrumentedHandler::Process:                return "Process";
+    case InstrumentedHandler::Metadata:               return "Metadata";
+    case InstrumentedHandler::PresentMon:             return "PresentMon";
+    case InstrumentedHandler::Win7DxgkBlt:            return "Win7DxgkBlt";
+    case InstrumentedHandler::Win7DxgkFlip:           return "Win7DxgkFlip";
+    case InstrumentedHandler::Win7DxgkPresentHistory: return "Win7DxgkPresentHistory";
+    case InstrumentedHandler::Win7DxgkQueuePacket:    return "Win7DxgkQueuePacket";
+    case InstrumentedHandler::Win7DxgkVSyncDPC:       return "Win7DxgkVSyncDPC";
+    case InstrumentedHandler::Win7DxgkMMIOFlip:       return "Win7DxgkMMIOFlip";
+    default:                                          return "Unknown";
+    }
+}
+
+char const* GetConsumerTableName(ConsumerTable table)
+{
+    switch (table) {
+    case ConsumerTable::TrackedPresents:                      return "TrackedPresents";
+    case ConsumerTable::PresentByThreadId:                    return "PresentByThreadId";
+    case ConsumerTable::PresentBySubmitSequence:              return "PresentBySubmitSequence";
+    case ConsumerTable::PresentByWin32KPresentHistoryToken:   return "PresentByWin32KPresentHistoryToken";
+    case ConsumerTable::PresentByDxgkPresentHistoryToken:     return "PresentByDxgkPresentHistoryToken";
+    case ConsumerTable::PresentByDxgkPresentHistoryTokenData: return "PresentByDxgkPresentHistoryTokenData";
+    case ConsumerTable::PresentByDxgkContext:                 return "PresentByDxgkContext";
+    case ConsumerTable::PresentByVidPnLayerId:                return "PresentByVidPnLayerId";
+    case ConsumerTable::LastPresentByWindow:                  return "LastPresentByWindow";
+    case ConsumerTable::ReceivedMouseClickByHwnd:             return "ReceivedMouseClickByHwnd";
+    case ConsumerTable::PendingPresentFrameTypeEvents:        return "PendingPresentFrameTypeEvents";
+    case ConsumerTable::PendingFlipFrameTypeEvents:           return "PendingFlipFrameTypeEvents";
+    case ConsumerTable::RetrievedInput:                       return "RetrievedInput";
+    case ConsumerTable::PresentsWaitingForDWM:                return "PresentsWaitingForDWM";
+    case ConsumerTable::GpuDevices:                           return "GpuDevices";
+    case ConsumerTable::GpuContexts:                          return "GpuContexts";
+    case ConsumerTable::GpuProcessFrameInfo:                  return "GpuProcessFrameInfo";
+    case ConsumerTable::GpuPagingSequenceIds:                 return "GpuPagingSequenceIds";
+    default:                                                  return "Unknown";
+    }
+}
+
+uint64_t GetCostHistogramPercentile(uint64_t const* histogram, double fraction)
+{
+    uint64_t count = 0;
+    for (uint32_t b = 0; b < INSTRUMENTATION_COST_BUCKET_COUNT; ++b) {
+        count += histogram[b];
+    }
+
+    uint64_t threshold = (uint64_t) (fraction * count + 0.5);
+    uint64_t sum = 0;
+    for (uint32_t b = 0; b < INSTRUMENTATION_COST_BUCKET_COUNT; ++b) {
+        sum += histogram[b];
+        if (sum >= threshold && sum > 0) {
+            return 2ull << b;
+        }
+    }
+    return 0;
+}
+
+#if PRESENTMON_ENABLE_INSTRUMENTATION
+
+namespace {
+
+// How many events each thread processes between samples of its consumer's table sizes.
+uint32_t const TABLE_SAMPLE_INTERVAL = 4096;
+
+// Number of distinct (handler, event id) pairs each thread can count.  Events that don't fit are
+// only counted in ThreadCounters::mUntrackedEventCount.
+uint32_t const EVENT_SLOT_COUNT = 256;
+
+// Each thread's counters are only written by that thread, so they are updated with a relaxed
+// load and store instead of a locked read-modify-write.  GetInstrumentationSnapshot() can read
+// them at any time from another thread.
+void Accumulate(std::atomic<uint64_t>* counter, uint64_t value)
+{
+    counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+uint32_t GetCostBucket(uint64_t cycles)
+{
+    uint32_t bucket = 0;
+    while (cycles > 1 && bucket < INSTRUMENTATION_COST_BUCKET_COUNT - 1) {
+        cycles >>= 1;
+        bucket += 1;
+    }
+    return bucket;
+}
+
+struct CostCounters {
+    std::atomic<uint64_t> mCount;
+    std::atomic<uint64_t> mCycles;
+    std::atomic<uint64_t> mCycleHistogram[INSTRUMENTATION_COST_BUCKET_COUNT];
+
+    void Add(uint64_t cycles)
+    {
+        Accumulate(&mCount, 1);
+        Accumulate(&mCycles, cycles);
+        Accumulate(&mCycleHistogram[GetCostBucket(cycles)], 1);
+    }
+};
+
+struct ThreadCounters {
+    // Open-addressed table of event costs.  mKeys[i] is zero until slot i is claimed, after which
+    // it holds ((handler + 1) << 16) | eventId.  The key is published after the slot is cleared,
+    // so a reader that sees the key also sees valid counters.
+    std::atomic<uint32_t> mKeys[EVENT_SLOT_COUNT];
+    CostCounters mEventCosts[EVENT_SLOT_COUNT];
+    std::atomic<uint64_t> mUntrackedEventCount;
+
+    CostCounters mCallbackCost;
+    uint32_t mEventsUntilTableSample;
+
+    std::atomic<uint64_t> mTableSizes[(size_t) ConsumerTable::Count];
+    std::atomic<uint64_t> mEvictedEntryCount;
+    std::atomic<uint32_t> mCompletedPresentCount;
+    std::atomic<uint32_t> mPeakCompletedPresentCount;
+};
+
+// Every thread that has processed an event.  Counters are kept after their thread exits so that
+// the events it processed are still reported.
+std::mutex gThreadCountersMutex;
+std::vector<std::unique_ptr<ThreadCounters>> gThreadCounters;
+
+thread_local ThreadCounters* tThreadCounters = nullptr;
+
+ThreadCounters* GetThreadCounters()
+{
+    if (tThreadCounters == nullptr) {
+        std::unique_ptr<ThreadCounters> counters(new ThreadCounters());
+
+        std::lock_guard<std::mutex> lock(gThreadCountersMutex);
+        tThreadCounters = counters.get();
+        gThreadCounters.emplace_back(std::move(counters));
+    }
+    return tThreadCounters;
+}
+
+void SampleTableSizes(ThreadCounters* counters, PMTraceConsumer* pmConsumer)
+{
+    size_t trackedPresents = 0;
+    for (auto const& pr : pmConsumer->mOrderedPresentsByProcessId) {
+        trackedPresents += pr.second.size();
+    }
+
+    size_t const sizes[] = {
+        trackedPresents,
+        pmConsumer->mPresentByThreadId.size(),
+        pmConsumer->mPresentBySubmitSequence.size(),
+        pmConsumer->mPresentByWin32KPresentHistoryToken.size(),
+        pmConsumer->mPresentByDxgkPresentHistoryToken.size(),
+        pmConsumer->mPresentByDxgkPresentHistoryTokenData.size(),
+        pmConsumer->mPresentByDxgkContext.size(),
+        pmConsumer->mPresentByVidPnLayerId.size(),
+        pmConsumer->mLastPresentByWindow.size(),
+        pmConsumer->mReceivedMouseClickByHwnd.size(),
+        pmConsumer->mPendingPresentFrameTypeEvents.size(),
+        pmConsumer->mPendingFlipFrameTypeEvents.size(),
+        pmConsumer->mRetrievedInput.size(),
+        pmConsumer->mPresentsWaitingForDWM.size(),
+        pmConsumer->mGpuTrace.GetDeviceCount(),
+        pmConsumer->mGpuTrace.GetContextCount(),
+        pmConsumer->mGpuTrace.GetProcessFrameInfoCount(),
+        pmConsumer->mGpuTrace.GetPagingSequenceCount(),
+    };
+    static_assert(_countof(sizes) == (size_t) ConsumerTable::Count, "sizes must match ConsumerTable");
+    for (size_t i = 0; i < _countof(sizes); ++i) {
+        counters->mTableSizes[i].store(sizes[i], std::memory_order_relaxed);
+    }
+    counters->mEvictedEntryCount.store(pmConsumer->mEvictedTrackingStateCount, std::memory_order_relaxed);
+
+    uint32_t completedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(pmConsumer->mPresentEventMutex);
+        completedCount = pmConsumer->mCompletedCount;
+    }
+    counters->mCompletedPresentCount.store(completedCount, std::memory_order_relaxed);
+    if (completedCount > counters->mPeakCompletedPresentCount.load(std::memory_order_relaxed)) {
+        counters->mPeakCompletedPresentCount.store(completedCount, std::memory_order_relaxed);
+    }
+}
+
+}
+
+void RecordHandlerCost(InstrumentedHandler handler, _EVENT_RECORD const* eventRecord, uint64_t cycles)
+{
+    auto counters = GetThreadCounters();
+    auto eventId = eventRecord->EventHeader.EventDescriptor.Id;
+    auto key = (((uint32_t) handler + 1) << 16) | eventId;
+
+    for (uint32_t i = 0, slot = (key * 2654435761u) % EVENT_SLOT_COUNT; i < EVENT_SLOT_COUNT; ++i, slot = (slot + 1) % EVENT_SLOT_COUNT) {
+        auto slotKey = counters->mKeys[slot].load(std::memory_order_relaxed);
+        if (slotKey == 0) {
+            counters->mKeys[slot].store(key, std::memory_order_release);
+            slotKey = key;
+        }
+        if (slotKey == key) {
+            counters->mEventCosts[slot].Add(cycles);
+            return;
+        }
+    }
+
+    Accumulate(&counters->mUntrackedEventCount, 1);
+}
+
+void RecordCallbackCost(PMTraceConsumer* pmConsumer, uint64_t cycles)
+{
+    auto counters = GetThreadCounters();
+    counters->mCallbackCost.Add(cycles);
+
+    if (counters->mEventsUntilTableSample == 0) {
+        counters->mEventsUntilTableSample = TABLE_SAMPLE_INTERVAL;
+        SampleTableSizes(counters, pmConsumer);
+    }
+    counters->mEventsUntilTableSample -= 1;
+}
+
+bool GetInstrumentationSnapshot(InstrumentationSnapshot* snapshot)
+{
+    snapshot->mEventCount = 0;
+    snapshot->mCallbackCycles = 0;
+    snapshot->mUntrackedEventCount = 0;
+    snapshot->mEventCosts.clear();
+    snapshot->mEvictedEntryCount = 0;
+    snapshot->mCompletedPresentCount = 0;
+    snapshot->mPeakCompletedPresentCount = 0;
+    memset(snapshot->mCallbackCycleHistogram, 0, sizeof(snapshot->mCallbackCycleHistogram));
+    memset(snapshot->mTableSizes, 0, sizeof(snapshot->mTableSizes));
+
+    std::lock_guard<std::mutex> lock(gThreadCountersMutex);
+    for (auto const& counters : gThreadCounters) {
+        snapshot->mEventCount += counters->mCallbackCost.mCount.load(std::memory_order_relaxed);
+        snapshot->mCallbackCycles += counters->mCallbackCost.mCycles.load(std::memory_order_relaxed);
+        for (uint32_t b = 0; b < INSTRUMENTATION_COST_BUCKET_COUNT; ++b) {
+            snapshot->mCallbackCycleHistogram[b] += counters->mCallbackCost.mCycleHistogram[b].load(std::memory_order_relaxed);
+        }
+        snapshot->mUntrackedEventCount += counters->mUntrackedEventCount.load(std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < EVENT_SLOT_COUNT; ++i) {
+            auto key = counters->mKeys[i].load(std::memory_order_acquire);
+            if (key == 0) {
+                continue;
+            }
+
+            auto handler = (InstrumentedHandler) ((key >> 16) - 1);
+            auto eventId = (uint16_t) key;
+            auto ii = std::find_if(snapshot->mEventCosts.begin(), snapshot->mEventCosts.end(), [=](HandlerEventCost const& c) {
+                return c.mHandler == handler && c.mEventId == eventId;
+            });
+            if (ii == snapshot->mEventCosts.end()) {
+                HandlerEventCost cost = {};
+                cost.mHandler = handler;
+                cost.mEventId = eventId;
+                ii = snapshot->mEventCosts.insert(ii, cost);
+            }
+
+            auto const& src = counters->mEventCosts[i];
+            ii->mCount += src.mCount.load(std::memory_order_relaxed);
+            ii->mCycles += src.mCycles.load(std::memory_order_relaxed);
+            for (uint32_t b = 0; b < INSTRUMENTATION_COST_BUCKET_COUNT; ++b) {
+                ii->mCycleHistogram[b] += src.mCycleHistogram[b].load(std::memory_order_relaxed);
+            }
+        }
+
+        for (size_t t = 0; t < (size_t) ConsumerTable::Count; ++t) {
+            snapshot->mTableSizes[t] += counters->mTableSizes[t].load(std::memory_order_relaxed);
+        }
+        snapshot->mEvictedEntryCount += counters->mEvictedEntryCount.load(std::memory_order_relaxed);
+        snapshot->mCompletedPresentCount += counters->mCompletedPresentCount.load(std::memory_order_relaxed);
+        snapshot->mPeakCompletedPresentCount = std::max(snapshot->mPeakCompletedPresentCount,
+                                                        counters->mPeakCompletedPresentCount.load(std::memory_order_relaxed));
+    }
+
+    std::sort(snapshot->mEventCosts.begin(), snapshot->mEventCosts.end(), [](HandlerEventCost const& a, HandlerEventCost const& b) {
+        return a.mHandler != b.mHandler ? a.mHandler < b.mHandler : a.mEventId < b.mEventId;
+    });
+    return true;
+}
+
+#else
+
+bool GetInstrumentationSnapshot(InstrumentationSnapshot* snapshot)
+{
+    *snapshot = InstrumentationSnapshot();
+    return false;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Instrumentation of the event analysis hot path.  When enabled, EventRecordCallback() and the
+// PMTraceConsumer::Handle*() functions count the events they process along with a histogram of
+// how many cycles each one took, and the size of the consumer's tracking tables is sampled
+// periodically.  This can be used to tell whether the consumer thread is causing ETW to lose
+// events, and which events are the most expensive to analyze.
+//
+// When PRESENTMON_ENABLE_INSTRUMENTATION==0 the instrumentation compiles away, and
+// GetInstrumentationSnapshot() reports that it is unavailable.
+#ifndef PRESENTMON_ENABLE_INSTRUMENTATION
+#define PRESENTMON_ENABLE_INSTRUMENTATION 0
+#endif
+
+struct PMTraceConsumer;
+struct _EVENT_RECORD;
+
+// The PMTraceConsumer::Handle*() function that analyzed an event.  Event ids are only unique
+// within a handler; DWM events from both the Dwm_Core and Win7 providers are counted as DWM.
+enum class InstrumentedHandler : uint8_t {
+    DXGI,
+    D3D9,
+    DXGK,
+    Win32k,
+    DWM,
+    Process,
+    Metadata,
+    PresentMon,
+    Win7DxgkBlt,
+    Win7DxgkFlip,
+    Win7DxgkPresentHistory,
+    Win7DxgkQueuePacket,
+    Win7DxgkVSyncDPC,
+    Win7DxgkMMIOFlip,
+    Count
+};
+
+// PMTraceConsumer and GpuTrace tables that hold per-present, per-process or per-context state.
+enum class ConsumerTable : uint8_t {
+    TrackedPresents,                // Sum of mOrderedPresentsByProcessId sizes
+    PresentByThreadId,
+    PresentBySubmitSequence,
+    PresentByWin32KPresentHistoryToken,
+    PresentByDxgkPresentHistoryToken,
+    PresentByDxgkPresentHistoryTokenData,
+    PresentByDxgkContext,
+    PresentByVidPnLayerId,
+    LastPresentByWindow,
+    ReceivedMouseClickByHwnd,
+    PendingPresentFrameTypeEvents,
+    PendingFlipFrameTypeEvents,
+    RetrievedInput,
+    PresentsWaitingForDWM,
+    GpuDevices,
+    GpuContexts,
+    GpuProcessFrameInfo,
+    GpuPagingSequenceIds,
+    Count
+};
+
+// Bucket i of a cost histogram counts calls that took [2^i, 2^(i+1)) cycles, except that the last
+// bucket also counts all longer calls.
+uint32_t const INSTRUMENTATION_COST_BUCKET_COUNT = 24;
+
+struct HandlerEventCost {
+    InstrumentedHandler mHandler;
+    uint16_t mEventId;
+    uint64_t mCount;
+    uint64_t mCycles;
+    uint64_t mCycleHistogram[INSTRUMENTATION_COST_BUCKET_COUNT];
+};
+
+// Counters summed over every thread that has processed events.  Table sizes and completed present
+// counts (and evicted entry counts) are the values last sampled by each thread's consumer.
+struct InstrumentationSnapshot {
+    uint64_t mEventCount;                   // Events received by EventRecordCallback()
+    uint64_t mCallbackCycles;               // Cycles spent in EventRecordCallback(), including the handlers
+    uint64_t mCallbackCycleHistogram[INSTRUMENTATION_COST_BUCKET_COUNT];
+    uint64_t mUntrackedEventCount;          // Handled events whose event id didn't fit in the per-thread table
+    std::vector<HandlerEventCost> mEventCosts;  // Ordered by handler, then event id
+    uint64_t mTableSizes[(size_t) ConsumerTable::Count];
+    uint64_t mEvictedEntryCount;            // Stale entries evicted from the tables (see PMTraceConsumer::mTrackingStateTimeLimit)
+    uint32_t mCompletedPresentCount;        // Presents waiting in the completed ring to be dequeued
+    uint32_t mPeakCompletedPresentCount;
+};
+
+// Returns false, and an empty snapshot, if the instrumentation is compiled out.
+bool GetInstrumentationSnapshot(InstrumentationSnapshot* snapshot);
+
+// Returns the number of cycles below which at least the given fraction of the calls counted by a
+// cost histogram completed, rounded up to the histogram's resolution.
+uint64_t GetCostHistogramPercentile(uint64_t const* histogram, double fraction);
+
+char const* GetInstrumentedHandlerName(InstrumentedHandler handler);
+char const* GetConsumerTableName(ConsumerTable table);
+
+#if PRESENTMON_ENABLE_INSTRUMENTATION
+
+#include <intrin.h>
+
+inline uint64_t ReadInstrumentationCycleCounter()
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    return __rdtsc();
+#elif defined(_M_ARM64)
+    return _ReadStatusReg(ARM64_CNTVCT);
+#else
+    return __rdpmccntr64();
+#endif
+}
+
+void RecordHandlerCost(InstrumentedHandler handler, _EVENT_RECORD const* eventRecord, uint64_t cycles);
+void RecordCallbackCost(PMTraceConsumer* pmConsumer, uint64_t cycles);
+
+class HandlerInstrumentationScope {
+    _EVENT_RECORD const* mEventRecord;
+    uint64_t mStart;
+    InstrumentedHandler mHandler;
+
+public:
+    HandlerInstrumentationScope(InstrumentedHandler handler, _EVENT_RECORD const* eventRecord)
+        : mEventRecord(eventRecord)
+        , mStart(ReadInstrumentationCycleCounter())
+        , mHandler(handler)
+    {
+    }
+    ~HandlerInstrumentationScope()
+    {
+        RecordHandlerCost(mHandler, mEventRecord, ReadInstrumentationCycleCounter() - mStart);
+    }
+};
+
+class CallbackInstrumentationScope {
+    PMTraceConsumer* mPMConsumer;
+    uint64_t mStart;
+
+public:
+    explicit CallbackInstrumentationScope(PMTraceConsumer* pmConsumer)
+        : mPMConsumer(pmConsumer)
+        , mStart(ReadInstrumentationCycleCounter())
+    {
+    }
+    ~CallbackInstrumentationScope()
+    {
+        RecordCallbackCost(mPMConsumer, ReadInstrumentationCycleCounter() - mStart);
+    }
+};
+
+// Measure the rest of the enclosing scope.
+#define InstrumentHandler(handler, eventRecord) HandlerInstrumentationScope handlerInstrumentationScope_(handler, eventRecord)
+#define InstrumentEventRecordCallback(pmConsumer) CallbackInstrumentationScope callbackInstrumentationScope_(pmConsumer)
+
+#else
+
+#define InstrumentHandler(handler, eventRecord)
+#define InstrumentEventRecordCallback(pmConsumer)
+
+#endif
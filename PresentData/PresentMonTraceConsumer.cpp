@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "PresentMonTraceConsumer.hpp"
+#include "Instrumentation.hpp"
 
 #include "ETW/Intel_PresentMon.h"
 #include "ETW/Microsoft_Windows_D3D9.h"
@@ -35,6 +36,21 @@ static inline uint64_t GenerateVidPnLayerId(uint32_t vidPnSourceId, uint32_t lay
     return (((uint64_t) vidPnSourceId) << 32) | (uint64_t) layerIndex;
 }
 
+// Removes any directory and extension, and converts the remaining name to lower case.
+static void CanonicalizeProcessName(std::wstring* name)
+{
+    size_t i = name->find_last_of(L"./\\");
+    if (i != std::wstring::npos && (*name)[i] == L'.') {
+        name->resize(i);
+        i = name->find_last_of(L"/\\");
+    }
+
+    name->erase(0, i + 1);
+
+    std::transform(name->begin(), name->end(), name->begin(),
+                   [](wchar_t c) { return (wchar_t) ::towlower(c); });
+}
+
 static inline FrameType ConvertPMPFrameTypeToFrameType(Intel_PresentMon::FrameType frameType)
 {
     switch (frameType) {
@@ -120,6 +136,8 @@ PMTraceConsumer::~PMTraceConsumer()
 
 void PMTraceConsumer::HandleD3D9Event(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::D3D9, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
     switch (hdr.EventDescriptor.Id) {
     case Microsoft_Windows_D3D9::Present_Start::Id:
@@ -158,6 +176,8 @@ void PMTraceConsumer::HandleD3D9Event(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleDXGIEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::DXGI, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
     switch (hdr.EventDescriptor.Id) {
     case Microsoft_Windows_DXGI::Present_Start::Id:
@@ -646,6 +666,8 @@ void PMTraceConsumer::HandleDxgkPresentHistoryInfo(EVENT_HEADER const& hdr, uint
 
 void PMTraceConsumer::HandleDXGKEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::DXGK, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
 
     if (hdr.EventDescriptor.Id == Microsoft_Windows_DxgKrnl::PresentHistory_Start::Id ||
@@ -993,7 +1015,13 @@ void PMTraceConsumer::HandleDXGKEvent(EVENT_RECORD* pEventRecord)
             auto pDxgAdapter = desc[0].GetData<uint64_t>();
             auto hDevice     = desc[1].GetData<uint64_t>();
 
-            mGpuTrace.RegisterDevice(hDevice, pDxgAdapter);
+            // If this is a DCStart, then it was generated by xperf instead of
+            // the device's process.
+            uint32_t processId = hdr.EventDescriptor.Id == Microsoft_Windows_DxgKrnl::Device_DCStart::Id
+                ? 0
+                : hdr.ProcessId;
+
+            mGpuTrace.RegisterDevice(hDevice, pDxgAdapter, processId);
             return;
         }
         // Sometimes a trace will miss a Device_Start, so we also check
@@ -1012,7 +1040,7 @@ void PMTraceConsumer::HandleDXGKEvent(EVENT_RECORD* pEventRecord)
             auto hDevice     = desc[1].GetData<uint64_t>();
 
             if (hDevice != 0) {
-                mGpuTrace.RegisterDevice(hDevice, pDxgAdapter);
+                mGpuTrace.RegisterDevice(hDevice, pDxgAdapter, 0);
             }
             return;
         }
@@ -1042,7 +1070,7 @@ void PMTraceConsumer::HandleDXGKEvent(EVENT_RECORD* pEventRecord)
                 ? 0
                 : hdr.ProcessId;
 
-            mGpuTrace.RegisterContext(hContext, hDevice, NodeOrdinal, processId);
+            mGpuTrace.RegisterContext(hContext, hDevice, NodeOrdinal, processId, hdr.TimeStamp.QuadPart);
             return;
         }
         case Microsoft_Windows_DxgKrnl::Context_Stop::Id:
@@ -1203,6 +1231,8 @@ void PMTraceConsumer::HandleDXGKEvent(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkBlt(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkBlt, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     auto pBltEvent = reinterpret_cast<DXGKETW_BLTEVENT*>(pEventRecord->UserData);
@@ -1214,6 +1244,8 @@ void PMTraceConsumer::HandleWin7DxgkBlt(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkFlip(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkFlip, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     auto pFlipEvent = reinterpret_cast<DXGKETW_FLIPEVENT*>(pEventRecord->UserData);
@@ -1226,6 +1258,8 @@ void PMTraceConsumer::HandleWin7DxgkFlip(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkPresentHistory(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkPresentHistory, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     auto pPresentHistoryEvent = reinterpret_cast<DXGKETW_PRESENTHISTORYEVENT*>(pEventRecord->UserData);
@@ -1242,6 +1276,8 @@ void PMTraceConsumer::HandleWin7DxgkPresentHistory(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkQueuePacket(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkQueuePacket, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     if (pEventRecord->EventHeader.EventDescriptor.Opcode == EVENT_TRACE_TYPE_START) {
@@ -1264,6 +1300,8 @@ void PMTraceConsumer::HandleWin7DxgkQueuePacket(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkVSyncDPC(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkVSyncDPC, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     auto pVSyncDPCEvent = reinterpret_cast<DXGKETW_SCHEDULER_VSYNC_DPC*>(pEventRecord->UserData);
@@ -1274,6 +1312,8 @@ void PMTraceConsumer::HandleWin7DxgkVSyncDPC(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleWin7DxgkMMIOFlip(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win7DxgkMMIOFlip, pEventRecord);
+
     using namespace Microsoft_Windows_DxgKrnl::Win7;
 
     if (pEventRecord->EventHeader.Flags & EVENT_HEADER_FLAG_32_BIT_HEADER) {
@@ -1304,6 +1344,8 @@ std::size_t PMTraceConsumer::Win32KPresentHistoryTokenHash::operator()(PMTraceCo
 
 void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Win32k, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
 
     if (mTrackDisplay) {
@@ -1490,16 +1532,28 @@ void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
 
             auto ii = mRetrievedInput.find(hdr.ProcessId);
             if (ii == mRetrievedInput.end()) {
-                InputData data = { mLastInputDeviceReadTime, 0, 0, mLastInputDeviceType, hWnd };
+                InputData data = { mLastInputDeviceReadTime, 0, 0, mLastInputDeviceType, hWnd, (uint64_t) hdr.TimeStamp.QuadPart };
+
+                // If this process' entry was evicted, we no longer know whether it already
+                // retrieved the last input.  Any input it hadn't retrieved is newer than the
+                // eviction time limit though, so older input is treated as retrieved.
+                if (mTrackingStateTimeLimit != 0 &&
+                    hdr.TimeStamp.QuadPart > mLastInputDeviceReadTime &&
+                    hdr.TimeStamp.QuadPart - mLastInputDeviceReadTime > mTrackingStateTimeLimit) {
+                    data.Type = InputDeviceType::None;
+                }
+
                 auto it = mReceivedMouseClickByHwnd.find(hWnd);
                 if (it != mReceivedMouseClickByHwnd.end()) {
                     data.MouseClickTime = it->second.CurrentMouseClickTime;
                     data.XFormTime = it->second.CurrentXFormTime;
                     it->second.LastMouseClickTime = it->second.CurrentMouseClickTime;
                     it->second.LastXFormTime = it->second.CurrentXFormTime;
+                    it->second.LastUpdateTime = hdr.TimeStamp.QuadPart;
                 }
                 mRetrievedInput.emplace(hdr.ProcessId, data);
             } else {
+                ii->second.LastUpdateTime = hdr.TimeStamp.QuadPart;
                 if (ii->second.Time < mLastInputDeviceReadTime) {
                     ii->second.Time = mLastInputDeviceReadTime;
                     ii->second.Type = mLastInputDeviceType;
@@ -1517,6 +1571,7 @@ void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
                             ii->second.XFormTime = it->second.CurrentXFormTime;
                             it->second.LastMouseClickTime = it->second.CurrentMouseClickTime;
                             it->second.LastXFormTime = it->second.CurrentXFormTime;
+                            it->second.LastUpdateTime = hdr.TimeStamp.QuadPart;
                         }
                     }
                 }
@@ -1539,10 +1594,11 @@ void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
                 if (it->second.LastMouseClickTime < mLastInputDeviceReadTime) {
                     it->second.CurrentMouseClickTime = mLastInputDeviceReadTime;
                     it->second.CurrentXFormTime = xFormQPCTime;
+                    it->second.LastUpdateTime = hdr.TimeStamp.QuadPart;
                 }
             }
             else {
-                MouseClickData data = { mLastInputDeviceReadTime, xFormQPCTime , 0, 0 };
+                MouseClickData data = { mLastInputDeviceReadTime, xFormQPCTime , 0, 0, hWnd, (uint64_t) hdr.TimeStamp.QuadPart };
                 mReceivedMouseClickByHwnd.emplace(hWnd, data);
             }
 
@@ -1557,6 +1613,8 @@ void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
 
 void PMTraceConsumer::HandleDWMEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::DWM, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
     switch (hdr.EventDescriptor.Id) {
     case Microsoft_Windows_Dwm_Core::MILEVENT_MEDIA_UCE_PROCESSPRESENTHISTORY_GetPresentHistory_Info::Id:
@@ -2077,6 +2135,13 @@ std::shared_ptr<PresentEvent> PMTraceConsumer::FindOrCreatePresent(EVENT_HEADER
     // been deferred by the driver and submitted on a different thread.  Such
     // presents should have only seen present start/stop events so should not
     // have a known PresentMode, etc. yet.
+    //
+    // Processes that are filtered out don't have any in-progress presents, so
+    // we check the filter before adding them to mOrderedPresentsByProcessId.
+    if (!IsProcessTrackedForFiltering(hdr.ProcessId)) {
+        return nullptr;
+    }
+
     auto presentsByThisProcess = &mOrderedPresentsByProcessId[hdr.ProcessId];
     for (auto const& pr : *presentsByThisProcess) {
         present = pr.second;
@@ -2098,29 +2163,24 @@ std::shared_ptr<PresentEvent> PMTraceConsumer::FindOrCreatePresent(EVENT_HEADER
     }
 
     // If we couldn't find an in-progress present on the same thread/process,
-    // then we create a new one and start tracking it from here (unless the
-    // user is filtering this process out).
+    // then we create a new one and start tracking it from here.
     //
     // This can happen if there was a lost event, or if the present didn't
     // originate from a runtime whose events we're tracking (i.e., DXGI or
     // D3D9) in which case a DxgKrnl event will be the first present-related
     // event we ever see.
-    if (IsProcessTrackedForFiltering(hdr.ProcessId)) {
-        present = std::make_shared<PresentEvent>();
-
-        VerboseTraceBeforeModifyingPresent(present.get());
-        present->PresentStartTime = *(uint64_t*) &hdr.TimeStamp;
-        present->ProcessId = hdr.ProcessId;
-        present->ThreadId = hdr.ThreadId;
+    present = std::make_shared<PresentEvent>();
 
-        ApplyPresentFrameType(present);
+    VerboseTraceBeforeModifyingPresent(present.get());
+    present->PresentStartTime = *(uint64_t*) &hdr.TimeStamp;
+    present->ProcessId = hdr.ProcessId;
+    present->ThreadId = hdr.ThreadId;
 
-        TrackPresent(present, presentsByThisProcess);
+    ApplyPresentFrameType(present);
 
-        return present;
-    }
+    TrackPresent(present, presentsByThisProcess);
 
-    return nullptr;
+    return present;
 }
 
 void PMTraceConsumer::TrackPresent(
@@ -2156,6 +2216,7 @@ void PMTraceConsumer::TrackPresent(
             }
             ii->second.Type = InputDeviceType::None;
             ii->second.XFormTime = 0;
+            ii->second.LastUpdateTime = present->PresentStartTime;
         }
     }
 }
@@ -2263,6 +2324,8 @@ void PMTraceConsumer::RuntimePresentStop(Runtime runtime, EVENT_HEADER const& hd
 
 void PMTraceConsumer::HandleProcessEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Process, pEventRecord);
+
     auto const& hdr = pEventRecord->EventHeader;
 
     ProcessEvent event;
@@ -2325,6 +2388,25 @@ void PMTraceConsumer::HandleProcessEvent(EVENT_RECORD* pEventRecord)
         }
     }
 
+    // Update the name filter results now, so presents don't have to query the process name.
+    if (mFilteredProcessNames) {
+        if (event.IsStartEvent) {
+            mProcessNameFilterResults[event.ProcessId] = PassesProcessNameFilter(event.ImageFileName);
+        } else {
+            mProcessNameFilterResults.erase(event.ProcessId);
+        }
+    }
+
+    // Any input the process retrieved but didn't present will never be applied.
+    if (mTrackInput && !event.IsStartEvent) {
+        mRetrievedInput.erase(event.ProcessId);
+    }
+
+    // The process' devices and contexts can't be used anymore, even if their stop events are lost.
+    if (mTrackGPU && !event.IsStartEvent) {
+        mGpuTrace.UnregisterProcess(event.ProcessId);
+    }
+
     {
         std::lock_guard<std::mutex> lock(mProcessEventMutex);
         mProcessEvents.emplace_back(event);
@@ -2332,8 +2414,51 @@ void PMTraceConsumer::HandleProcessEvent(EVENT_RECORD* pEventRecord)
     SignalEventsReady();
 }
 
+bool PMTraceConsumer::IsProcessNameTracked(uint32_t processId)
+{
+    auto ii = mProcessNameFilterResults.find(processId);
+    if (ii != mProcessNameFilterResults.end()) {
+        return ii->second;
+    }
+
+    std::wstring imageFileName;
+    if (mProcessNameResolver) {
+        mProcessNameResolver(processId, &imageFileName);
+    }
+
+    auto tracked = PassesProcessNameFilter(imageFileName);
+    mProcessNameFilterResults.emplace(processId, tracked);
+    return tracked;
+}
+
+bool PMTraceConsumer::PassesProcessNameFilter(std::wstring const& imageFileName) const
+{
+    auto name = imageFileName;
+    CanonicalizeProcessName(&name);
+
+    for (auto const& excludedName : mExcludedProcessNames) {
+        if (name == excludedName) {
+            return false;
+        }
+    }
+
+    if (mTargetProcessNames.empty()) {
+        return true;
+    }
+
+    for (auto const& targetName : mTargetProcessNames) {
+        if (name == targetName) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void PMTraceConsumer::HandleIntelPresentMonEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::PresentMon, pEventRecord);
+
     if (mTrackFrameType) {
         switch (pEventRecord->EventHeader.EventDescriptor.Id) {
         case Intel_PresentMon::PresentFrameType_Info::Id: {
@@ -2432,6 +2557,79 @@ void PMTraceConsumer::ApplyPresentFrameType(
 }
 
 // TODO: consider separating process and present events, would reduce unneccessary mutex locking
+void PMTraceConsumer::SweepTrackingState(uint64_t timestamp)
+{
+    // The tables are swept in turn, so each sweep only iterates over one of them.  GPU devices
+    // and contexts are not swept: an idle context can submit work at any time, so they are only
+    // removed by their stop events or when their process stops (see HandleProcessEvent).
+    static ConsumerTable const SWEPT_TABLES[] = {
+        ConsumerTable::ReceivedMouseClickByHwnd,
+        ConsumerTable::RetrievedInput,
+        ConsumerTable::PendingFlipFrameTypeEvents,
+        ConsumerTable::GpuProcessFrameInfo,
+    };
+
+    mEventsUntilTrackingStateSweep = std::max(mTrackingStateSweepInterval, 1u);
+    if (mTrackingStateTimeLimit == 0 && mTrackingStateTableLimit == 0) {
+        return;
+    }
+
+    auto table = SWEPT_TABLES[mNextTrackingStateSweep];
+    mNextTrackingStateSweep = (mNextTrackingStateSweep + 1) % (uint32_t) _countof(SWEPT_TABLES);
+
+    auto candidates = &mEvictionCandidates;
+    auto timeLimit = mTrackingStateTimeLimit;
+    auto tableLimit = mTrackingStateTableLimit;
+    size_t evictedCount = 0;
+    switch (table) {
+    case ConsumerTable::ReceivedMouseClickByHwnd:
+        candidates->clear();
+        for (auto const& pr : mReceivedMouseClickByHwnd) {
+            candidates->emplace_back(pr.second.LastUpdateTime, pr.first);
+        }
+        SelectEvictions(candidates, mReceivedMouseClickByHwnd.size(), timestamp, timeLimit, tableLimit);
+        for (auto const& c : *candidates) {
+            mReceivedMouseClickByHwnd.erase(c.second);
+        }
+        evictedCount = candidates->size();
+        break;
+
+    case ConsumerTable::RetrievedInput:
+        candidates->clear();
+        for (auto const& pr : mRetrievedInput) {
+            candidates->emplace_back(pr.second.LastUpdateTime, pr.first);
+        }
+        SelectEvictions(candidates, mRetrievedInput.size(), timestamp, timeLimit, tableLimit);
+        for (auto const& c : *candidates) {
+            mRetrievedInput.erase((uint32_t) c.second);
+        }
+        evictedCount = candidates->size();
+        break;
+
+    case ConsumerTable::PendingFlipFrameTypeEvents:
+        candidates->clear();
+        for (auto const& pr : mPendingFlipFrameTypeEvents) {
+            candidates->emplace_back(pr.second.Timestamp, pr.first);
+        }
+        SelectEvictions(candidates, mPendingFlipFrameTypeEvents.size(), timestamp, timeLimit, tableLimit);
+        for (auto const& c : *candidates) {
+            mPendingFlipFrameTypeEvents.erase(c.second);
+        }
+        evictedCount = candidates->size();
+        break;
+
+    case ConsumerTable::GpuProcessFrameInfo: evictedCount = mGpuTrace.EvictProcessFrameInfo(timestamp, timeLimit, tableLimit, candidates); break;
+    default: break;
+    }
+
+    mEvictedTrackingStateCount += evictedCount;
+
+    #pragma warning(suppress: 4127) // conditional expression is constant in release build
+    if (IsVerboseTraceEnabled() && evictedCount > 0) {
+        wprintf(L"                             Evicted %zu stale %hs entries\n", evictedCount, GetConsumerTableName(table));
+    }
+}
+
 void PMTraceConsumer::SignalEventsReady()
 {
     SetEvent(hEventsReadyEvent);
@@ -2439,6 +2637,7 @@ void PMTraceConsumer::SignalEventsReady()
 
 void PMTraceConsumer::HandleMetadataEvent(EVENT_RECORD* pEventRecord)
 {
+    InstrumentHandler(InstrumentedHandler::Metadata, pEventRecord);
     mMetadata.AddMetadata(pEventRecord);
 }
 
@@ -2462,13 +2661,33 @@ void PMTraceConsumer::RemoveTrackedProcessForFiltering(uint32_t processID)
 
 bool PMTraceConsumer::IsProcessTrackedForFiltering(uint32_t processID)
 {
-    if (!mFilteredProcessIds || processID == DwmProcessId) {
+    if (processID == DwmProcessId) {
         return true;
     }
 
-    std::shared_lock<std::shared_mutex> lock(mTrackedProcessFilterMutex);
-    auto iterator = mTrackedProcessFilter.find(processID);
-    return (iterator != mTrackedProcessFilter.end());
+    if (mFilteredProcessIds) {
+        std::shared_lock<std::shared_mutex> lock(mTrackedProcessFilterMutex);
+        auto iterator = mTrackedProcessFilter.find(processID);
+        if (iterator == mTrackedProcessFilter.end()) {
+            return false;
+        }
+    }
+
+    return !mFilteredProcessNames || IsProcessNameTracked(processID);
+}
+
+void PMTraceConsumer::AddTargetProcessName(std::wstring const& name)
+{
+    mTargetProcessNames.emplace_back(name);
+    CanonicalizeProcessName(&mTargetProcessNames.back());
+    mFilteredProcessNames = true;
+}
+
+void PMTraceConsumer::AddExcludedProcessName(std::wstring const& name)
+{
+    mExcludedProcessNames.emplace_back(name);
+    CanonicalizeProcessName(&mExcludedProcessNames.back());
+    mFilteredProcessNames = true;
 }
 
 void PMTraceConsumer::DequeueProcessEvents(std::vector<ProcessEvent>& outProcessEvents)
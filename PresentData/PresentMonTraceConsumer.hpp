@@ -7,6 +7,7 @@
 #endif
 
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -132,6 +133,7 @@ struct InputData {
     uint64_t XFormTime;
     InputDeviceType Type;
     uint64_t hWnd;
+    uint64_t LastUpdateTime;    // QPC when the input was last retrieved or applied to a present
 };
 
 struct MouseClickData {
@@ -140,6 +142,7 @@ struct MouseClickData {
     uint64_t LastMouseClickTime;
     uint64_t LastXFormTime;
     uint64_t hWnd;
+    uint64_t LastUpdateTime;    // QPC when the click was last updated or retrieved
 };
 
 struct PresentFrameTypeEvent {
@@ -266,6 +269,17 @@ struct PMTraceConsumer
     bool mIsRealtimeSession = true; // allow consumer to have different behavior for realtime vs. offline analysis
     bool mDisableOfflineBackpressure = false;
 
+    // Some tracking state is only removed when an expected event arrives (e.g., the process stop
+    // of a process whose mouse clicks were tracked), and accumulates if that event is missed or
+    // never comes.  Every mTrackingStateSweepInterval events, one such table is swept and any
+    // entries not used for longer than mTrackingStateTimeLimit are evicted.  If the table still
+    // has more than mTrackingStateTableLimit entries, the least-recently used ones are evicted
+    // too.  The default limits of 0 mean that no state is evicted.  GPU devices and contexts are
+    // never evicted this way; they are removed by their own stop events or their process' stop.
+    uint64_t mTrackingStateTimeLimit = 0;           // QPC duration
+    uint32_t mTrackingStateTableLimit = 0;
+    uint32_t mTrackingStateSweepInterval = 4096;
+
     // -------------------------------------------------------------------------------------------
     // These functions can be used to filter PresentEvents by process from within the consumer.
 
@@ -273,6 +287,24 @@ struct PMTraceConsumer
     void RemoveTrackedProcessForFiltering(uint32_t processID);
     bool IsProcessTrackedForFiltering(uint32_t processID);
 
+    // -------------------------------------------------------------------------------------------
+    // These functions can be used to filter PresentEvents by process name from within the
+    // consumer, in addition to any process id filtering.  They should be called prior to starting
+    // the trace session.
+    //
+    // Names are compared without case, directory, or extension.  Once any target name is added,
+    // only processes matching a target name are tracked.  Processes matching an excluded name are
+    // never tracked.
+    //
+    // A process's name is taken from its process start event.  If a present is seen from a
+    // process whose start event was not (e.g., a process that was already running when a realtime
+    // session started), mProcessNameResolver is used to query the name.  If it is not set, or
+    // returns false, the process is treated as having an unknown name.
+
+    void AddTargetProcessName(std::wstring const& name);
+    void AddExcludedProcessName(std::wstring const& name);
+    std::function<bool(uint32_t processId, std::wstring* imageFileName)> mProcessNameResolver;
+
 
     // -------------------------------------------------------------------------------------------
     // Once the session is started the consumer will consume and analyze ETW data to produce
@@ -315,6 +347,14 @@ struct PMTraceConsumer
     std::set<uint32_t> mTrackedProcessFilter;
     std::shared_mutex mTrackedProcessFilterMutex;
 
+    // Limit tracking to processes with specified names.  mProcessNameFilterResults stores whether
+    // each process seen so far passes the name filter, and is only accessed from the thread
+    // consuming events.
+    std::vector<std::wstring> mTargetProcessNames;
+    std::vector<std::wstring> mExcludedProcessNames;
+    std::unordered_map<uint32_t, bool> mProcessNameFilterResults; // ProcessId -> tracked
+    bool mFilteredProcessNames = false;
+
     // Whether we've completed any presents yet.  This is used to indicate that all the necessary
     // providers have started and it's safe to start tracking presents.
     bool mHasCompletedAPresent = false;
@@ -429,6 +469,13 @@ struct PMTraceConsumer
 
     std::unordered_map<uint32_t, InputData> mRetrievedInput; // ProcessID -> InputData<InputTime, InputType, isMouseClick>
 
+    // State for evicting stale tracking state (see mTrackingStateTimeLimit).
+    // mEvictedTrackingStateCount is the total number of entries evicted from all tables.
+    EvictionCandidates mEvictionCandidates;
+    uint32_t mEventsUntilTrackingStateSweep = 1;
+    uint32_t mNextTrackingStateSweep = 0;
+    uint64_t mEvictedTrackingStateCount = 0;
+
 
     // -------------------------------------------------------------------------------------------
     // Functions for decoding ETW and analysing process and present events.
@@ -451,6 +498,8 @@ struct PMTraceConsumer
     void HandleDxgkPresentHistoryInfo(EVENT_HEADER const& hdr, uint64_t token);
 
     void HandleProcessEvent(EVENT_RECORD* pEventRecord);
+    bool IsProcessNameTracked(uint32_t processId);
+    bool PassesProcessNameFilter(std::wstring const& imageFileName) const;
     void HandleDXGIEvent(EVENT_RECORD* pEventRecord);
     void HandleD3D9Event(EVENT_RECORD* pEventRecord);
     void HandleDXGKEvent(EVENT_RECORD* pEventRecord);
@@ -489,4 +538,13 @@ struct PMTraceConsumer
     void ApplyPresentFrameType(std::shared_ptr<PresentEvent> const& present);
 
     void SignalEventsReady();
+
+    // Called for every event before it's handled.
+    void CountEventForTrackingStateSweep(uint64_t timestamp)
+    {
+        if (--mEventsUntilTrackingStateSweep == 0) {
+            SweepTrackingState(timestamp);
+        }
+    }
+    void SweepTrackingState(uint64_t timestamp);
 };
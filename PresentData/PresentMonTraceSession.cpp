@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: MIT
 
 #include "Debug.hpp"
+#include "Instrumentation.hpp"
 #include "PresentMonTraceConsumer.hpp"
 #include "PresentMonTraceSession.hpp"
+#include "ShardedTraceConsumer.hpp"
 
 #include "ETW/Microsoft_Windows_D3D9.h"
 #include "ETW/Microsoft_Windows_Dwm_Core.h"
@@ -374,94 +376,84 @@ void DisableProviders(TRACEHANDLE sessionHandle)
 }
 
 template<
-    bool IS_REALTIME_SESSION,
     bool TRACK_DISPLAY,
     bool TRACK_INPUT,
     bool TRACK_PRESENTMON>
-void CALLBACK EventRecordCallback(EVENT_RECORD* pEventRecord)
+void HandleEvent(PMTraceConsumer* pmConsumer, EVENT_RECORD* pEventRecord)
 {
-    auto session = (PMTraceSession*) pEventRecord->UserContext;
     auto const& hdr = pEventRecord->EventHeader;
 
     #pragma warning(push)
     #pragma warning(disable: 4984) // c++17 extension
 
-    if constexpr (!IS_REALTIME_SESSION) {
-        if (session->mStartTimestamp.QuadPart == 0) {
-            session->mStartTimestamp = hdr.TimeStamp;
-        }
-    }
-
-    VerboseTraceEvent(session->mPMConsumer, pEventRecord, &session->mPMConsumer->mMetadata);
-
     if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::GUID) {
-        session->mPMConsumer->HandleDXGKEvent(pEventRecord);
+        pmConsumer->HandleDXGKEvent(pEventRecord);
         return;
     }
     if (hdr.ProviderId == Microsoft_Windows_DXGI::GUID) {
-        session->mPMConsumer->HandleDXGIEvent(pEventRecord);
+        pmConsumer->HandleDXGIEvent(pEventRecord);
         return;
     }
     if constexpr (TRACK_DISPLAY || TRACK_INPUT) {
         if (hdr.ProviderId == Microsoft_Windows_Win32k::GUID) {
-            session->mPMConsumer->HandleWin32kEvent(pEventRecord);
+            pmConsumer->HandleWin32kEvent(pEventRecord);
             return;
         }
     }
     if constexpr (TRACK_DISPLAY) {
         if (hdr.ProviderId == Microsoft_Windows_Dwm_Core::GUID) {
-            session->mPMConsumer->HandleDWMEvent(pEventRecord);
+            pmConsumer->HandleDWMEvent(pEventRecord);
             return;
         }
     }
     if (hdr.ProviderId == Microsoft_Windows_D3D9::GUID) {
-        session->mPMConsumer->HandleD3D9Event(pEventRecord);
+        pmConsumer->HandleD3D9Event(pEventRecord);
         return;
     }
     if (hdr.ProviderId == Microsoft_Windows_Kernel_Process::GUID ||
         hdr.ProviderId == NT_Process::GUID) {
-        session->mPMConsumer->HandleProcessEvent(pEventRecord);
+        pmConsumer->HandleProcessEvent(pEventRecord);
         return;
     }
     if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::PRESENTHISTORY_GUID) {
-        session->mPMConsumer->HandleWin7DxgkPresentHistory(pEventRecord);
+        pmConsumer->HandleWin7DxgkPresentHistory(pEventRecord);
         return;
     }
     if (hdr.ProviderId == Microsoft_Windows_EventMetadata::GUID) {
-        session->mPMConsumer->HandleMetadataEvent(pEventRecord);
+        pmConsumer->HandleMetadataEvent(pEventRecord);
         return;
     }
 
     if constexpr (TRACK_DISPLAY) {
         if (hdr.ProviderId == Microsoft_Windows_Dwm_Core::Win7::GUID) {
-            session->mPMConsumer->HandleDWMEvent(pEventRecord);
+            pmConsumer->HandleDWMEvent(pEventRecord);
             return;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::BLT_GUID) {
-            session->mPMConsumer->HandleWin7DxgkBlt(pEventRecord);
+            pmConsumer->HandleWin7DxgkBlt(pEventRecord);
             return;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::FLIP_GUID) {
-            session->mPMConsumer->HandleWin7DxgkFlip(pEventRecord);
+            pmConsumer->HandleWin7DxgkFlip(pEventRecord);
             return;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::QUEUEPACKET_GUID) {
-            session->mPMConsumer->HandleWin7DxgkQueuePacket(pEventRecord);
+            pmConsumer->HandleWin7DxgkQueuePacket(pEventRecord);
             return;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::VSYNCDPC_GUID) {
-            session->mPMConsumer->HandleWin7DxgkVSyncDPC(pEventRecord);
+            pmConsumer->HandleWin7DxgkVSyncDPC(pEventRecord);
             return;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::MMIOFLIP_GUID) {
-            session->mPMConsumer->HandleWin7DxgkMMIOFlip(pEventRecord);
+            pmConsumer->HandleWin7DxgkMMIOFlip(pEventRecord);
             return;
         }
     }
 
     if constexpr (TRACK_PRESENTMON) {
         if (hdr.ProviderId == Intel_PresentMon::GUID) {
-            session->mPMConsumer->HandleIntelPresentMonEvent(pEventRecord);
+            pmConsumer->HandleIntelPresentMonEvent(pEventRecord);
             return;
         }
     }
@@ -469,6 +461,47 @@ void CALLBACK EventRecordCallback(EVENT_RECORD* pEventRecord)
     #pragma warning(pop)
 }
 
+template<
+    bool IS_REALTIME_SESSION,
+    bool TRACK_DISPLAY,
+    bool TRACK_INPUT,
+    bool TRACK_PRESENTMON>
+void CALLBACK EventRecordCallback(EVENT_RECORD* pEventRecord)
+{
+    auto session = (PMTraceSession*) pEventRecord->UserContext;
+    auto const& hdr = pEventRecord->EventHeader;
+
+    InstrumentEventRecordCallback(session->mPMConsumer);
+
+    #pragma warning(push)
+    #pragma warning(disable: 4984) // c++17 extension
+
+    if constexpr (!IS_REALTIME_SESSION) {
+        if (session->mStartTimestamp.QuadPart == 0) {
+            session->mStartTimestamp = hdr.TimeStamp;
+        }
+    }
+
+    VerboseTraceEvent(session->mPMConsumer, pEventRecord, &session->mPMConsumer->mMetadata);
+
+    session->mPMConsumer->CountEventForTrackingStateSweep(hdr.TimeStamp.QuadPart);
+
+    HandleEvent<TRACK_DISPLAY, TRACK_INPUT, TRACK_PRESENTMON>(session->mPMConsumer, pEventRecord);
+
+    #pragma warning(pop)
+}
+
+// When the analysis is sharded, the callback thread only copies each event into the queues of the
+// shards that need it.
+void CALLBACK ShardedEventRecordCallback(EVENT_RECORD* pEventRecord)
+{
+    auto session = (PMTraceSession*) pEventRecord->UserContext;
+
+    InstrumentEventRecordCallback(session->mPMConsumer);
+
+    session->mShardedConsumer->RouteEvent(pEventRecord);
+}
+
 template<bool... Ts>
 PEVENT_RECORD_CALLBACK GetEventRecordCallback(bool t1)
 {
@@ -497,6 +530,27 @@ PEVENT_RECORD_CALLBACK GetEventRecordCallback(bool t1, bool t2, bool t3, bool t4
               : GetEventRecordCallback<Ts..., false>(t2, t3, t4);
 }
 
+template<bool... Ts>
+PMEventHandler GetHandleEvent(bool t1)
+{
+    return t1 ? &HandleEvent<Ts..., true>
+              : &HandleEvent<Ts..., false>;
+}
+
+template<bool... Ts>
+PMEventHandler GetHandleEvent(bool t1, bool t2)
+{
+    return t1 ? GetHandleEvent<Ts..., true>(t2)
+              : GetHandleEvent<Ts..., false>(t2);
+}
+
+template<bool... Ts>
+PMEventHandler GetHandleEvent(bool t1, bool t2, bool t3)
+{
+    return t1 ? GetHandleEvent<Ts..., true>(t2, t3)
+              : GetHandleEvent<Ts..., false>(t2, t3);
+}
+
 ULONG CALLBACK BufferCallback(EVENT_TRACE_LOGFILE* pLogFile)
 {
     auto session = (PMTraceSession*) pLogFile->Context;
@@ -557,11 +611,15 @@ ULONG PMTraceSession::Start(
         traceProps.BufferCallback = &BufferCallback;
     }
 
-    traceProps.EventRecordCallback = GetEventRecordCallback(
-        mIsRealtimeSession,            // IS_REALTIME_SESSION
-        mPMConsumer->mTrackDisplay,    // TRACK_DISPLAY
-        mPMConsumer->mTrackInput,      // TRACK_INPUT
-        mPMConsumer->mTrackFrameType); // TRACK_PRESENTMON
+    if (mIsRealtimeSession && mShardedConsumer != nullptr) {
+        traceProps.EventRecordCallback = &ShardedEventRecordCallback;
+    } else {
+        traceProps.EventRecordCallback = GetEventRecordCallback(
+            mIsRealtimeSession,            // IS_REALTIME_SESSION
+            mPMConsumer->mTrackDisplay,    // TRACK_DISPLAY
+            mPMConsumer->mTrackInput,      // TRACK_INPUT
+            mPMConsumer->mTrackFrameType); // TRACK_PRESENTMON
+    }
 
     mTraceHandle = OpenTraceW(&traceProps);
     if (mTraceHandle == INVALID_PROCESSTRACE_HANDLE) {
@@ -656,6 +714,14 @@ void PMTraceSession::Stop()
     }
 }
 
+PMEventHandler GetEventHandler(PMTraceConsumer const* pmConsumer)
+{
+    return GetHandleEvent(
+        pmConsumer->mTrackDisplay,    // TRACK_DISPLAY
+        pmConsumer->mTrackInput,      // TRACK_INPUT
+        pmConsumer->mTrackFrameType); // TRACK_PRESENTMON
+}
+
 ULONG StopNamedTraceSession(wchar_t const* sessionName)
 {
     TraceProperties sessionProps = {};
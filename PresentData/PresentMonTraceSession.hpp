@@ -1,7 +1,10 @@
 // Copyright (C) 2017-2024 Intel Corporation
 // SPDX-License-Identifier: MIT
+#pragma once
 
 struct PMTraceConsumer;
+struct ShardedTraceConsumer;
+struct _EVENT_RECORD;
 
 struct PMTraceSession {
     enum TimestampType {
@@ -12,6 +15,11 @@ struct PMTraceSession {
 
     PMTraceConsumer* mPMConsumer = nullptr; // Required PMTraceConsumer instance
 
+    // Optional.  If set, a realtime session only routes each event to mShardedConsumer's analysis
+    // threads, and mPMConsumer is only used for its configuration.  It is ignored when reading an
+    // ETL.
+    ShardedTraceConsumer* mShardedConsumer = nullptr;
+
     LARGE_INTEGER mStartTimestamp = {};
     LARGE_INTEGER mTimestampFrequency = {};
     uint64_t mStartFileTime = 0;
@@ -41,3 +49,8 @@ struct PMTraceSession {
 
 ULONG StopNamedTraceSession(wchar_t const* sessionName);
 
+// Returns the function that passes an event to the PMTraceConsumer::Handle*() function for its
+// provider, specialized for the events that pmConsumer is configured to track.
+using PMEventHandler = void (*)(PMTraceConsumer* pmConsumer, _EVENT_RECORD* eventRecord);
+PMEventHandler GetEventHandler(PMTraceConsumer const* pmConsumer);
+
@@ -0,0 +1,424 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "ShardedTraceConsumer.hpp"
+
+#include "ETW/Microsoft_Windows_Dwm_Core.h"
+#include "ETW/Microsoft_Windows_Dwm_Core_Win7.h"
+#include "ETW/Microsoft_Windows_DxgKrnl.h"
+#include "ETW/Microsoft_Windows_EventMetadata.h"
+#include "ETW/Microsoft_Windows_Kernel_Process.h"
+#include "ETW/Microsoft_Windows_Win32k.h"
+#include "ETW/NT_Process.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iterator>
+#include <string.h>
+
+namespace {
+
+// Each queue entry is an EntryHeader followed by the EVENT_RECORD, its extended data items, each
+// item's data, and the user data, each starting 8-byte aligned.  An EntryHeader with mSize == 0
+// marks that the rest of the buffer is unused, and that the next entry is at the start of the
+// buffer.
+struct EntryHeader {
+    uint32_t mSize;
+    uint32_t mReserved;
+};
+
+// Large enough to absorb the bursts of events delivered with each ETW buffer.
+size_t const EVENT_QUEUE_CAPACITY = 2 * 1024 * 1024;
+
+// How often a busy shard publishes its progress, in events.  An idle shard publishes it whenever
+// it runs out of events.
+uint32_t const PROGRESS_INTERVAL = 1024;
+
+size_t AlignEntrySize(size_t size)
+{
+    return (size + 7) & ~(size_t) 7;
+}
+
+size_t GetEntrySize(EVENT_RECORD const* eventRecord)
+{
+    size_t size = sizeof(EntryHeader) +
+                AlignEntrySize(sizeof(EVENT_RECORD)) +
+                eventRecord->ExtendedDataCount * sizeof(EVENT_HEADER_EXTENDED_DATA_ITEM) +
+                AlignEntrySize(eventRecord->UserDataLength);
+    for (USHORT i = 0; i < eventRecord->ExtendedDataCount; ++i) {
+        size += AlignEntrySize(eventRecord->ExtendedData[i].DataSize);
+    }
+    return size;
+}
+
+void CopyConfiguration(PMTraceConsumer* shard, PMTraceConsumer const& config)
+{
+    shard->mFilteredEvents             = config.mFilteredEvents;
+    shard->mFilteredProcessIds         = config.mFilteredProcessIds;
+    shard->mTrackDisplay               = config.mTrackDisplay;
+    shard->mTrackGPU                   = config.mTrackGPU;
+    shard->mTrackGPUVideo              = config.mTrackGPUVideo;
+    shard->mTrackInput                 = config.mTrackInput;
+    shard->mTrackFrameType             = config.mTrackFrameType;
+    shard->mDeferralTimeLimit          = config.mDeferralTimeLimit;
+    shard->mIsRealtimeSession          = config.mIsRealtimeSession;
+    shard->mDisableOfflineBackpressure = config.mDisableOfflineBackpressure;
+    shard->mTrackingStateTimeLimit     = config.mTrackingStateTimeLimit;
+    shard->mTrackingStateTableLimit    = config.mTrackingStateTableLimit;
+    shard->mTrackingStateSweepInterval = config.mTrackingStateSweepInterval;
+    shard->mTrackedProcessFilter       = config.mTrackedProcessFilter;
+    shard->mTargetProcessNames         = config.mTargetProcessNames;
+    shard->mExcludedProcessNames       = config.mExcludedProcessNames;
+    shard->mFilteredProcessNames       = config.mFilteredProcessNames;
+    shard->mProcessNameResolver        = config.mProcessNameResolver;
+    shard->mMetadata.metadata_         = config.mMetadata.metadata_;
+}
+
+// Returns the earliest PresentStartTime of any present the consumer may still complete: those
+// that are still tracked, or that are completed but not yet ready to be dequeued.  Presents that
+// haven't been seen yet start no earlier than the last analyzed event.
+uint64_t GetAnalysisProgress(PMTraceConsumer* pmConsumer, uint64_t lastEventTime, uint64_t maxMergeDelay)
+{
+    auto progress = lastEventTime;
+    auto consider = [&](PresentEvent const& present) {
+        if (present.PresentStartTime + maxMergeDelay >= lastEventTime) {
+            progress = std::min(progress, present.PresentStartTime);
+        }
+    };
+
+    // mTrackedPresents is only modified by this thread.
+    for (auto const& present : pmConsumer->mTrackedPresents) {
+        if (present != nullptr) {
+            consider(*present);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pmConsumer->mPresentEventMutex);
+    auto ringSize = (uint32_t) pmConsumer->mCompletedPresents.size();
+    for (uint32_t i = pmConsumer->mReadyCount; i < pmConsumer->mCompletedCount; ++i) {
+        consider(*pmConsumer->mCompletedPresents[(pmConsumer->mCompletedIndex + i) % ringSize]);
+    }
+    return progress;
+}
+
+void AnalyzeShard(ShardedTraceConsumer::Shard* shard, PMEventHandler handleEvent, uint64_t maxMergeDelay)
+{
+    auto pmConsumer = &shard->mConsumer;
+    auto queue = &shard->mQueue;
+    uint64_t lastEventTime = 0;
+    uint32_t eventsUntilProgress = PROGRESS_INTERVAL;
+    for (;;) {
+        auto eventRecord = queue->Front();
+        if (eventRecord == nullptr) {
+            shard->mProgress.store(GetAnalysisProgress(pmConsumer, lastEventTime, maxMergeDelay), std::memory_order_release);
+            eventsUntilProgress = PROGRESS_INTERVAL;
+            if (!queue->Wait()) {
+                break;
+            }
+            continue;
+        }
+
+        auto timestamp = (uint64_t) eventRecord->EventHeader.TimeStamp.QuadPart;
+        lastEventTime = std::max(lastEventTime, timestamp);
+        pmConsumer->CountEventForTrackingStateSweep(timestamp);
+        handleEvent(pmConsumer, eventRecord);
+
+        queue->PopFront();
+
+        if (--eventsUntilProgress == 0) {
+            shard->mProgress.store(GetAnalysisProgress(pmConsumer, lastEventTime, maxMergeDelay), std::memory_order_release);
+            eventsUntilProgress = PROGRESS_INTERVAL;
+        }
+    }
+
+    // Nothing else will be completed, so all the completed presents can be merged.
+    shard->mProgress.store(UINT64_MAX, std::memory_order_release);
+}
+
+}
+
+ShardedTraceConsumer::EventQueue::EventQueue(size_t capacity)
+    : mBuffer(AlignEntrySize(capacity) / sizeof(uint64_t))
+    , mCapacity(AlignEntrySize(capacity))
+{
+    mDataEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+}
+
+ShardedTraceConsumer::EventQueue::~EventQueue()
+{
+    if (mDataEvent != nullptr) {
+        CloseHandle(mDataEvent);
+    }
+}
+
+void ShardedTraceConsumer::EventQueue::Push(EVENT_RECORD const* eventRecord)
+{
+    auto size = GetEntrySize(eventRecord);
+    assert(size <= mCapacity);
+
+    // If the entry doesn't fit before the end of the buffer, skip to the start.
+    auto writePosition = mWritePosition.load(std::memory_order_relaxed);
+    auto offset = (size_t) (writePosition % mCapacity);
+    auto skip = offset + size > mCapacity ? mCapacity - offset : 0;
+
+    while (writePosition + skip + size - mReadPosition.load(std::memory_order_acquire) > mCapacity) {
+        std::this_thread::yield();
+    }
+
+    auto buffer = (uint8_t*) mBuffer.data();
+    if (skip != 0) {
+        ((EntryHeader*) (buffer + offset))->mSize = 0;
+        offset = 0;
+    }
+
+    // Copy the event, pointing the copy at the copies of its data.
+    auto p = buffer + offset;
+    ((EntryHeader*) p)->mSize = (uint32_t) size;
+    p += sizeof(EntryHeader);
+
+    auto copy = (EVENT_RECORD*) p;
+    memcpy(copy, eventRecord, sizeof(EVENT_RECORD));
+    p += AlignEntrySize(sizeof(EVENT_RECORD));
+
+    if (eventRecord->ExtendedDataCount > 0) {
+        auto items = (EVENT_HEADER_EXTENDED_DATA_ITEM*) p;
+        memcpy(items, eventRecord->ExtendedData, eventRecord->ExtendedDataCount * sizeof(EVENT_HEADER_EXTENDED_DATA_ITEM));
+        p += eventRecord->ExtendedDataCount * sizeof(EVENT_HEADER_EXTENDED_DATA_ITEM);
+
+        copy->ExtendedData = items;
+        for (USHORT i = 0; i < eventRecord->ExtendedDataCount; ++i) {
+            memcpy(p, (void const*) (uintptr_t) eventRecord->ExtendedData[i].DataPtr, items[i].DataSize);
+            items[i].DataPtr = (ULONGLONG) (uintptr_t) p;
+            p += AlignEntrySize(items[i].DataSize);
+        }
+    }
+
+    memcpy(p, eventRecord->UserData, eventRecord->UserDataLength);
+    copy->UserData = p;
+
+    // Publish the entry, then wake the consumer if it is waiting.  Both are sequentially
+    // consistent, pairing with the consumer's store to mConsumerWaiting and load of
+    // mWritePosition in Wait(), so either the consumer sees the entry or we see it waiting.
+    mWritePosition.store(writePosition + skip + size);
+    if (mConsumerWaiting.load()) {
+        SetEvent(mDataEvent);
+    }
+}
+
+EVENT_RECORD* ShardedTraceConsumer::EventQueue::Front()
+{
+    auto buffer = (uint8_t*) mBuffer.data();
+    for (;;) {
+        auto readPosition = mReadPosition.load(std::memory_order_relaxed);
+        if (readPosition == mWritePosition.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        auto offset = (size_t) (readPosition % mCapacity);
+        auto header = (EntryHeader*) (buffer + offset);
+        if (header->mSize != 0) {
+            return (EVENT_RECORD*) (header + 1);
+        }
+
+        mReadPosition.store(readPosition + mCapacity - offset, std::memory_order_release);
+    }
+}
+
+void ShardedTraceConsumer::EventQueue::PopFront()
+{
+    auto readPosition = mReadPosition.load(std::memory_order_relaxed);
+    auto header = (EntryHeader const*) ((uint8_t const*) mBuffer.data() + (size_t) (readPosition % mCapacity));
+    mReadPosition.store(readPosition + header->mSize, std::memory_order_release);
+}
+
+bool ShardedTraceConsumer::EventQueue::Wait()
+{
+    auto isOpen = true;
+    mConsumerWaiting.store(true);
+    if (mReadPosition.load(std::memory_order_relaxed) == mWritePosition.load()) {
+        if (mClosed.load()) {
+            isOpen = false;
+        } else {
+            WaitForSingleObject(mDataEvent, INFINITE);
+        }
+    }
+    mConsumerWaiting.store(false);
+    return isOpen;
+}
+
+void ShardedTraceConsumer::EventQueue::Close()
+{
+    mClosed.store(true);
+    SetEvent(mDataEvent);
+}
+
+ShardedTraceConsumer::Shard::Shard(size_t queueCapacity)
+    : mQueue(queueCapacity)
+{
+}
+
+ShardedTraceConsumer::~ShardedTraceConsumer()
+{
+    Stop();
+}
+
+void ShardedTraceConsumer::Start(PMTraceConsumer const& config, uint32_t shardCount)
+{
+    assert(mShards.empty());
+
+    mHandleEvent = GetEventHandler(&config);
+
+    LARGE_INTEGER qpcFrequency;
+    QueryPerformanceFrequency(&qpcFrequency);
+    mMaxMergeDelay = (uint64_t) qpcFrequency.QuadPart;
+
+    shardCount = std::max(shardCount, 1u);
+    for (uint32_t i = 0; i < shardCount; ++i) {
+        mShards.emplace_back(std::make_unique<Shard>(EVENT_QUEUE_CAPACITY));
+        CopyConfiguration(&mShards.back()->mConsumer, config);
+    }
+
+    for (auto& shard : mShards) {
+        shard->mThread = std::thread(AnalyzeShard, shard.get(), mHandleEvent, mMaxMergeDelay);
+    }
+}
+
+void ShardedTraceConsumer::Stop()
+{
+    for (auto& shard : mShards) {
+        shard->mQueue.Close();
+    }
+    for (auto& shard : mShards) {
+        if (shard->mThread.joinable()) {
+            shard->mThread.join();
+        }
+    }
+}
+
+uint32_t ShardedTraceConsumer::GetShardIndex(uint32_t processId) const
+{
+    // Windows process ids are multiples of 4.
+    return (processId / 4) % (uint32_t) mShards.size();
+}
+
+bool ShardedTraceConsumer::IsBroadcastEvent(EVENT_HEADER const& hdr)
+{
+    // DWM composes presents from every process.
+    if (hdr.ProviderId == Microsoft_Windows_Dwm_Core::GUID ||
+        hdr.ProviderId == Microsoft_Windows_Dwm_Core::Win7::GUID) {
+        mDwmProcessId = hdr.ProcessId;
+        return true;
+    }
+
+    // Events logged from the idle/system processes (e.g., from DPCs and interrupts) or by DWM can
+    // reference any process' presents or GPU work.
+    if (hdr.ProcessId == 0 || hdr.ProcessId == 4 || hdr.ProcessId == mDwmProcessId) {
+        return true;
+    }
+
+    // Every shard needs to know when processes start and stop, and how to decode events.
+    if (hdr.ProviderId == Microsoft_Windows_Kernel_Process::GUID ||
+        hdr.ProviderId == NT_Process::GUID ||
+        hdr.ProviderId == Microsoft_Windows_EventMetadata::GUID) {
+        return true;
+    }
+
+    // Device and context registration may be logged by another process (e.g., DCStart events are
+    // logged by whoever requested the capture state).
+    if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::GUID) {
+        switch (hdr.EventDescriptor.Id) {
+        case Microsoft_Windows_DxgKrnl::Device_DCStart::Id:
+        case Microsoft_Windows_DxgKrnl::Device_Start::Id:
+        case Microsoft_Windows_DxgKrnl::Device_Stop::Id:
+        case Microsoft_Windows_DxgKrnl::AdapterAllocation_Start::Id:
+        case Microsoft_Windows_DxgKrnl::AdapterAllocation_DCStart::Id:
+        case Microsoft_Windows_DxgKrnl::AdapterAllocation_Stop::Id:
+        case Microsoft_Windows_DxgKrnl::Context_DCStart::Id:
+        case Microsoft_Windows_DxgKrnl::Context_Start::Id:
+        case Microsoft_Windows_DxgKrnl::Context_Stop::Id:
+        case Microsoft_Windows_DxgKrnl::HwQueue_DCStart::Id:
+        case Microsoft_Windows_DxgKrnl::HwQueue_Start::Id:
+        case Microsoft_Windows_DxgKrnl::NodeMetadata_Info::Id:
+            return true;
+        }
+        return false;
+    }
+
+    // Input is read, and token states are changed, outside of the process that the input or
+    // token belongs to.
+    if (hdr.ProviderId == Microsoft_Windows_Win32k::GUID) {
+        switch (hdr.EventDescriptor.Id) {
+        case Microsoft_Windows_Win32k::TokenStateChanged_Info::Id:
+        case Microsoft_Windows_Win32k::InputDeviceRead_Stop::Id:
+        case Microsoft_Windows_Win32k::OnInputXformUpdate_Info::Id:
+            return true;
+        }
+        return false;
+    }
+
+    return false;
+}
+
+void ShardedTraceConsumer::RouteEvent(EVENT_RECORD const* eventRecord)
+{
+    auto const& hdr = eventRecord->EventHeader;
+    if (mShards.size() == 1) {
+        mShards[0]->mQueue.Push(eventRecord);
+    } else if (IsBroadcastEvent(hdr)) {
+        for (auto& shard : mShards) {
+            shard->mQueue.Push(eventRecord);
+        }
+    } else {
+        mShards[GetShardIndex(hdr.ProcessId)]->mQueue.Push(eventRecord);
+    }
+}
+
+void ShardedTraceConsumer::DequeueProcessEvents(std::vector<ProcessEvent>& outProcessEvents)
+{
+    if (mShards.empty()) {
+        return;
+    }
+
+    // Process events are routed to every shard, so they're only returned from the first.
+    mShards[0]->mConsumer.DequeueProcessEvents(outProcessEvents);
+    for (size_t i = 1, n = mShards.size(); i < n; ++i) {
+        mShards[i]->mConsumer.DequeueProcessEvents(mShardProcessEvents);
+        mShardProcessEvents.clear();
+    }
+}
+
+void ShardedTraceConsumer::DequeuePresentEvents(std::vector<std::shared_ptr<PresentEvent>>& outPresentEvents)
+{
+    outPresentEvents.clear();
+
+    // Each shard publishes its progress after the presents it completed before then are ready,
+    // so the progress must be read before dequeuing: every present that started before it has
+    // then either been dequeued already or is dequeued now.
+    auto progress = UINT64_MAX;
+    for (auto const& shard : mShards) {
+        progress = std::min(progress, shard->mProgress.load(std::memory_order_acquire));
+    }
+
+    for (uint32_t i = 0, n = (uint32_t) mShards.size(); i < n; ++i) {
+        mShards[i]->mConsumer.DequeuePresentEvents(mShardPresentEvents);
+        for (auto& present : mShardPresentEvents) {
+            if (GetShardIndex(present->ProcessId) == i) {
+                mPendingPresentEvents.emplace_back(std::move(present));
+            }
+        }
+    }
+    mShardPresentEvents.clear();
+
+    // Each shard's presents are only ordered per swapchain, so merge them all by PresentStartTime
+    // (ProcessId breaks ties deterministically) and return those no shard can precede anymore.
+    std::stable_sort(mPendingPresentEvents.begin(), mPendingPresentEvents.end(),
+        [](std::shared_ptr<PresentEvent> const& a, std::shared_ptr<PresentEvent> const& b) {
+            return a->PresentStartTime != b->PresentStartTime
+                ? a->PresentStartTime < b->PresentStartTime
+                : a->ProcessId < b->ProcessId;
+        });
+    auto ready = std::find_if(mPendingPresentEvents.begin(), mPendingPresentEvents.end(),
+        [progress](std::shared_ptr<PresentEvent> const& p) { return p->PresentStartTime >= progress; });
+    outPresentEvents.assign(std::make_move_iterator(mPendingPresentEvents.begin()), std::make_move_iterator(ready));
+    mPendingPresentEvents.erase(mPendingPresentEvents.begin(), ready);
+}
@@ -0,0 +1,109 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "PresentMonTraceConsumer.hpp"
+#include "PresentMonTraceSession.hpp"
+
+// ShardedTraceConsumer splits the analysis of a realtime session across several threads, each
+// analyzing the events of a subset of the processes with its own PMTraceConsumer (a shard).
+//
+// The ETW callback thread only routes each event: events logged by a process are copied into
+// the queue of the shard that owns that process, while events that the analysis of any process
+// may depend on are copied into every shard's queue.  Those are the events logged by DWM or on
+// behalf of no particular process (e.g., MMIOFlip, VSyncDPC, and DMA/queue packet completion),
+// process and metadata events, GPU device and context registration, and the Win32k input and
+// token state events.  Every shard therefore also analyzes DWM's presents, but each present is
+// only dequeued from the shard that owns its process.
+//
+// Each shard only sees the GPU work of its own processes (and DWM), so when processes owned by
+// different shards contend for the same GPU engine their GPUStartTime and GPUDuration are
+// measured as if the other shard's packets were not queued ahead of them.
+struct ShardedTraceConsumer {
+    // Single-producer single-consumer ring of copied EVENT_RECORDs, including their extended and
+    // user data.  Entries are written and read in place, so the consumer can pass them directly
+    // to the Handle*() functions.
+    struct EventQueue {
+        std::vector<uint64_t> mBuffer;
+        size_t mCapacity = 0;                       // Bytes
+        std::atomic<uint64_t> mWritePosition{ 0 };  // Total bytes written
+        uint8_t mPadding0[64];
+        std::atomic<uint64_t> mReadPosition{ 0 };   // Total bytes read
+        uint8_t mPadding1[64];
+        std::atomic<bool> mConsumerWaiting{ false };
+        std::atomic<bool> mClosed{ false };
+        HANDLE mDataEvent = nullptr;
+
+        explicit EventQueue(size_t capacity);
+        ~EventQueue();
+
+        void Push(EVENT_RECORD const* eventRecord); // Waits for space if the queue is full
+        EVENT_RECORD* Front();                      // nullptr if the queue is empty
+        void PopFront();
+        bool Wait();                                // Returns false once the queue is closed and empty
+        void Close();
+    };
+
+    struct Shard {
+        PMTraceConsumer mConsumer;
+        EventQueue mQueue;
+        std::thread mThread;
+
+        // The shard will not complete any more presents that started before this QPC (except
+        // ones still in flight after mMaxMergeDelay), or UINT64_MAX once its thread has exited.
+        // Written by the shard's thread, read by DequeuePresentEvents().
+        std::atomic<uint64_t> mProgress{ 0 };
+
+        explicit Shard(size_t queueCapacity);
+    };
+
+    // Creates shardCount PMTraceConsumers configured like config (including its process filters,
+    // limits, and any cached event metadata), and starts a thread to analyze each one's events.
+    // config must be fully configured, and is not used after Start() returns.
+    void Start(PMTraceConsumer const& config, uint32_t shardCount);
+
+    // Waits for the events already routed to be analyzed, then stops the analysis threads.  The
+    // shards' completed events can still be dequeued afterwards.
+    void Stop();
+
+    ~ShardedTraceConsumer();
+
+    // Called from the ETW callback thread.
+    void RouteEvent(EVENT_RECORD const* eventRecord);
+
+    // These merge the completed events of every shard; see PMTraceConsumer::Dequeue*Events().
+    // Presents are returned in PresentStartTime order across all shards: a present is held back
+    // until every shard has progressed past its PresentStartTime, so it may be returned by a
+    // later call than it would be from a single PMTraceConsumer.
+    void DequeueProcessEvents(std::vector<ProcessEvent>& outProcessEvents);
+    void DequeuePresentEvents(std::vector<std::shared_ptr<PresentEvent>>& outPresentEvents);
+
+    uint32_t GetShardIndex(uint32_t processId) const;
+
+    // -------------------------------------------------------------------------------------------
+    // Internal data
+
+    std::vector<std::unique_ptr<Shard>> mShards;
+    PMEventHandler mHandleEvent = nullptr;
+
+    // The DWM process id, as seen by RouteEvent().  Only accessed from the ETW callback thread.
+    uint32_t mDwmProcessId = 0;
+
+    // Presents still in flight this long (QPC) after the last analyzed event, e.g. ones that
+    // will be lost, no longer hold back other presents.
+    uint64_t mMaxMergeDelay = 0;
+
+    // Scratch storage for Dequeue*Events(), and the completed presents that are held back until
+    // every shard has progressed past them.  Only accessed from the dequeuing thread.
+    std::vector<std::shared_ptr<PresentEvent>> mShardPresentEvents;
+    std::vector<std::shared_ptr<PresentEvent>> mPendingPresentEvents;
+    std::vector<ProcessEvent> mShardProcessEvents;
+
+    bool IsBroadcastEvent(EVENT_HEADER const& hdr);
+};
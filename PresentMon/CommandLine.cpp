@@ -264,16 +264,18 @@ void PrintUsage()
         LR"(--etl_file path)",     LR"(Analyze an ETW trace log file instead of the actively running processes.)",
 
         LR"(--Output Options)", nullptr,
-        LR"(--output_file path)", LR"(Write CSV output to the specified path.)",
-        LR"(--output_stdout)",    LR"(Write CSV output to STDOUT.)",
-        LR"(--multi_csv)",        LR"(Create a separate CSV file for each captured process.)",
-        LR"(--no_csv)",           LR"(Do not create any output CSV file.)",
-        LR"(--no_console_stats)", LR"(Do not display active swap chains and frame statistics in the console.)",
-        LR"(--qpc_time)",         LR"(Output the CPU start time as a performance counter value.)",
-        LR"(--qpc_time_ms)",      LR"(Output the CPU start time as a performance counter value converted to milliseconds.)",
-        LR"(--date_time)",        LR"(Output the CPU start time as a date and time with nanosecond precision.)",
-        LR"(--exclude_dropped)",  LR"(Exclude frames that were not displayed to the screen from the CSV output.)",
-        LR"(--v1_metrics)",       LR"(Output a CSV using PresentMon 1.x metrics.)",
+        LR"(--output_file path)",     LR"(Write CSV output to the specified path.)",
+        LR"(--output_stdout)",        LR"(Write CSV output to STDOUT.)",
+        LR"(--multi_csv)",            LR"(Create a separate CSV file for each captured process.)",
+        LR"(--no_csv)",               LR"(Do not create any output CSV file.)",
+        LR"(--no_console_stats)",     LR"(Do not display active swap chains and frame statistics in the console.)",
+        LR"(--stats_window seconds)", LR"(Compute the console statistics' frame time and latency percentiles over the specified amount of time (default 5).)",
+        LR"(--stats_refresh ms)",     LR"(Refresh the console statistics at the specified interval in milliseconds (default 100).)",
+        LR"(--qpc_time)",             LR"(Output the CPU start time as a performance counter value.)",
+        LR"(--qpc_time_ms)",          LR"(Output the CPU start time as a performance counter value converted to milliseconds.)",
+        LR"(--date_time)",            LR"(Output the CPU start time as a date and time with nanosecond precision.)",
+        LR"(--exclude_dropped)",      LR"(Exclude frames that were not displayed to the screen from the CSV output.)",
+        LR"(--v1_metrics)",           LR"(Output a CSV using PresentMon 1.x metrics.)",
 
         LR"(--Recording Options)", nullptr,
         LR"(--hotkey key)",       LR"(Use the specified key press to start and stop recording. 'key' is of the form MODIFIER+KEY, e.g., "ALT+SHIFT+F11".)",
@@ -380,6 +382,9 @@ bool ParseCommandLine(int argc, wchar_t** argv)
     args->mTimer = 0;
     args->mHotkeyModifiers = MOD_NOREPEAT;
     args->mHotkeyVirtualKeyCode = 0;
+    args->mAnalysisThreadCount = 0;
+    args->mStatisticsWindow = 5;
+    args->mStatisticsRefreshPeriod = 100;
     args->mConsoleOutput = ConsoleOutput::Statistics;
     args->mTrackDisplay = true;
     args->mTrackInput = true;
@@ -400,6 +405,7 @@ bool ParseCommandLine(int argc, wchar_t** argv)
     args->mWriteFrameId = false;
     args->mWriteDisplayTime = false;
     args->mDisableOfflineBackpressure = false;
+    args->mDebugInstrumentation = false;
 
     bool sessionNameSet  = false;
     bool csvOutputStdout = false;
@@ -428,6 +434,8 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         else if (ParseArg(argv[i], L"multi_csv"))        { args->mMultiCsv       = true;                              continue; }
         else if (ParseArg(argv[i], L"no_csv"))           { csvOutputNone         = true;                              continue; }
         else if (ParseArg(argv[i], L"no_console_stats")) { args->mConsoleOutput  = ConsoleOutput::Simple;             continue; }
+        else if (ParseArg(argv[i], L"stats_window"))     { if (ParseValue(argv, argc, &i, &args->mStatisticsWindow))  continue; }
+        else if (ParseArg(argv[i], L"stats_refresh"))    { if (ParseValue(argv, argc, &i, &args->mStatisticsRefreshPeriod)) continue; }
         else if (ParseArg(argv[i], L"qpc_time"))         { qpcTime               = true;                              continue; }
         else if (ParseArg(argv[i], L"qpc_time_ms"))      { qpcmsTime             = true;                              continue; }
         else if (ParseArg(argv[i], L"date_time"))        { dtTime                = true;                              continue; }
@@ -459,9 +467,13 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         #if PRESENTMON_ENABLE_DEBUG_TRACE
         else if (ParseArg(argv[i], L"debug_verbose_trace")) { verboseTrace = true; continue; }
         #endif
+        #if PRESENTMON_ENABLE_INSTRUMENTATION
+        else if (ParseArg(argv[i], L"debug_instrumentation")) { args->mDebugInstrumentation = true; continue; }
+        #endif
         else if (ParseArg(argv[i], L"write_frame_id")) { args->mWriteFrameId = true; continue; }
         else if (ParseArg(argv[i], L"write_display_time")) { args->mWriteDisplayTime = true; continue; }
         else if (ParseArg(argv[i], L"disable_offline_backpressure")) { args->mDisableOfflineBackpressure = true; continue; }
+        else if (ParseArg(argv[i], L"analysis_threads")) { if (ParseValue(argv, argc, &i, &args->mAnalysisThreadCount)) continue; }
 
         // Provided argument wasn't recognized
         else if (!(ParseArg(argv[i], L"?") || ParseArg(argv[i], L"h") || ParseArg(argv[i], L"help"))) {
@@ -531,6 +543,16 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         }
     }
 
+    // Console statistics need a non-empty percentile window and refresh period
+    if (args->mStatisticsWindow == 0) {
+        PrintWarning(L"warning: --stats_window must be at least 1 second; using the default of 5 seconds.\n");
+        args->mStatisticsWindow = 5;
+    }
+    if (args->mStatisticsRefreshPeriod == 0) {
+        PrintWarning(L"warning: --stats_refresh must be at least 1 millisecond; using the default of 100 milliseconds.\n");
+        args->mStatisticsRefreshPeriod = 100;
+    }
+
     // Ignore --track_gpu_video if --no_track_gpu used
     if (args->mTrackGPUVideo && !args->mTrackGPU) {
         PrintWarning(L"warning: ignoring --track_gpu_video due to --no_track_gpu.\n");
@@ -543,6 +565,13 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         args->mTrackDisplay = true;
     }
 
+    // Analysis is only split across threads for realtime sessions, since ETL analysis relies on
+    // the consumer applying backpressure to the thread reading the ETL.
+    if (args->mAnalysisThreadCount > 1 && args->mEtlFileName != nullptr) {
+        PrintWarning(L"warning: ignoring --analysis_threads because --etl_file is being analyzed.\n");
+        args->mAnalysisThreadCount = 0;
+    }
+
     // If --terminate_existing_session, warn about any normal arguments since we'll just
     // be stopping an existing session and then exiting.
     if (args->mTerminateExistingSession) {
@@ -574,6 +603,13 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         args->mConsoleOutput = ConsoleOutput::Simple;
     }
 
+    #if PRESENTMON_ENABLE_INSTRUMENTATION
+    if (args->mDebugInstrumentation && args->mConsoleOutput != ConsoleOutput::Statistics) {
+        PrintWarning(L"warning: ignoring --debug_instrumentation because console statistics are not being displayed.\n");
+        args->mDebugInstrumentation = false;
+    }
+    #endif
+
     // Convert the provided process names into a canonical form used for comparison.
     // The comparison is not case-sensitive, and does not include any directory nor
     // extension.
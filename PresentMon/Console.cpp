@@ -2,11 +2,14 @@
 // SPDX-License-Identifier: MIT
 
 #include "PresentMon.hpp"
+#include "ConsoleScreen.hpp"
 
+#include <algorithm>
 #include <fcntl.h>
 #include <io.h>
 
-static COORD gWritePosition{};
+static ConsoleScreen gScreen;
+static COORD gScreenOrigin{ 0, -1 };
 static bool gStderrIsConsole = false;
 static bool gStdoutIsConsole = false;
 
@@ -94,70 +97,9 @@ static void VConsolePrint(wchar_t const* format, va_list val, bool newLine)
     wchar_t buffer[256];
     uint32_t numChars = VPrint(buffer, _countof(buffer), format, val);
 
-    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
-
-    CONSOLE_SCREEN_BUFFER_INFO info = {};
-    GetConsoleScreenBufferInfo(console, &info);
-    if (info.dwSize.X == 0) {
-        return;
-    }
-
-    COORD endPosition;
-    endPosition.Y = gWritePosition.Y + (SHORT) ((numChars + gWritePosition.X) / info.dwSize.X);
-    endPosition.X = (numChars + gWritePosition.X) % info.dwSize.X;
-
-    SHORT finalY = endPosition.Y + (newLine ? 1 : 0);
-    if (finalY >= info.dwSize.Y) {
-        SHORT deltaY = finalY - info.dwSize.Y + 1;
-
-        SMALL_RECT rect;
-        rect.Left   = 0;
-        rect.Top    = deltaY;
-        rect.Right  = info.dwSize.X - 1;
-        rect.Bottom = info.dwSize.Y - deltaY - 1;
-
-        COORD dstPos;
-        dstPos.X = 0;
-        dstPos.Y = 0;
-
-        CHAR_INFO fill;
-        fill.Char.UnicodeChar = L' ';
-        fill.Attributes = info.wAttributes;
-
-        ScrollConsoleScreenBufferW(console, &rect, nullptr, dstPos, &fill);
-
-        info.dwCursorPosition.Y -= deltaY;
-        gWritePosition.Y        -= deltaY;
-        endPosition.Y           -= deltaY;
-
-        SetConsoleCursorPosition(console, info.dwCursorPosition);
-    }
-
-    if (info.dwCursorPosition.Y >= info.srWindow.Top &&
-        info.dwCursorPosition.Y <= info.srWindow.Bottom &&
-        finalY > info.srWindow.Bottom) {
-        SHORT deltaY = finalY - info.srWindow.Bottom;
-
-        SMALL_RECT rect;
-        rect.Left   = 0;
-        rect.Top    = deltaY;
-        rect.Right  = 0;
-        rect.Bottom = deltaY;
-
-        SetConsoleWindowInfo(console, FALSE, &rect);
-    }
-
-    DWORD numCharsWritten = 0;
-    WriteConsoleOutputCharacterW(console, buffer, numChars, gWritePosition, &numCharsWritten);
-
+    gScreen.Print(buffer, numChars);
     if (newLine) {
-        numChars = info.dwSize.X - endPosition.X;
-        FillConsoleOutputCharacterW(console, L' ', numChars, endPosition, &numCharsWritten);
-
-        gWritePosition.X = 0;
-        gWritePosition.Y = endPosition.Y + 1;
-    } else {
-        gWritePosition = endPosition;
+        gScreen.EndRow();
     }
 }
 
@@ -174,8 +116,12 @@ void ConsolePrintLn(wchar_t const* format, ...)
     va_list val;
     va_start(val, format);
     VConsolePrint(format, val, true);
+    va_end(val);
 }
 
+// Statistics are formatted into gScreen between BeginConsoleUpdate() and EndConsoleUpdate(), and
+// written below the cursor.  If the cursor moved or the console was resized since the last update
+// (e.g., because something else was printed), everything is rewritten.
 bool BeginConsoleUpdate()
 {
     if (!gStdoutIsConsole) {
@@ -187,18 +133,20 @@ bool BeginConsoleUpdate()
     CONSOLE_SCREEN_BUFFER_INFO info = {};
     GetConsoleScreenBufferInfo(console, &info);
 
-    gWritePosition = info.dwCursorPosition;
+    // Start on the line after the cursor if it isn't at the start of a line.
+    COORD origin;
+    origin.X = 0;
+    origin.Y = info.dwCursorPosition.Y + (info.dwCursorPosition.X == 0 ? 0 : 1);
+
+    gScreen.BeginFrame(info.dwSize.X, origin.Y != gScreenOrigin.Y);
+    gScreenOrigin = origin;
 
     return true;
 }
 
-void EndConsoleUpdate()
+// Clears the console from the specified row until the first blank rows.
+static void ClearConsoleBelow(HANDLE console, CONSOLE_SCREEN_BUFFER_INFO const& info, SHORT row)
 {
-    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
-
-    CONSOLE_SCREEN_BUFFER_INFO info = {};
-    GetConsoleScreenBufferInfo(console, &info);
-
     COORD dstPos;
     dstPos.X = 0;
     dstPos.Y = 0;
@@ -212,7 +160,7 @@ void EndConsoleUpdate()
 
     COORD srcPos;
     srcPos.X = 0;
-    srcPos.Y = gWritePosition.Y;
+    srcPos.Y = row;
 
     SMALL_RECT rect;
     for ( ; srcPos.Y < info.dwSize.Y; srcPos.Y += dstSize.Y) {
@@ -244,6 +192,78 @@ void EndConsoleUpdate()
     delete[] buffer;
 }
 
+void EndConsoleUpdate()
+{
+    auto invalidated = gScreen.mInvalidated;
+    gScreen.EndFrame();
+
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+
+    CONSOLE_SCREEN_BUFFER_INFO info = {};
+    GetConsoleScreenBufferInfo(console, &info);
+    if (info.dwSize.X == 0) {
+        return;
+    }
+
+    // Scroll the console buffer up if the rows don't fit below the origin.  The rows already on
+    // screen scroll with it, so they don't need to be rewritten.
+    SHORT finalY = gScreenOrigin.Y + (SHORT) std::max(gScreen.mPresentedRowCount, gScreen.GetWrittenRowCount());
+    if (finalY >= info.dwSize.Y) {
+        SHORT deltaY = std::min<SHORT>(finalY - info.dwSize.Y + 1, gScreenOrigin.Y);
+
+        SMALL_RECT rect;
+        rect.Left   = 0;
+        rect.Top    = deltaY;
+        rect.Right  = info.dwSize.X - 1;
+        rect.Bottom = info.dwSize.Y - 1;
+
+        COORD dstPos;
+        dstPos.X = 0;
+        dstPos.Y = 0;
+
+        CHAR_INFO fill;
+        fill.Char.UnicodeChar = L' ';
+        fill.Attributes = info.wAttributes;
+
+        ScrollConsoleScreenBufferW(console, &rect, nullptr, dstPos, &fill);
+
+        info.dwCursorPosition.Y -= deltaY;
+        gScreenOrigin.Y         -= deltaY;
+        finalY                  -= deltaY;
+
+        SetConsoleCursorPosition(console, info.dwCursorPosition);
+    }
+
+    // Scroll the window down to show the rows if the cursor is visible.
+    if (info.dwCursorPosition.Y >= info.srWindow.Top &&
+        info.dwCursorPosition.Y <= info.srWindow.Bottom &&
+        finalY > info.srWindow.Bottom) {
+        SHORT deltaY = std::min<SHORT>(finalY - info.srWindow.Bottom, gScreenOrigin.Y - info.srWindow.Top);
+
+        SMALL_RECT rect;
+        rect.Left   = 0;
+        rect.Top    = deltaY;
+        rect.Right  = 0;
+        rect.Bottom = deltaY;
+
+        SetConsoleWindowInfo(console, FALSE, &rect);
+    }
+
+    for (auto const& write : gScreen.mWrites) {
+        COORD position;
+        position.X = 0;
+        position.Y = gScreenOrigin.Y + (SHORT) write.mRow;
+
+        DWORD numCharsWritten = 0;
+        WriteConsoleOutputCharacterW(console, gScreen.mBuffer.data() + write.mOffset, write.mLength, position, &numCharsWritten);
+    }
+
+    // If the screen was invalidated, whatever was below the rows is unknown.
+    if (invalidated) {
+        ClearConsoleBelow(console, info, gScreenOrigin.Y + (SHORT) gScreen.mPresentedRowCount);
+    }
+}
+
 static float CalculateFPSForPrintf(float duration)
 {
     return duration == 0.f ? 0.f : ((1000.f / duration) + 0.05f);
@@ -299,6 +319,25 @@ void UpdateConsole(uint32_t processId, ProcessInfo const& processInfo)
         }
 
         ConsolePrintLn(L"");
+
+        // Percentiles over the --stats_window
+        auto const& frameTime = chain.mFrameTimeHistogram;
+        auto const& latency = chain.mDisplayLatencyHistogram;
+        if (frameTime.mValueCount > 0) {
+            ConsolePrint(L"        CPU p1/p5/p99=%.3f/%.3f/%.3fms",
+                frameTime.GetPercentile(1.0),
+                frameTime.GetPercentile(5.0),
+                frameTime.GetPercentile(99.0));
+
+            if (args.mTrackDisplay && latency.mValueCount > 0) {
+                ConsolePrint(L" Latency p1/p5/p99=%.3f/%.3f/%.3fms",
+                    latency.GetPercentile(1.0),
+                    latency.GetPercentile(5.0),
+                    latency.GetPercentile(99.0));
+            }
+
+            ConsolePrintLn(L"");
+        }
     }
 
     if (!empty) {
@@ -306,6 +345,61 @@ void UpdateConsole(uint32_t processId, ProcessInfo const& processInfo)
     }
 }
 
+#if PRESENTMON_ENABLE_INSTRUMENTATION
+void UpdateInstrumentationConsole()
+{
+    static uint64_t lastEventCount = 0;
+    static uint64_t lastUpdateTime = 0;
+
+    InstrumentationSnapshot snapshot;
+    GetInstrumentationSnapshot(&snapshot);
+
+    LARGE_INTEGER now = {};
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    auto eventsPerSecond = lastUpdateTime == 0 || (uint64_t) now.QuadPart == lastUpdateTime ? 0.0 :
+        (double) (snapshot.mEventCount - lastEventCount) * frequency.QuadPart / (now.QuadPart - lastUpdateTime);
+    lastEventCount = snapshot.mEventCount;
+    lastUpdateTime = now.QuadPart;
+
+    ConsolePrintLn(L"Analysis: %llu events (%.0f/s) %.0f cycles/event p99<%llu cycles",
+        snapshot.mEventCount,
+        eventsPerSecond,
+        snapshot.mEventCount == 0 ? 0.0 : (double) snapshot.mCallbackCycles / snapshot.mEventCount,
+        GetCostHistogramPercentile(snapshot.mCallbackCycleHistogram, 0.99));
+    ConsolePrintLn(L"    Completed presents=%u (peak %u) Untracked events=%llu Evicted entries=%llu",
+        snapshot.mCompletedPresentCount,
+        snapshot.mPeakCompletedPresentCount,
+        snapshot.mUntrackedEventCount,
+        snapshot.mEvictedEntryCount);
+
+    ConsolePrint(L"   ");
+    for (size_t i = 0; i < (size_t) ConsumerTable::Count; ++i) {
+        if (snapshot.mTableSizes[i] > 0) {
+            ConsolePrint(L" %hs=%llu", GetConsumerTableName((ConsumerTable) i), snapshot.mTableSizes[i]);
+        }
+    }
+    ConsolePrintLn(L"");
+
+    // List the events that the consumer has spent the most time analyzing.
+    std::sort(snapshot.mEventCosts.begin(), snapshot.mEventCosts.end(), [](HandlerEventCost const& a, HandlerEventCost const& b) {
+        return a.mCycles > b.mCycles;
+    });
+    auto costCount = std::min<size_t>(snapshot.mEventCosts.size(), 8);
+    for (size_t i = 0; i < costCount; ++i) {
+        auto const& cost = snapshot.mEventCosts[i];
+        ConsolePrintLn(L"    %-10hs %5u: %llu events %.0f cycles/event p99<%llu cycles",
+            GetInstrumentedHandlerName(cost.mHandler),
+            cost.mEventId,
+            cost.mCount,
+            (double) cost.mCycles / cost.mCount,
+            GetCostHistogramPercentile(cost.mCycleHistogram, 0.99));
+    }
+    ConsolePrintLn(L"");
+}
+#endif
+
 static int PrintColor(WORD color, wchar_t const* format, va_list val)
 {
     #ifndef NDEBUG
@@ -0,0 +1,121 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ConsoleScreen retains the rows of console statistics last written to the console, so that each
+// refresh only writes the rows that changed.
+//
+// Each refresh formats its text into rows with Print() and EndRow(), wrapping at the console width,
+// then EndFrame() compares them with the rows already on screen.  Changed rows, and rows that are
+// no longer used, are appended (padded with spaces to the console width) to a single buffer, and
+// writes of consecutive rows are coalesced since they are contiguous in the console buffer.
+struct ConsoleScreen {
+    struct Write {
+        uint32_t mRow;      // First row written, relative to the top of the statistics
+        uint32_t mOffset;   // Offset of the text in mBuffer
+        uint32_t mLength;   // Number of characters, spanning mLength / mWidth rows
+    };
+
+    uint32_t mWidth = 0;
+    bool mInvalidated = true;
+
+    // Rows formatted since BeginFrame(), and the rows currently on screen.  The vectors are only
+    // grown so that their strings' storage is reused between refreshes.
+    std::vector<std::wstring> mRows;
+    std::vector<std::wstring> mPresentedRows;
+    uint32_t mRowCount = 0;
+    uint32_t mPresentedRowCount = 0;
+    bool mRowOpen = false;
+
+    // The writes needed to update the console, computed by EndFrame().
+    std::wstring mBuffer;
+    std::vector<Write> mWrites;
+
+    // If the width changed, or invalidate is set because the screen may have been modified
+    // elsewhere, every row is written on the next EndFrame().
+    void BeginFrame(uint32_t width, bool invalidate)
+    {
+        mInvalidated = invalidate || width != mWidth;
+        mWidth = std::max(width, 1u);
+        mRowCount = 0;
+        mRowOpen = false;
+    }
+
+    void Print(wchar_t const* text, size_t length)
+    {
+        for (;;) {
+            auto row = OpenRow();
+            auto n = std::min(length, (size_t) mWidth - row->size());
+            row->append(text, n);
+            text += n;
+            length -= n;
+            if (length == 0) {
+                break;
+            }
+            mRowOpen = false;
+        }
+    }
+
+    void EndRow()
+    {
+        OpenRow();
+        mRowOpen = false;
+    }
+
+    void EndFrame()
+    {
+        mBuffer.clear();
+        mWrites.clear();
+
+        if (mRowOpen) {
+            EndRow();
+        }
+
+        auto rowCount = mInvalidated ? mRowCount : std::max(mRowCount, mPresentedRowCount);
+        for (uint32_t i = 0; i < rowCount; ++i) {
+            static std::wstring const empty;
+            auto const& row = i < mRowCount ? mRows[i] : empty;
+            if (!mInvalidated && i < mPresentedRowCount && row == mPresentedRows[i]) {
+                continue;
+            }
+
+            if (!mWrites.empty() && mWrites.back().mRow + mWrites.back().mLength / mWidth == i) {
+                mWrites.back().mLength += mWidth;
+            } else {
+                mWrites.push_back({ i, (uint32_t) mBuffer.size(), mWidth });
+            }
+            mBuffer.append(row);
+            mBuffer.append(mWidth - row.size(), L' ');
+        }
+
+        std::swap(mRows, mPresentedRows);
+        mPresentedRowCount = mRowCount;
+        mInvalidated = false;
+    }
+
+    // The number of rows covered by mWrites.
+    uint32_t GetWrittenRowCount() const
+    {
+        return mWrites.empty() ? 0 : mWrites.back().mRow + mWrites.back().mLength / mWidth;
+    }
+
+    std::wstring* OpenRow()
+    {
+        if (!mRowOpen) {
+            if (mRowCount == mRows.size()) {
+                mRows.emplace_back();
+            }
+            mRows[mRowCount].clear();
+            mRowCount += 1;
+            mRowOpen = true;
+        }
+        return &mRows[mRowCount - 1];
+    }
+};
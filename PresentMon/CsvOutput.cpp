@@ -126,8 +126,17 @@ static void GenerateFilename(wchar_t* path, std::wstring const& processName, uin
 template<typename FrameMetricsT>
 void WriteCsvHeader(FILE* fp);
 
+// Rows are written by a WriteCsvRow instantiation specialized for the track
+// options in use, which is selected once by InitializeCsvOutput().  Time
+// unit, --write_display_time and --write_frame_id are still checked per row.
 template<typename FrameMetricsT>
-void WriteCsvRow(FILE* fp, PMTraceSession const& pmSession, ProcessInfo const& processInfo, PresentEvent const& p, FrameMetricsT const& metrics);
+using WriteCsvRowFn = void (*)(FILE* fp, PMTraceSession const& pmSession, ProcessInfo const& processInfo, PresentEvent const& p, FrameMetricsT const& metrics);
+
+static WriteCsvRowFn<FrameMetrics1> gWriteCsvRow1 = nullptr;
+static WriteCsvRowFn<FrameMetrics> gWriteCsvRow = nullptr;
+
+#pragma warning(push)
+#pragma warning(disable: 4984) // c++17 extension
 
 template<>
 void WriteCsvHeader<FrameMetrics1>(FILE* fp)
@@ -177,8 +186,14 @@ void WriteCsvHeader<FrameMetrics1>(FILE* fp)
     }
 }
 
-template<>
-void WriteCsvRow<FrameMetrics1>(
+// TRACK_FRAME_TYPE is unused, --track_frame_type is not supported with --v1_metrics.
+template<
+    bool TRACK_DISPLAY,
+    bool TRACK_GPU,
+    bool TRACK_GPU_VIDEO,
+    bool TRACK_INPUT,
+    bool TRACK_FRAME_TYPE>
+void WriteCsvRow(
     FILE* fp,
     PMTraceSession const& pmSession,
     ProcessInfo const& processInfo,
@@ -213,21 +228,21 @@ void WriteCsvRow<FrameMetrics1>(
     }
     fwprintf(fp, L",%.*lf,%.*lf", DBL_DIG - 1, metrics.msInPresentApi,
                                   DBL_DIG - 1, metrics.msBetweenPresents);
-    if (args.mTrackDisplay) {
+    if constexpr (TRACK_DISPLAY) {
         fwprintf(fp, L",%d,%hs,%.*lf,%.*lf,%.*lf", p.SupportsTearing,
                                                    PresentModeToString(p.PresentMode),
                                                    DBL_DIG - 1, metrics.msUntilRenderComplete,
                                                    DBL_DIG - 1, metrics.msUntilDisplayed,
                                                    DBL_DIG - 1, metrics.msBetweenDisplayChange);
     }
-    if (args.mTrackGPU) {
+    if constexpr (TRACK_GPU) {
         fwprintf(fp, L",%.*lf,%.*lf", DBL_DIG - 1, metrics.msUntilRenderStart,
                                       DBL_DIG - 1, metrics.msGPUDuration);
     }
-    if (args.mTrackGPUVideo) {
+    if constexpr (TRACK_GPU_VIDEO) {
         fwprintf(fp, L",%.*lf", DBL_DIG - 1, metrics.msVideoDuration);
     }
-    if (args.mTrackInput) {
+    if constexpr (TRACK_INPUT) {
         fwprintf(fp, L",%.*lf", DBL_DIG - 1, metrics.msSinceInput);
     }
     switch (args.mTimeUnit) {
@@ -314,8 +329,13 @@ void WriteCsvHeader<FrameMetrics>(FILE* fp)
     }
 }
 
-template<>
-void WriteCsvRow<FrameMetrics>(
+template<
+    bool TRACK_DISPLAY,
+    bool TRACK_GPU,
+    bool TRACK_GPU_VIDEO,
+    bool TRACK_INPUT,
+    bool TRACK_FRAME_TYPE>
+void WriteCsvRow(
     FILE* fp,
     PMTraceSession const& pmSession,
     ProcessInfo const& processInfo,
@@ -330,11 +350,11 @@ void WriteCsvRow<FrameMetrics>(
                                             RuntimeToString(p.Runtime),
                                             p.SyncInterval,
                                             p.PresentFlags);
-    if (args.mTrackDisplay) {
+    if constexpr (TRACK_DISPLAY) {
         fwprintf(fp, L",%d,%hs", p.SupportsTearing,
                                  PresentModeToString(p.PresentMode));
     }
-    if (args.mTrackFrameType) {
+    if constexpr (TRACK_FRAME_TYPE) {
         fwprintf(fp, L",%hs", FrameTypeToString(p.FrameType));
     }
     switch (args.mTimeUnit) {
@@ -363,16 +383,16 @@ void WriteCsvRow<FrameMetrics>(
     fwprintf(fp, L",%.4lf,%.4lf,%.4lf", metrics.mCPUBusy + metrics.mCPUWait,
                                         metrics.mCPUBusy,
                                         metrics.mCPUWait);
-    if (args.mTrackGPU) {
+    if constexpr (TRACK_GPU) {
         fwprintf(fp, L",%.4lf,%.4lf,%.4lf,%.4lf", metrics.mGPULatency,
                                                   metrics.mGPUBusy + metrics.mGPUWait,
                                                   metrics.mGPUBusy,
                                                   metrics.mGPUWait);
     }
-    if (args.mTrackGPUVideo) {
+    if constexpr (TRACK_GPU_VIDEO) {
         fwprintf(fp, L",%.4lf", metrics.mVideoBusy);
     }
-    if (args.mTrackDisplay) {
+    if constexpr (TRACK_DISPLAY) {
         if (metrics.mDisplayedTime == 0.0) {
             fwprintf(fp, L",NA,NA,NA");
         } else {
@@ -381,7 +401,7 @@ void WriteCsvRow<FrameMetrics>(
                                                 metrics.mAnimationError);
         }
     }
-    if (args.mTrackInput) {
+    if constexpr (TRACK_INPUT) {
         if (metrics.mAllInputPhotonLatency == 0.0) {
             fwprintf(fp, L",NA");
         }
@@ -412,12 +432,68 @@ void WriteCsvRow<FrameMetrics>(
     }
 }
 
+#pragma warning(pop)
+
+template<typename FrameMetricsT, bool... Ts>
+WriteCsvRowFn<FrameMetricsT> GetWriteCsvRow(bool t1)
+{
+    return t1 ? static_cast<WriteCsvRowFn<FrameMetricsT>>(&WriteCsvRow<Ts..., true>)
+              : static_cast<WriteCsvRowFn<FrameMetricsT>>(&WriteCsvRow<Ts..., false>);
+}
+
+template<typename FrameMetricsT, bool... Ts>
+WriteCsvRowFn<FrameMetricsT> GetWriteCsvRow(bool t1, bool t2)
+{
+    return t1 ? GetWriteCsvRow<FrameMetricsT, Ts..., true>(t2)
+              : GetWriteCsvRow<FrameMetricsT, Ts..., false>(t2);
+}
+
+template<typename FrameMetricsT, bool... Ts>
+WriteCsvRowFn<FrameMetricsT> GetWriteCsvRow(bool t1, bool t2, bool t3)
+{
+    return t1 ? GetWriteCsvRow<FrameMetricsT, Ts..., true>(t2, t3)
+              : GetWriteCsvRow<FrameMetricsT, Ts..., false>(t2, t3);
+}
+
+template<typename FrameMetricsT, bool... Ts>
+WriteCsvRowFn<FrameMetricsT> GetWriteCsvRow(bool t1, bool t2, bool t3, bool t4)
+{
+    return t1 ? GetWriteCsvRow<FrameMetricsT, Ts..., true>(t2, t3, t4)
+              : GetWriteCsvRow<FrameMetricsT, Ts..., false>(t2, t3, t4);
+}
+
+template<typename FrameMetricsT, bool... Ts>
+WriteCsvRowFn<FrameMetricsT> GetWriteCsvRow(bool t1, bool t2, bool t3, bool t4, bool t5)
+{
+    return t1 ? GetWriteCsvRow<FrameMetricsT, Ts..., true>(t2, t3, t4, t5)
+              : GetWriteCsvRow<FrameMetricsT, Ts..., false>(t2, t3, t4, t5);
+}
+
+void InitializeCsvOutput()
+{
+    auto const& args = GetCommandLineArgs();
+
+    gWriteCsvRow1 = GetWriteCsvRow<FrameMetrics1>(
+        args.mTrackDisplay,     // TRACK_DISPLAY
+        args.mTrackGPU,         // TRACK_GPU
+        args.mTrackGPUVideo,    // TRACK_GPU_VIDEO
+        args.mTrackInput,       // TRACK_INPUT
+        false);                 // TRACK_FRAME_TYPE
+    gWriteCsvRow = GetWriteCsvRow<FrameMetrics>(
+        args.mTrackDisplay,     // TRACK_DISPLAY
+        args.mTrackGPU,         // TRACK_GPU
+        args.mTrackGPUVideo,    // TRACK_GPU_VIDEO
+        args.mTrackInput,       // TRACK_INPUT
+        args.mTrackFrameType);  // TRACK_FRAME_TYPE
+}
+
 template<typename FrameMetricsT>
 void UpdateCsvT(
     PMTraceSession const& pmSession,
     ProcessInfo* processInfo,
     PresentEvent const& p,
-    FrameMetricsT const& metrics)
+    FrameMetricsT const& metrics,
+    WriteCsvRowFn<FrameMetricsT> writeCsvRow)
 {
     auto const& args = GetCommandLineArgs();
 
@@ -452,17 +528,17 @@ void UpdateCsvT(
     }
 
     // Output in CSV format
-    WriteCsvRow(*fp, pmSession, *processInfo, p, metrics);
+    writeCsvRow(*fp, pmSession, *processInfo, p, metrics);
 }
 
 void UpdateCsv(PMTraceSession const& pmSession, ProcessInfo* processInfo, PresentEvent const& p, FrameMetrics1 const& metrics)
 {
-    UpdateCsvT(pmSession, processInfo, p, metrics);
+    UpdateCsvT(pmSession, processInfo, p, metrics, gWriteCsvRow1);
 }
 
 void UpdateCsv(PMTraceSession const& pmSession, ProcessInfo* processInfo, PresentEvent const& p, FrameMetrics const& metrics)
 {
-    UpdateCsvT(pmSession, processInfo, p, metrics);
+    UpdateCsvT(pmSession, processInfo, p, metrics, gWriteCsvRow);
 }
 
 static void CloseCsv(FILE** fp)
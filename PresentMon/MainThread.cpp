@@ -52,6 +52,26 @@ static bool EnableScrollLock(bool enable)
     return enabled;
 }
 
+// Used by the consumer to look up the name of processes that were already
+// running when the realtime session started.
+static bool QueryProcessImageFileName(uint32_t processId, std::wstring* imageFileName)
+{
+    auto handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (handle == NULL) {
+        return false;
+    }
+
+    wchar_t path[MAX_PATH];
+    DWORD numChars = _countof(path);
+    auto ok = QueryFullProcessImageNameW(handle, 0, path, &numChars) != 0;
+    if (ok) {
+        imageFileName->assign(path, numChars);
+    }
+
+    CloseHandle(handle);
+    return ok;
+}
+
 static bool IsRecording()
 {
     return gIsRecording;
@@ -264,11 +284,27 @@ int wmain(int argc, wchar_t** argv)
     if (args.mTargetPid != 0) {
         pmConsumer.mFilteredProcessIds = true;
         pmConsumer.AddTrackedProcessForFiltering(args.mTargetPid);
+    } else {
+        // With --process_id, that process is a target whatever its name.
+        for (auto const& name : args.mTargetProcessNames) {
+            pmConsumer.AddTargetProcessName(name);
+        }
+    }
+    for (auto const& name : args.mExcludeProcessNames) {
+        pmConsumer.AddExcludedProcessName(name);
+    }
+    if (args.mEtlFileName == nullptr) {
+        pmConsumer.mProcessNameResolver = &QueryProcessImageFileName;
     }
 
     // Start the ETW trace session.
     PMTraceSession pmSession;
     pmSession.mPMConsumer = &pmConsumer;
+
+    ShardedTraceConsumer shardedConsumer;
+    if (args.mAnalysisThreadCount > 1) {
+        pmSession.mShardedConsumer = &shardedConsumer;
+    }
     auto status = pmSession.Start(args.mEtlFileName, args.mSessionName);
 
     // If a session with this same name is already running, we either exit or
@@ -328,7 +364,17 @@ int wmain(int argc, wchar_t** argv)
         pmConsumer.mDeferralTimeLimit = pmSession.mTimestampFrequency.QuadPart * 2;
     }
 
-    // Start the consumer and output threads
+    // Realtime sessions can run indefinitely, so evict tracking state that hasn't been used for
+    // 60 seconds (e.g., because its stop event was lost).  ETL analysis is left unchanged.
+    if (args.mEtlFileName == nullptr) {
+        pmConsumer.mTrackingStateTimeLimit = pmSession.mTimestampFrequency.QuadPart * 60;
+        pmConsumer.mTrackingStateTableLimit = 4096;
+    }
+
+    // Start the analysis, consumer, and output threads
+    if (pmSession.mShardedConsumer != nullptr) {
+        shardedConsumer.Start(pmConsumer, args.mAnalysisThreadCount);
+    }
     StartConsumerThread(pmSession.mTraceHandle);
     StartOutputThread(pmSession);
 
@@ -372,6 +418,7 @@ int wmain(int argc, wchar_t** argv)
     // Wait for the consumer and output threads to end (which are using the
     // consumers).
     WaitForConsumerThreadToExit();
+    shardedConsumer.Stop();
     StopOutputThread();
 
     // Output warning if events were lost.
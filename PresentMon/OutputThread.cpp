@@ -179,11 +179,15 @@ static void ProcessProcessEvent(
 }
 
 static void UpdateProcessEvents(
-    PMTraceConsumer* pmConsumer,
+    PMTraceSession const* pmSession,
     std::vector<ProcessEvent>* processEvents)
 {
     std::vector<ProcessEvent> newProcessEvents;
-    pmConsumer->DequeueProcessEvents(newProcessEvents);
+    if (pmSession->mShardedConsumer != nullptr) {
+        pmSession->mShardedConsumer->DequeueProcessEvents(newProcessEvents);
+    } else {
+        pmSession->mPMConsumer->DequeueProcessEvents(newProcessEvents);
+    }
 
     if (!newProcessEvents.empty()) {
         processEvents->insert(processEvents->end(), newProcessEvents.begin(), newProcessEvents.end());
@@ -233,6 +237,17 @@ static void UpdateAverage(float* avg, double value)
     }
 }
 
+// The duration of the console statistics' rolling histograms, in timestamp units.
+static uint64_t gStatisticsWindow = 0;
+
+static void UpdateHistogram(RollingHistogram* histogram, uint64_t timestamp, double value)
+{
+    if (!histogram->IsInitialized()) {
+        histogram->Initialize(gStatisticsWindow);
+    }
+    histogram->Add(timestamp, value);
+}
+
 static void UpdateChain(
     SwapChainData* chain,
     std::shared_ptr<PresentEvent> const& p)
@@ -248,38 +263,67 @@ static void UpdateChain(
     chain->mIncludeFrameData = true;
 }
 
+// The per-present metric kernels are instantiated for each combination of
+// options that changes which metrics are computed, and ProcessEvents() calls
+// the instantiation selected by GetReportPresent() for the command line.
+// Metrics that are neither written to the CSV nor used for console statistics
+// under the active options are left at zero.
+
+#pragma warning(push)
+#pragma warning(disable: 4984) // c++17 extension
+
+template<
+    bool TRACK_DISPLAY,
+    bool TRACK_GPU,
+    bool TRACK_GPU_VIDEO,
+    bool TRACK_INPUT,
+    bool COMPUTE_AVG>
 static void ReportMetrics1(
     PMTraceSession const& pmSession,
     ProcessInfo* processInfo,
     SwapChainData* chain,
     std::shared_ptr<PresentEvent> const& p,
-    bool isRecording,
-    bool computeAvg)
+    bool isRecording)
 {
-    bool displayed = p->FinalState == PresentResult::Presented;
-
-    FrameMetrics1 metrics;
+    FrameMetrics1 metrics = {};
     metrics.msBetweenPresents      = chain->mLastPresent == nullptr ? 0 : pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastPresent->PresentStartTime, p->PresentStartTime);
     metrics.msInPresentApi         = pmSession.TimestampDeltaToMilliSeconds(p->TimeInPresent);
-    metrics.msUntilRenderComplete  = pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime, p->ReadyTime);
-    metrics.msUntilDisplayed       = !displayed ? 0 : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->PresentStartTime, p->ScreenTime);
-    metrics.msBetweenDisplayChange = !displayed || chain->mLastDisplayedScreenTime == 0 ? 0 : pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastDisplayedScreenTime, p->ScreenTime);
-    metrics.msUntilRenderStart     = pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime, p->GPUStartTime);
-    metrics.msGPUDuration          = pmSession.TimestampDeltaToMilliSeconds(p->GPUDuration);
-    metrics.msVideoDuration        = pmSession.TimestampDeltaToMilliSeconds(p->GPUVideoDuration);
-    metrics.msSinceInput           = p->InputTime == 0 ? 0 : pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime - p->InputTime);
+    if constexpr (TRACK_DISPLAY) {
+        bool displayed = p->FinalState == PresentResult::Presented;
+        metrics.msUntilRenderComplete  = pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime, p->ReadyTime);
+        metrics.msUntilDisplayed       = !displayed ? 0 : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->PresentStartTime, p->ScreenTime);
+        metrics.msBetweenDisplayChange = !displayed || chain->mLastDisplayedScreenTime == 0 ? 0 : pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastDisplayedScreenTime, p->ScreenTime);
+    }
+    if constexpr (TRACK_GPU) {
+        metrics.msUntilRenderStart     = pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime, p->GPUStartTime);
+        metrics.msGPUDuration          = pmSession.TimestampDeltaToMilliSeconds(p->GPUDuration);
+    }
+    if constexpr (TRACK_GPU_VIDEO) {
+        metrics.msVideoDuration        = pmSession.TimestampDeltaToMilliSeconds(p->GPUVideoDuration);
+    }
+    if constexpr (TRACK_INPUT) {
+        metrics.msSinceInput           = p->InputTime == 0 ? 0 : pmSession.TimestampDeltaToMilliSeconds(p->PresentStartTime - p->InputTime);
+    }
 
     if (isRecording) {
         UpdateCsv(pmSession, processInfo, *p, metrics);
     }
 
-    if (computeAvg) {
+    if constexpr (COMPUTE_AVG) {
         UpdateAverage(&chain->mAvgCPUDuration, metrics.msBetweenPresents);
-        UpdateAverage(&chain->mAvgGPUDuration, metrics.msGPUDuration);
-        if (metrics.msUntilDisplayed > 0) {
-            UpdateAverage(&chain->mAvgDisplayLatency, metrics.msUntilDisplayed);
-            if (metrics.msBetweenDisplayChange > 0) {
-                UpdateAverage(&chain->mAvgDisplayedTime, metrics.msBetweenDisplayChange);
+        if (metrics.msBetweenPresents > 0) {
+            UpdateHistogram(&chain->mFrameTimeHistogram, p->PresentStartTime, metrics.msBetweenPresents);
+        }
+        if constexpr (TRACK_GPU) {
+            UpdateAverage(&chain->mAvgGPUDuration, metrics.msGPUDuration);
+        }
+        if constexpr (TRACK_DISPLAY) {
+            if (metrics.msUntilDisplayed > 0) {
+                UpdateAverage(&chain->mAvgDisplayLatency, metrics.msUntilDisplayed);
+                UpdateHistogram(&chain->mDisplayLatencyHistogram, p->PresentStartTime, metrics.msUntilDisplayed);
+                if (metrics.msBetweenDisplayChange > 0) {
+                    UpdateAverage(&chain->mAvgDisplayedTime, metrics.msBetweenDisplayChange);
+                }
             }
         }
     }
@@ -287,6 +331,12 @@ static void ReportMetrics1(
     UpdateChain(chain, p);
 }
 
+template<
+    bool TRACK_DISPLAY,
+    bool TRACK_GPU,
+    bool TRACK_GPU_VIDEO,
+    bool TRACK_INPUT,
+    bool COMPUTE_AVG>
 static void ReportMetrics(
     PMTraceSession const& pmSession,
     ProcessInfo* processInfo,
@@ -294,8 +344,7 @@ static void ReportMetrics(
     std::shared_ptr<PresentEvent> const& p,
     std::shared_ptr<PresentEvent> const& nextPresent,
     PresentEvent const* nextDisplayedPresent,
-    bool isRecording,
-    bool computeAvg)
+    bool isRecording)
 {
     // Ignore repeated frames
     if (p->FrameType == FrameType::Repeated) {
@@ -330,55 +379,56 @@ static void ReportMetrics(
     bool includeFrameData = chain->mIncludeFrameData && (p->FrameId != nextPresent->FrameId || p->FrameType == FrameType::Application);
 
     bool displayed = p->FinalState == PresentResult::Presented;
-    double msGPUDuration = 0.0;
 
-    FrameMetrics metrics;
+    FrameMetrics metrics = {};
     metrics.mCPUStart = chain->mLastPresent->PresentStartTime + chain->mLastPresent->TimeInPresent;
 
     if (includeFrameData) {
-        msGPUDuration       = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->GPUStartTime, p->ReadyTime);
         metrics.mCPUBusy    = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->PresentStartTime);
         metrics.mCPUWait    = pmSession.TimestampDeltaToMilliSeconds(p->TimeInPresent);
-        metrics.mGPULatency = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->GPUStartTime);
-        metrics.mGPUBusy    = pmSession.TimestampDeltaToMilliSeconds(p->GPUDuration);
-        metrics.mVideoBusy  = pmSession.TimestampDeltaToMilliSeconds(p->GPUVideoDuration);
-        metrics.mGPUWait    = std::max(0.0, msGPUDuration - metrics.mGPUBusy);
-    } else {
-        metrics.mCPUBusy    = 0;
-        metrics.mCPUWait    = 0;
-        metrics.mGPULatency = 0;
-        metrics.mGPUBusy    = 0;
-        metrics.mVideoBusy  = 0;
-        metrics.mGPUWait    = 0;
+        if constexpr (TRACK_GPU) {
+            auto msGPUDuration  = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->GPUStartTime, p->ReadyTime);
+            metrics.mGPULatency = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->GPUStartTime);
+            metrics.mGPUBusy    = pmSession.TimestampDeltaToMilliSeconds(p->GPUDuration);
+            metrics.mGPUWait    = std::max(0.0, msGPUDuration - metrics.mGPUBusy);
+            if constexpr (COMPUTE_AVG) {
+                UpdateAverage(&chain->mAvgGPUDuration, msGPUDuration);
+            }
+        }
+        if constexpr (TRACK_GPU_VIDEO) {
+            metrics.mVideoBusy  = pmSession.TimestampDeltaToMilliSeconds(p->GPUVideoDuration);
+        }
     }
 
     if (displayed) {
-        metrics.mDisplayLatency       = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->ScreenTime);
-        metrics.mDisplayedTime        = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->ScreenTime, nextDisplayedPresent->ScreenTime);
-        metrics.mAnimationError       = chain->mLastDisplayedCPUStart == 0 ? 0 : pmSession.TimestampDeltaToMilliSeconds(p->ScreenTime - chain->mLastDisplayedScreenTime,
-                                                                                                                        metrics.mCPUStart - chain->mLastDisplayedCPUStart);
-        auto updatedInputTime = chain->mLastReceivedNotDisplayedAllInputTime == 0 ? 0 :
-            pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastReceivedNotDisplayedAllInputTime, p->ScreenTime);
-        metrics.mAllInputPhotonLatency = p->InputTime == 0 ? updatedInputTime : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->InputTime, p->ScreenTime);
-
-        updatedInputTime = chain->mLastReceivedNotDisplayedMouseClickTime == 0 ? 0 :
-            pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastReceivedNotDisplayedMouseClickTime, p->ScreenTime);
-        metrics.mClickToPhotonLatency = p->MouseClickTime == 0 ? updatedInputTime : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->MouseClickTime, p->ScreenTime);
+        if constexpr (TRACK_DISPLAY) {
+            metrics.mDisplayLatency       = pmSession.TimestampDeltaToUnsignedMilliSeconds(metrics.mCPUStart, p->ScreenTime);
+            metrics.mDisplayedTime        = pmSession.TimestampDeltaToUnsignedMilliSeconds(p->ScreenTime, nextDisplayedPresent->ScreenTime);
+            metrics.mAnimationError       = chain->mLastDisplayedCPUStart == 0 ? 0 : pmSession.TimestampDeltaToMilliSeconds(p->ScreenTime - chain->mLastDisplayedScreenTime,
+                                                                                                                            metrics.mCPUStart - chain->mLastDisplayedCPUStart);
+        } else {
+            (void) nextDisplayedPresent;
+        }
+        if constexpr (TRACK_INPUT) {
+            auto updatedInputTime = chain->mLastReceivedNotDisplayedAllInputTime == 0 ? 0 :
+                pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastReceivedNotDisplayedAllInputTime, p->ScreenTime);
+            metrics.mAllInputPhotonLatency = p->InputTime == 0 ? updatedInputTime : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->InputTime, p->ScreenTime);
 
-        chain->mLastReceivedNotDisplayedAllInputTime = 0;
-        chain->mLastReceivedNotDisplayedMouseClickTime = 0;
+            updatedInputTime = chain->mLastReceivedNotDisplayedMouseClickTime == 0 ? 0 :
+                pmSession.TimestampDeltaToUnsignedMilliSeconds(chain->mLastReceivedNotDisplayedMouseClickTime, p->ScreenTime);
+            metrics.mClickToPhotonLatency = p->MouseClickTime == 0 ? updatedInputTime : pmSession.TimestampDeltaToUnsignedMilliSeconds(p->MouseClickTime, p->ScreenTime);
 
-    } else {
-        metrics.mDisplayLatency       = 0;
-        metrics.mDisplayedTime        = 0;
-        metrics.mAnimationError       = 0;
-        metrics.mClickToPhotonLatency = 0;
-        metrics.mAllInputPhotonLatency = 0;
-        if (p->InputTime != 0) {
-            chain->mLastReceivedNotDisplayedAllInputTime = p->InputTime;
+            chain->mLastReceivedNotDisplayedAllInputTime = 0;
+            chain->mLastReceivedNotDisplayedMouseClickTime = 0;
         }
-        if (p->MouseClickTime != 0) {
-            chain->mLastReceivedNotDisplayedMouseClickTime = p->MouseClickTime;
+    } else {
+        if constexpr (TRACK_INPUT) {
+            if (p->InputTime != 0) {
+                chain->mLastReceivedNotDisplayedAllInputTime = p->InputTime;
+            }
+            if (p->MouseClickTime != 0) {
+                chain->mLastReceivedNotDisplayedMouseClickTime = p->MouseClickTime;
+            }
         }
     }
 
@@ -386,14 +436,17 @@ static void ReportMetrics(
         UpdateCsv(pmSession, processInfo, *p, metrics);
     }
 
-    if (computeAvg) {
+    if constexpr (COMPUTE_AVG) {
         if (includeFrameData) {
             UpdateAverage(&chain->mAvgCPUDuration, metrics.mCPUBusy + metrics.mCPUWait);
-            UpdateAverage(&chain->mAvgGPUDuration, msGPUDuration);
+            UpdateHistogram(&chain->mFrameTimeHistogram, p->PresentStartTime, metrics.mCPUBusy + metrics.mCPUWait);
         }
-        if (displayed) {
-            UpdateAverage(&chain->mAvgDisplayLatency, metrics.mDisplayLatency);
-            UpdateAverage(&chain->mAvgDisplayedTime, metrics.mDisplayedTime);
+        if constexpr (TRACK_DISPLAY) {
+            if (displayed) {
+                UpdateAverage(&chain->mAvgDisplayLatency, metrics.mDisplayLatency);
+                UpdateHistogram(&chain->mDisplayLatencyHistogram, p->PresentStartTime, metrics.mDisplayLatency);
+                UpdateAverage(&chain->mAvgDisplayedTime, metrics.mDisplayedTime);
+            }
         }
     }
 
@@ -406,6 +459,103 @@ static void ReportMetrics(
     }
 }
 
+// If we are recording or presenting metrics to console then update the metrics and pending
+// presents.  Otherwise, just update the latest present details in the chain.
+//
+// If there are more than one pending PresentEvents, then the first one is displayed and the
+// rest aren't.  Otherwise, there will only be one (or zero) pending presents.
+template<
+    bool USE_V1_METRICS,
+    bool TRACK_DISPLAY,
+    bool TRACK_GPU,
+    bool TRACK_GPU_VIDEO,
+    bool TRACK_INPUT,
+    bool COMPUTE_AVG>
+static void ReportPresent(
+    PMTraceSession const& pmSession,
+    ProcessInfo* processInfo,
+    SwapChainData* chain,
+    std::shared_ptr<PresentEvent> const& presentEvent,
+    bool isRecording)
+{
+    if constexpr (!COMPUTE_AVG) {
+        if (!isRecording) {
+            UpdateChain(chain, presentEvent);
+            return;
+        }
+    }
+
+    if constexpr (USE_V1_METRICS) {
+        ReportMetrics1<TRACK_DISPLAY, TRACK_GPU, TRACK_GPU_VIDEO, TRACK_INPUT, COMPUTE_AVG>(pmSession, processInfo, chain, presentEvent, isRecording);
+    } else {
+        auto reportMetrics = &ReportMetrics<TRACK_DISPLAY, TRACK_GPU, TRACK_GPU_VIDEO, TRACK_INPUT, COMPUTE_AVG>;
+        auto numPendingPresents = chain->mPendingPresents.size();
+        if (numPendingPresents > 0) {
+            if (presentEvent->FinalState == PresentResult::Presented) {
+                size_t i = 1;
+                for ( ; i < numPendingPresents; ++i) {
+                    reportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[i - 1], chain->mPendingPresents[i], presentEvent.get(), isRecording);
+                }
+                reportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[i - 1], presentEvent, presentEvent.get(), isRecording);
+                chain->mPendingPresents.clear();
+            } else {
+                if (chain->mPendingPresents[0]->FinalState != PresentResult::Presented) {
+                    reportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[0], presentEvent, nullptr, isRecording);
+                    chain->mPendingPresents.clear();
+                }
+            }
+        }
+
+        chain->mPendingPresents.push_back(presentEvent);
+    }
+}
+
+#pragma warning(pop)
+
+typedef void (*ReportPresentFn)(PMTraceSession const&, ProcessInfo*, SwapChainData*, std::shared_ptr<PresentEvent> const&, bool);
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1)
+{
+    return t1 ? &ReportPresent<Ts..., true>
+              : &ReportPresent<Ts..., false>;
+}
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1, bool t2)
+{
+    return t1 ? GetReportPresent<Ts..., true>(t2)
+              : GetReportPresent<Ts..., false>(t2);
+}
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1, bool t2, bool t3)
+{
+    return t1 ? GetReportPresent<Ts..., true>(t2, t3)
+              : GetReportPresent<Ts..., false>(t2, t3);
+}
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1, bool t2, bool t3, bool t4)
+{
+    return t1 ? GetReportPresent<Ts..., true>(t2, t3, t4)
+              : GetReportPresent<Ts..., false>(t2, t3, t4);
+}
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1, bool t2, bool t3, bool t4, bool t5)
+{
+    return t1 ? GetReportPresent<Ts..., true>(t2, t3, t4, t5)
+              : GetReportPresent<Ts..., false>(t2, t3, t4, t5);
+}
+
+template<bool... Ts>
+static ReportPresentFn GetReportPresent(bool t1, bool t2, bool t3, bool t4, bool t5, bool t6)
+{
+    return t1 ? GetReportPresent<Ts..., true>(t2, t3, t4, t5, t6)
+              : GetReportPresent<Ts..., false>(t2, t3, t4, t5, t6);
+}
+
 static void PruneOldSwapChainData(
     PMTraceSession const& pmSession,
     uint64_t latestTimestamp)
@@ -522,14 +672,12 @@ static void ProcessRecordingToggle(
 
 static void ProcessEvents(
     PMTraceSession const& pmSession,
+    ReportPresentFn reportPresent,
     std::vector<std::shared_ptr<PresentEvent>> const& presentEvents,
     std::vector<ProcessEvent>* processEvents,
     std::vector<uint64_t>* recordingToggleHistory,
     bool currentRecordingState)
 {
-    auto const& args = GetCommandLineArgs();
-    auto computeAvg = args.mConsoleOutput == ConsoleOutput::Statistics;
-
     // Determine the recording state and when the next toggle is.
     size_t recordingToggleIndex = 0;
     size_t recordingToggleCount = recordingToggleHistory->size();
@@ -588,37 +736,7 @@ static void ProcessEvents(
             continue;
         }
 
-        // If we are recording or presenting metrics to console then update the metrics and pending
-        // presents.  Otherwise, just update the latest present details in the chain.
-        //
-        // If there are more than one pending PresentEvents, then the first one is displayed and the
-        // rest aren't.  Otherwise, there will only be one (or zero) pending presents.
-        if (isRecording || computeAvg) {
-            if (args.mUseV1Metrics) {
-                ReportMetrics1(pmSession, processInfo, chain, presentEvent, isRecording, computeAvg);
-            } else {
-                auto numPendingPresents = chain->mPendingPresents.size();
-                if (numPendingPresents > 0) {
-                    if (presentEvent->FinalState == PresentResult::Presented) {
-                        size_t i = 1;
-                        for ( ; i < numPendingPresents; ++i) {
-                            ReportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[i - 1], chain->mPendingPresents[i], presentEvent.get(), isRecording, computeAvg);
-                        }
-                        ReportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[i - 1], presentEvent, presentEvent.get(), isRecording, computeAvg);
-                        chain->mPendingPresents.clear();
-                    } else {
-                        if (chain->mPendingPresents[0]->FinalState != PresentResult::Presented) {
-                            ReportMetrics(pmSession, processInfo, chain, chain->mPendingPresents[0], presentEvent, nullptr, isRecording, computeAvg);
-                            chain->mPendingPresents.clear();
-                        }
-                    }
-                }
-
-                chain->mPendingPresents.push_back(presentEvent);
-            }
-        } else {
-            UpdateChain(chain, presentEvent);
-        }
+        reportPresent(pmSession, processInfo, chain, presentEvent, isRecording);
     }
 
     // Prune any SwapChainData that hasn't seen an update for over 4 seconds.
@@ -639,6 +757,16 @@ void Output(PMTraceSession const* pmSession)
 
     auto const& args = GetCommandLineArgs();
 
+    auto reportPresent = GetReportPresent(
+        args.mUseV1Metrics,                                 // USE_V1_METRICS
+        args.mTrackDisplay,                                 // TRACK_DISPLAY
+        args.mTrackGPU,                                     // TRACK_GPU
+        args.mTrackGPUVideo,                                // TRACK_GPU_VIDEO
+        args.mTrackInput,                                   // TRACK_INPUT
+        args.mConsoleOutput == ConsoleOutput::Statistics);  // COMPUTE_AVG
+
+    gStatisticsWindow = pmSession->MilliSecondsDeltaToTimestamp(1000.0 * args.mStatisticsWindow);
+
     // Structures to track processes and statistics from recorded events.
     std::vector<uint64_t> recordingToggleHistory;
     std::vector<ProcessEvent> processEvents;
@@ -646,6 +774,10 @@ void Output(PMTraceSession const* pmSession)
     processEvents.reserve(128);
     presentEvents.reserve(4096);
 
+    // The console statistics are refreshed every --stats_refresh milliseconds, independently of
+    // how often the analyzed events are processed.
+    ULONGLONG nextConsoleUpdate = 0;
+
     for (;;) {
         // Read gQuit here, but then check it after processing queued events.
         // This ensures that we call Dequeue*() at least once after
@@ -656,13 +788,17 @@ void Output(PMTraceSession const* pmSession)
         bool currentRecordingState = CopyRecordingToggleHistory(&recordingToggleHistory);
 
         // Copy process events, present events, and lost present events from ConsumerThread.
-        UpdateProcessEvents(pmSession->mPMConsumer, &processEvents);
-        pmSession->mPMConsumer->DequeuePresentEvents(presentEvents);
+        UpdateProcessEvents(pmSession, &processEvents);
+        if (pmSession->mShardedConsumer != nullptr) {
+            pmSession->mShardedConsumer->DequeuePresentEvents(presentEvents);
+        } else {
+            pmSession->mPMConsumer->DequeuePresentEvents(presentEvents);
+        }
 
         // Process all the collected events, and update the various tracking
         // and statistics data structures.
         if (!presentEvents.empty()) {
-            ProcessEvents(*pmSession, presentEvents, &processEvents, &recordingToggleHistory, currentRecordingState);
+            ProcessEvents(*pmSession, reportPresent, presentEvents, &processEvents, &recordingToggleHistory, currentRecordingState);
             presentEvents.clear();
         }
 
@@ -681,11 +817,22 @@ void Output(PMTraceSession const* pmSession)
             break;
         #endif
         case ConsoleOutput::Statistics:
+            if (GetTickCount64() < nextConsoleUpdate) {
+                break;
+            }
+            nextConsoleUpdate = GetTickCount64() + args.mStatisticsRefreshPeriod;
+
             if (BeginConsoleUpdate()) {
                 for (auto const& pair : gProcesses) {
                     UpdateConsole(pair.first, pair.second);
                 }
 
+                #if PRESENTMON_ENABLE_INSTRUMENTATION
+                if (args.mDebugInstrumentation) {
+                    UpdateInstrumentationConsole();
+                }
+                #endif
+
                 if (currentRecordingState && args.mCSVOutput != CSVOutput::None) {
                     ConsolePrintLn(L"** RECORDING **");
                 }
@@ -701,8 +848,13 @@ void Output(PMTraceSession const* pmSession)
             break;
         }
 
-        // Sleep to reduce overhead.
-        Sleep(100);
+        // Sleep to reduce overhead, but wake up in time for the next console update.
+        DWORD sleepMs = 100;
+        if (args.mConsoleOutput == ConsoleOutput::Statistics) {
+            auto now = GetTickCount64();
+            sleepMs = now >= nextConsoleUpdate ? 0 : (DWORD) std::min<ULONGLONG>(sleepMs, nextConsoleUpdate - now);
+        }
+        Sleep(sleepMs);
     }
 
     // Close all CSV and process handles
@@ -724,6 +876,7 @@ void Output(PMTraceSession const* pmSession)
 void StartOutputThread(PMTraceSession const& pmSession)
 {
     InitializeCriticalSection(&gRecordingToggleCS);
+    InitializeCsvOutput();
     gQuit = false;
     gThread = std::thread(Output, &pmSession); // Doesn't work to pass a reference, it makes a copy
 }
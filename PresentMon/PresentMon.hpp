@@ -26,8 +26,11 @@ collected data is written to the CSV file(s) is controlled by a recording state
 which is controlled from MainThread based on user input or timer.
 */
 
+#include "../PresentData/Instrumentation.hpp"
 #include "../PresentData/PresentMonTraceConsumer.hpp"
 #include "../PresentData/PresentMonTraceSession.hpp"
+#include "../PresentData/ShardedTraceConsumer.hpp"
+#include "RollingHistogram.hpp"
 
 #include <unordered_map>
 #include <queue>
@@ -65,6 +68,9 @@ struct CommandLineArgs {
     UINT mTimer;
     UINT mHotkeyModifiers;
     UINT mHotkeyVirtualKeyCode;
+    UINT mAnalysisThreadCount;
+    UINT mStatisticsWindow;
+    UINT mStatisticsRefreshPeriod;
     TimeUnit mTimeUnit;
     CSVOutput mCSVOutput;
     ConsoleOutput mConsoleOutput;
@@ -87,6 +93,7 @@ struct CommandLineArgs {
     bool mWriteFrameId;
     bool mWriteDisplayTime;
     bool mDisableOfflineBackpressure;
+    bool mDebugInstrumentation;
 };
 
 // Metrics computed per-frame.  Duration and Latency metrics are in milliseconds.
@@ -121,7 +128,7 @@ struct FrameMetrics1 {
 // - information on previous presents needed for console output or to compute metrics for upcoming
 //   presents,
 // - pending presents whose metrics cannot be computed until future presents are received,
-// - exponential averages of key metrics displayed in console output.
+// - exponential averages and rolling histograms of key metrics displayed in console output.
 struct SwapChainData {
     // Pending presents waiting for the next displayed present.
     std::vector<std::shared_ptr<PresentEvent>> mPendingPresents;
@@ -147,6 +154,11 @@ struct SwapChainData {
     float mAvgGPUDuration = 0.f;
     float mAvgDisplayLatency = 0.f;
     float mAvgDisplayedTime = 0.f;
+
+    // Frame time and display latency (in milliseconds) over the --stats_window, keyed by
+    // PresentStartTime.  Only initialized if console statistics are displayed.
+    RollingHistogram mFrameTimeHistogram;
+    RollingHistogram mDisplayLatencyHistogram;
 };
 
 struct ProcessInfo {
@@ -171,6 +183,9 @@ void EndConsoleUpdate();
 void ConsolePrint(wchar_t const* format, ...);
 void ConsolePrintLn(wchar_t const* format, ...);
 void UpdateConsole(uint32_t processId, ProcessInfo const& processInfo);
+#if PRESENTMON_ENABLE_INSTRUMENTATION
+void UpdateInstrumentationConsole();
+#endif
 int PrintWarning(wchar_t const* format, ...);
 int PrintError(wchar_t const* format, ...);
 
@@ -179,6 +194,7 @@ void StartConsumerThread(TRACEHANDLE traceHandle);
 void WaitForConsumerThreadToExit();
 
 // CsvOutput.cpp:
+void InitializeCsvOutput();
 void IncrementRecordingCount();
 void CloseMultiCsv(ProcessInfo* processInfo);
 void CloseGlobalCsv();
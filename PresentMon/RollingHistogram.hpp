@@ -0,0 +1,142 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+
+// RollingHistogram counts the values added over a recent window of time in logarithmically-sized
+// buckets, so that percentiles of an unbounded stream of values can be estimated in fixed memory.
+//
+// Time is divided into slices of WindowDuration / SLICE_COUNT, and the histogram covers the
+// SLICE_COUNT most recent slices (including the one containing the latest value).  Adding a value
+// increments its bucket in the current slice and in the totals.  When a value is added in a
+// later slice, the slices that fell out of the window are subtracted from the totals and reused,
+// so each value is evicted once, along with the rest of its slice.
+//
+// Each bucket spans a factor of 2^(1 / BUCKETS_PER_OCTAVE), and percentiles are reported as the
+// geometric center of the bucket containing them, which is within 2^(1 / (2 * BUCKETS_PER_OCTAVE))
+// (about 4.4%) of the exact percentile.  Values outside of [2^MIN_EXPONENT, 2^MAX_EXPONENT) are
+// counted in the first or last bucket.
+struct RollingHistogram {
+    static constexpr uint32_t SLICE_COUNT        = 8;
+    static constexpr uint32_t BUCKETS_PER_OCTAVE = 8;
+    static constexpr int      MIN_EXPONENT       = -6;  // 1/64 ms
+    static constexpr int      MAX_EXPONENT       = 11;  // 2048 ms
+    static constexpr uint32_t BUCKET_COUNT       = (MAX_EXPONENT - MIN_EXPONENT) * BUCKETS_PER_OCTAVE;
+
+    // Bucket counts of each slice, followed by the totals over all slices.  Empty until
+    // Initialize() is called.
+    std::vector<uint32_t> mCounts;
+    uint32_t mSliceValueCount[SLICE_COUNT] = {};
+    uint32_t mValueCount = 0;
+    uint64_t mSliceDuration = 0;
+    uint64_t mCurrentSlice = 0;     // Index of the current slice since time 0
+
+    bool IsInitialized() const
+    {
+        return mSliceDuration != 0;
+    }
+
+    // windowDuration is in the same units as the times passed to Add().
+    void Initialize(uint64_t windowDuration)
+    {
+        mCounts.assign((SLICE_COUNT + 1) * BUCKET_COUNT, 0);
+        std::fill(mSliceValueCount, mSliceValueCount + SLICE_COUNT, 0);
+        mValueCount = 0;
+        mSliceDuration = std::max<uint64_t>(windowDuration / SLICE_COUNT, 1);
+        mCurrentSlice = 0;
+    }
+
+    static uint32_t GetBucket(double value)
+    {
+        if (!(value >= std::ldexp(1.0, MIN_EXPONENT))) {
+            return 0;
+        }
+        auto bucket = (std::log2(value) - MIN_EXPONENT) * BUCKETS_PER_OCTAVE;
+        return bucket >= BUCKET_COUNT ? BUCKET_COUNT - 1 : (uint32_t) bucket;
+    }
+
+    static double GetBucketCenter(uint32_t bucket)
+    {
+        return std::exp2(MIN_EXPONENT + (bucket + 0.5) / BUCKETS_PER_OCTAVE);
+    }
+
+    // Times are expected to be non-decreasing; a value added with an earlier time than the
+    // latest value is counted in the current slice.
+    void Add(uint64_t time, double value)
+    {
+        assert(IsInitialized());
+
+        Advance(time);
+
+        auto slice = (uint32_t) (mCurrentSlice % SLICE_COUNT);
+        auto bucket = GetBucket(value);
+        mCounts[slice * BUCKET_COUNT + bucket] += 1;
+        mCounts[SLICE_COUNT * BUCKET_COUNT + bucket] += 1;
+        mSliceValueCount[slice] += 1;
+        mValueCount += 1;
+    }
+
+    // Evicts the slices that are no longer in the window ending at time.
+    void Advance(uint64_t time)
+    {
+        auto slice = time / mSliceDuration;
+        if (slice <= mCurrentSlice) {
+            return;
+        }
+
+        auto evictCount = std::min<uint64_t>(slice - mCurrentSlice, SLICE_COUNT);
+        for (uint64_t i = 1; i <= evictCount; ++i) {
+            auto evict = (uint32_t) ((mCurrentSlice + i) % SLICE_COUNT);
+            if (mSliceValueCount[evict] == 0) {
+                continue;
+            }
+
+            auto sliceCounts = &mCounts[evict * BUCKET_COUNT];
+            auto totals = &mCounts[SLICE_COUNT * BUCKET_COUNT];
+            for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+                totals[bucket] -= sliceCounts[bucket];
+                sliceCounts[bucket] = 0;
+            }
+            mValueCount -= mSliceValueCount[evict];
+            mSliceValueCount[evict] = 0;
+        }
+
+        mCurrentSlice = slice;
+    }
+
+    // The earliest time whose values are still counted.
+    uint64_t GetWindowStart() const
+    {
+        return mCurrentSlice < SLICE_COUNT ? 0 : (mCurrentSlice - SLICE_COUNT + 1) * mSliceDuration;
+    }
+
+    // Returns the estimated value at the given percentile (0-100) by nearest rank, or 0 if the
+    // window is empty.
+    double GetPercentile(double percentile) const
+    {
+        if (mValueCount == 0) {
+            return 0.0;
+        }
+
+        auto rank = (uint32_t) std::ceil(percentile / 100.0 * mValueCount);
+        rank = std::min(std::max(rank, 1u), mValueCount);
+
+        auto totals = &mCounts[SLICE_COUNT * BUCKET_COUNT];
+        uint32_t count = 0;
+        for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            count += totals[bucket];
+            if (count >= rank) {
+                return GetBucketCenter(bucket);
+            }
+        }
+
+        assert(false);
+        return GetBucketCenter(BUCKET_COUNT - 1);
+    }
+};
@@ -0,0 +1,352 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "GoldCsvComparison.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ctype.h>
+#include <istream>
+#include <iterator>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace {
+
+std::string Trim(char const* begin, char const* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+    return std::string(begin, end);
+}
+
+bool EqualsIgnoreCase(std::string const& a, std::string const& b)
+{
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return tolower((unsigned char) x) == tolower((unsigned char) y); });
+}
+
+bool ParseNumber(std::string const& s, double* value)
+{
+    if (s.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    *value = strtod(s.c_str(), &end);
+    return end == s.c_str() + s.size();
+}
+
+size_t CountDecimalPlaces(std::string const& s)
+{
+    auto i = s.find('.');
+    return i == std::string::npos ? 0 : s.size() - i - 1;
+}
+
+bool ValuesMatch(std::string const& test, std::string const& gold, double const* tolerance)
+{
+    if (EqualsIgnoreCase(test, gold)) {
+        return true;
+    }
+
+    double testNumber = 0.0;
+    double goldNumber = 0.0;
+    if (!ParseNumber(test, &testNumber) || !ParseNumber(gold, &goldNumber)) {
+        return false;
+    }
+
+    auto difference = fabs(testNumber - goldNumber);
+    if (tolerance != nullptr) {
+        return difference <= *tolerance;
+    }
+
+    // Different versions of PresentMon may output different decimal precision.  Also,
+    // floating point may be inconsistently rounded by printf() on different platforms.
+    // Therefore, we do a rounding check by ensuring the difference between the two
+    // numbers is less than 1 in the final printed digit.
+    return difference < pow(0.1, (double) std::min(CountDecimalPlaces(test), CountDecimalPlaces(gold)));
+}
+
+struct ComparedColumn {
+    std::string const* name_;
+    size_t goldIndex_;
+    size_t testIndex_;
+    double const* tolerance_;
+};
+
+struct ProcessStream {
+    std::string processId_;
+    std::vector<size_t> goldRows_;
+    std::vector<size_t> testRows_;
+    std::vector<GoldDivergence> divergences_;
+};
+
+std::string const& GetField(CsvTable const& table, size_t row, size_t column)
+{
+    static std::string const missing("<missing>");
+    auto const& fields = table.rows_[row];
+    return column < fields.size() ? fields[column] : missing;
+}
+
+std::vector<size_t> GetContext(std::vector<size_t> const& rows, size_t position, uint32_t count)
+{
+    position = std::min(position, rows.size());
+    return std::vector<size_t>(rows.begin() + (position - std::min<size_t>(position, count)), rows.begin() + position);
+}
+
+void CompareStream(CsvTable const& gold, CsvTable const& test, std::vector<ComparedColumn> const& columns,
+                   GoldComparisonOptions const& options, ProcessStream* stream)
+{
+    auto const& goldRows = stream->goldRows_;
+    auto const& testRows = stream->testRows_;
+    for (size_t i = 0, n = std::max(goldRows.size(), testRows.size()); i < n; ++i) {
+        GoldDivergence d;
+        d.processId_ = stream->processId_;
+        d.goldRow_ = i < goldRows.size() ? goldRows[i] : SIZE_MAX;
+        d.testRow_ = i < testRows.size() ? testRows[i] : SIZE_MAX;
+
+        if (d.goldRow_ == SIZE_MAX || d.testRow_ == SIZE_MAX) {
+            d.kind_ = GoldDivergence::MissingRow;
+        } else {
+            d.kind_ = GoldDivergence::DifferentValues;
+            for (auto const& c : columns) {
+                auto const& goldValue = GetField(gold, d.goldRow_, c.goldIndex_);
+                auto const& testValue = GetField(test, d.testRow_, c.testIndex_);
+                if (!ValuesMatch(testValue, goldValue, c.tolerance_)) {
+                    d.columns_.push_back({ *c.name_, goldValue, testValue });
+                }
+            }
+            if (d.columns_.empty()) {
+                continue;
+            }
+        }
+
+        d.goldContext_ = GetContext(goldRows, i, options.contextRowCount_);
+        d.testContext_ = GetContext(testRows, i, options.contextRowCount_);
+        stream->divergences_.push_back(std::move(d));
+
+        // Once one CSV has run out of rows for the process, the rest are all missing.
+        if (!options.reportAllDiffs_ || stream->divergences_.back().kind_ == GoldDivergence::MissingRow) {
+            break;
+        }
+    }
+}
+
+void AppendRow(std::string* s, char const* label, CsvTable const& table, size_t row)
+{
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "    %s line %zu: ", label, table.lines_[row]);
+    *s += prefix;
+    auto const& fields = table.rows_[row];
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) *s += ',';
+        *s += fields[i];
+    }
+    *s += '\n';
+}
+
+}
+
+void CsvTable::Read(std::istream& stream)
+{
+    Parse(std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+}
+
+void CsvTable::Parse(std::string const& text)
+{
+    header_.clear();
+    rows_.clear();
+    lines_.clear();
+
+    auto p = text.c_str();
+    auto end = p + text.size();
+
+    // Remove UTF-8 marker if there is one.
+    if (text.compare(0, 3, "\xef\xbb\xbf") == 0) {
+        p += 3;
+    }
+
+    bool haveHeader = false;
+    for (size_t line = 1; p < end; ++line) {
+        auto lineEnd = (char const*) memchr(p, '\n', end - p);
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+
+        std::vector<std::string> fields;
+        for (auto fieldBegin = p; ; ) {
+            auto fieldEnd = std::find(fieldBegin, lineEnd, ',');
+            fields.emplace_back(Trim(fieldBegin, fieldEnd));
+            if (fieldEnd == lineEnd) break;
+            fieldBegin = fieldEnd + 1;
+        }
+        p = lineEnd + 1;
+
+        if (fields.size() == 1 && fields[0].empty()) {
+            continue;
+        }
+        if (haveHeader) {
+            rows_.emplace_back(std::move(fields));
+            lines_.push_back(line);
+        } else {
+            header_ = std::move(fields);
+            haveHeader = true;
+        }
+    }
+}
+
+size_t CsvTable::FindColumn(std::string const& name) const
+{
+    auto i = std::find(header_.begin(), header_.end(), name);
+    return i == header_.end() ? SIZE_MAX : (size_t) (i - header_.begin());
+}
+
+bool ParseColumnTolerance(char const* arg, GoldComparisonOptions* options)
+{
+    auto equals = strchr(arg, '=');
+    if (equals == nullptr || equals == arg) {
+        return false;
+    }
+
+    double tolerance = 0.0;
+    if (!ParseNumber(equals + 1, &tolerance) || !(tolerance >= 0.0)) {
+        return false;
+    }
+
+    options->columnTolerances_[std::string(arg, equals)] = tolerance;
+    return true;
+}
+
+std::vector<GoldDivergence> CompareGoldCsv(CsvTable const& gold, CsvTable const& test, GoldComparisonOptions const& options)
+{
+    // Compare the columns present in both CSVs.
+    std::vector<ComparedColumn> columns;
+    for (size_t i = 0; i < gold.header_.size(); ++i) {
+        auto testIndex = test.FindColumn(gold.header_[i]);
+        if (testIndex != SIZE_MAX) {
+            auto tolerance = options.columnTolerances_.find(gold.header_[i]);
+            columns.push_back({ &gold.header_[i], i, testIndex,
+                                tolerance == options.columnTolerances_.end() ? nullptr : &tolerance->second });
+        }
+    }
+
+    // Split the rows into a stream per process, in order of first appearance.
+    std::vector<ProcessStream> streams;
+    std::unordered_map<std::string, size_t> streamIndex;
+    auto goldPid = gold.FindColumn("ProcessID");
+    auto testPid = test.FindColumn("ProcessID");
+    auto perProcess = goldPid != SIZE_MAX && testPid != SIZE_MAX;
+    auto getStream = [&](std::string const& processId) {
+        auto ii = streamIndex.emplace(processId, streams.size());
+        if (ii.second) {
+            streams.emplace_back();
+            streams.back().processId_ = processId;
+        }
+        return &streams[ii.first->second];
+    };
+    for (size_t i = 0; i < gold.rows_.size(); ++i) {
+        getStream(perProcess ? GetField(gold, i, goldPid) : std::string())->goldRows_.push_back(i);
+    }
+    for (size_t i = 0; i < test.rows_.size(); ++i) {
+        getStream(perProcess ? GetField(test, i, testPid) : std::string())->testRows_.push_back(i);
+    }
+
+    // Compare the streams in parallel.
+    auto threadCount = options.threadCount_ != 0 ? options.threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (uint32_t) std::min<size_t>(threadCount, streams.size());
+    std::atomic<size_t> nextStream(0);
+    auto compareStreams = [&]() {
+        for (size_t i; (i = nextStream++) < streams.size(); ) {
+            CompareStream(gold, test, columns, options, &streams[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(compareStreams);
+    }
+    compareStreams();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::vector<GoldDivergence> divergences;
+
+    // The per-process comparison doesn't see the processes' rows being
+    // interleaved differently, so check that separately.
+    if (perProcess) {
+        for (size_t i = 0, n = std::min(gold.rows_.size(), test.rows_.size()); i < n; ++i) {
+            if (GetField(gold, i, goldPid) != GetField(test, i, testPid)) {
+                std::vector<size_t> context;
+                for (size_t j = i - std::min<size_t>(i, options.contextRowCount_); j < i; ++j) {
+                    context.push_back(j);
+                }
+
+                GoldDivergence d;
+                d.kind_ = GoldDivergence::DifferentProcess;
+                d.processId_ = GetField(gold, i, goldPid);
+                d.goldRow_ = i;
+                d.testRow_ = i;
+                d.columns_.push_back({ "ProcessID", GetField(gold, i, goldPid), GetField(test, i, testPid) });
+                d.goldContext_ = context;
+                d.testContext_ = context;
+                divergences.push_back(std::move(d));
+                break;
+            }
+        }
+    }
+
+    for (auto& stream : streams) {
+        std::move(stream.divergences_.begin(), stream.divergences_.end(), std::back_inserter(divergences));
+    }
+
+    std::stable_sort(divergences.begin(), divergences.end(), [](GoldDivergence const& a, GoldDivergence const& b) {
+        return (a.goldRow_ != SIZE_MAX ? a.goldRow_ : a.testRow_) <
+               (b.goldRow_ != SIZE_MAX ? b.goldRow_ : b.testRow_);
+    });
+
+    return divergences;
+}
+
+std::string FormatDivergence(CsvTable const& gold, CsvTable const& test, GoldDivergence const& d)
+{
+    char buffer[256];
+    switch (d.kind_) {
+    case GoldDivergence::DifferentValues:
+        snprintf(buffer, sizeof(buffer), "ProcessID %s: values differ on GOLD line %zu, TEST line %zu\n",
+                 d.processId_.c_str(), gold.lines_[d.goldRow_], test.lines_[d.testRow_]);
+        break;
+    case GoldDivergence::MissingRow:
+        if (d.testRow_ == SIZE_MAX) {
+            snprintf(buffer, sizeof(buffer), "ProcessID %s: TEST is missing rows from GOLD line %zu\n",
+                     d.processId_.c_str(), gold.lines_[d.goldRow_]);
+        } else {
+            snprintf(buffer, sizeof(buffer), "ProcessID %s: TEST has extra rows from TEST line %zu\n",
+                     d.processId_.c_str(), test.lines_[d.testRow_]);
+        }
+        break;
+    case GoldDivergence::DifferentProcess:
+        snprintf(buffer, sizeof(buffer), "Rows are ordered differently from GOLD line %zu, TEST line %zu\n",
+                 gold.lines_[d.goldRow_], test.lines_[d.testRow_]);
+        break;
+    }
+
+    std::string s(buffer);
+    for (size_t i = 0; i < std::max(d.goldContext_.size(), d.testContext_.size()); ++i) {
+        if (i < d.goldContext_.size()) AppendRow(&s, "GOLD", gold, d.goldContext_[i]);
+        if (i < d.testContext_.size()) AppendRow(&s, "TEST", test, d.testContext_[i]);
+    }
+    if (d.goldRow_ != SIZE_MAX) AppendRow(&s, "GOLD", gold, d.goldRow_);
+    if (d.testRow_ != SIZE_MAX) AppendRow(&s, "TEST", test, d.testRow_);
+
+    if (!d.columns_.empty()) {
+        s += "    COLUMN                    TEST VALUE                            GOLD VALUE\n";
+        for (auto const& c : d.columns_) {
+            snprintf(buffer, sizeof(buffer), "    %-25s %-37s %s\n", c.name_.c_str(), c.test_.c_str(), c.gold_.c_str());
+            s += buffer;
+        }
+    }
+
+    return s;
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// Comparison of a PresentMon CSV against a gold CSV.  This only depends on the
+// standard library, so that recorded CSVs can be compared on any platform.
+
+#include <iosfwd>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CsvTable {
+    std::vector<std::string> header_;
+    std::vector<std::vector<std::string>> rows_;
+    std::vector<size_t> lines_;     // lines_[i] is the file line number of rows_[i]
+
+    // Reads the whole stream, replacing any previous contents.  Fields are
+    // trimmed of whitespace, and blank lines are skipped.
+    void Read(std::istream& stream);
+    void Parse(std::string const& text);
+
+    // Returns the index of the named column, or SIZE_MAX if it isn't present.
+    size_t FindColumn(std::string const& name) const;
+};
+
+struct GoldComparisonOptions {
+    // Absolute tolerance of numeric columns, by column name.  Numeric columns
+    // without a tolerance match if they differ by less than one in the last
+    // digit printed by the less precise of the two CSVs.
+    std::unordered_map<std::string, double> columnTolerances_;
+
+    uint32_t contextRowCount_ = 2;  // Preceding rows of the process to report
+    uint32_t threadCount_ = 0;      // 0 = one per processor
+    bool reportAllDiffs_ = false;   // Report every differing row, not just the first per process
+};
+
+// Parses a "column=tolerance" argument into options->columnTolerances_.
+bool ParseColumnTolerance(char const* arg, GoldComparisonOptions* options);
+
+struct GoldDivergence {
+    enum Kind {
+        DifferentValues,    // goldRow_ and testRow_ have different values in columns_
+        MissingRow,         // The process has fewer rows in TEST (testRow_ == SIZE_MAX) or GOLD (goldRow_ == SIZE_MAX)
+        DifferentProcess,   // The row at this position belongs to a different process
+    };
+
+    struct Column {
+        std::string name_;
+        std::string gold_;
+        std::string test_;
+    };
+
+    Kind kind_;
+    std::string processId_;
+    size_t goldRow_;                    // Row indices into the tables, or SIZE_MAX
+    size_t testRow_;
+    std::vector<Column> columns_;
+    std::vector<size_t> goldContext_;   // The process's rows preceding goldRow_/testRow_
+    std::vector<size_t> testContext_;
+};
+
+// Rows are split into a stream per ProcessID, and the streams are compared in
+// parallel.  Divergences are returned in the order of their gold rows.
+std::vector<GoldDivergence> CompareGoldCsv(CsvTable const& gold, CsvTable const& test, GoldComparisonOptions const& options);
+
+// Describes the divergence, the columns that differ, and its context rows.
+std::string FormatDivergence(CsvTable const& gold, CsvTable const& test, GoldDivergence const& divergence);
@@ -0,0 +1,188 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "GoldCsvComparison.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+char const* const GOLD_CSV =
+    "\xef\xbb\xbf" "Application,ProcessID,FrameTime,PresentMode\r\n"
+    "a.exe,10,16.6667,Hardware: Independent Flip\r\n"
+    "b.exe,20,33.3333,Composed: Flip\r\n"
+    "a.exe,10,16.6000,Hardware: Independent Flip\r\n"
+    "\r\n"
+    "b.exe,20,33.3000,Composed: Flip\r\n"
+    "a.exe,10,16.7000,Hardware: Independent Flip\r\n";
+
+std::vector<GoldDivergence> Compare(char const* test, GoldComparisonOptions const& options = GoldComparisonOptions())
+{
+    CsvTable goldTable;
+    CsvTable testTable;
+    goldTable.Parse(GOLD_CSV);
+    testTable.Parse(test);
+    return CompareGoldCsv(goldTable, testTable, options);
+}
+
+}
+
+TEST(GoldCsvComparison, Parse)
+{
+    CsvTable t;
+    t.Parse(GOLD_CSV);
+    ASSERT_EQ(t.header_.size(), 4u);
+    EXPECT_EQ(t.header_[0], "Application");
+    EXPECT_EQ(t.FindColumn("FrameTime"), 2u);
+    EXPECT_EQ(t.FindColumn("Missing"), SIZE_MAX);
+    ASSERT_EQ(t.rows_.size(), 5u);
+    EXPECT_EQ(t.rows_[0][3], "Hardware: Independent Flip");
+    EXPECT_EQ(t.lines_[2], 4u);
+    EXPECT_EQ(t.lines_[3], 6u);  // blank line skipped
+}
+
+TEST(GoldCsvComparison, Identical)
+{
+    EXPECT_TRUE(Compare(GOLD_CSV).empty());
+}
+
+TEST(GoldCsvComparison, PrintPrecision)
+{
+    // Fewer decimals and different column order/whitespace still match
+    EXPECT_TRUE(Compare(
+        "ProcessID, Application, PresentMode, FrameTime\n"
+        "10,A.EXE,Hardware: Independent Flip,16.667\n"
+        "20,b.exe,Composed: Flip,33.333\n"
+        "10,a.exe,Hardware: Independent Flip,16.6\n"
+        "20,b.exe,Composed: Flip,33.3\n"
+        "10,a.exe,Hardware: Independent Flip,16.7\n").empty());
+
+    auto d = Compare(
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Flip\n"
+        "a.exe,10,16.6002,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n"
+        "a.exe,10,16.7000,Hardware: Independent Flip\n");
+    ASSERT_EQ(d.size(), 1u);
+    EXPECT_EQ(d[0].kind_, GoldDivergence::DifferentValues);
+    EXPECT_EQ(d[0].processId_, "10");
+    EXPECT_EQ(d[0].goldRow_, 2u);
+    ASSERT_EQ(d[0].columns_.size(), 1u);
+    EXPECT_EQ(d[0].columns_[0].name_, "FrameTime");
+    EXPECT_EQ(d[0].columns_[0].gold_, "16.6000");
+    EXPECT_EQ(d[0].columns_[0].test_, "16.6002");
+}
+
+TEST(GoldCsvComparison, ColumnTolerance)
+{
+    GoldComparisonOptions options;
+    EXPECT_FALSE(ParseColumnTolerance("FrameTime", &options));
+    EXPECT_FALSE(ParseColumnTolerance("=0.1", &options));
+    EXPECT_FALSE(ParseColumnTolerance("FrameTime=-1", &options));
+    EXPECT_FALSE(ParseColumnTolerance("FrameTime=1x", &options));
+    EXPECT_TRUE(options.columnTolerances_.empty());
+    EXPECT_TRUE(ParseColumnTolerance("FrameTime=0.01", &options));
+    EXPECT_EQ(options.columnTolerances_["FrameTime"], 0.01);
+
+    char const* test =
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6717,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Flip\n"
+        "a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n"
+        "a.exe,10,16.7000,Hardware: Independent Flip\n";
+    EXPECT_EQ(Compare(test).size(), 1u);
+    EXPECT_TRUE(Compare(test, options).empty());
+}
+
+TEST(GoldCsvComparison, FirstDivergencePerProcess)
+{
+    char const* test =
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Copy with GPU GDI\n"
+        "a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Copy with GPU GDI\n"
+        "a.exe,10,17.7000,Hardware: Independent Flip\n";
+
+    auto d = Compare(test);
+    ASSERT_EQ(d.size(), 2u);
+    EXPECT_EQ(d[0].processId_, "20");
+    EXPECT_EQ(d[0].goldRow_, 1u);
+    EXPECT_EQ(d[1].processId_, "10");
+    EXPECT_EQ(d[1].goldRow_, 4u);
+    EXPECT_EQ(d[1].goldContext_, (std::vector<size_t>{ 0, 2 }));
+
+    GoldComparisonOptions options;
+    options.reportAllDiffs_ = true;
+    options.contextRowCount_ = 1;
+    options.threadCount_ = 1;
+    d = Compare(test, options);
+    ASSERT_EQ(d.size(), 3u);
+    EXPECT_EQ(d[1].goldRow_, 3u);
+    EXPECT_EQ(d[1].testContext_, (std::vector<size_t>{ 1 }));
+}
+
+TEST(GoldCsvComparison, MissingRows)
+{
+    auto d = Compare(
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Flip\n"
+        "a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n");
+    ASSERT_EQ(d.size(), 3u);
+    EXPECT_EQ(d[0].kind_, GoldDivergence::DifferentProcess);
+    EXPECT_EQ(d[0].goldRow_, 4u);
+    EXPECT_EQ(d[1].kind_, GoldDivergence::MissingRow);
+    EXPECT_EQ(d[1].processId_, "10");
+    EXPECT_EQ(d[1].goldRow_, 4u);
+    EXPECT_EQ(d[1].testRow_, SIZE_MAX);
+    EXPECT_EQ(d[2].kind_, GoldDivergence::MissingRow);
+    EXPECT_EQ(d[2].processId_, "20");
+    EXPECT_EQ(d[2].goldRow_, SIZE_MAX);
+    EXPECT_EQ(d[2].testRow_, 4u);
+
+    // Extra rows for a process that isn't in gold
+    d = Compare(
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Flip\n"
+        "a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n"
+        "a.exe,10,16.7000,Hardware: Independent Flip\n"
+        "c.exe,30,8.0000,Composed: Flip\n");
+    ASSERT_EQ(d.size(), 1u);
+    EXPECT_EQ(d[0].kind_, GoldDivergence::MissingRow);
+    EXPECT_EQ(d[0].processId_, "30");
+    EXPECT_EQ(d[0].goldRow_, SIZE_MAX);
+    EXPECT_EQ(d[0].testRow_, 5u);
+}
+
+TEST(GoldCsvComparison, Format)
+{
+    CsvTable gold;
+    CsvTable test;
+    gold.Parse(GOLD_CSV);
+    test.Parse(
+        "Application,ProcessID,FrameTime,PresentMode\n"
+        "a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "b.exe,20,33.3333,Composed: Flip\n"
+        "a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "b.exe,20,33.3000,Composed: Flip\n"
+        "a.exe,10,16.8000,Hardware: Independent Flip\n");
+    auto d = CompareGoldCsv(gold, test, GoldComparisonOptions());
+    ASSERT_EQ(d.size(), 1u);
+    EXPECT_EQ(FormatDivergence(gold, test, d[0]),
+        "ProcessID 10: values differ on GOLD line 7, TEST line 6\n"
+        "    GOLD line 2: a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "    TEST line 2: a.exe,10,16.6667,Hardware: Independent Flip\n"
+        "    GOLD line 4: a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "    TEST line 4: a.exe,10,16.6000,Hardware: Independent Flip\n"
+        "    GOLD line 7: a.exe,10,16.7000,Hardware: Independent Flip\n"
+        "    TEST line 6: a.exe,10,16.8000,Hardware: Independent Flip\n"
+        "    COLUMN                    TEST VALUE                            GOLD VALUE\n"
+        "    FrameTime                 16.8000                               16.7000\n");
+}
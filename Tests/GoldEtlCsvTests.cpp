@@ -3,6 +3,11 @@
 
 #include "PresentMonTests.h"
 
+#include <fstream>
+#include <gtest/gtest-spi.h>
+#include <memory>
+#include <thread>
+
 namespace {
 
 struct TestArgs {
@@ -11,118 +16,146 @@ struct TestArgs {
     std::wstring testCsv_;
 };
 
+// PresentMon runs for every registered test, in registration order.  Each
+// test also starts the runs of the tests that follow it (up to jobCount_ at
+// once), so that PresentMon is analyzing the next ETLs while the current
+// test waits for and compares its own output.
+struct GoldRun {
+    TestArgs args_;
+    ::testing::TestInfo const* testInfo_;
+    std::unique_ptr<PresentMon> pm_;
+};
+
+std::vector<GoldRun> goldRuns_;
+size_t startedRunCount_ = 0;    // runs with a pm_ that hasn't been waited on yet
+
+// Start PresentMon, querying the gold CSV to try and match the expected data.
+// Returns nullptr on failure.
+std::unique_ptr<PresentMon> StartPresentMon(TestArgs const& args)
+{
+    PresentMonCsv goldCsv;
+    if (!goldCsv.CSVOPEN(args.goldCsv_)) {
+        return nullptr;
+    }
+    goldCsv.Close();
+
+    // Make sure output directory exists.
+    auto i = args.testCsv_.find_last_of(L"/\\");
+    if (i == std::wstring::npos || !EnsureDirectoryCreated(args.testCsv_.substr(0, i))) {
+        AddTestFailure(__FILE__, __LINE__, "Output directory does not exist!");
+        return nullptr;
+    }
+
+    std::unique_ptr<PresentMon> pm(new PresentMon);
+    pm->Add(L"--stop_existing_session");
+    pm->AddEtlPath(args.etl_);
+    pm->AddCsvPath(args.testCsv_);
+    for (auto param : goldCsv.params_) {
+        pm->Add(param);
+    }
+    pm->PMSTART();
+    if (pm->hProcess == nullptr) {
+        return nullptr;
+    }
+    return pm;
+}
+
+// Start the run for goldRuns_[index], and the runs of any following tests that
+// will run.  Failures starting the following runs are ignored here; those runs
+// are left for their own test to start again and report.
+void StartRuns(size_t index)
+{
+    auto& run = goldRuns_[index];
+    if (run.pm_ == nullptr) {
+        run.pm_ = StartPresentMon(run.args_);
+        if (run.pm_ == nullptr) {
+            return;
+        }
+        startedRunCount_ += 1;
+    }
+
+    auto jobCount = jobCount_ != 0 ? jobCount_ : std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = index + 1, n = goldRuns_.size(); i < n && startedRunCount_ < jobCount; ++i) {
+        auto& next = goldRuns_[i];
+        if (next.pm_ == nullptr && next.testInfo_->should_run()) {
+            ::testing::TestPartResultArray failures;
+            ::testing::ScopedFakeTestPartResultReporter reporter(
+                ::testing::ScopedFakeTestPartResultReporter::INTERCEPT_ONLY_CURRENT_THREAD, &failures);
+            next.pm_ = StartPresentMon(next.args_);
+            if (next.pm_ != nullptr) {
+                startedRunCount_ += 1;
+            }
+        }
+    }
+}
+
 class Tests : public ::testing::Test, TestArgs {
+    size_t runIndex_;
+
 public:
-    explicit Tests(TestArgs const& args)
+    Tests(TestArgs const& args, size_t runIndex)
+        : runIndex_(runIndex)
     {
         TestArgs::operator=(args);
     }
 
     void TestBody() override
     {
-        // Open the gold CSV
-        PresentMonCsv goldCsv;
-        if (!goldCsv.CSVOPEN(goldCsv_)) {
-            return;
+        // Kept until the end of the test, so its command line is printed
+        // with any failures.
+        std::unique_ptr<PresentMon> pm;
+        if (recordedDir_.empty()) {
+            StartRuns(runIndex_);
+            pm = std::move(goldRuns_[runIndex_].pm_);
+            if (pm == nullptr) {
+                return;
+            }
+            startedRunCount_ -= 1;
+            pm->PMEXITED();
         }
 
-        // Make sure output directory exists.
-        for (auto i = testCsv_.find_last_of(L"/\\"); i == std::wstring::npos || !EnsureDirectoryCreated(testCsv_.substr(0, i)); ) {
-            AddTestFailure(__FILE__, __LINE__, "Output directory does not exist!");
-            goldCsv.Close();
+        // Check each row of the gold and test CSVs is self-consistent, and
+        // that the test CSV has the expected columns.
+        PresentMonCsv goldCsv;
+        if (!goldCsv.CSVOPEN(goldCsv_)) {
             return;
         }
-
-        // Generate command line, querying gold CSV to try and match expected
-        // data.
-        PresentMon pm;
-        pm.Add(L"--stop_existing_session");
-        pm.AddEtlPath(etl_);
-        pm.AddCsvPath(testCsv_);
-        for (auto param : goldCsv.params_) {
-            pm.Add(param);
+        while (goldCsv.ReadRow()) {
         }
-        pm.PMSTART();
-        pm.PMEXITED();
+        goldCsv.Close();
 
-        // Open test CSV file and check it has the same columns as gold
         PresentMonCsv testCsv;
         if (!testCsv.CSVOPEN(testCsv_)) {
-            goldCsv.Close();
             return;
         }
+        while (testCsv.ReadRow()) {
+        }
+        testCsv.Close();
 
         // Compare gold/test CSV data rows
-        for (;;) {
-            auto goldDone = !goldCsv.ReadRow();
-            auto testDone = !testCsv.ReadRow();
-            if (goldDone || testDone) {
-                if (!goldDone || !testDone) {
-                    AddTestFailure(__FILE__, __LINE__, "GOLD and TEST CSV had different number of rows");
-                    printf("GOLD = %ls\n", goldCsv_.c_str());
-                    printf("TEST = %ls\n", testCsv_.c_str());
-                }
-                break;
-            }
+        CsvTable gold;
+        CsvTable test;
+        {
+            std::ifstream goldStream(goldCsv_, std::ios::binary);
+            std::ifstream testStream(testCsv_, std::ios::binary);
+            gold.Read(goldStream);
+            test.Read(testStream);
+        }
 
-            auto rowOk = true;
-            for (size_t h = 0; h < PresentMonCsv::KnownHeaderCount; ++h) {
-                if (testCsv.headerColumnIndex_[h] != SIZE_MAX && goldCsv.headerColumnIndex_[h] != SIZE_MAX) {
-                    // Need to protect against missing columns on each line as
-                    // the file may be corrupted.
-                    auto testColIdx = testCsv.headerColumnIndex_[h];
-                    auto goldColIdx = goldCsv.headerColumnIndex_[h];
-                    char const* a = testColIdx < testCsv.cols_.size() ? testCsv.cols_[testColIdx] : "<missing>";
-                    char const* b = goldColIdx < goldCsv.cols_.size() ? goldCsv.cols_[goldColIdx] : "<missing>";
-                    if (_stricmp(a, b) == 0) {
-                        continue;
-                    }
-
-                    // Different versions of PresentMon may output different decimal precision.  Also, 
-                    // floating point may be inconsistently rounded by printf() on different platforms.
-                    // Therefore, we do a rounding check by ensuring the difference between the two
-                    // numbers is less than 1 in the final printed digit.
-
-                    double testNumber = 0.0;
-                    double goldNumber = 0.0;
-                    int testSucceededCount = sscanf_s(a, "%lf", &testNumber);
-                    int goldSucceededCount = sscanf_s(b, "%lf", &goldNumber);
-                    if (testSucceededCount == 1 && goldSucceededCount == 1) {
-                        const char* testDecimalAddr = strchr(a, '.');
-                        const char* goldDecimalAddr = strchr(b, '.');
-                        size_t testDecimalNumbersCount = testDecimalAddr == nullptr ? 0 : ((a + strlen(a)) - testDecimalAddr - 1);
-                        size_t goldDecimalNumbersCount = goldDecimalAddr == nullptr ? 0 : ((b + strlen(b)) - goldDecimalAddr - 1);
-                        double threshold = pow(0.1, std::min(testDecimalNumbersCount, goldDecimalNumbersCount));
-                        double difference = testNumber - goldNumber;
-
-                        if (difference > -threshold && difference < threshold) {
-                            continue;
-                        }
-                    }
-
-                    if (rowOk) {
-                        rowOk = false;
-                        printf("GOLD = %ls\n", goldCsv_.c_str());
-                        printf("TEST = %ls\n", testCsv_.c_str());
-                        AddTestFailure(__FILE__, __LINE__, "Difference on line: %zu", testCsv.line_);
-                        printf("    COLUMN                    TEST VALUE                            GOLD VALUE\n");
-                    }
-
-                    auto r = printf("    %s", testCsv.GetHeaderString((PresentMonCsv::Header) h));
-                    printf("%*s", r < 29 ? 29 - r : 0, "");
-                    r = printf(" %s", a);
-                    printf("%*s", r < 38 ? 38 - r : 0, "");
-                    printf(" %s\n", b);
-                }
-            }
-            if (!reportAllCsvDiffs_ && !rowOk) {
-                break;
+        auto divergences = CompareGoldCsv(gold, test, goldComparisonOptions_);
+        if (!divergences.empty()) {
+            printf("GOLD = %ls\n", goldCsv_.c_str());
+            printf("TEST = %ls\n", testCsv_.c_str());
+        }
+        for (auto const& d : divergences) {
+            switch (d.kind_) {
+            case GoldDivergence::DifferentValues:  AddTestFailure(__FILE__, __LINE__, "Difference on line: %zu", test.lines_[d.testRow_]); break;
+            case GoldDivergence::MissingRow:       AddTestFailure(__FILE__, __LINE__, "GOLD and TEST CSV had different number of rows for ProcessID %s", d.processId_.c_str()); break;
+            case GoldDivergence::DifferentProcess: AddTestFailure(__FILE__, __LINE__, "GOLD and TEST CSV rows are in a different order"); break;
             }
+            printf("%s", FormatDivergence(gold, test, d).c_str());
         }
 
-        goldCsv.Close();
-        testCsv.Close();
-
         if (::testing::Test::HasFailure() && !diffPath_.empty()) {
             std::wstring cmd;
             cmd += diffPath_;
@@ -183,7 +216,7 @@ void AddGoldEtlCsvTests(
                             TestArgs args;
                             args.etl_     = etl;
                             args.goldCsv_ = dir + fileName;
-                            args.testCsv_ = outDir_ + fileName;
+                            args.testCsv_ = (recordedDir_.empty() ? outDir_ : recordedDir_) + fileName;
 
                             // Replace any '-' characters in the name, as they will screw up googletest
                             // filters.
@@ -194,9 +227,12 @@ void AddGoldEtlCsvTests(
                                 }
                             }
 
-                            ::testing::RegisterTest(
+                            auto runIndex = goldRuns_.size();
+                            goldRuns_.emplace_back();
+                            goldRuns_[runIndex].args_ = args;
+                            goldRuns_[runIndex].testInfo_ = ::testing::RegisterTest(
                                 "GoldEtlCsvTests", name.c_str(), nullptr, nullptr, __FILE__, __LINE__,
-                                [=]() -> ::testing::Test* { return new Tests(std::move(args)); });
+                                [=]() -> ::testing::Test* { return new Tests(args, runIndex); });
 
                             csvCount += 1;
                         }
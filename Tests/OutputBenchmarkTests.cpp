@@ -0,0 +1,171 @@
+// Copyright (C) 2017-2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMonTests.h"
+
+#include <algorithm>
+#include <float.h>
+
+namespace {
+
+// Each set of options selects a different instantiation of PresentMon's
+// per-present metric and CSV row kernels.
+struct BenchmarkOptions {
+    char const* name_;
+    wchar_t const* args_;
+};
+
+BenchmarkOptions const kBenchmarkOptions[] = {
+    { "cpu_only",    L"--no_track_display --no_track_gpu --no_track_input" },
+    { "default",     L"" },
+    { "all",         L"--track_gpu_video --track_frame_type" },
+    { "v1_cpu_only", L"--v1_metrics --no_track_display --no_track_gpu --no_track_input" },
+    { "v1_default",  L"--v1_metrics" },
+};
+
+uint32_t const kBenchmarkRepeatCount = 5;
+
+double FileTimeToMilliSeconds(FILETIME const& ft)
+{
+    return 0.0001 * (double) ((uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime);
+}
+
+// Replays an ETL through PresentMon with each of kBenchmarkOptions, and then
+// capturing a single process by name, with and without CSV output.  Reports
+// the least CPU time PresentMon used over kBenchmarkRepeatCount runs.  Wall
+// time isn't used since it is dominated by the output thread's polling
+// interval.
+class Benchmark : public ::testing::Test {
+    std::wstring etl_;
+    std::wstring csv_;
+
+public:
+    Benchmark(std::wstring const& etl, std::wstring const& csv)
+        : etl_(etl)
+        , csv_(csv)
+    {
+    }
+
+    double Run(wchar_t const* args, bool writeCsv)
+    {
+        PresentMon pm;
+        pm.Add(L"--stop_existing_session");
+        pm.AddEtlPath(etl_);
+        if (writeCsv) {
+            pm.AddCsvPath(csv_);
+        }
+        pm.Add(args);
+        pm.PMSTART();
+        if (::testing::Test::HasFailure()) {
+            return 0.0;
+        }
+
+        WaitForSingleObject(pm.hProcess, INFINITE);
+
+        FILETIME creationTime = {};
+        FILETIME exitTime = {};
+        FILETIME kernelTime = {};
+        FILETIME userTime = {};
+        GetProcessTimes(pm.hProcess, &creationTime, &exitTime, &kernelTime, &userTime);
+
+        pm.PMEXITED(0);
+
+        return FileTimeToMilliSeconds(kernelTime) + FileTimeToMilliSeconds(userTime);
+    }
+
+    bool Report(char const* name, wchar_t const* args)
+    {
+        double cpuMs[2] = { DBL_MAX, DBL_MAX };
+        for (uint32_t i = 0; i < kBenchmarkRepeatCount; ++i) {
+            for (int writeCsv = 0; writeCsv < 2; ++writeCsv) {
+                cpuMs[writeCsv] = std::min(cpuMs[writeCsv], Run(args, writeCsv == 1));
+                if (::testing::Test::HasFailure()) {
+                    return false;
+                }
+            }
+        }
+        printf("    %-12s %14.1lf %14.1lf\n", name, cpuMs[0], cpuMs[1]);
+        return true;
+    }
+
+    // Returns the application with the fewest presents in the CSV written by
+    // the last Run(), or an empty string if the CSV has no presents.
+    std::wstring FindLeastPresentingApplication()
+    {
+        PresentMonCsv csv;
+        if (!csv.CSVOPEN(csv_)) {
+            return std::wstring();
+        }
+
+        std::unordered_map<std::string, size_t> presentCounts;
+        auto idxApplication = csv.GetColumnIndex("Application");
+        while (idxApplication != SIZE_MAX && csv.ReadRow()) {
+            presentCounts[csv.cols_[idxApplication]] += 1;
+        }
+        csv.Close();
+
+        auto ii = std::min_element(presentCounts.begin(), presentCounts.end(),
+                                   [](auto const& a, auto const& b) { return a.second < b.second; });
+        return ii == presentCounts.end() ? std::wstring() : Convert(ii->first);
+    }
+
+    void TestBody() override
+    {
+        printf("    %-12s %14s %14s\n", "options", "no_csv CPU ms", "csv CPU ms");
+        for (auto const& options : kBenchmarkOptions) {
+            if (!Report(options.name_, options.args_)) {
+                return;
+            }
+        }
+
+        // Capture only the process with the fewest presents, so that the
+        // presents of all other processes are filtered out by name.
+        auto application = FindLeastPresentingApplication();
+        if (!application.empty()) {
+            printf("    one_process: %ls\n", application.c_str());
+            Report("one_process", (L"--process_name \"" + application + L"\"").c_str());
+        }
+    }
+};
+
+}
+
+void AddOutputBenchmarkTests(
+    std::wstring const& dir)
+{
+    WIN32_FIND_DATA ff = {};
+    auto h = FindFirstFile((dir + L'*').c_str(), &ff);
+    if (h == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do
+    {
+        if (ff.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if (wcscmp(ff.cFileName, L".") == 0) continue;
+            if (wcscmp(ff.cFileName, L"..") == 0) continue;
+            AddOutputBenchmarkTests(dir + ff.cFileName + L'\\');
+        } else {
+            auto len = wcslen(ff.cFileName);
+            if (len >= 4 && _wcsicmp(ff.cFileName + len - 4, L".etl") == 0) {
+                std::wstring fileName(ff.cFileName, len - 4);
+                std::wstring etl(dir + ff.cFileName);
+                std::wstring csv(outDir_ + L"benchmark_" + fileName + L".csv");
+
+                // Replace any '-' characters in the name, as they will screw up googletest
+                // filters.
+                std::string name(Convert(fileName));
+                for (auto& ch : name) {
+                    if (ch == '-') {
+                        ch = '_';
+                    }
+                }
+
+                ::testing::RegisterTest(
+                    "OutputBenchmarks", name.c_str(), nullptr, nullptr, __FILE__, __LINE__,
+                    [=]() -> ::testing::Test* { return new Benchmark(etl, csv); });
+            }
+        }
+    } while (FindNextFile(h, &ff) != 0);
+
+    FindClose(h);
+}
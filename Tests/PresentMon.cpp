@@ -297,7 +297,8 @@ size_t PresentMonCsv::GetColumnIndex(char const* header) const
 }
 
 PresentMon::PresentMon()
-    : cmdline_()
+    : PROCESS_INFORMATION()
+    , cmdline_()
     , csvArgSet_(false)
 {
     cmdline_ += L'\"';
@@ -111,9 +111,11 @@ bool CheckPath(
 
 std::wstring PresentMon::exePath_;
 std::wstring outDir_;
-bool reportAllCsvDiffs_ = false;
 bool warnOnMissingCsv_ = true;
 std::wstring diffPath_;
+std::wstring recordedDir_;
+uint32_t jobCount_ = 0;
+GoldComparisonOptions goldComparisonOptions_;
 
 std::string Convert(std::wstring const& src)
 {
@@ -201,8 +203,17 @@ int wmain(
                 "    --outdir=path        Path to directory for test outputs (default=%%temp%%/PresentMonTestOutput).\n"
                 "    --nodelete           Keep the output directory after tests.\n"
                 "    --nowarnmissing      Don't warn if a found ETL is missing a gold CSV.\n"
-                "    --allcsvdiffs        Report all CSV differences, not just the first.\n"
+                "    --allcsvdiffs        Report all CSV differences, not just the first per process.\n"
+                "    --diffcontext=N      Number of preceding rows to report with a CSV difference (default=2).\n"
+                "    --tolerance=col=val  Allow numeric values in CSV column 'col' to differ from gold\n"
+                "                         by up to 'val'.  Can be specified multiple times.\n"
+                "    --jobs=N             Number of PresentMon processes to run at once (default=one\n"
+                "                         per processor).\n"
+                "    --recorded=path      Compare gold CSVs against previously-recorded CSVs with the\n"
+                "                         same names in path, instead of running PresentMon.\n"
                 "    --diff=path          Start an extra process to compare each differing CSV.\n"
+                "    --benchmark          Also report PresentMon's CPU time analyzing each test ETL\n"
+                "                         with several output option combinations.\n"
                 "\n",
                 PresentMon::exePath_.c_str(),
                 goldDir.c_str());
@@ -222,7 +233,9 @@ int wmain(
     wchar_t* presentMonPathArg = nullptr;
     wchar_t* goldDirArg = nullptr;
     wchar_t* outDirArg = nullptr;
+    wchar_t* recordedDirArg = nullptr;
     bool deleteOutDir = true;
+    bool benchmark = false;
     for (int i = 1; i < argc; ++i) {
         if (_wcsnicmp(argv[i], L"--presentmon=", 13) == 0) {
             presentMonPathArg = argv[i] + 13;
@@ -250,7 +263,31 @@ int wmain(
         }
 
         if (_wcsicmp(argv[i], L"--allcsvdiffs") == 0) {
-            reportAllCsvDiffs_ = true;
+            goldComparisonOptions_.reportAllDiffs_ = true;
+            continue;
+        }
+
+        if (_wcsnicmp(argv[i], L"--diffcontext=", 14) == 0) {
+            goldComparisonOptions_.contextRowCount_ = wcstoul(argv[i] + 14, nullptr, 10);
+            continue;
+        }
+
+        if (_wcsnicmp(argv[i], L"--tolerance=", 12) == 0) {
+            if (!ParseColumnTolerance(Convert(argv[i] + 12).c_str(), &goldComparisonOptions_)) {
+                fprintf(stderr, "error: invalid column tolerance: %ls.\n", argv[i] + 12);
+                fprintf(stderr, "       Expecting --tolerance=column=value, e.g. --tolerance=FrameTime=0.001\n");
+                return 1;
+            }
+            continue;
+        }
+
+        if (_wcsnicmp(argv[i], L"--jobs=", 7) == 0) {
+            jobCount_ = wcstoul(argv[i] + 7, nullptr, 10);
+            continue;
+        }
+
+        if (_wcsnicmp(argv[i], L"--recorded=", 11) == 0) {
+            recordedDirArg = argv[i] + 11;
             continue;
         }
 
@@ -259,6 +296,11 @@ int wmain(
             continue;
         }
 
+        if (_wcsicmp(argv[i], L"--benchmark") == 0) {
+            benchmark = true;
+            continue;
+        }
+
         fprintf(stderr, "error: unrecognized command line argument: %ls.\n", argv[i]);
         fprintf(stderr, "       Use --help command line argument for usage.\n");
         return 1;
@@ -269,12 +311,16 @@ int wmain(
     bool outDirExists = true;
     if (!CheckPath("--presentmon", &PresentMon::exePath_, presentMonPathArg, false, nullptr) ||
         !CheckPath("--golddir", &goldDir, goldDirArg, true, &goldDirExists) ||
-        !CheckPath("--outdir", &outDir_, outDirArg, true, &outDirExists)) {
+        !CheckPath("--outdir", &outDir_, outDirArg, true, &outDirExists) ||
+        (recordedDirArg != nullptr && !CheckPath("--recorded", &recordedDir_, recordedDirArg, true, nullptr))) {
         return 1;
     }
 
     if (goldDirExists) {
         AddGoldEtlCsvTests(goldDir, goldDir.size());
+        if (benchmark) {
+            AddOutputBenchmarkTests(goldDir);
+        }
     } else {
         fprintf(stderr, "warning: gold directory does not exist: %ls\n", goldDir.c_str());
         fprintf(stderr, "         Continuing, but no GoldEtlCsvTests.* will run.  Specify a new path\n");
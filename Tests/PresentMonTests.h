@@ -5,6 +5,8 @@
 #define NOMINMAX
 #endif
 
+#include "GoldCsvComparison.h"
+
 #include <gtest/gtest.h>
 #include <string>
 #include <unordered_map>
@@ -161,9 +163,11 @@ struct PresentMon : PROCESS_INFORMATION {
 
 // PresentMonTests.cpp
 extern std::wstring outDir_;
-extern bool reportAllCsvDiffs_;
 extern bool warnOnMissingCsv_;
 extern std::wstring diffPath_;
+extern std::wstring recordedDir_;
+extern uint32_t jobCount_;
+extern GoldComparisonOptions goldComparisonOptions_;
 
 bool EnsureDirectoryCreated(std::wstring path);
 std::string Convert(std::wstring const& s);
@@ -174,3 +178,6 @@ void AddTestFailure(char const* file, int line, char const* fmt, ...);
 
 // GoldEtlCsvTests.cpp
 void AddGoldEtlCsvTests(std::wstring const& dir, size_t relIdx);
+
+// OutputBenchmarkTests.cpp
+void AddOutputBenchmarkTests(std::wstring const& dir);
@@ -1,15 +1,20 @@
 // Copyright (C) 2017-2024 Intel Corporation
 // SPDX-License-Identifier: MIT
 
-#include <array>
-#include <fstream>
+#include "../../IntelPresentMon/CommonUtilities/csv/CsvReader.h"
+
+#include <algorithm>
+#include <charconv>
 #include <stdio.h>
-#include <string>
-#include <sstream>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace {
 
+namespace csv = pmon::util::csv;
+
 enum Columns {
     Application,
     ProcessID,
@@ -44,18 +49,22 @@ struct Options {
     bool mQpcTime;
 };
 
+// Input rows are parsed in segments of up to this many bytes per thread.
+constexpr size_t SEGMENT_SIZE_PER_THREAD = 16 * 1024 * 1024;
+
+// String fields refer to the mapped input file.
 struct PresentEvent {
-    std::wstring Application;
+    std::string_view Application;
     uint32_t     ProcessID;
     uint64_t     SwapChainAddress;
-    std::wstring Runtime;
-    uint32_t     SyncInterval;
+    std::string_view Runtime;
+    int32_t      SyncInterval;
     uint32_t     PresentFlags;
     bool         Dropped;
     double       TimeInSeconds;
     double       msInPresentAPI;
     bool         AllowsTearing;
-    std::wstring PresentMode;
+    std::string_view PresentMode;
     double       msUntilRenderComplete;
     double       msUntilDisplayed;
     double       msBetweenDisplayChange;
@@ -64,6 +73,13 @@ struct PresentEvent {
     double       msGPUVideoActive;
     double       msSinceInput;
     uint64_t     QPCTime;
+    bool         QPCTimeIsInteger;  // False if the QPCTime column is in seconds
+};
+
+// The presents parsed from a chunk of the input rows, or the line that failed to parse.
+struct ParsedChunk {
+    std::vector<PresentEvent> mPresents;
+    size_t mErrorLine = 0;
 };
 
 struct SwapChainData {
@@ -191,15 +207,15 @@ void ReportMetrics(Options const& opts, SwapChainData* chain, PresentEvent const
         metrics_mVideoBusy   = 0.0;
     }
 
-    printf("%ls,%d,0x%016llX,%ls,%d,%d", p.Application.c_str(),
-                                         p.ProcessID,
-                                         p.SwapChainAddress,
-                                         p.Runtime.c_str(),
-                                         p.SyncInterval,
-                                         p.PresentFlags);
+    printf("%.*s,%d,0x%016llX,%.*s,%d,%d", (int) p.Application.size(), p.Application.data(),
+                                           p.ProcessID,
+                                           p.SwapChainAddress,
+                                           (int) p.Runtime.size(), p.Runtime.data(),
+                                           p.SyncInterval,
+                                           p.PresentFlags);
     if (opts.mTrackDisplay) {
-        printf(",%d,%ls", p.AllowsTearing ? 1 : 0,
-                          p.PresentMode.c_str());
+        printf(",%d,%.*s", p.AllowsTearing ? 1 : 0,
+                           (int) p.PresentMode.size(), p.PresentMode.data());
     }
     if (chain->mNextCPUFrameTimeIsValid) {
         if (opts.mQpcTime) {
@@ -245,6 +261,73 @@ void ReportMetrics(Options const& opts, SwapChainData* chain, PresentEvent const
     chain->mNextCPUFrameTimeIsValid = true;
 }
 
+bool ParseHex(std::string_view field, uint64_t* value)
+{
+    if (field.size() > 2 && field[0] == '0' && (field[1] == 'x' || field[1] == 'X')) {
+        field.remove_prefix(2);
+    }
+    auto end = field.data() + field.size();
+    auto result = std::from_chars(field.data(), end, *value, 16);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+void ParseChunk(Options const& opts, uint32_t const (&columnIndex)[NumColumns], size_t columnCount, std::string_view rows, ParsedChunk* chunk)
+{
+    chunk->mPresents.clear();
+    chunk->mErrorLine = 0;
+
+    csv::Tokenizer tokenizer(rows);
+    std::vector<std::string_view> row;
+    while (tokenizer.ReadRow(row)) {
+        if (row.size() < columnCount) {
+            chunk->mErrorLine = tokenizer.GetLine();
+            return;
+        }
+
+        auto field = [&](Columns column) { return row[columnIndex[column]]; };
+
+        PresentEvent p{};
+        p.Application = field(Application);
+        p.Runtime     = field(Runtime);
+        p.Dropped     = field(Dropped) == "1";
+        bool ok = csv::ParseField(field(ProcessID),      p.ProcessID) &&
+                  ParseHex       (field(SwapChainAddress), &p.SwapChainAddress) &&
+                  csv::ParseField(field(SyncInterval),   p.SyncInterval) &&
+                  csv::ParseField(field(PresentFlags),   p.PresentFlags) &&
+                  csv::ParseField(field(TimeInSeconds),  p.TimeInSeconds) &&
+                  csv::ParseField(field(msInPresentAPI), p.msInPresentAPI);
+        if (opts.mTrackDisplay) {
+            p.AllowsTearing = field(AllowsTearing) == "1";
+            p.PresentMode   = field(PresentMode);
+            ok = ok && csv::ParseField(field(msUntilRenderComplete),  p.msUntilRenderComplete) &&
+                       csv::ParseField(field(msUntilDisplayed),       p.msUntilDisplayed) &&
+                       csv::ParseField(field(msBetweenDisplayChange), p.msBetweenDisplayChange);
+        }
+        if (opts.mTrackGPU) {
+            ok = ok && csv::ParseField(field(msUntilRenderStart), p.msUntilRenderStart) &&
+                       csv::ParseField(field(msGPUActive),        p.msGPUActive);
+        }
+        if (opts.mTrackGPUVideo) {
+            ok = ok && csv::ParseField(field(msGPUVideoActive), p.msGPUVideoActive);
+        }
+        if (opts.mTrackInput) {
+            ok = ok && csv::ParseField(field(msSinceInput), p.msSinceInput);
+        }
+        if (opts.mQpcTime) {
+            auto qpcTime = field(QPCTime);
+            p.QPCTimeIsInteger = qpcTime.find('.') == std::string_view::npos;
+            ok = ok && (!p.QPCTimeIsInteger || csv::ParseField(qpcTime, p.QPCTime));
+        }
+
+        if (!ok) {
+            chunk->mErrorLine = tokenizer.GetLine();
+            return;
+        }
+
+        chunk->mPresents.push_back(p);
+    }
+}
+
 void usage()
 {
     fprintf(stderr,
@@ -263,153 +346,132 @@ int wmain(
         return 1;
     }
 
-    std::wifstream file(argv[1]);
-    if (!file.is_open()) {
+    csv::MappedFile file;
+    if (!file.Open(argv[1])) {
         fprintf(stderr, "error: failed to open input file: %ls\n", argv[1]);
         usage();
         return 2;
     }
 
-    SwapChains swapChains;
-
-    std::wstring line;
-    if (std::getline(file, line)) {
-        std::wstringstream ss(line);
-
-        if (line.size() >= 3 && line[0] == 0xef && line[1] == 0xbb && line[2] == 0xbf) {
-            ss.seekg(3);
-        }
-
-        uint32_t columnIndex[NumColumns];
-        for (uint32_t i = 0; i < NumColumns; ++i) {
-            columnIndex[i] = UINT32_MAX;
-        }
+    csv::Tokenizer tokenizer(file.GetData());
+    std::vector<std::string_view> header;
+    if (!tokenizer.ReadRow(header)) {
+        return 0;
+    }
 
-        std::wstring word;
-        for (uint32_t i = 0; std::getline(ss, word, L','); ++i) {
-                 if (word == L"Application")           columnIndex[Application]            = i;
-            else if (word == L"ProcessID")             columnIndex[ProcessID]              = i;
-            else if (word == L"SwapChainAddress")      columnIndex[SwapChainAddress]       = i;
-            else if (word == L"Runtime")               columnIndex[Runtime]                = i;
-            else if (word == L"SyncInterval")          columnIndex[SyncInterval]           = i;
-            else if (word == L"PresentFlags")          columnIndex[PresentFlags]           = i;
-            else if (word == L"Dropped")               columnIndex[Dropped]                = i;
-            else if (word == L"TimeInSeconds")         columnIndex[TimeInSeconds]          = i;
-            else if (word == L"msInPresentAPI")        columnIndex[msInPresentAPI]         = i;
-            else if (word == L"msBetweenPresents")     columnIndex[msBetweenPresents]      = i;
-            else if (word == L"AllowsTearing")         columnIndex[AllowsTearing]          = i;
-            else if (word == L"PresentMode")           columnIndex[PresentMode]            = i;
-            else if (word == L"msUntilRenderComplete") columnIndex[msUntilRenderComplete]  = i;
-            else if (word == L"msUntilDisplayed")      columnIndex[msUntilDisplayed]       = i;
-            else if (word == L"msBetweenDisplayChange")columnIndex[msBetweenDisplayChange] = i;
-            else if (word == L"msUntilRenderStart")    columnIndex[msUntilRenderStart]     = i;
-            else if (word == L"msGPUActive")           columnIndex[msGPUActive]            = i;
-            else if (word == L"msGPUVideoActive")      columnIndex[msGPUVideoActive]       = i;
-            else if (word == L"msSinceInput")          columnIndex[msSinceInput]           = i;
-            else if (word == L"QPCTime")               columnIndex[QPCTime]                = i;
-            else if (word == L"WasBatched")            columnIndex[WasBatched]             = i;
-            else if (word == L"DwmNotified")           columnIndex[DwmNotified]            = i;
-            else {
-                fprintf(stderr, "error: unrecognised column: %ls\n", word.c_str());
-                return 3;
-            }
-        }
+    uint32_t columnIndex[NumColumns];
+    for (uint32_t i = 0; i < NumColumns; ++i) {
+        columnIndex[i] = UINT32_MAX;
+    }
 
-        if (columnIndex[Application]       == UINT32_MAX ||
-            columnIndex[ProcessID]         == UINT32_MAX ||
-            columnIndex[SwapChainAddress]  == UINT32_MAX ||
-            columnIndex[Runtime]           == UINT32_MAX ||
-            columnIndex[SyncInterval]      == UINT32_MAX ||
-            columnIndex[PresentFlags]      == UINT32_MAX ||
-            columnIndex[Dropped]           == UINT32_MAX ||
-            columnIndex[TimeInSeconds]     == UINT32_MAX ||
-            columnIndex[msInPresentAPI]    == UINT32_MAX ||
-            columnIndex[msBetweenPresents] == UINT32_MAX) {
-            fprintf(stderr, "error: missing expected column.\n");
-            return 4;
+    for (uint32_t i = 0; i < (uint32_t) header.size(); ++i) {
+        auto word = header[i];
+             if (word == "Application")           columnIndex[Application]            = i;
+        else if (word == "ProcessID")             columnIndex[ProcessID]              = i;
+        else if (word == "SwapChainAddress")      columnIndex[SwapChainAddress]       = i;
+        else if (word == "Runtime")               columnIndex[Runtime]                = i;
+        else if (word == "SyncInterval")          columnIndex[SyncInterval]           = i;
+        else if (word == "PresentFlags")          columnIndex[PresentFlags]           = i;
+        else if (word == "Dropped")               columnIndex[Dropped]                = i;
+        else if (word == "TimeInSeconds")         columnIndex[TimeInSeconds]          = i;
+        else if (word == "msInPresentAPI")        columnIndex[msInPresentAPI]         = i;
+        else if (word == "msBetweenPresents")     columnIndex[msBetweenPresents]      = i;
+        else if (word == "AllowsTearing")         columnIndex[AllowsTearing]          = i;
+        else if (word == "PresentMode")           columnIndex[PresentMode]            = i;
+        else if (word == "msUntilRenderComplete") columnIndex[msUntilRenderComplete]  = i;
+        else if (word == "msUntilDisplayed")      columnIndex[msUntilDisplayed]       = i;
+        else if (word == "msBetweenDisplayChange")columnIndex[msBetweenDisplayChange] = i;
+        else if (word == "msUntilRenderStart")    columnIndex[msUntilRenderStart]     = i;
+        else if (word == "msGPUActive")           columnIndex[msGPUActive]            = i;
+        else if (word == "msGPUVideoActive")      columnIndex[msGPUVideoActive]       = i;
+        else if (word == "msSinceInput")          columnIndex[msSinceInput]           = i;
+        else if (word == "QPCTime")               columnIndex[QPCTime]                = i;
+        else if (word == "WasBatched")            columnIndex[WasBatched]             = i;
+        else if (word == "DwmNotified")           columnIndex[DwmNotified]            = i;
+        else {
+            fprintf(stderr, "error: unrecognised column: %.*s\n", (int) word.size(), word.data());
+            return 3;
         }
+    }
 
-        Options opts;
-        opts.mTrackDisplay  = columnIndex[AllowsTearing]          != UINT32_MAX &&
-                              columnIndex[PresentMode]            != UINT32_MAX &&
-                              columnIndex[msUntilRenderComplete]  != UINT32_MAX &&
-                              columnIndex[msUntilDisplayed]       != UINT32_MAX &&
-                              columnIndex[msBetweenDisplayChange] != UINT32_MAX;
-        opts.mTrackGPU      = columnIndex[msUntilRenderStart]     != UINT32_MAX &&
-                              columnIndex[msGPUActive]            != UINT32_MAX;
-        opts.mTrackGPUVideo = columnIndex[msGPUVideoActive]       != UINT32_MAX;
-        opts.mTrackInput    = columnIndex[msSinceInput]           != UINT32_MAX;
-        opts.mQpcTime       = columnIndex[QPCTime]                != UINT32_MAX;
-
-        std::wstring row[NumColumns];
-        bool firstRow = true;
-        while (std::getline(file, line)) {
-            ss.str(line);
-            ss.clear();
-            for (size_t i = 0; std::getline(ss, word, L','); ++i) {
-                row[i] = word;
-            }
+    if (columnIndex[Application]       == UINT32_MAX ||
+        columnIndex[ProcessID]         == UINT32_MAX ||
+        columnIndex[SwapChainAddress]  == UINT32_MAX ||
+        columnIndex[Runtime]           == UINT32_MAX ||
+        columnIndex[SyncInterval]      == UINT32_MAX ||
+        columnIndex[PresentFlags]      == UINT32_MAX ||
+        columnIndex[Dropped]           == UINT32_MAX ||
+        columnIndex[TimeInSeconds]     == UINT32_MAX ||
+        columnIndex[msInPresentAPI]    == UINT32_MAX ||
+        columnIndex[msBetweenPresents] == UINT32_MAX) {
+        fprintf(stderr, "error: missing expected column.\n");
+        return 4;
+    }
 
-            PresentEvent p;
-            p.Application                 =             row[columnIndex[Application]];
-            p.ProcessID                   = std::stoul (row[columnIndex[ProcessID]]);
-            p.SwapChainAddress            = std::stoull(row[columnIndex[SwapChainAddress]], nullptr, 16);
-            p.Runtime                     =             row[columnIndex[Runtime]];
-            p.SyncInterval                = std::stol  (row[columnIndex[SyncInterval]]);
-            p.PresentFlags                = std::stoul (row[columnIndex[PresentFlags]]);
-            p.Dropped                     =             row[columnIndex[Dropped]] == L"1";
-            p.TimeInSeconds               = std::stod  (row[columnIndex[TimeInSeconds]]);
-            p.msInPresentAPI              = std::stod  (row[columnIndex[msInPresentAPI]]);
-            if (opts.mTrackDisplay) {
-                p.AllowsTearing           =             row[columnIndex[AllowsTearing]] == L"1";
-                p.PresentMode             =             row[columnIndex[PresentMode]];
-                p.msUntilRenderComplete   = std::stod  (row[columnIndex[msUntilRenderComplete]]);
-                p.msUntilDisplayed        = std::stod  (row[columnIndex[msUntilDisplayed]]);
-                p.msBetweenDisplayChange  = std::stod  (row[columnIndex[msBetweenDisplayChange]]);
-            }
-            if (opts.mTrackGPU) {
-                p.msUntilRenderStart      = std::stod  (row[columnIndex[msUntilRenderStart]]);
-                p.msGPUActive             = std::stod  (row[columnIndex[msGPUActive]]);
-            }
-            if (opts.mTrackGPUVideo) {
-                p.msGPUVideoActive        = std::stod  (row[columnIndex[msGPUVideoActive]]);
-            }
-            if (opts.mTrackInput) {
-                p.msSinceInput            = std::stod  (row[columnIndex[msSinceInput]]);
+    Options opts;
+    opts.mTrackDisplay  = columnIndex[AllowsTearing]          != UINT32_MAX &&
+                          columnIndex[PresentMode]            != UINT32_MAX &&
+                          columnIndex[msUntilRenderComplete]  != UINT32_MAX &&
+                          columnIndex[msUntilDisplayed]       != UINT32_MAX &&
+                          columnIndex[msBetweenDisplayChange] != UINT32_MAX;
+    opts.mTrackGPU      = columnIndex[msUntilRenderStart]     != UINT32_MAX &&
+                          columnIndex[msGPUActive]            != UINT32_MAX;
+    opts.mTrackGPUVideo = columnIndex[msGPUVideoActive]       != UINT32_MAX;
+    opts.mTrackInput    = columnIndex[msSinceInput]           != UINT32_MAX;
+    opts.mQpcTime       = columnIndex[QPCTime]                != UINT32_MAX;
+
+    // The rows are parsed a segment at a time, to bound the memory used by the parsed presents.
+    // Each segment is split into a chunk per thread and parsed in parallel, then the presents are
+    // reported in file order since each swap chain's metrics depend on its previous presents.
+    auto threadCount = std::max(1u, std::thread::hardware_concurrency());
+    auto rows = tokenizer.GetRemainder();
+    auto segments = csv::SplitIntoChunks(rows, rows.size() / (threadCount * SEGMENT_SIZE_PER_THREAD) + 1);
+
+    auto parseOpts = opts;
+    std::vector<ParsedChunk> parsedChunks(threadCount);
+    SwapChains swapChains;
+    bool firstRow = true;
+    for (auto segment : segments) {
+        auto chunks = csv::SplitIntoChunks(segment, threadCount);
+        csv::ParseChunksInParallel(chunks, [&](size_t i, std::string_view chunk) {
+            ParseChunk(parseOpts, columnIndex, header.size(), chunk, &parsedChunks[i]);
+        });
+
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (parsedChunks[i].mErrorLine != 0) {
+                auto line = tokenizer.GetLine() + std::count(rows.data(), chunks[i].data(), '\n') + parsedChunks[i].mErrorLine;
+                fprintf(stderr, "error: failed to parse line %zu.\n", (size_t) line);
+                return 5;
             }
 
-            if (opts.mQpcTime) {
-                auto const& qpcTime = row[columnIndex[QPCTime]];
-                if (qpcTime.find('.') == std::string::npos) {
-                    p.QPCTime = std::stoull(qpcTime);
-                } else {
+            for (auto const& p : parsedChunks[i].mPresents) {
+                if (opts.mQpcTime && !p.QPCTimeIsInteger) {
                     opts.mQpcTime = false;
                 }
-            }
 
-            if (firstRow) {
-                firstRow = false;
-                WriteCsvHeader(opts);
-            }
+                if (firstRow) {
+                    firstRow = false;
+                    WriteCsvHeader(opts);
+                }
 
-            auto chain = &swapChains[p.ProcessID][p.SwapChainAddress];
+                auto chain = &swapChains[p.ProcessID][p.SwapChainAddress];
 
-            if (p.Dropped) {
-                if (chain->mPendingPresents.empty()) {
-                    ReportMetrics(opts, chain, p, nullptr);
+                if (p.Dropped) {
+                    if (chain->mPendingPresents.empty()) {
+                        ReportMetrics(opts, chain, p, nullptr);
+                    } else {
+                        chain->mPendingPresents.push_back(p);
+                    }
                 } else {
+                    for (auto const& pp : chain->mPendingPresents) {
+                        ReportMetrics(opts, chain, pp, &p);
+                    }
+                    chain->mPendingPresents.clear();
                     chain->mPendingPresents.push_back(p);
                 }
-            } else {
-                for (auto const& pp : chain->mPendingPresents) {
-                    ReportMetrics(opts, chain, pp, &p);
-                }
-                chain->mPendingPresents.clear();
-                chain->mPendingPresents.push_back(p);
             }
         }
     }
 
-    file.close();
     return 0;
 }